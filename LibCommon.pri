@@ -35,6 +35,7 @@ CONFIG += force_debug_info
 win32 {
     QMAKE_CXXFLAGS += /std:c++17
     QMAKE_CXXFLAGS += /MP /W3 /Zc:wchar_t /Zi /Gm- /fp:precise /FC /EHsc /permissive- /bigobj
+    QMAKE_CXXFLAGS += /arch:AVX2
     QMAKE_CXXFLAGS += /D "_WINDOWS" /D "WIN32" /D "WIN64" /D "_MBCS" /D "_SILENCE_ALL_CXX17_DEPRECATION_WARNINGS"
     QMAKE_CXXFLAGS += /D "PARTIO_WIN32" /D "PARTIO_USE_ZLIB" /D "NOMINMAX"
 
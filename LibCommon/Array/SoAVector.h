@@ -0,0 +1,339 @@
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//
+//    .--------------------------------------------------.
+//    |  This file is part of NTCodeBase                 |
+//    |  Created 2018 by NT (https://ttnghia.github.io)  |
+//    '--------------------------------------------------'
+//                            \o/
+//                             |
+//                            / |
+//
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <LibCommon/CommonSetup.h>
+#include <LibCommon/Utils/STLHelpers.h>
+#include <LibCommon/ParallelHelpers/ParallelExec.h>
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+namespace NTCodeBase {
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// Structure of arrays storage for a vector of VecN (e.g. particle positions and velocities)
+// Each component is stored in its own 64-byte aligned array, so the bulk operations below are plain
+// loops over contiguous Real_t arrays that the compiler vectorizes at full SIMD width, which is not
+// possible with StdVT<VecN> (array of structures).
+// Element access goes through operator[], returning VecN by value (const) or a proxy object that converts to
+// and assigns from VecN, thus code written for StdVT<VecN> mostly compiles unchanged.
+// The bulk operations process blocks of BlockSize elements in parallel. The reductions combine the partial
+// results of the blocks in a fixed order, thus their results do not depend on the number of threads.
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<Int N, class Real_t>
+class SoAVector final {
+    ////////////////////////////////////////////////////////////////////////////////
+    NT_TYPE_ALIAS
+    ////////////////////////////////////////////////////////////////////////////////
+public:
+    using ComponentArray = std::vector<Real_t, STLHelpers::AlignedAllocator<Real_t>>;
+    static constexpr size_t BlockSize = 4096;
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // proxy to the i-th element, returned by the non-const operator[]
+    class Reference {
+    public:
+        Reference(SoAVector& v, size_t i) : m_Vector(v), m_Idx(i) {}
+
+        operator VecN() const { return static_cast<const SoAVector&>(m_Vector)[m_Idx]; }
+        Reference& operator=(const VecN& v) { for(Int d = 0; d < N; ++d) { m_Vector.m_Data[d][m_Idx] = v[d]; } return *this; }
+        Reference& operator=(const Reference& r) { return operator=(VecN(r)); }
+        Reference& operator+=(const VecN& v) { for(Int d = 0; d < N; ++d) { m_Vector.m_Data[d][m_Idx] += v[d]; } return *this; }
+        Reference& operator-=(const VecN& v) { for(Int d = 0; d < N; ++d) { m_Vector.m_Data[d][m_Idx] -= v[d]; } return *this; }
+        Reference& operator*=(Real_t s) { for(Int d = 0; d < N; ++d) { m_Vector.m_Data[d][m_Idx] *= s; } return *this; }
+
+        Real_t& operator[](Int d) { return m_Vector.m_Data[d][m_Idx]; }
+        Real_t operator[](Int d) const { return m_Vector.m_Data[d][m_Idx]; }
+
+    private:
+        SoAVector& m_Vector;
+        size_t     m_Idx;
+    };
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // constructors
+    SoAVector() = default;
+    explicit SoAVector(size_t size, const VecN& value = VecN(0)) { resize(size, value); }
+    explicit SoAVector(const StdVT_VecN& aos) { copyFrom(aos); }
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // size
+    size_t size() const noexcept { return m_Size; }
+    bool   empty() const noexcept { return m_Size == 0; }
+    void   reserve(size_t size) { for(Int d = 0; d < N; ++d) { m_Data[d].reserve(size); } }
+    void   resize(size_t size, const VecN& value = VecN(0)) { for(Int d = 0; d < N; ++d) { m_Data[d].resize(size, value[d]); } m_Size = size; }
+    void   clear() { for(Int d = 0; d < N; ++d) { m_Data[d].clear(); } m_Size = 0; }
+    void   push_back(const VecN& v) { for(Int d = 0; d < N; ++d) { m_Data[d].push_back(v[d]); } ++m_Size; }
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // element and component access
+    VecN      operator[](size_t i) const { assert(i < m_Size); VecN v; for(Int d = 0; d < N; ++d) { v[d] = m_Data[d][i]; } return v; }
+    Reference operator[](size_t i) { assert(i < m_Size); return Reference(*this, i); }
+
+    ComponentArray&       component(Int d) { assert(d < N); return m_Data[d]; }
+    const ComponentArray& component(Int d) const { assert(d < N); return m_Data[d]; }
+    Real_t*               data(Int d) { assert(d < N); return m_Data[d].data(); }
+    const Real_t*         data(Int d) const { assert(d < N); return m_Data[d].data(); }
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // conversion from/to array of structures
+    void copyFrom(const StdVT_VecN& aos) {
+        resize(aos.size());
+        forEachBlock([&](size_t begin, size_t end) {
+                         for(size_t i = begin; i < end; ++i) {
+                             for(Int d = 0; d < N; ++d) {
+                                 m_Data[d][i] = aos[i][d];
+                             }
+                         }
+                     });
+    }
+
+    void copyTo(StdVT_VecN& aos) const {
+        aos.resize(m_Size);
+        forEachBlock([&](size_t begin, size_t end) {
+                         for(size_t i = begin; i < end; ++i) {
+                             for(Int d = 0; d < N; ++d) {
+                                 aos[i][d] = m_Data[d][i];
+                             }
+                         }
+                     });
+    }
+
+    StdVT_VecN toAoS() const { StdVT_VecN aos; copyTo(aos); return aos; }
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // bulk operations, the vector arguments must have the same size as this vector
+    void fill(const VecN& value) {
+        forEachComponentBlock([&](Int d, size_t begin, size_t end) { std::fill(data(d) + begin, data(d) + end, value[d]); });
+    }
+
+    SoAVector& operator+=(const SoAVector& x) { addScaled(Real_t(1), x); return *this; }
+    SoAVector& operator-=(const SoAVector& x) { addScaled(Real_t(-1), x); return *this; }
+    SoAVector& operator*=(Real_t alpha) { scale(alpha); return *this; }
+
+    // this = this + alpha * x (axpy)
+    void addScaled(Real_t alpha, const SoAVector& x) {
+        NT_REQUIRE(x.size() == m_Size);
+        forEachComponentBlock([&](Int d, size_t begin, size_t end) {
+                                  Real_t* NT_RESTRICT       y  = data(d);
+                                  const Real_t* NT_RESTRICT xd = x.data(d);
+                                  for(size_t i = begin; i < end; ++i) {
+                                      y[i] += alpha * xd[i];
+                                  }
+                              });
+    }
+
+    // this = x + beta * this
+    void scaledAdd(Real_t beta, const SoAVector& x) {
+        NT_REQUIRE(x.size() == m_Size);
+        forEachComponentBlock([&](Int d, size_t begin, size_t end) {
+                                  Real_t* NT_RESTRICT       y  = data(d);
+                                  const Real_t* NT_RESTRICT xd = x.data(d);
+                                  for(size_t i = begin; i < end; ++i) {
+                                      y[i] = beta * y[i] + xd[i];
+                                  }
+                              });
+    }
+
+    void scale(Real_t alpha) {
+        forEachComponentBlock([&](Int d, size_t begin, size_t end) {
+                                  Real_t* NT_RESTRICT y = data(d);
+                                  for(size_t i = begin; i < end; ++i) {
+                                      y[i] *= alpha;
+                                  }
+                              });
+    }
+
+    // component-wise clamp to [lower, upper], e.g. to keep particles inside the domain box
+    void clamp(const VecN& lower, const VecN& upper) {
+        forEachComponentBlock([&](Int d, size_t begin, size_t end) {
+                                  Real_t* NT_RESTRICT y  = data(d);
+                                  const Real_t        lo = lower[d];
+                                  const Real_t        hi = upper[d];
+                                  for(size_t i = begin; i < end; ++i) {
+                                      y[i] = std::min(std::max(y[i], lo), hi);
+                                  }
+                              });
+    }
+
+    // scale down the elements having length larger than maxLength, e.g. to limit particle velocities
+    void clampLength(Real_t maxLength) {
+        const Real_t maxLength2 = maxLength * maxLength;
+        forEachBlock([&](size_t begin, size_t end) {
+                         for(size_t i = begin; i < end; ++i) {
+                             Real_t l2 = 0;
+                             for(Int d = 0; d < N; ++d) {
+                                 l2 += m_Data[d][i] * m_Data[d][i];
+                             }
+                             const Real_t s = l2 > maxLength2 ? maxLength / std::sqrt(l2) : Real_t(1);
+                             for(Int d = 0; d < N; ++d) {
+                                 m_Data[d][i] *= s;
+                             }
+                         }
+                     });
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // reductions
+    VecN minComponents() const {
+        VecN result;
+        for(Int d = 0; d < N; ++d) {
+            result[d] = reduceBlocks(std::numeric_limits<Real_t>::max(),
+                                     [&](size_t begin, size_t end) {
+                                         const Real_t* NT_RESTRICT x = data(d);
+                                         Real_t                    m = std::numeric_limits<Real_t>::max();
+                                         for(size_t i = begin; i < end; ++i) {
+                                             m = std::min(m, x[i]);
+                                         }
+                                         return m;
+                                     },
+                                     [](Real_t a, Real_t b) { return std::min(a, b); });
+        }
+        return result;
+    }
+
+    VecN maxComponents() const {
+        VecN result;
+        for(Int d = 0; d < N; ++d) {
+            result[d] = reduceBlocks(std::numeric_limits<Real_t>::lowest(),
+                                     [&](size_t begin, size_t end) {
+                                         const Real_t* NT_RESTRICT x = data(d);
+                                         Real_t                    m = std::numeric_limits<Real_t>::lowest();
+                                         for(size_t i = begin; i < end; ++i) {
+                                             m = std::max(m, x[i]);
+                                         }
+                                         return m;
+                                     },
+                                     [](Real_t a, Real_t b) { return std::max(a, b); });
+        }
+        return result;
+    }
+
+    Real_t dotProduct(const SoAVector& x) const {
+        NT_REQUIRE(x.size() == m_Size);
+        return reduceBlocks(Real_t(0),
+                            [&](size_t begin, size_t end) {
+                                const Real_t* NT_RESTRICT xp[N];
+                                const Real_t* NT_RESTRICT yp[N];
+                                for(Int d = 0; d < N; ++d) {
+                                    xp[d] = data(d);
+                                    yp[d] = x.data(d);
+                                }
+                                return sumBlock(begin, end, [&](size_t i) {
+                                                    Real_t s = 0;
+                                                    for(Int d = 0; d < N; ++d) {
+                                                        s += xp[d][i] * yp[d][i];
+                                                    }
+                                                    return s;
+                                                });
+                            },
+                            [](Real_t a, Real_t b) { return a + b; });
+    }
+
+    // sum of squared lengths, as ParallelBLAS::norm2
+    Real_t norm2() const { return dotProduct(*this); }
+
+    // largest element length, e.g. for CFL time step computation
+    Real_t maxNorm() const {
+        const Real_t maxL2 = reduceBlocks(Real_t(0),
+                                          [&](size_t begin, size_t end) {
+                                              Real_t m = 0;
+                                              for(size_t i = begin; i < end; ++i) {
+                                                  Real_t l2 = 0;
+                                                  for(Int d = 0; d < N; ++d) {
+                                                      l2 += m_Data[d][i] * m_Data[d][i];
+                                                  }
+                                                  m = std::max(m, l2);
+                                              }
+                                              return m;
+                                          },
+                                          [](Real_t a, Real_t b) { return std::max(a, b); });
+        return std::sqrt(maxL2);
+    }
+
+    // norms[i] = length of the i-th element
+    void computeNorms(StdVT<Real_t>& norms) const {
+        norms.resize(m_Size);
+        forEachBlock([&](size_t begin, size_t end) {
+                         for(size_t i = begin; i < end; ++i) {
+                             Real_t l2 = 0;
+                             for(Int d = 0; d < N; ++d) {
+                                 l2 += m_Data[d][i] * m_Data[d][i];
+                             }
+                             norms[i] = std::sqrt(l2);
+                         }
+                     });
+    }
+
+private:
+    size_t numBlocks() const noexcept { return (m_Size + BlockSize - 1) / BlockSize; }
+
+    template<class Function>
+    void forEachBlock(Function&& func) const {
+        ParallelExec::run(numBlocks(), [&](size_t block) { func(block * BlockSize, std::min(m_Size, (block + 1) * BlockSize)); });
+    }
+
+    template<class Function>
+    void forEachComponentBlock(Function&& func) const {
+        ParallelExec::run(numBlocks() * N,
+                          [&](size_t idx) {
+                              const Int    d     = static_cast<Int>(idx % N);
+                              const size_t block = idx / N;
+                              func(d, block * BlockSize, std::min(m_Size, (block + 1) * BlockSize));
+                          });
+    }
+
+    // partial results of the blocks are computed in parallel then combined serially in block order
+    template<class BlockFunction, class Combine>
+    Real_t reduceBlocks(Real_t zero, BlockFunction&& blockFunc, Combine&& combine) const {
+        StdVT<Real_t> partials(numBlocks(), zero);
+        ParallelExec::run(partials.size(), [&](size_t block) { partials[block] = blockFunc(block * BlockSize, std::min(m_Size, (block + 1) * BlockSize)); });
+        Real_t result = zero;
+        for(auto x : partials) {
+            result = combine(result, x);
+        }
+        return result;
+    }
+
+    // sum with SumLanes independent accumulators, so the compiler can keep them in one SIMD register
+    // (a single accumulator would serialize the additions, as floating point addition is not associative)
+    template<class Function>
+    Real_t sumBlock(size_t begin, size_t end, Function&& func) const {
+        constexpr size_t SumLanes      = 16;
+        Real_t           acc[SumLanes] = {};
+        size_t           i             = begin;
+        for(; i + SumLanes <= end; i += SumLanes) {
+            for(size_t l = 0; l < SumLanes; ++l) {
+                acc[l] += func(i + l);
+            }
+        }
+        for(; i < end; ++i) {
+            acc[0] += func(i);
+        }
+        Real_t sum = 0;
+        for(size_t l = 0; l < SumLanes; ++l) {
+            sum += acc[l];
+        }
+        return sum;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+    ComponentArray m_Data[N];
+    size_t         m_Size = 0;
+};
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+} // end namespace NTCodeBase
@@ -0,0 +1,117 @@
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//
+//    .--------------------------------------------------.
+//    |  This file is part of NTCodeBase                 |
+//    |  Created 2018 by NT (https://ttnghia.github.io)  |
+//    '--------------------------------------------------'
+//                            \o/
+//                             |
+//                            / |
+//
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+
+
+#pragma once
+
+#include <catch2/catch.hpp>
+#include <LibCommon/CommonSetup.h>
+#include <LibCommon/Array/SoAVector.h>
+#include <LibCommon/Utils/NumberHelpers.h>
+
+using namespace NTCodeBase;
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// SoAVector operations against the same operations written on StdVT<Vec3>, for sizes smaller than, equal to,
+// and not multiple of the block size
+template<class Real_t>
+void testSoAVector(size_t size, Real_t tolerance) {
+    using SoAVec3 = SoAVector<3, Real_t>;
+    const Real_t alpha = Real_t(0.37);
+    const Real_t beta  = Real_t(-1.25);
+
+    StdVT_Vec3<Real_t> x(size), y(size);
+    for(size_t i = 0; i < size; ++i) {
+        x[i] = NumberHelpers::fRand11<Real_t>::template vrnd<Vec3<Real_t>>();
+        y[i] = Real_t(3) * NumberHelpers::fRand11<Real_t>::template vrnd<Vec3<Real_t>>();
+    }
+    auto requireEqual = [&](const SoAVec3& soa, const StdVT_Vec3<Real_t>& aos) {
+                            REQUIRE(soa.size() == aos.size());
+                            for(size_t i = 0; i < aos.size(); ++i) {
+                                for(Int d = 0; d < 3; ++d) {
+                                    REQUIRE(std::abs(soa[i][d] - aos[i][d]) <= tolerance * (Real_t(1) + std::abs(aos[i][d])));
+                                }
+                            }
+                        };
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // conversions are exact
+    SoAVec3 soaX(x), soaY;
+    soaY.copyFrom(y);
+    REQUIRE(soaX.toAoS() == x);
+    REQUIRE(soaY.toAoS() == y);
+    for(size_t i = 0; i < size; ++i) {
+        REQUIRE(Vec3<Real_t>(soaY[i]) == y[i]);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // reductions
+    double dot    = 0;
+    Real_t maxL2  = 0;
+    auto   minVal = Vec3<Real_t>(std::numeric_limits<Real_t>::max());
+    auto   maxVal = Vec3<Real_t>(std::numeric_limits<Real_t>::lowest());
+    for(size_t i = 0; i < size; ++i) {
+        dot   += static_cast<double>(glm::dot(x[i], y[i]));
+        maxL2  = std::max(maxL2, glm::length2(y[i]));
+        minVal = glm::min(minVal, y[i]);
+        maxVal = glm::max(maxVal, y[i]);
+    }
+    REQUIRE(std::abs(static_cast<double>(soaX.dotProduct(soaY)) - dot) <= static_cast<double>(tolerance) * (1.0 + static_cast<double>(size)));
+    REQUIRE(std::abs(soaY.maxNorm() - std::sqrt(maxL2)) <= tolerance * (Real_t(1) + std::sqrt(maxL2)));
+    REQUIRE(soaY.minComponents() == minVal);
+    REQUIRE(soaY.maxComponents() == maxVal);
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // bulk operations
+    soaY.addScaled(alpha, soaX);
+    for(size_t i = 0; i < size; ++i) {
+        y[i] += alpha * x[i];
+    }
+    requireEqual(soaY, y);
+
+    soaY.scaledAdd(beta, soaX);
+    for(size_t i = 0; i < size; ++i) {
+        y[i] = beta * y[i] + x[i];
+    }
+    requireEqual(soaY, y);
+
+    const auto lower = Vec3<Real_t>(-1, Real_t(-0.5), 0);
+    const auto upper = Vec3<Real_t>(Real_t(0.5), 1, 2);
+    soaY.clamp(lower, upper);
+    for(size_t i = 0; i < size; ++i) {
+        y[i] = glm::clamp(y[i], lower, upper);
+    }
+    requireEqual(soaY, y);
+
+    // y is now in [-1, 2]^3, thus a part of the elements is longer than maxLength
+    const Real_t maxLength = Real_t(1.2);
+    soaY.clampLength(maxLength);
+    for(size_t i = 0; i < size; ++i) {
+        const Real_t l = glm::length(y[i]);
+        if(l > maxLength) {
+            y[i] *= maxLength / l;
+        }
+    }
+    requireEqual(soaY, y);
+    REQUIRE(soaY.maxNorm() <= maxLength * (Real_t(1) + tolerance));
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+TEST_CASE("Test_SoAVector", "[Test_SoAVector]")
+{
+    for(size_t size : { size_t(1), size_t(1000), SoAVector<3, float>::BlockSize, 3 * SoAVector<3, float>::BlockSize + 17 }) {
+        testSoAVector<float>(size, 1e-5f);
+        testSoAVector<double>(size, 1e-12);
+    }
+}
@@ -13,10 +13,12 @@
 
 #include <LibCommon/CommonSetup.h>
 #include <LibCommon/Array/Array.h>
+#include <LibCommon/Array/SoAVector.h>
 #include <LibCommon/Utils/NumberHelpers.h>
 #include <LibCommon/Timer/Timer.h>
 #include <LibCommon/ParallelHelpers/AtomicOperations.h>
 #include <LibCommon/ParallelHelpers/ParallelExec.h>
+#include <LibCommon/ParallelHelpers/ParallelBLAS.h>
 
 namespace TestArray {
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
@@ -108,5 +110,41 @@ void test_array_access() {
     printf("z time: %f\n",                  float(zTime));
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// particle-like update x += dt * v, v clamped to [-1, 1], then dot product, with StdVT<Vec3> and SoAVector
+void test_soa_vector() {
+    StdVT_Vec3<Real_t> positions(NUM_ELEMENTS), velocities(NUM_ELEMENTS);
+    for(UInt i = 0; i < NUM_ELEMENTS; ++i) {
+        positions[i]  = Vec3<Real_t>(Real_t(rand()) / Real_t(RAND_MAX), Real_t(rand()) / Real_t(RAND_MAX), Real_t(rand()) / Real_t(RAND_MAX));
+        velocities[i] = Real_t(4) * (Vec3<Real_t>(Real_t(rand()) / Real_t(RAND_MAX), Real_t(rand()) / Real_t(RAND_MAX), Real_t(rand()) / Real_t(RAND_MAX)) - Real_t(0.5));
+    }
+    const Real_t         dt = Real_t(1e-3);
+    SoAVector<3, Real_t> soaPositions(positions), soaVelocities(velocities);
+    Timer                timer;
+    double               aosTime = 0, soaTime = 0;
+    Real_t               aosDot  = 0, soaDot = 0;
+
+    for(int i = 0; i < PERFORMANCE_TEST_NUM; ++i) {
+        timer.tick();
+        ParallelExec::run(velocities.size(), [&](size_t p) { velocities[p] = glm::clamp(velocities[p], Vec3<Real_t>(-1), Vec3<Real_t>(1)); });
+        ParallelBLAS::addScaled(dt, velocities, positions);
+        aosDot   = ParallelBLAS::dotProduct(positions, velocities, ParallelExec::ReductionPolicy::Deterministic);
+        aosTime += timer.tock();
+
+        timer.tick();
+        soaVelocities.clamp(Vec3<Real_t>(-1), Vec3<Real_t>(1));
+        soaPositions.addScaled(dt, soaVelocities);
+        soaDot   = soaPositions.dotProduct(soaVelocities);
+        soaTime += timer.tock();
+    }
+
+    Real_t maxDiff = 0;
+    for(UInt i = 0; i < NUM_ELEMENTS; ++i) {
+        maxDiff = std::max(maxDiff, glm::compMax(glm::abs(positions[i] - Vec3<Real_t>(soaPositions[i]))));
+    }
+    printf("AoS: dot = %f, time = %f ms\n", float(aosDot), float(aosTime));
+    printf("SoA: dot = %f, time = %f ms, max position difference = %g\n", float(soaDot), float(soaTime), float(maxDiff));
+}
+
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 }
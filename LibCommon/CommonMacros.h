@@ -98,10 +98,17 @@ namespace NTCodeBase {
 
 #ifdef NT_IN_WINDOWS_OS
 #define NT_ALIGN16 _MM_ALIGN16
+#define NT_ALIGN32 __declspec(align(32))
+#define NT_ALIGN64 __declspec(align(64))
 #else
 #define NT_ALIGN16 __attribute__((aligned(16)))
+#define NT_ALIGN32 __attribute__((aligned(32)))
+#define NT_ALIGN64 __attribute__((aligned(64)))
 #endif
 
+// pointer not aliased by any other pointer in its scope, supported by MSVC, GCC and Clang
+#define NT_RESTRICT __restrict
+
 #ifdef NT_DEBUG
 #  define NT_DEBUG_BREAK_OR_TERMINATE debug_break();
 #else
@@ -14,6 +14,8 @@
 
 #include <LibCommon/LinearAlgebra/ImplicitQRSVD.h>
 #include <LibCommon/Math/MathHelpers.h>
+#include <LibCommon/Math/SIMDPack.h>
+#include <LibCommon/ParallelHelpers/ParallelExec.h>
 
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
@@ -841,6 +843,287 @@ std::pair<MatMxN<M, M, T>, MatMxN<M, N, T>> GivensQR(const MatMxN<M, N, T>& A) {
     return std::make_pair(Q, R);
 }
 
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// Batched 3x3 SVD
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+namespace {
+using SIMD::Pack;
+
+// number of Jacobi sweeps: with fewer sweeps, the reconstruction error of the worst cases of random matrices
+// is well above the machine precision (1e-2 for float with the 4 sweeps of McAdams et al.)
+template<class T> constexpr Int JacobiSweeps() { return std::is_same_v<T, float> ? 6 : 7; }
+template<class T> constexpr T   QREpsilon() { return std::is_same_v<T, float> ? T(1e-6) : T(1e-14); }
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// Branch-free SVD of 3x3 matrices (McAdams, Selle, Tamstorf, Teran, Sifakis 2011), all lanes at once:
+//    - Jacobi eigenanalysis of A^T * A with approximate Givens rotations, fixed number of sweeps,
+//      the rotations are accumulated in a quaternion and give V
+//    - B = A * V, columns sorted by decreasing norm (conditional swaps, one column negated to keep det(V) = 1)
+//    - QR decomposition of B by Givens rotations: U = Q, Sigma = diag(R)
+// Matrices are stored row major in 9 packs: m[row * 3 + col]
+template<class T>
+struct BatchedSVD {
+    using P = Pack<T>;
+
+    static void condSwap(typename P::Mask c, P& x, P& y) {
+        const P z = x;
+        x = select(c, y, x);
+        y = select(c, z, y);
+    }
+
+    static void condNegSwap(typename P::Mask c, P& x, P& y) {
+        const P z = -x;
+        x = select(c, y, x);
+        y = select(c, z, y);
+    }
+
+    // quaternion (ch, sh) of the approximate Givens rotation annihilating a12 of the symmetric 2x2 [a11 a12; a12 a22]
+    static void approximateGivensQuaternion(P a11, P a12, P a22, P& ch, P& sh) {
+        const T gamma = T(5.828427124746190); // 3 + 2 * sqrt(2)
+        const T cstar = T(0.923879532511287); // cos(pi / 8)
+        const T sstar = T(0.382683432365090); // sin(pi / 8)
+        ch = P::set1(T(2)) * (a11 - a22);
+        sh = a12;
+        const auto b = P::set1(gamma) * sh * sh < ch * ch;
+        const P    w = rsqrt(ch * ch + sh * sh);
+        ch = select(b, w * ch, P::set1(cstar));
+        sh = select(b, w * sh, P::set1(sstar));
+    }
+
+    // S = Q^T * S * Q for the (p, q) pair in the leading position, then rotate the indices for the next pair
+    // (x, y, z) = (0, 1, 2), (1, 2, 0), (2, 0, 1) for (p, q) = (0, 1), (1, 2), (0, 2)
+    template<Int x, Int y, Int z>
+    static void jacobiConjugation(P& s11, P& s21, P& s22, P& s31, P& s32, P& s33, P qV[4]) {
+        P ch, sh;
+        approximateGivensQuaternion(s11, s21, s22, ch, sh);
+        // (ch, sh) is normalized, thus the rotation is (cos, sin) = (ch^2 - sh^2, 2 * ch * sh)
+        const P a = ch * ch - sh * sh;
+        const P b = P::set1(T(2)) * sh * ch;
+
+        const P t11 = s11, t21 = s21, t22 = s22, t31 = s31, t32 = s32, t33 = s33;
+        s11 = a * (a * t11 + b * t21) + b * (a * t21 + b * t22);
+        s21 = a * (-b * t11 + a * t21) + b * (-b * t21 + a * t22);
+        s22 = -b * (-b * t11 + a * t21) + a * (-b * t21 + a * t22);
+        s31 = a * t31 + b * t32;
+        s32 = -b * t31 + a * t32;
+        s33 = t33;
+
+        // qV = qV * (ch, sh on axis z)
+        const P tmp[3] = { qV[0] * sh, qV[1] * sh, qV[2] * sh };
+        sh = sh * qV[3];
+        for(Int i = 0; i < 4; ++i) {
+            qV[i] = qV[i] * ch;
+        }
+        qV[z] = qV[z] + sh;
+        qV[3] = qV[3] - tmp[z];
+        qV[x] = qV[x] + tmp[y];
+        qV[y] = qV[y] - tmp[x];
+
+        // cyclic permutation of the indices
+        const P u11 = s22, u21 = s32, u22 = s33, u31 = s21, u32 = s31, u33 = s11;
+        s11 = u11; s21 = u21; s22 = u22; s31 = u31; s32 = u32; s33 = u33;
+    }
+
+    // Givens quaternion for the QR step, a1 = diagonal (pivot), a2 = entry to annihilate
+    static void QRGivensQuaternion(P a1, P a2, P& ch, P& sh) {
+        const P epsilon = P::set1(QREpsilon<T>());
+        const P rho     = sqrt(a1 * a1 + a2 * a2);
+        sh = select(epsilon < rho, a2, P::set1(T(0)));
+        ch = abs(a1) + max(rho, epsilon);
+        condSwap(a1 < P::set1(T(0)), sh, ch);
+        const P w = rsqrt(ch * ch + sh * sh);
+        ch = ch * w;
+        sh = sh * w;
+    }
+
+    static void svd(const P a[9], P u[9], P sigma[3], P v[9]) {
+        ////////////////////////////////////////////////////////////////////////////////
+        // eigenvectors of A^T * A
+        P s11 = a[0] * a[0] + a[3] * a[3] + a[6] * a[6];
+        P s21 = a[1] * a[0] + a[4] * a[3] + a[7] * a[6];
+        P s22 = a[1] * a[1] + a[4] * a[4] + a[7] * a[7];
+        P s31 = a[2] * a[0] + a[5] * a[3] + a[8] * a[6];
+        P s32 = a[2] * a[1] + a[5] * a[4] + a[8] * a[7];
+        P s33 = a[2] * a[2] + a[5] * a[5] + a[8] * a[8];
+        P qV[4] = { P::set1(T(0)), P::set1(T(0)), P::set1(T(0)), P::set1(T(1)) };
+        for(Int sweep = 0; sweep < JacobiSweeps<T>(); ++sweep) {
+            jacobiConjugation<0, 1, 2>(s11, s21, s22, s31, s32, s33, qV);
+            jacobiConjugation<1, 2, 0>(s11, s21, s22, s31, s32, s33, qV);
+            jacobiConjugation<2, 0, 1>(s11, s21, s22, s31, s32, s33, qV);
+        }
+
+        // rotation matrix of the (renormalized) quaternion
+        const P n  = rsqrt(qV[0] * qV[0] + qV[1] * qV[1] + qV[2] * qV[2] + qV[3] * qV[3]);
+        const P qx = qV[0] * n, qy = qV[1] * n, qz = qV[2] * n, qw = qV[3] * n;
+        const P one = P::set1(T(1)), two = P::set1(T(2));
+        v[0] = one - two * (qy * qy + qz * qz); v[1] = two * (qx * qy - qw * qz);       v[2] = two * (qx * qz + qw * qy);
+        v[3] = two * (qx * qy + qw * qz);       v[4] = one - two * (qx * qx + qz * qz); v[5] = two * (qy * qz - qw * qx);
+        v[6] = two * (qx * qz - qw * qy);       v[7] = two * (qy * qz + qw * qx);       v[8] = one - two * (qx * qx + qy * qy);
+
+        ////////////////////////////////////////////////////////////////////////////////
+        // B = A * V, sorted by decreasing column norms
+        P b[9];
+        for(Int r = 0; r < 3; ++r) {
+            for(Int c = 0; c < 3; ++c) {
+                b[r * 3 + c] = a[r * 3] * v[c] + a[r * 3 + 1] * v[3 + c] + a[r * 3 + 2] * v[6 + c];
+            }
+        }
+        P rho[3];
+        for(Int c = 0; c < 3; ++c) {
+            rho[c] = b[c] * b[c] + b[3 + c] * b[3 + c] + b[6 + c] * b[6 + c];
+        }
+        auto sortColumns = [&](Int c1, Int c2) {
+                               const auto mask = rho[c1] < rho[c2];
+                               for(Int r = 0; r < 3; ++r) {
+                                   condNegSwap(mask, b[r * 3 + c1], b[r * 3 + c2]);
+                                   condNegSwap(mask, v[r * 3 + c1], v[r * 3 + c2]);
+                               }
+                               condSwap(mask, rho[c1], rho[c2]);
+                           };
+        sortColumns(0, 1);
+        sortColumns(0, 2);
+        sortColumns(1, 2);
+
+        ////////////////////////////////////////////////////////////////////////////////
+        // QR decomposition of B, Q = Q1 * Q2 * Q3
+        P ch1, sh1, ch2, sh2, ch3, sh3, ca, sa;
+        P r[9];
+        QRGivensQuaternion(b[0], b[3], ch1, sh1);
+        ca = one - two * sh1 * sh1;
+        sa = two * ch1 * sh1;
+        for(Int c = 0; c < 3; ++c) {
+            r[c]     = ca * b[c] + sa * b[3 + c];
+            r[3 + c] = -sa * b[c] + ca * b[3 + c];
+            r[6 + c] = b[6 + c];
+        }
+        QRGivensQuaternion(r[0], r[6], ch2, sh2);
+        ca = one - two * sh2 * sh2;
+        sa = two * ch2 * sh2;
+        for(Int c = 0; c < 3; ++c) {
+            b[c]     = ca * r[c] + sa * r[6 + c];
+            b[3 + c] = r[3 + c];
+            b[6 + c] = -sa * r[c] + ca * r[6 + c];
+        }
+        QRGivensQuaternion(b[4], b[7], ch3, sh3);
+        ca = one - two * sh3 * sh3;
+        sa = two * ch3 * sh3;
+        sigma[0] = b[0];
+        sigma[1] = ca * b[4] + sa * b[7];
+        sigma[2] = -sa * b[5] + ca * b[8];
+
+        const P sh12 = sh1 * sh1, sh22 = sh2 * sh2, sh32 = sh3 * sh3;
+        const P four = P::set1(T(4)), eight = P::set1(T(8));
+        const P m1 = two * sh12 - one, m2 = two * sh22 - one, m3 = two * sh32 - one;
+        u[0] = m1 * m2;
+        u[1] = four * ch2 * ch3 * m1 * sh2 * sh3 + two * ch1 * sh1 * m3;
+        u[2] = four * ch1 * ch3 * sh1 * sh3 - two * ch2 * m1 * sh2 * m3;
+        u[3] = -two * ch1 * sh1 * m2;
+        u[4] = -eight * ch1 * ch2 * ch3 * sh1 * sh2 * sh3 + m1 * m3;
+        u[5] = -two * ch3 * sh3 + four * sh1 * (ch3 * sh1 * sh3 + ch1 * ch2 * sh2 * m3);
+        u[6] = two * ch2 * sh2;
+        u[7] = -two * ch3 * m2 * sh3;
+        u[8] = m2 * m3;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // transpose groups of Width matrices to SoA, decompose, transpose back
+    // the last group is padded with identity matrices
+    template<class Output>
+    static void run(const StdVT<Mat3x3<T>>& A, Output&& output) {
+        constexpr Int W       = P::Width;
+        const UInt    nGroups = static_cast<UInt>((A.size() + W - 1) / W);
+        ParallelExec::run(nGroups,
+                          [&](UInt group) {
+                              alignas(64) T buffer[9][W];
+                              const size_t  first = static_cast<size_t>(group) * W;
+                              for(Int lane = 0; lane < W; ++lane) {
+                                  const auto& M = first + lane < A.size() ? A[first + lane] : Mat3x3<T>(1);
+                                  for(Int r = 0; r < 3; ++r) {
+                                      for(Int c = 0; c < 3; ++c) {
+                                          buffer[r * 3 + c][lane] = M[c][r];
+                                      }
+                                  }
+                              }
+                              P a[9], u[9], sigma[3], v[9];
+                              for(Int k = 0; k < 9; ++k) {
+                                  a[k] = P::load(buffer[k]);
+                              }
+                              svd(a, u, sigma, v);
+                              output(first, std::min<size_t>(W, A.size() - first), u, sigma, v);
+                          });
+    }
+};
+} // end anonymous namespace
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<class T>
+void svd(const StdVT<Mat3x3<T>>& A, StdVT<Mat3x3<T>>& U, StdVT<Vec3<T>>& sigma, StdVT<Mat3x3<T>>& V) {
+    constexpr Int W = Pack<T>::Width;
+    U.resize(A.size());
+    sigma.resize(A.size());
+    V.resize(A.size());
+    if constexpr(W == 1) {
+        // without SIMD, the implicit QR version is faster than the fixed number of Jacobi sweeps
+        ParallelExec::run(A.size(), [&](size_t i) { std::tie(U[i], sigma[i], V[i]) = svd(A[i]); });
+        return;
+    }
+    BatchedSVD<T>::run(A, [&](size_t first, size_t count, const Pack<T> u[9], const Pack<T> s[3], const Pack<T> v[9]) {
+                           alignas(64) T bufU[9][W], bufS[3][W], bufV[9][W];
+                           for(Int k = 0; k < 9; ++k) {
+                               u[k].store(bufU[k]);
+                               v[k].store(bufV[k]);
+                           }
+                           for(Int k = 0; k < 3; ++k) {
+                               s[k].store(bufS[k]);
+                           }
+                           for(size_t lane = 0; lane < count; ++lane) {
+                               auto& Ul = U[first + lane];
+                               auto& Vl = V[first + lane];
+                               for(Int r = 0; r < 3; ++r) {
+                                   for(Int c = 0; c < 3; ++c) {
+                                       Ul[c][r] = bufU[r * 3 + c][lane];
+                                       Vl[c][r] = bufV[r * 3 + c][lane];
+                                   }
+                                   sigma[first + lane][r] = bufS[r][lane];
+                               }
+                           }
+                       });
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// R = U * V^T and S = V * Sigma * V^T are also computed in SoA form
+template<class T>
+void polarDecomposition(const StdVT<Mat3x3<T>>& A, StdVT<Mat3x3<T>>& R, StdVT<Mat3x3<T>>& S_Sym) {
+    using P         = Pack<T>;
+    constexpr Int W = P::Width;
+    R.resize(A.size());
+    S_Sym.resize(A.size());
+    if constexpr(W == 1) {
+        ParallelExec::run(A.size(), [&](size_t i) { std::tie(R[i], S_Sym[i]) = polarDecomposition(A[i]); });
+        return;
+    }
+    BatchedSVD<T>::run(A, [&](size_t first, size_t count, const P u[9], const P s[3], const P v[9]) {
+                           alignas(64) T bufR[9][W], bufS[9][W];
+                           for(Int r = 0; r < 3; ++r) {
+                               for(Int c = 0; c < 3; ++c) {
+                                   const P rot = u[r * 3] * v[c * 3] + u[r * 3 + 1] * v[c * 3 + 1] + u[r * 3 + 2] * v[c * 3 + 2];
+                                   const P sym = v[r * 3] * s[0] * v[c * 3] + v[r * 3 + 1] * s[1] * v[c * 3 + 1] + v[r * 3 + 2] * s[2] * v[c * 3 + 2];
+                                   rot.store(bufR[r * 3 + c]);
+                                   sym.store(bufS[r * 3 + c]);
+                               }
+                           }
+                           for(size_t lane = 0; lane < count; ++lane) {
+                               for(Int r = 0; r < 3; ++r) {
+                                   for(Int c = 0; c < 3; ++c) {
+                                       R[first + lane][c][r]     = bufR[r * 3 + c][lane];
+                                       S_Sym[first + lane][c][r] = bufS[r * 3 + c][lane];
+                                   }
+                               }
+                           }
+                       });
+}
+
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 #define __BNN_INSTANTIATE_QRSVD_FUNCS(dim, type)                                                                     \
@@ -853,6 +1136,11 @@ __BNN_INSTANTIATE_QRSVD_FUNCS(2, float)
 __BNN_INSTANTIATE_QRSVD_FUNCS(2, double)
 __BNN_INSTANTIATE_QRSVD_FUNCS(3, float)
 __BNN_INSTANTIATE_QRSVD_FUNCS(3, double)
+
+template void svd<float>(const StdVT<Mat3x3f>&, StdVT<Mat3x3f>&, StdVT<Vec3f>&, StdVT<Mat3x3f>&);
+template void svd<double>(const StdVT<Mat3x3d>&, StdVT<Mat3x3d>&, StdVT<Vec3d>&, StdVT<Mat3x3d>&);
+template void polarDecomposition<float>(const StdVT<Mat3x3f>&, StdVT<Mat3x3f>&, StdVT<Mat3x3f>&);
+template void polarDecomposition<double>(const StdVT<Mat3x3d>&, StdVT<Mat3x3d>&, StdVT<Mat3x3d>&);
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 } // end namespace NTCodeBase::QRSVD
@@ -0,0 +1,745 @@
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//
+//    .--------------------------------------------------.
+//    |  This file is part of NTCodeBase                 |
+//    |  Created 2018 by NT (https://ttnghia.github.io)  |
+//    '--------------------------------------------------'
+//                            \o/
+//                             |
+//                            / |
+//
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+
+#include <LibCommon/LinearAlgebra/LinearSolvers/AMGSolver.h>
+#include <LibCommon/ParallelHelpers/AtomicOperations.h>
+#include <LibCommon/Utils/NumberHelpers.h>
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+namespace NTCodeBase {
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+namespace {
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// result = matrix * x, the matrix can be rectangular (FixedSparseMatrix::multiply requires square matrix)
+template<class Real_t>
+void multiplyRectangular(const FixedSparseMatrix<Real_t>& matrix, const StdVT<Real_t>& x, StdVT<Real_t>& result) {
+    result.resize(matrix.nRows);
+    ParallelExec::run(matrix.nRows,
+                      [&](UInt i) {
+                          Real_t tmp = 0;
+                          for(UInt j = matrix.rowStart[i], jEnd = matrix.rowStart[i + 1]; j < jEnd; ++j) {
+                              tmp += matrix.colValue[j] * x[matrix.colIndex[j]];
+                          }
+                          result[i] = tmp;
+                      });
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// Sort entries of each row by column index
+template<class Real_t>
+void sortRows(FixedSparseMatrix<Real_t>& matrix) {
+    ParallelExec::run(matrix.nRows,
+                      [&](UInt i) {
+                          const auto rowBegin = matrix.rowStart[i];
+                          const auto rowEnd   = matrix.rowStart[i + 1];
+                          for(UInt j = rowBegin + 1; j < rowEnd; ++j) {
+                              const auto col = matrix.colIndex[j];
+                              const auto val = matrix.colValue[j];
+                              UInt       k   = j;
+                              for(; k > rowBegin && matrix.colIndex[k - 1] > col; --k) {
+                                  matrix.colIndex[k] = matrix.colIndex[k - 1];
+                                  matrix.colValue[k] = matrix.colValue[k - 1];
+                              }
+                              matrix.colIndex[k] = col;
+                              matrix.colValue[k] = val;
+                          }
+                      });
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// result = matrix^T, matrix has nCols columns
+template<class Real_t>
+void transpose(const FixedSparseMatrix<Real_t>& matrix, UInt nCols, FixedSparseMatrix<Real_t>& result) {
+    result.resize(nCols);
+    result.rowStart.assign(nCols + 1, 0);
+    ParallelExec::run(matrix.nRows,
+                      [&](UInt i) {
+                          for(UInt j = matrix.rowStart[i], jEnd = matrix.rowStart[i + 1]; j < jEnd; ++j) {
+                              AtomicOps::fetchAdd(result.rowStart[matrix.colIndex[j]], 1u);
+                          }
+                      });
+    const auto nnz = ParallelSTL::exclusive_scan(result.rowStart);
+    result.colIndex.resize(nnz);
+    result.colValue.resize(nnz);
+
+    StdVT_UInt cursor(result.rowStart.begin(), result.rowStart.end() - 1);
+    ParallelExec::run(matrix.nRows,
+                      [&](UInt i) {
+                          for(UInt j = matrix.rowStart[i], jEnd = matrix.rowStart[i + 1]; j < jEnd; ++j) {
+                              const auto pos = AtomicOps::fetchAdd(cursor[matrix.colIndex[j]], 1u);
+                              result.colIndex[pos] = i;
+                              result.colValue[pos] = matrix.colValue[j];
+                          }
+                      });
+    sortRows(result);
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// result = A * B, B has nColsB columns
+// Row-parallel Gustavson product: a symbolic pass counts the nonzeros of each row, a numeric pass fills the rows
+template<class Real_t>
+void multiplySparse(const FixedSparseMatrix<Real_t>& A, const FixedSparseMatrix<Real_t>& B, UInt nColsB, FixedSparseMatrix<Real_t>& result) {
+    struct Accumulator {
+        StdVT_UInt    marker;
+        StdVT<Real_t> value;
+        StdVT_UInt    cols;
+    };
+    tbb::enumerable_thread_specific<Accumulator> accumulators;
+    auto getAccumulator = [&]() -> Accumulator& {
+                              auto& acc = accumulators.local();
+                              if(acc.marker.size() != nColsB) {
+                                  acc.marker.assign(nColsB, std::numeric_limits<UInt>::max());
+                                  acc.value.assign(nColsB, Real_t(0));
+                              }
+                              return acc;
+                          };
+
+    result.resize(A.nRows);
+    result.rowStart[A.nRows] = 0;
+    ParallelExec::run(A.nRows,
+                      [&](UInt i) {
+                          auto& acc   = getAccumulator();
+                          UInt  count = 0;
+                          for(UInt j = A.rowStart[i], jEnd = A.rowStart[i + 1]; j < jEnd; ++j) {
+                              const auto k = A.colIndex[j];
+                              for(UInt l = B.rowStart[k], lEnd = B.rowStart[k + 1]; l < lEnd; ++l) {
+                                  const auto col = B.colIndex[l];
+                                  if(acc.marker[col] != i) {
+                                      acc.marker[col] = i;
+                                      ++count;
+                                  }
+                              }
+                          }
+                          result.rowStart[i] = count;
+                      });
+    const auto nnz = ParallelSTL::exclusive_scan(result.rowStart);
+    result.colIndex.resize(nnz);
+    result.colValue.resize(nnz);
+
+    for(auto& acc : accumulators) {
+        acc.marker.assign(nColsB, std::numeric_limits<UInt>::max());
+    }
+    ParallelExec::run(A.nRows,
+                      [&](UInt i) {
+                          auto& acc = getAccumulator();
+                          acc.cols.resize(0);
+                          for(UInt j = A.rowStart[i], jEnd = A.rowStart[i + 1]; j < jEnd; ++j) {
+                              const auto k    = A.colIndex[j];
+                              const auto aVal = A.colValue[j];
+                              for(UInt l = B.rowStart[k], lEnd = B.rowStart[k + 1]; l < lEnd; ++l) {
+                                  const auto col = B.colIndex[l];
+                                  if(acc.marker[col] != i) {
+                                      acc.marker[col] = i;
+                                      acc.value[col]  = aVal * B.colValue[l];
+                                      acc.cols.push_back(col);
+                                  } else {
+                                      acc.value[col] += aVal * B.colValue[l];
+                                  }
+                              }
+                          }
+                          std::sort(acc.cols.begin(), acc.cols.end());
+                          auto pos = result.rowStart[i];
+                          for(auto col : acc.cols) {
+                              result.colIndex[pos] = col;
+                              result.colValue[pos] = acc.value[col];
+                              ++pos;
+                          }
+                      });
+}
+}   // end namespace anonymous
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<class Real_t>
+Real_t AMGSolver<Real_t>::operatorComplexity() const {
+    if(m_Levels.empty() || m_Levels.front().A.colIndex.empty()) {
+        return Real_t(0);
+    }
+    UInt64 nnz = 0;
+    for(const auto& level : m_Levels) {
+        nnz += static_cast<UInt64>(level.A.rowStart[level.A.nRows]);
+    }
+    return static_cast<Real_t>(nnz) / static_cast<Real_t>(m_Levels.front().A.rowStart[m_Levels.front().A.nRows]);
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<class Real_t>
+void AMGSolver<Real_t>::setSolverParameters(Real_t toleranceFactor, UInt maxIterations) {
+    m_ToleranceFactor = toleranceFactor;
+    m_MaxIterations   = maxIterations;
+}
+
+template<class Real_t>
+void AMGSolver<Real_t>::setSmoother(Smoother smoother, UInt nSmoothSteps /*= 2u*/, UInt chebyshevDegree /*= 2u*/) {
+    NT_REQUIRE(nSmoothSteps > 0 && chebyshevDegree > 0);
+    m_Smoother        = smoother;
+    m_nSmoothSteps    = nSmoothSteps;
+    m_ChebyshevDegree = chebyshevDegree;
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<class Real_t>
+void AMGSolver<Real_t>::setup(const FixedSparseMatrix<Real_t>& matrix) {
+    m_Levels.resize(1);
+    m_Levels[0].A = matrix;
+
+    StdVT_UInt aggregates;
+    while(true) {
+        const auto levelIdx = static_cast<UInt>(m_Levels.size() - 1);
+        computeSmootherData(m_Levels[levelIdx]);
+        const auto nRows = m_Levels[levelIdx].A.nRows;
+        if(nRows <= m_CoarsestSize || m_Levels.size() >= m_MaxLevels) {
+            break;
+        }
+
+        const auto theta       = m_StrengthThreshold * std::pow(Real_t(0.5), static_cast<Real_t>(levelIdx)); // Galerkin operators have weaker couplings
+        const auto nAggregates = m_BlockSize > 1u ?
+                                 computeNodeAggregates(m_Levels[levelIdx].A, theta, aggregates) :
+                                 computeAggregates(m_Levels[levelIdx].A, theta, aggregates);
+        if(nAggregates == 0 || nAggregates * 10u > nRows * 9u) {
+            break; // coarsening stalled
+        }
+
+        m_Levels.emplace_back();
+        auto& fine   = m_Levels[levelIdx];
+        auto& coarse = m_Levels[levelIdx + 1];
+        computeProlongator(fine, aggregates, nAggregates, fine.P);
+        transpose(fine.P, nAggregates, fine.R);
+
+        FixedSparseMatrix<Real_t> AP;
+        multiplySparse(fine.A, fine.P, nAggregates, AP);
+        multiplySparse(fine.R, AP, nAggregates, coarse.A);
+    }
+
+    for(auto& level : m_Levels) {
+        level.x.resize(level.A.nRows);
+        level.b.resize(level.A.nRows);
+        level.r.resize(level.A.nRows);
+        level.d.resize(level.A.nRows);
+    }
+    setupCoarsestSolver();
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// Inverse diagonal and estimation of the spectral radius of D^-1 * A
+template<class Real_t>
+void AMGSolver<Real_t>::computeSmootherData(Level& level) {
+    const auto& A = level.A;
+    level.invDiag.resize(A.nRows);
+    StdVT<Real_t> rowBound(A.nRows);
+    ParallelExec::run(A.nRows,
+                      [&](UInt i) {
+                          Real_t diag   = 0;
+                          Real_t absSum = 0;
+                          for(UInt j = A.rowStart[i], jEnd = A.rowStart[i + 1]; j < jEnd; ++j) {
+                              if(A.colIndex[j] == i) {
+                                  diag = A.colValue[j];
+                              }
+                              absSum += std::abs(A.colValue[j]);
+                          }
+                          level.invDiag[i] = (diag != Real_t(0)) ? Real_t(1) / diag : Real_t(0);
+                          rowBound[i]      = absSum * std::abs(level.invDiag[i]);
+                      });
+    const auto gershgorinBound = rowBound.empty() ? Real_t(0) : ParallelSTL::max<Real_t>(rowBound);
+
+    // the Gershgorin bound is loose for Galerkin operators: refine it by a few power iterations
+    auto& v  = level.x;
+    auto& Av = level.r;
+    v.resize(A.nRows);
+    Av.resize(A.nRows);
+    ParallelExec::run(A.nRows, [&](UInt i) { v[i] = NumberHelpers::frandhash<Real_t>(i) + Real_t(0.5); });
+    Real_t lambda = 0;
+    for(UInt iter = 0; iter < 15u; ++iter) {
+        const auto vNorm = std::sqrt(ParallelBLAS::norm2<Real_t>(v));
+        if(vNorm < std::numeric_limits<Real_t>::min()) {
+            break;
+        }
+        FixedSparseMatrix<Real_t>::multiply(A, v, Av);
+        ParallelExec::run(A.nRows, [&](UInt i) { v[i] = level.invDiag[i] * Av[i] / vNorm; });
+        lambda = std::sqrt(ParallelBLAS::norm2<Real_t>(v));
+    }
+    level.lambdaMax = std::min(Real_t(1.1) * lambda, gershgorinBound);
+    if(level.lambdaMax <= Real_t(0)) {
+        level.lambdaMax = Real_t(1);
+    }
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// Aggregation by distance-2 maximal independent set of the strength graph:
+// in each round, an undecided node becomes an aggregate root if it has the largest (random) priority among the undecided nodes
+// within distance 2, then all undecided nodes within distance 2 of the new roots are excluded.
+// Each node then joins the aggregate of its root neighbor (unique, as roots are at least 3 edges apart),
+// and the remaining nodes join the aggregate of their strongest aggregated neighbor.
+// Returns the number of aggregates
+template<class Real_t>
+UInt AMGSolver<Real_t>::computeAggregates(const FixedSparseMatrix<Real_t>& A, Real_t theta, StdVT_UInt& aggregates) {
+    const auto    nRows = A.nRows;
+    StdVT<Real_t> absDiag(nRows);
+    ParallelExec::run(nRows,
+                      [&](UInt i) {
+                          absDiag[i] = 0;
+                          for(UInt j = A.rowStart[i], jEnd = A.rowStart[i + 1]; j < jEnd; ++j) {
+                              if(A.colIndex[j] == i) {
+                                  absDiag[i] = std::abs(A.colValue[j]);
+                                  break;
+                              }
+                          }
+                      });
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // strength graph
+    const auto theta2      = theta * theta;
+    auto       isStrong    = [&](UInt i, UInt j, Real_t val) { return j != i && val * val >= theta2 * absDiag[i] * absDiag[j] && val != Real_t(0); };
+    StdVT_UInt strongStart(nRows + 1, 0);
+    ParallelExec::run(nRows,
+                      [&](UInt i) {
+                          UInt count = 0;
+                          for(UInt j = A.rowStart[i], jEnd = A.rowStart[i + 1]; j < jEnd; ++j) {
+                              count += isStrong(i, A.colIndex[j], A.colValue[j]) ? 1u : 0u;
+                          }
+                          strongStart[i] = count;
+                      });
+    const auto    nStrong = ParallelSTL::exclusive_scan(strongStart);
+    StdVT_UInt    strongIndex(nStrong);
+    StdVT<Real_t> strongValue(nStrong);
+    ParallelExec::run(nRows,
+                      [&](UInt i) {
+                          auto pos = strongStart[i];
+                          for(UInt j = A.rowStart[i], jEnd = A.rowStart[i + 1]; j < jEnd; ++j) {
+                              if(isStrong(i, A.colIndex[j], A.colValue[j])) {
+                                  strongIndex[pos] = A.colIndex[j];
+                                  strongValue[pos] = std::abs(A.colValue[j]);
+                                  ++pos;
+                              }
+                          }
+                      });
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // distance-2 maximal independent set
+    enum : char { Undecided = 0, Root = 1, Excluded = 2 };
+    auto        priority = [](UInt i) { return (static_cast<UInt64>(NumberHelpers::randhash(i)) << 32) | static_cast<UInt64>(i); };
+    StdVT<char> state(nRows, Undecided);
+    StdVT<char> newState(nRows);
+    for(UInt nUndecided = nRows; nUndecided > 0;) {
+        ParallelExec::run(nRows,
+                          [&](UInt i) {
+                              newState[i] = state[i];
+                              if(state[i] != Undecided) {
+                                  return;
+                              }
+                              const auto pi = priority(i);
+                              for(UInt j = strongStart[i], jEnd = strongStart[i + 1]; j < jEnd; ++j) {
+                                  const auto nb = strongIndex[j];
+                                  if(state[nb] == Undecided && priority(nb) > pi) {
+                                      return;
+                                  }
+                                  for(UInt k = strongStart[nb], kEnd = strongStart[nb + 1]; k < kEnd; ++k) {
+                                      const auto nb2 = strongIndex[k];
+                                      if(nb2 != i && state[nb2] == Undecided && priority(nb2) > pi) {
+                                          return;
+                                      }
+                                  }
+                              }
+                              newState[i] = Root;
+                          });
+        std::atomic<UInt> remaining { 0 };
+        ParallelExec::run(nRows,
+                          [&](UInt i) {
+                              state[i] = newState[i];
+                              if(newState[i] != Undecided) {
+                                  return;
+                              }
+                              for(UInt j = strongStart[i], jEnd = strongStart[i + 1]; j < jEnd; ++j) {
+                                  const auto nb = strongIndex[j];
+                                  if(newState[nb] == Root) {
+                                      state[i] = Excluded;
+                                      return;
+                                  }
+                                  for(UInt k = strongStart[nb], kEnd = strongStart[nb + 1]; k < kEnd; ++k) {
+                                      if(newState[strongIndex[k]] == Root) {
+                                          state[i] = Excluded;
+                                          return;
+                                      }
+                                  }
+                              }
+                              remaining.fetch_add(1u, std::memory_order_relaxed);
+                          });
+        nUndecided = remaining.load();
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // aggregates from roots
+    StdVT_UInt rootIndex(nRows);
+    ParallelExec::run(nRows, [&](UInt i) { rootIndex[i] = (state[i] == Root) ? 1u : 0u; });
+    auto nAggregates = ParallelSTL::exclusive_scan(rootIndex);
+
+    constexpr auto Unassigned = std::numeric_limits<UInt>::max();
+    StdVT_UInt     rootAggregates(nRows);
+    ParallelExec::run(nRows,
+                      [&](UInt i) {
+                          rootAggregates[i] = Unassigned;
+                          if(state[i] == Root) {
+                              rootAggregates[i] = rootIndex[i];
+                              return;
+                          }
+                          for(UInt j = strongStart[i], jEnd = strongStart[i + 1]; j < jEnd; ++j) {
+                              if(state[strongIndex[j]] == Root) {
+                                  rootAggregates[i] = rootIndex[strongIndex[j]];
+                                  return;
+                              }
+                          }
+                      });
+    aggregates.resize(nRows);
+    ParallelExec::run(nRows,
+                      [&](UInt i) {
+                          aggregates[i] = rootAggregates[i];
+                          if(aggregates[i] != Unassigned) {
+                              return;
+                          }
+                          Real_t maxStrength = 0;
+                          for(UInt j = strongStart[i], jEnd = strongStart[i + 1]; j < jEnd; ++j) {
+                              if(rootAggregates[strongIndex[j]] != Unassigned && strongValue[j] > maxStrength) {
+                                  maxStrength   = strongValue[j];
+                                  aggregates[i] = rootAggregates[strongIndex[j]];
+                              }
+                          }
+                      });
+
+    // nodes left unassigned (possible only for non-symmetric strength graph) become singleton aggregates
+    for(UInt i = 0; i < nRows; ++i) {
+        if(aggregates[i] == Unassigned) {
+            aggregates[i] = nAggregates++;
+        }
+    }
+    return nAggregates;
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// Aggregation of the node matrix, whose entries are the Frobenius norms of the m_BlockSize x m_BlockSize node blocks.
+// Unknown d of node i joins aggregate (aggregate(i) * m_BlockSize + d)
+template<class Real_t>
+UInt AMGSolver<Real_t>::computeNodeAggregates(const FixedSparseMatrix<Real_t>& A, Real_t theta, StdVT_UInt& aggregates) {
+    const auto bs = m_BlockSize;
+    NT_REQUIRE(A.nRows % bs == 0);
+    const auto nNodes = A.nRows / bs;
+
+    // node rows: merge the sorted node columns of the bs rows of each node, sum the squared values
+    FixedSparseMatrix<Real_t>             nodeMatrix(nNodes);
+    StdVT<StdVT<std::pair<UInt, Real_t>>> nodeRows(nNodes);
+    ParallelExec::run(nNodes,
+                      [&](UInt node) {
+                          auto& entries = nodeRows[node];
+                          for(UInt i = node * bs, iEnd = i + bs; i < iEnd; ++i) {
+                              for(UInt j = A.rowStart[i], jEnd = A.rowStart[i + 1]; j < jEnd; ++j) {
+                                  entries.emplace_back(A.colIndex[j] / bs, A.colValue[j] * A.colValue[j]);
+                              }
+                          }
+                          std::sort(entries.begin(), entries.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+                          UInt nUnique = 0;
+                          for(size_t k = 0; k < entries.size(); ++k) {
+                              if(nUnique > 0 && entries[nUnique - 1].first == entries[k].first) {
+                                  entries[nUnique - 1].second += entries[k].second;
+                              } else {
+                                  entries[nUnique++] = entries[k];
+                              }
+                          }
+                          entries.resize(nUnique);
+                          nodeMatrix.rowStart[node] = nUnique;
+                      });
+    const auto nnz = ParallelSTL::exclusive_scan(nodeMatrix.rowStart);
+    nodeMatrix.colIndex.resize(nnz);
+    nodeMatrix.colValue.resize(nnz);
+    ParallelExec::run(nNodes,
+                      [&](UInt node) {
+                          auto pos = nodeMatrix.rowStart[node];
+                          for(const auto& [col, value] : nodeRows[node]) {
+                              nodeMatrix.colIndex[pos] = col;
+                              nodeMatrix.colValue[pos] = std::sqrt(value);
+                              ++pos;
+                          }
+                      });
+
+    StdVT_UInt nodeAggregates;
+    const auto nNodeAggregates = computeAggregates(nodeMatrix, theta, nodeAggregates);
+    aggregates.resize(A.nRows);
+    ParallelExec::run(A.nRows, [&](UInt i) { aggregates[i] = nodeAggregates[i / bs] * bs + i % bs; });
+    return nNodeAggregates * bs;
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// P = (I - omega * D^-1 * A) * T, with T the tentative prolongator: T(i, aggregate(i)) = 1 / sqrt(|aggregate|)
+template<class Real_t>
+void AMGSolver<Real_t>::computeProlongator(const Level& level, const StdVT_UInt& aggregates, UInt nAggregates, FixedSparseMatrix<Real_t>& P) {
+    const auto& A     = level.A;
+    const auto  nRows = A.nRows;
+
+    StdVT_UInt aggregateSize(nAggregates, 0);
+    ParallelExec::run(nRows, [&](UInt i) { AtomicOps::fetchAdd(aggregateSize[aggregates[i]], 1u); });
+
+    FixedSparseMatrix<Real_t> T(nRows);
+    T.colIndex = aggregates;
+    T.colValue.resize(nRows);
+    ParallelExec::run(nRows + 1, [&](UInt i) { T.rowStart[i] = i; });
+    ParallelExec::run(nRows, [&](UInt i) { T.colValue[i] = Real_t(1) / std::sqrt(static_cast<Real_t>(aggregateSize[aggregates[i]])); });
+
+    const auto                omega = Real_t(4.0 / 3.0) / level.lambdaMax;
+    FixedSparseMatrix<Real_t> S     = A;
+    ParallelExec::run(nRows,
+                      [&](UInt i) {
+                          for(UInt j = S.rowStart[i], jEnd = S.rowStart[i + 1]; j < jEnd; ++j) {
+                              S.colValue[j] *= -omega * level.invDiag[i];
+                              if(S.colIndex[j] == i) {
+                                  S.colValue[j] += Real_t(1);
+                              }
+                          }
+                      });
+    multiplySparse(S, T, nAggregates, P);
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// Dense Cholesky factorization of the coarsest level
+// Zero pivots (singular matrix, such as pure Neumann problem) are skipped: the corresponding solution components are set to zero
+template<class Real_t>
+void AMGSolver<Real_t>::setupCoarsestSolver() {
+    const auto& A = m_Levels.back().A;
+    const auto  n = A.nRows;
+    if(n > m_MaxCoarsestSize) {
+        m_CoarsestFactorSize = 0;
+        m_CoarsestFactor.resize(0);
+        return;
+    }
+
+    m_CoarsestFactorSize = n;
+    m_CoarsestFactor.assign(static_cast<size_t>(n) * static_cast<size_t>(n), Real_t(0));
+    auto F = [&](UInt i, UInt j) -> Real_t& { return m_CoarsestFactor[static_cast<size_t>(i) * n + j]; };
+    for(UInt i = 0; i < n; ++i) {
+        for(UInt j = A.rowStart[i], jEnd = A.rowStart[i + 1]; j < jEnd; ++j) {
+            if(A.colIndex[j] <= i) {
+                F(i, A.colIndex[j]) = A.colValue[j];
+            }
+        }
+    }
+
+    for(UInt j = 0; j < n; ++j) {
+        const auto aDiag = std::abs(F(j, j));
+        Real_t     diag  = F(j, j);
+        for(UInt k = 0; k < j; ++k) {
+            diag -= F(j, k) * F(j, k);
+        }
+        if(diag <= Real_t(1e-6) * aDiag || diag <= Real_t(0)) {
+            for(UInt i = j; i < n; ++i) {
+                F(i, j) = 0;
+            }
+            continue;
+        }
+        F(j, j) = std::sqrt(diag);
+        const auto invDiag = Real_t(1) / F(j, j);
+        ParallelExec::run(j + 1, n,
+                          [&](UInt i) {
+                              Real_t tmp = F(i, j);
+                              for(UInt k = 0; k < j; ++k) {
+                                  tmp -= F(i, k) * F(j, k);
+                              }
+                              F(i, j) = tmp * invDiag;
+                          });
+    }
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<class Real_t>
+void AMGSolver<Real_t>::solveCoarsest(Level& level) {
+    const auto n = level.A.nRows;
+    if(m_CoarsestFactorSize != n) {
+        // no direct solver: smooth with more steps
+        const auto nSmoothSteps = m_nSmoothSteps;
+        m_nSmoothSteps = 10u * nSmoothSteps;
+        smooth(level, true);
+        m_nSmoothSteps = nSmoothSteps;
+        return;
+    }
+
+    auto F = [&](UInt i, UInt j) { return m_CoarsestFactor[static_cast<size_t>(i) * n + j]; };
+    auto& x = level.x;
+    for(UInt i = 0; i < n; ++i) {
+        if(F(i, i) == Real_t(0)) {
+            x[i] = 0;
+            continue;
+        }
+        Real_t tmp = level.b[i];
+        for(UInt k = 0; k < i; ++k) {
+            tmp -= F(i, k) * x[k];
+        }
+        x[i] = tmp / F(i, i);
+    }
+    for(UInt i = n; i-- > 0;) {
+        if(F(i, i) == Real_t(0)) {
+            x[i] = 0;
+            continue;
+        }
+        Real_t tmp = x[i];
+        for(UInt k = i + 1; k < n; ++k) {
+            tmp -= F(k, i) * x[k];
+        }
+        x[i] = tmp / F(i, i);
+    }
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// Smoothing of level.x for level.A * x = level.b, using level.r, level.d and level.q as work vectors
+// Both smoothers are polynomials of D^-1 * A, thus pre- and post-smoothing together keep the V-cycle symmetric
+template<class Real_t>
+void AMGSolver<Real_t>::smooth(Level& level, bool bZeroInitial) {
+    const auto& A       = level.A;
+    const auto& invDiag = level.invDiag;
+    auto&       x       = level.x;
+    auto&       b       = level.b;
+    auto&       r       = level.r;
+    auto&       d       = level.d;
+    auto&       q       = level.q;
+    const auto  nRows   = A.nRows;
+
+    if(m_Smoother == Smoother::JACOBI) {
+        const auto omega = Real_t(4.0 / 3.0) / level.lambdaMax;
+        for(UInt step = 0; step < m_nSmoothSteps; ++step) {
+            if(bZeroInitial && step == 0) {
+                ParallelExec::run(nRows, [&](UInt i) { x[i] = omega * invDiag[i] * b[i]; });
+            } else {
+                FixedSparseMatrix<Real_t>::multiply(A, x, r);
+                ParallelExec::run(nRows, [&](UInt i) { x[i] += omega * invDiag[i] * (b[i] - r[i]); });
+            }
+        }
+        return;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // Chebyshev, targeting the upper part [lambdaMax / 30, lambdaMax] of the spectrum of D^-1 * A
+    const auto lambdaMax = level.lambdaMax;
+    const auto lambdaMin = level.lambdaMax / Real_t(30);
+    const auto theta     = Real_t(0.5) * (lambdaMax + lambdaMin);
+    const auto delta     = Real_t(0.5) * (lambdaMax - lambdaMin);
+    const auto sigma     = theta / delta;
+    for(UInt step = 0; step < m_nSmoothSteps; ++step) {
+        if(bZeroInitial && step == 0) {
+            ParallelExec::run(nRows,
+                              [&](UInt i) {
+                                  x[i] = 0;
+                                  r[i] = invDiag[i] * b[i];
+                                  d[i] = r[i] / theta;
+                              });
+        } else {
+            FixedSparseMatrix<Real_t>::multiply(A, x, q);
+            ParallelExec::run(nRows,
+                              [&](UInt i) {
+                                  r[i] = invDiag[i] * (b[i] - q[i]);
+                                  d[i] = r[i] / theta;
+                              });
+        }
+
+        Real_t rho = Real_t(1) / sigma;
+        for(UInt k = 0; k < m_ChebyshevDegree; ++k) {
+            if(k + 1 == m_ChebyshevDegree) {
+                ParallelBLAS::addScaled<Real_t>(Real_t(1), d, x);
+                break;
+            }
+            FixedSparseMatrix<Real_t>::multiply(A, d, q);
+            const auto rhoNew = Real_t(1) / (Real_t(2) * sigma - rho);
+            const auto cd     = rhoNew * rho;
+            const auto cr     = Real_t(2) * rhoNew / delta;
+            ParallelExec::run(nRows,
+                              [&](UInt i) {
+                                  x[i] += d[i];
+                                  r[i] -= invDiag[i] * q[i];
+                                  d[i]  = cd * d[i] + cr * r[i];
+                              });
+            rho = rhoNew;
+        }
+    }
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// V-cycle for m_Levels[levelIdx].A * x = b, stored in level.x and level.b
+template<class Real_t>
+void AMGSolver<Real_t>::vcycle(UInt levelIdx, bool bZeroInitial) {
+    auto& level = m_Levels[levelIdx];
+    if(levelIdx + 1 == numLevels()) {
+        solveCoarsest(level);
+        return;
+    }
+
+    smooth(level, bZeroInitial);
+    FixedSparseMatrix<Real_t>::multiply(level.A, level.x, level.r);
+    ParallelExec::run(level.A.nRows, [&](UInt i) { level.r[i] = level.b[i] - level.r[i]; });
+
+    auto& coarse = m_Levels[levelIdx + 1];
+    multiplyRectangular(level.R, level.r, coarse.b);
+    vcycle(levelIdx + 1, true);
+    multiplyRectangular(level.P, coarse.x, level.r);
+    ParallelBLAS::addScaled<Real_t>(Real_t(1), level.r, level.x);
+    smooth(level, false);
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<class Real_t>
+bool AMGSolver<Real_t>::solve(const StdVT<Real_t>& rhs, StdVT<Real_t>& result) {
+    NT_REQUIRE(!m_Levels.empty() && rhs.size() == m_Levels.front().A.nRows);
+    auto& fine = m_Levels.front();
+    result.resize(rhs.size());
+    if(m_bZeroInitial) {
+        result.assign(result.size(), 0);
+    }
+
+    fine.b = rhs;
+    fine.x = result;
+    FixedSparseMatrix<Real_t>::multiply(fine.A, fine.x, fine.r);
+    ParallelExec::run(fine.A.nRows, [&](UInt i) { fine.r[i] = fine.b[i] - fine.r[i]; });
+    m_OutResidual = ParallelSTL::maxAbs<Real_t>(fine.r);
+    if(m_OutResidual < std::numeric_limits<Real_t>::min()) {
+        m_OutIterations = 0;
+        return true;
+    }
+
+    const auto tol = m_ToleranceFactor * m_OutResidual;
+    for(UInt iteration = 0; iteration < m_MaxIterations; ++iteration) {
+        vcycle(0, m_bZeroInitial && iteration == 0);
+        FixedSparseMatrix<Real_t>::multiply(fine.A, fine.x, fine.r);
+        ParallelExec::run(fine.A.nRows, [&](UInt i) { fine.r[i] = fine.b[i] - fine.r[i]; });
+        m_OutResidual = ParallelSTL::maxAbs<Real_t>(fine.r);
+        if(m_OutResidual < tol) {
+            result          = fine.x;
+            m_OutIterations = iteration + 1;
+            return true;
+        }
+    }
+
+    result          = fine.x;
+    m_OutIterations = m_MaxIterations;
+    return false;
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<class Real_t>
+void AMGSolver<Real_t>::applyPreconditioner(const StdVT<Real_t>& r, StdVT<Real_t>& z) {
+    NT_REQUIRE(!m_Levels.empty() && r.size() == m_Levels.front().A.nRows);
+    auto& fine = m_Levels.front();
+    fine.b = r;
+    vcycle(0, true);
+    z = fine.x;
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+NT_INSTANTIATE_CLASS_COMMON_TYPES(AMGSolver)
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+} // end namespace NTCodeBase
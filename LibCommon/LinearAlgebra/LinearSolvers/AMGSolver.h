@@ -0,0 +1,112 @@
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//
+//    .--------------------------------------------------.
+//    |  This file is part of NTCodeBase                 |
+//    |  Created 2018 by NT (https://ttnghia.github.io)  |
+//    '--------------------------------------------------'
+//                            \o/
+//                             |
+//                            / |
+//
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+
+#pragma once
+
+#include <LibCommon/LinearAlgebra/SparseMatrix/SparseMatrix.h>
+#include <LibCommon/ParallelHelpers/ParallelBLAS.h>
+#include <LibCommon/ParallelHelpers/ParallelSTL.h>
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+namespace NTCodeBase {
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// Smoothed aggregation algebraic multigrid (Vanek, Mandel, Brezina 1996) for symmetric positive definite matrices
+// Setup, all steps parallel:
+//    - strength graph: j is strongly connected to i if |a_ij| >= theta * sqrt(|a_ii * a_jj|), theta is halved at each level
+//    - aggregation: distance-2 maximal independent set of the strength graph (random priorities) as aggregate roots,
+//      each node joins the aggregate of a root within distance 2
+//    - prolongator: tentative piecewise constant prolongator smoothed by one damped Jacobi step
+//    - Galerkin product: A_coarse = P^T * A * P
+// The coarsest level is solved by dense Cholesky factorization.
+// For systems with several unknowns per node (e.g. elasticity, setBlockSize), the aggregation is done on the node graph
+// (strength of the Frobenius norms of the node blocks), and each unknown of a node joins the aggregate of its node
+// component-wise, thus the coarse levels keep the same block structure.
+// Use solve() as a standalone solver (V-cycles), or applyPreconditioner() (one V-cycle) as preconditioner for PCG.
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<class Real_t>
+class AMGSolver {
+public:
+    enum Smoother {
+        JACOBI,   // damped Jacobi
+        CHEBYSHEV // Chebyshev polynomial of the Jacobi preconditioned matrix
+    };
+
+    AMGSolver() = default;
+    Real_t residual() const noexcept { return m_OutResidual; }
+    UInt   iterations() const noexcept { return m_OutIterations; }
+    UInt   numLevels() const noexcept { return static_cast<UInt>(m_Levels.size()); }
+    UInt   levelSize(UInt level) const { NT_REQUIRE(level < numLevels()); return m_Levels[level].A.nRows; }
+    Real_t operatorComplexity() const;
+
+    ////////////////////////////////////////////////////////////////////////////////
+    void setSolverParameters(Real_t toleranceFactor, UInt maxIterations);
+    void setSmoother(Smoother smoother, UInt nSmoothSteps = 2u, UInt chebyshevDegree = 2u);
+    void setStrengthThreshold(Real_t theta) { m_StrengthThreshold = theta; }
+    void setCoarsestSize(UInt coarsestSize) { m_CoarsestSize = coarsestSize; }
+    void setMaxLevels(UInt maxLevels) { m_MaxLevels = maxLevels; }
+    void setBlockSize(UInt blockSize) { NT_REQUIRE(blockSize > 0); m_BlockSize = blockSize; } // rows ordered node by node
+    void setZeroInitial(bool bZeroInitial) { m_bZeroInitial = bZeroInitial; }
+
+    ////////////////////////////////////////////////////////////////////////////////
+    void setup(const FixedSparseMatrix<Real_t>& matrix);
+    bool solve(const StdVT<Real_t>& rhs, StdVT<Real_t>& result);
+    // z = one V-cycle applied to r with zero initial guess, a symmetric operator suitable for PCG
+    void applyPreconditioner(const StdVT<Real_t>& r, StdVT<Real_t>& z);
+
+private:
+    struct Level {
+        FixedSparseMatrix<Real_t> A;         // operator of this level
+        FixedSparseMatrix<Real_t> P;         // prolongator to this level from the next (coarser) level, nRows x nCoarse
+        FixedSparseMatrix<Real_t> R;         // restriction = P^T, nCoarse x nRows
+        StdVT<Real_t>             invDiag;
+        Real_t                    lambdaMax; // upper bound of the spectral radius of D^-1 * A
+        StdVT<Real_t>             x, b, r, d, q; // solution, right hand side, residual and smoother work vectors
+    };
+
+    void computeSmootherData(Level& level);
+    UInt computeAggregates(const FixedSparseMatrix<Real_t>& A, Real_t theta, StdVT_UInt& aggregates);
+    UInt computeNodeAggregates(const FixedSparseMatrix<Real_t>& A, Real_t theta, StdVT_UInt& aggregates);
+    void computeProlongator(const Level& level, const StdVT_UInt& aggregates, UInt nAggregates, FixedSparseMatrix<Real_t>& P);
+    void setupCoarsestSolver();
+
+    void vcycle(UInt levelIdx, bool bZeroInitial);
+    void smooth(Level& level, bool bZeroInitial);
+    void solveCoarsest(Level& level);
+
+    ////////////////////////////////////////////////////////////////////////////////
+    StdVT<Level>  m_Levels;
+    StdVT<Real_t> m_CoarsestFactor; // dense lower triangular Cholesky factor, row major
+    UInt          m_CoarsestFactorSize = 0;
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // solver parameters
+    Smoother m_Smoother          = Smoother::JACOBI;
+    UInt     m_nSmoothSteps      = 2u;
+    UInt     m_ChebyshevDegree   = 2u;
+    Real_t   m_StrengthThreshold = Real_t(0.08);
+    UInt     m_CoarsestSize      = 500u;
+    UInt     m_MaxCoarsestSize   = 1500u; // if coarsening stalls above this size, the coarsest level is only smoothed
+    UInt     m_MaxLevels         = 25u;
+    UInt     m_BlockSize         = 1u;
+    Real_t   m_ToleranceFactor   = Real_t(1e-20);
+    UInt     m_MaxIterations     = 100u;
+    bool     m_bZeroInitial      = true;
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // output
+    Real_t m_OutResidual   = 0;
+    UInt   m_OutIterations = 0;
+};
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+} // end namespace NTCodeBase
@@ -13,178 +13,381 @@
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 
 #include <LibCommon/LinearAlgebra/LinearSolvers/BlockPCGSolver.h>
+#include <LibCommon/LinearAlgebra/LinearSolvers/PCGKernel.h>
 
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 namespace NTCodeBase {
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+namespace {
+// Jacobi preconditioner of a block: inverse of its diagonal entries
+template<class MatNxN>
+MatNxN invertDiagonalEntries(const MatNxN& block) {
+    using Real_t = typename MatNxN::value_type;
+    MatNxN result(0);
+    for(Int j = 0; j < MatNxN::length(); ++j) {
+        result[j][j] = block[j][j] != Real_t(0) ? Real_t(1.0) / block[j][j] : Real_t(0);
+    }
+    return result;
+}
+} // end anonymous namespace
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// The assembled and matrix-free solves run the same iterations, see PCGKernel::iterate
 template<Int N, class Real_t>
 bool BlockPCGSolver<N, Real_t>::solve(const BlockSparseMatrix<MatNxN>& matrix, const StdVT_VecN& rhs, StdVT_VecN& result) {
+    initSolve(matrix, rhs, result);
+    return PCGKernel::iterate(
+        [&](const StdVT_VecN& x, StdVT_VecN& y) { FixedBlockSparseMatrix<MatNxN>::multiply(m_FixedSparseMatrix, x, y); },
+        [&](const StdVT_VecN& x, StdVT_VecN& y) { y = x; },
+        m_ToleranceFactor * ParallelSTL::maxAbs<N, Real_t>(rhs), m_MaxIterations, result, r, z, s, m_OutResidual, m_OutIterations);
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<Int N, class Real_t>
+bool BlockPCGSolver<N, Real_t>::solve_precond(const BlockSparseMatrix<MatNxN>& matrix, const StdVT_VecN& rhs, StdVT_VecN& result) {
+    initSolve(matrix, rhs, result);
+    formPreconditioner(matrix);
+    return PCGKernel::iterate(
+        [&](const StdVT_VecN& x, StdVT_VecN& y) { FixedBlockSparseMatrix<MatNxN>::multiply(m_FixedSparseMatrix, x, y); },
+        [&](const StdVT_VecN& x, StdVT_VecN& y) { applyPreconditioner(x, y); },
+        m_ToleranceFactor * ParallelSTL::maxAbs<N, Real_t>(rhs), m_MaxIterations, result, r, z, s, m_OutResidual, m_OutIterations);
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// work vectors, initial guess and r = rhs - A * result for the solves with an assembled matrix
+template<Int N, class Real_t>
+void BlockPCGSolver<N, Real_t>::initSolve(const BlockSparseMatrix<MatNxN>& matrix, const StdVT_VecN& rhs, StdVT_VecN& result) {
     const UInt n = matrix.size();
-    if(z.size() != n) {
-        s.resize(n);
-        z.resize(n);
-        r.resize(n);
-    }
+    NT_REQUIRE(rhs.size() == n);
+    s.resize(n);
+    z.resize(n);
+    r.resize(n);
 
+    m_FixedSparseMatrix.constructFromSparseMatrix(matrix);
+    result.resize(n);
     if(m_bZeroInitial) {
         result.assign(result.size(), VecN(0));
+        r = rhs;
+    } else {
+        FixedBlockSparseMatrix<MatNxN>::multiply(m_FixedSparseMatrix, result, s);
+        ParallelExec::run(n, [&](UInt i) { r[i] = rhs[i] - s[i]; });
     }
+}
 
-    m_FixedSparseMatrix.constructFromSparseMatrix(matrix);
-    r = rhs;
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<Int N, class Real_t>
+bool BlockPCGSolver<N, Real_t>::solve(const BlockLinearOperator<N, Real_t>& op, const StdVT_VecN& rhs, StdVT_VecN& result) {
+    return solveOperator(op, rhs, result, false);
+}
 
-    m_OutResidual = ParallelSTL::maxAbs<N, Real_t>(r);
+template<Int N, class Real_t>
+bool BlockPCGSolver<N, Real_t>::solve_precond(const BlockLinearOperator<N, Real_t>& op, const StdVT_VecN& rhs, StdVT_VecN& result) {
+    return solveOperator(op, rhs, result, op.hasDiagonal());
+}
 
-    if(m_OutResidual < m_ToleranceFactor) {
-        m_OutIterations = 0;
-        return true;
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// see PCGKernel::iterate
+template<Int N, class Real_t>
+bool BlockPCGSolver<N, Real_t>::solveOperator(const BlockLinearOperator<N, Real_t>& op, const StdVT_VecN& rhs, StdVT_VecN& result, bool bJacobi) {
+    const UInt n = op.size();
+    NT_REQUIRE(rhs.size() == n);
+    s.resize(n);
+    z.resize(n);
+    r.resize(n);
+
+    result.resize(n);
+    if(m_bZeroInitial) {
+        result.assign(result.size(), VecN(0));
+        r = rhs;
+    } else {
+        op.multiply(result, s);
+        ParallelExec::run(n, [&](UInt i) { r[i] = rhs[i] - s[i]; });
     }
 
-    Real_t tol = m_ToleranceFactor * m_OutResidual;
-    Real_t rho = ParallelBLAS::dotProduct<N, Real_t>(r, r);
-
-    if(std::abs(rho) < m_ToleranceFactor || std::isnan(rho)) {
-        m_OutIterations = 0;
-        return true;
+    // relative to the right hand side, whichever the initial guess
+    const Real_t tol = m_ToleranceFactor * ParallelSTL::maxAbs<N, Real_t>(rhs);
+    if(bJacobi) {
+        op.computeDiagonal(m_OperatorJacobiPreconditioner);
+        NT_REQUIRE(m_OperatorJacobiPreconditioner.size() == n);
+        ParallelExec::run(n, [&](UInt i) { m_OperatorJacobiPreconditioner[i] = invertDiagonalEntries(m_OperatorJacobiPreconditioner[i]); });
     }
+    return PCGKernel::iterate(
+        [&](const StdVT_VecN& x, StdVT_VecN& y) { op.multiply(x, y); },
+        [&](const StdVT_VecN& x, StdVT_VecN& y) {
+            if(bJacobi) {
+                ParallelExec::run(n, [&](UInt i) { y[i] = m_OperatorJacobiPreconditioner[i] * x[i]; });
+            } else {
+                y = x;
+            }
+        },
+        tol, m_MaxIterations, result, r, z, s, m_OutResidual, m_OutIterations);
+}
 
-    z = r;
-
-    for(UInt iteration = 0; iteration < m_MaxIterations; ++iteration) {
-        FixedBlockSparseMatrix<MatNxN>::multiply(m_FixedSparseMatrix, z, s);
-        Real_t tmp = ParallelBLAS::dotProduct<N, Real_t>(s, z);
-
-        if(std::abs(tmp) < m_ToleranceFactor || std::isnan(tmp)) {
-            m_OutIterations = iteration;
-            return true;
-        }
-
-        Real_t alpha = rho / tmp;
-
-        tbb::parallel_invoke(
-            [&] { ParallelBLAS::addScaled(alpha, z, result); },
-            [&] { ParallelBLAS::addScaled(-alpha, s, r); }
-            );
-
-        m_OutResidual = ParallelSTL::maxAbs<N, Real_t>(r);
-
-        if(m_OutResidual < tol) {
-            m_OutIterations = iteration + 1;
-            return true;
-        }
-
-        Real_t rho_new = ParallelBLAS::dotProduct<N, Real_t>(r, r);
-        Real_t beta    = rho_new / rho;
-        ParallelBLAS::scaledAdd(beta, r, z);
-        rho = rho_new;
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<Int N, class Real_t>
+void BlockPCGSolver<N, Real_t>::formPreconditioner(const BlockSparseMatrix<MatNxN>& matrix) {
+    switch(m_PreconditionerType) {
+        case Preconditioner::JACOBI:
+            formPreconditioner_Jacobi(matrix);
+            break;
+
+        case Preconditioner::BLOCK_ICC0:
+            formPreconditioner_BlockICC0();
+            break;
+
+        case Preconditioner::AMG:
+            formPreconditioner_AMG();
+            break;
     }
+}
 
-    m_OutIterations = m_MaxIterations;
-    return false;
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<Int N, class Real_t>
+void BlockPCGSolver<N, Real_t>::applyPreconditioner(const StdVT_VecN& x, StdVT_VecN& result) {
+    switch(m_PreconditionerType) {
+        case Preconditioner::JACOBI:
+            ParallelExec::run(x.size(), [&](size_t i) { result[i] = m_JacobiPreconditioner[i] * x[i]; });
+            break;
+
+        case Preconditioner::BLOCK_ICC0:
+            applyPreconditioner_BlockICC0(x, result);
+            break;
+
+        case Preconditioner::AMG:
+            m_AMGX.resize(x.size() * N);
+            ParallelExec::run(x.size(),
+                              [&](size_t i) {
+                                  for(Int d = 0; d < N; ++d) {
+                                      m_AMGX[i * N + d] = x[i][d];
+                                  }
+                              });
+            m_AMGPrecond.applyPreconditioner(m_AMGX, m_AMGResult);
+            ParallelExec::run(x.size(),
+                              [&](size_t i) {
+                                  for(Int d = 0; d < N; ++d) {
+                                      result[i][d] = m_AMGResult[i * N + d];
+                                  }
+                              });
+            break;
+    }
 }
 
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 template<Int N, class Real_t>
-bool BlockPCGSolver<N, Real_t>::solve_precond(const BlockSparseMatrix<MatNxN>& matrix, const StdVT_VecN& rhs, StdVT_VecN& result) {
-    UInt n = matrix.size();
+void BlockPCGSolver<N, Real_t>::formPreconditioner_Jacobi(const BlockSparseMatrix<MatNxN>& matrix) {
+    m_JacobiPreconditioner.resize(matrix.size());
+    ParallelExec::run(matrix.size(),
+                      [&](UInt i) {
+                          const auto& v = matrix.getIndices(i);
+                          const auto it = std::lower_bound(v.begin(), v.end(), i);
+                          m_JacobiPreconditioner[i] = (it != v.end()) ? invertDiagonalEntries(matrix.getValues(i)[std::distance(v.begin(), it)]) : MatNxN(0);
+                      });
+}
 
-    if(z.size() != n) {
-        s.resize(n);
-        z.resize(n);
-        r.resize(n);
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// Block IC(0)
+// Rows in the same dependency level (wavefront) of the factorization and of the triangular solves do not depend on
+// each other and are processed in parallel, keeping the natural ordering (which converges faster than multicolor orderings)
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+namespace {
+constexpr UInt MinParallelLevelSize = 64u;
+
+template<class Function>
+void runLevel(const StdVT_UInt& levelStart, const StdVT_UInt& levelRows, UInt level, Function&& function) {
+    const UInt begin = levelStart[level];
+    const UInt end   = levelStart[level + 1];
+    if(end - begin < MinParallelLevelSize) {
+        for(UInt idx = begin; idx < end; ++idx) {
+            function(levelRows[idx]);
+        }
+    } else {
+        ParallelExec::run(begin, end, [&](UInt idx) { function(levelRows[idx]); });
     }
+}
 
-    // zero out the result
-    if(m_bZeroInitial) {
-        result.assign(result.size(), VecN(0));
+void groupByLevel(const StdVT_UInt& level, StdVT_UInt& levelStart, StdVT_UInt& levelRows) {
+    const UInt nRows   = static_cast<UInt>(level.size());
+    const UInt nLevels = nRows > 0 ? *std::max_element(level.begin(), level.end()) + 1u : 0u;
+    levelStart.assign(nLevels + 1, 0u);
+    for(UInt i = 0; i < nRows; ++i) {
+        ++levelStart[level[i] + 1];
     }
-
-    m_FixedSparseMatrix.constructFromSparseMatrix(matrix);
-    r = rhs;
-
-    FixedBlockSparseMatrix<MatNxN>::multiply(m_FixedSparseMatrix, result, s);
-    ParallelBLAS::addScaled(Real_t(-1.0), s, r);
-
-    m_OutResidual = ParallelSTL::maxAbs<N, Real_t>(r);
-    if(m_OutResidual < m_ToleranceFactor) {
-        m_OutIterations = 0;
-        return true;
+    for(UInt l = 0; l < nLevels; ++l) {
+        levelStart[l + 1] += levelStart[l];
     }
-
-    Real_t tol = m_ToleranceFactor * m_OutResidual;
-
-    formPreconditioner(matrix);
-    applyPreconditioner(r, z);
-
-    Real_t rho = ParallelBLAS::dotProduct<N, Real_t>(z, r);
-    if(std::abs(rho) < m_ToleranceFactor || std::isnan(rho)) {
-        m_OutIterations = 0;
-        return true;
+    levelRows.resize(nRows);
+    StdVT_UInt levelCursor(levelStart.begin(), levelStart.end() - 1);
+    for(UInt i = 0; i < nRows; ++i) {
+        levelRows[levelCursor[level[i]]++] = i;
     }
+}
+} // end anonymous namespace
 
-    s = z;
-
-    for(UInt iteration = 0; iteration < m_MaxIterations; ++iteration) {
-        FixedBlockSparseMatrix<MatNxN>::multiply(m_FixedSparseMatrix, s, z);
-        Real_t tmp = ParallelBLAS::dotProduct<N, Real_t>(s, z);
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// M = (D + L) * D^-1 * (D + L)^T matches A on the diagonal blocks and on the lower pattern:
+//    L(i, j) = A(i, j) - sum_{k < j} L(i, k) * D(k)^-1 * L(j, k)^T
+//    D(i)    = A(i, i) - sum_{k < i} L(i, k) * D(k)^-1 * L(i, k)^T
+// Row i only reads rows of lower levels. A pivot D(i) that lost too much of its diagonal (or is not invertible)
+// is replaced by A(i, i)
+template<Int N, class Real_t>
+void BlockPCGSolver<N, Real_t>::formPreconditioner_BlockICC0() {
+    const auto& A        = m_FixedSparseMatrix;
+    const auto& rowStart = A.rowStarts();
+    const auto& colIndex = A.colIndices();
+    const auto& colValue = A.colValues();
+    const UInt  n        = A.size();
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // analysis of the sparsity pattern, only redone when the pattern changed (e.g. time steps with the same mesh)
+    if(rowStart != m_ICPatternRowStart || colIndex != m_ICPatternColIndex) {
+        m_ICDiagPos.resize(n);
+        m_ICTransposePos.resize(colIndex.size());
+        ParallelExec::run(n,
+                          [&](UInt i) {
+                              const auto first = colIndex.begin() + rowStart[i];
+                              const auto last  = colIndex.begin() + rowStart[i + 1];
+                              const auto it    = std::lower_bound(first, last, i);
+                              NT_REQUIRE(it != last && *it == i);
+                              m_ICDiagPos[i] = static_cast<UInt>(std::distance(colIndex.begin(), it));
+                          });
+        ParallelExec::run(n,
+                          [&](UInt i) {
+                              for(UInt p = m_ICDiagPos[i] + 1, pEnd = rowStart[i + 1]; p < pEnd; ++p) {
+                                  const auto j  = colIndex[p];
+                                  const auto it = std::lower_bound(colIndex.begin() + rowStart[j], colIndex.begin() + m_ICDiagPos[j], i);
+                                  NT_REQUIRE(it != colIndex.begin() + m_ICDiagPos[j] && *it == i); // symmetric pattern
+                                  m_ICTransposePos[p] = static_cast<UInt>(std::distance(colIndex.begin(), it));
+                              }
+                          });
 
-        if(std::abs(tmp) < m_ToleranceFactor || std::isnan(tmp)) {
-            m_OutIterations = iteration;
-            return true;
+        StdVT_UInt level(n, 0u);
+        for(UInt i = 0; i < n; ++i) {
+            for(UInt p = rowStart[i]; p < m_ICDiagPos[i]; ++p) {
+                level[i] = std::max(level[i], level[colIndex[p]] + 1u);
+            }
         }
-
-        Real_t alpha = rho / tmp;
-
-        tbb::parallel_invoke(
-            [&] { ParallelBLAS::addScaled(alpha, s, result); },
-            [&] { ParallelBLAS::addScaled(-alpha, z, r); }
-            );
-
-        m_OutResidual = ParallelSTL::maxAbs<N, Real_t>(r);
-        if(m_OutResidual < tol) {
-            m_OutIterations = iteration + 1;
-            return true;
+        groupByLevel(level, m_ICForwardLevelStart, m_ICForwardLevelRows);
+        for(UInt i = n; i > 0; --i) {
+            const UInt row = i - 1;
+            level[row] = 0;
+            for(UInt p = m_ICDiagPos[row] + 1, pEnd = rowStart[row + 1]; p < pEnd; ++p) {
+                level[row] = std::max(level[row], level[colIndex[p]] + 1u);
+            }
         }
+        groupByLevel(level, m_ICBackwardLevelStart, m_ICBackwardLevelRows);
+        m_ICPatternRowStart = rowStart;
+        m_ICPatternColIndex = colIndex;
+    }
 
-        applyPreconditioner(r, z);
-
-        Real_t rho_new = ParallelBLAS::dotProduct<N, Real_t>(z, r);
-        Real_t beta    = rho_new / rho;
-
-        ParallelBLAS::addScaled(beta, s, z);
-        s.swap(z); // s=beta*s+z
-        rho = rho_new;
+    ////////////////////////////////////////////////////////////////////////////////
+    // factorization
+    m_ICLower.resize(colValue.size());
+    m_ICInvDiag.resize(n);
+    for(UInt l = 0, nLevels = static_cast<UInt>(m_ICForwardLevelStart.size() - 1); l < nLevels; ++l) {
+        runLevel(m_ICForwardLevelStart, m_ICForwardLevelRows, l,
+                 [&](UInt i) {
+                     MatNxN D = colValue[m_ICDiagPos[i]];
+                     for(UInt p = rowStart[i]; p < m_ICDiagPos[i]; ++p) {
+                         const auto j   = colIndex[p];
+                         MatNxN     Lij = colValue[p];
+                         // common columns k < j of rows i and j
+                         for(UInt q = rowStart[i], t = rowStart[j]; q < p && t < m_ICDiagPos[j];) {
+                             if(colIndex[q] == colIndex[t]) {
+                                 Lij -= m_ICLower[q] * m_ICInvDiag[colIndex[q]] * glm::transpose(m_ICLower[t]);
+                                 ++q;
+                                 ++t;
+                             } else if(colIndex[q] < colIndex[t]) {
+                                 ++q;
+                             } else {
+                                 ++t;
+                             }
+                         }
+                         m_ICLower[p] = Lij;
+                         D           -= Lij * m_ICInvDiag[j] * glm::transpose(Lij);
+                     }
+
+                     const auto& Aii    = colValue[m_ICDiagPos[i]];
+                     bool        bValid = glm::determinant(D) > Real_t(0);
+                     for(Int d = 0; d < N; ++d) {
+                         bValid = bValid && D[d][d] >= m_MinDiagonalRatio * Aii[d][d];
+                     }
+                     m_ICInvDiag[i] = glm::inverse(bValid ? D : Aii);
+                     bValid         = true;
+                     for(Int c = 0; c < N; ++c) {
+                         for(Int d = 0; d < N; ++d) {
+                             bValid = bValid && NumberHelpers::isValidNumber(m_ICInvDiag[i][c][d]);
+                         }
+                     }
+                     if(!bValid) {
+                         m_ICInvDiag[i] = MatNxN(0);
+                         for(Int d = 0; d < N; ++d) {
+                             m_ICInvDiag[i][d][d] = Aii[d][d] != Real_t(0) ? Real_t(1) / Aii[d][d] : Real_t(0);
+                         }
+                     }
+                 });
     }
+}
 
-    m_OutIterations = m_MaxIterations;
-    return false;
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// solve (D + L) * y = x, then (D + L)^T * result = D * y
+template<Int N, class Real_t>
+void BlockPCGSolver<N, Real_t>::applyPreconditioner_BlockICC0(const StdVT_VecN& x, StdVT_VecN& result) {
+    const auto& rowStart = m_FixedSparseMatrix.rowStarts();
+    const auto& colIndex = m_FixedSparseMatrix.colIndices();
+    result.resize(x.size());
+    for(UInt l = 0, nLevels = static_cast<UInt>(m_ICForwardLevelStart.size() - 1); l < nLevels; ++l) {
+        runLevel(m_ICForwardLevelStart, m_ICForwardLevelRows, l,
+                 [&](UInt i) {
+                     VecN tmp = x[i];
+                     for(UInt p = rowStart[i]; p < m_ICDiagPos[i]; ++p) {
+                         tmp -= m_ICLower[p] * result[colIndex[p]];
+                     }
+                     result[i] = m_ICInvDiag[i] * tmp;
+                 });
+    }
+    for(UInt l = 0, nLevels = static_cast<UInt>(m_ICBackwardLevelStart.size() - 1); l < nLevels; ++l) {
+        runLevel(m_ICBackwardLevelStart, m_ICBackwardLevelRows, l,
+                 [&](UInt i) {
+                     VecN tmp(0);
+                     for(UInt p = m_ICDiagPos[i] + 1, pEnd = rowStart[i + 1]; p < pEnd; ++p) {
+                         tmp += glm::transpose(m_ICLower[m_ICTransposePos[p]]) * result[colIndex[p]];
+                     }
+                     result[i] -= m_ICInvDiag[i] * tmp;
+                 });
+    }
 }
 
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// Block AMG on the expanded scalar matrix, unknown d of node i is row i * N + d
 template<Int N, class Real_t>
-void BlockPCGSolver<N, Real_t>::formPreconditioner(const BlockSparseMatrix<MatNxN>& matrix) {
-    m_JacobiPreconditioner.resize(matrix.size());
-    ParallelExec::run(matrix.size(),
+void BlockPCGSolver<N, Real_t>::formPreconditioner_AMG() {
+    const auto& rowStart = m_FixedSparseMatrix.rowStarts();
+    const auto& colIndex = m_FixedSparseMatrix.colIndices();
+    const auto& colValue = m_FixedSparseMatrix.colValues();
+    const UInt  n        = m_FixedSparseMatrix.size();
+
+    FixedSparseMatrix<Real_t> scalarMatrix(n * N);
+    scalarMatrix.colIndex.resize(colIndex.size() * N * N);
+    scalarMatrix.colValue.resize(colValue.size() * N * N);
+    scalarMatrix.rowStart[n * N] = rowStart[n] * N * N;
+    ParallelExec::run(n,
                       [&](UInt i) {
-                          const auto& v = matrix.getIndices(i);
-                          const auto it = std::lower_bound(v.begin(), v.end(), i);
-                          MatNxN tmp_inv;
-                          if(it != v.end()) {
-                              MatNxN tmp = matrix.getValues(i)[std::distance(v.begin(), it)];
-                              for(Int j = 0; j < MatNxN::length(); ++j) {
-                                  for(Int k = 0; k < MatNxN::length(); ++k) {
-                                      tmp_inv[k][j] = (j == k && tmp[j][j] != 0) ? typename MatNxN::value_type(1.0) / tmp[j][j] : 0;
+                          const UInt rowSize = (rowStart[i + 1] - rowStart[i]) * N;
+                          for(Int r = 0; r < N; ++r) {
+                              UInt pos = rowStart[i] * N * N + r * rowSize;
+                              scalarMatrix.rowStart[i * N + r] = pos;
+                              for(UInt p = rowStart[i], pEnd = rowStart[i + 1]; p < pEnd; ++p) {
+                                  for(Int c = 0; c < N; ++c) {
+                                      scalarMatrix.colIndex[pos] = colIndex[p] * N + c;
+                                      scalarMatrix.colValue[pos] = colValue[p][c][r]; // column major blocks
+                                      ++pos;
                                   }
                               }
                           }
-                          m_JacobiPreconditioner[i] = tmp_inv;
                       });
-}
-
-//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
-template<Int N, class Real_t>
-void BlockPCGSolver<N, Real_t>::applyPreconditioner(const StdVT_VecN& x, StdVT_VecN& result) {
-    ParallelExec::run(x.size(), [&](size_t i) { result[i] = m_JacobiPreconditioner[i] * x[i]; });
+    m_AMGPrecond.setBlockSize(N);
+    m_AMGPrecond.setup(scalarMatrix);
 }
 
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
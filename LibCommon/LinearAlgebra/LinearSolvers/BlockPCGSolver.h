@@ -15,6 +15,8 @@
 #pragma once
 
 #include <LibCommon/LinearAlgebra/SparseMatrix/BlockSparseMatrix.h>
+#include <LibCommon/LinearAlgebra/LinearSolvers/AMGSolver.h>
+#include <LibCommon/LinearAlgebra/LinearSolvers/LinearOperator.h>
 #include <LibCommon/ParallelHelpers/ParallelBLAS.h>
 #include <LibCommon/ParallelHelpers/ParallelSTL.h>
 
@@ -27,32 +29,72 @@ class BlockPCGSolver {
     NT_TYPE_ALIAS
     ////////////////////////////////////////////////////////////////////////////////
 public:
+    enum Preconditioner {
+        JACOBI,     // inverse of the diagonal of the diagonal blocks
+        BLOCK_ICC0, // block incomplete Cholesky, N x N pivots, factorization and triangular solves parallelized by dependency levels
+        AMG         // one V-cycle of smoothed aggregation AMG, aggregating nodes (blocks), see AMGSolver::setBlockSize
+    };
+
     BlockPCGSolver() = default;
 
     Real_t residual() const noexcept { return m_OutResidual; }
     UInt     iterations() const noexcept { return m_OutIterations; }
+    AMGSolver<Real_t>& AMGPreconditioner() noexcept { return m_AMGPrecond; } // for setting AMG parameters
 
     ////////////////////////////////////////////////////////////////////////////////
-    void setSolverParameters(Real_t toleranceFactor, UInt maxIterations) { m_ToleranceFactor = toleranceFactor; m_MaxIterations = maxIterations; }
+    // minDiagonalRatio: a BLOCK_ICC0 pivot whose diagonal dropped below this ratio of the matrix diagonal is replaced by the matrix block
+    void setSolverParameters(Real_t toleranceFactor, UInt maxIterations, Real_t minDiagonalRatio = Real_t(0.25)) {
+        m_ToleranceFactor  = toleranceFactor;
+        m_MaxIterations    = maxIterations;
+        m_MinDiagonalRatio = minDiagonalRatio;
+    }
     void setZeroInitial(bool bZeroInitial) { m_bZeroInitial = bZeroInitial; }
     void enableZeroInitial() { m_bZeroInitial = true; }
     void disableZeroInitial() { m_bZeroInitial = false; }
+    void setPreconditioners(Preconditioner precond) { m_PreconditionerType = precond; }
 
     bool solve(const BlockSparseMatrix<MatNxN>& matrix, const StdVT_VecN& rhs, StdVT_VecN& result);
     bool solve_precond(const BlockSparseMatrix<MatNxN>& matrix, const StdVT_VecN& rhs, StdVT_VecN& result);
 
+    // Matrix-free solves: solve() is unpreconditioned, solve_precond() uses Jacobi preconditioning if the operator
+    // provides its diagonal blocks
+    bool solve(const BlockLinearOperator<N, Real_t>& op, const StdVT_VecN& rhs, StdVT_VecN& result);
+    bool solve_precond(const BlockLinearOperator<N, Real_t>& op, const StdVT_VecN& rhs, StdVT_VecN& result);
+
 private:
+    void initSolve(const BlockSparseMatrix<MatNxN>& matrix, const StdVT_VecN& rhs, StdVT_VecN& result);
     void formPreconditioner(const BlockSparseMatrix<MatNxN>& matrix);
     void applyPreconditioner(const StdVT_VecN& x, StdVT_VecN& result);
+    void formPreconditioner_Jacobi(const BlockSparseMatrix<MatNxN>& matrix);
+    void formPreconditioner_BlockICC0();
+    void formPreconditioner_AMG();
+    void applyPreconditioner_BlockICC0(const StdVT_VecN& x, StdVT_VecN& result);
+    bool solveOperator(const BlockLinearOperator<N, Real_t>& op, const StdVT_VecN& rhs, StdVT_VecN& result, bool bJacobi);
 
     ////////////////////////////////////////////////////////////////////////////////
     StdVT_VecN                     z, s, r;
     StdVT_MatNxN                   m_JacobiPreconditioner;
+    StdVT_MatNxN                   m_OperatorJacobiPreconditioner; // from the diagonal blocks of a BlockLinearOperator
     FixedBlockSparseMatrix<MatNxN> m_FixedSparseMatrix;
 
-    Real_t m_ToleranceFactor = Real_t(1e-20);
-    UInt   m_MaxIterations   = 10000u;
-    bool   m_bZeroInitial    = true;
+    // Block IC(0): M = (D + L) * D^-1 * (D + L)^T, L has the sparsity pattern of the strictly lower part of the matrix
+    StdVT_MatNxN m_ICLower;        // L(i, j) at the positions of the matrix entries with j < i
+    StdVT_MatNxN m_ICInvDiag;      // D^-1
+    StdVT_UInt   m_ICDiagPos;      // position of the diagonal entry in each row (one past the lower entries)
+    StdVT_UInt   m_ICTransposePos; // for entries (i, j) with j > i, the position of (j, i)
+    StdVT_UInt   m_ICForwardLevelStart, m_ICForwardLevelRows;
+    StdVT_UInt   m_ICBackwardLevelStart, m_ICBackwardLevelRows;
+    StdVT_UInt   m_ICPatternRowStart; // sparsity pattern that the positions and levels above were computed for
+    StdVT_UInt   m_ICPatternColIndex;
+
+    AMGSolver<Real_t> m_AMGPrecond;
+    StdVT<Real_t>     m_AMGX, m_AMGResult; // vectors of m_AMGPrecond, unknowns ordered node by node
+
+    Preconditioner m_PreconditionerType = Preconditioner::JACOBI;
+    Real_t m_ToleranceFactor  = Real_t(1e-20);
+    UInt   m_MaxIterations    = 10000u;
+    Real_t m_MinDiagonalRatio = Real_t(0.25);
+    bool   m_bZeroInitial     = true;
 
     ////////////////////////////////////////////////////////////////////////////////
     // output
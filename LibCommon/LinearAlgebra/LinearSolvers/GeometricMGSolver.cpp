@@ -0,0 +1,436 @@
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//
+//    .--------------------------------------------------.
+//    |  This file is part of NTCodeBase                 |
+//    |  Created 2018 by NT (https://ttnghia.github.io)  |
+//    '--------------------------------------------------'
+//                            \o/
+//                             |
+//                            / |
+//
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+
+#include <LibCommon/LinearAlgebra/LinearSolvers/GeometricMGSolver.h>
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+namespace NTCodeBase {
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+namespace {
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// Parallel loop over all cells, parallelized over z slices: func(i, j, k, flatIndex)
+template<class Function>
+inline void runCells(const Vec3ui& res, Function&& func) {
+    ParallelExec::run(0u, res.z,
+                      [&](UInt k) {
+                          for(UInt j = 0; j < res.y; ++j) {
+                              size_t idx = (static_cast<size_t>(k) * res.y + j) * res.x;
+                              for(UInt i = 0; i < res.x; ++i, ++idx) {
+                                  func(i, j, k, idx);
+                              }
+                          }
+                      });
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// Diagonal and weighted sum of the fluid neighbor values of the 7-point stencil at cell (i, j, k) with flat index idx,
+// the neighbors in dimension d have weight w[d]
+template<class Real_t>
+inline void stencil(const Vec3ui& res, const Vec3<Real_t>& w, const char* cellTypes, const Real_t* x, UInt i, UInt j, UInt k, size_t idx,
+                    Real_t& diag, Real_t& sum) {
+    const size_t strideY = res.x;
+    const size_t strideZ = static_cast<size_t>(res.x) * res.y;
+    diag = 0;
+    sum  = 0;
+    auto visit = [&](size_t nIdx, Real_t weight) {
+                     const auto type = cellTypes[nIdx];
+                     diag += (type != GeometricMGSolver<Real_t>::Solid) ? weight : Real_t(0);
+                     sum  += (type == GeometricMGSolver<Real_t>::Fluid) ? weight * x[nIdx] : Real_t(0);
+                 };
+    if(i > 0) { visit(idx - 1, w.x); }
+    if(i + 1 < res.x) { visit(idx + 1, w.x); }
+    if(j > 0) { visit(idx - strideY, w.y); }
+    if(j + 1 < res.y) { visit(idx + strideY, w.y); }
+    if(k > 0) { visit(idx - strideZ, w.z); }
+    if(k + 1 < res.z) { visit(idx + strideZ, w.z); }
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// 1D linear interpolation weight of coarse cell C for fine cell f, between cell centers of two consecutive levels:
+// fine cell f gets 3/4 from its parent f/2 and 1/4 from the next closest coarse cell,
+// which is clamped to the grid (constant extrapolation at the domain boundary)
+// In a dimension that is not coarsened (factor 1), fine cell f is coarse cell f
+template<class Real_t>
+inline Real_t prolongationWeight(Int f, Int C, Int coarseRes, UInt factor) {
+    if(factor == 1u) {
+        return f == C ? Real_t(1) : Real_t(0);
+    }
+    const Int parent   = f / 2;
+    const Int neighbor = std::clamp((f & 1) ? parent + 1 : parent - 1, 0, coarseRes - 1);
+    return (parent == C ? Real_t(0.75) : Real_t(0)) + (neighbor == C ? Real_t(0.25) : Real_t(0));
+}
+}   // end namespace anonymous
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<class Real_t>
+void GeometricMGSolver<Real_t>::setSolverParameters(Real_t toleranceFactor, UInt maxIterations) {
+    m_ToleranceFactor = toleranceFactor;
+    m_MaxIterations   = maxIterations;
+}
+
+template<class Real_t>
+void GeometricMGSolver<Real_t>::setSmoothingSteps(UInt nSmoothSteps, UInt nCoarsestSmoothSteps /*= 50u*/) {
+    NT_REQUIRE(nSmoothSteps > 0 && nCoarsestSmoothSteps > 0);
+    m_nSmoothSteps         = nSmoothSteps;
+    m_nCoarsestSmoothSteps = nCoarsestSmoothSteps;
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<class Real_t>
+void GeometricMGSolver<Real_t>::setup(const Array3c& cellTypes) {
+    const auto& res = cellTypes.resolution();
+    m_Levels.resize(1);
+    m_Levels[0].resolution = Vec3ui(res[0], res[1], res[2]);
+    m_Levels[0].cellTypes  = cellTypes;
+    m_Levels[0].factor     = Vec3ui(1u);
+    m_Levels[0].weights    = Vec3<Real_t>(1);
+
+    // semi-coarsening: only the dimensions larger than the coarsest resolution are halved
+    while(glm::compMax(m_Levels.back().resolution) > m_CoarsestResolution) {
+        const auto levelIdx = m_Levels.size();
+        m_Levels.emplace_back();
+        const auto& fine   = m_Levels[levelIdx - 1];
+        auto&       coarse = m_Levels[levelIdx];
+        for(Int d = 0; d < 3; ++d) {
+            coarse.factor[d]     = fine.resolution[d] > m_CoarsestResolution ? 2u : 1u;
+            coarse.resolution[d] = (fine.resolution[d] + coarse.factor[d] - 1u) / coarse.factor[d];
+            coarse.weights[d]    = fine.weights[d] / Real_t(coarse.factor[d] * coarse.factor[d]);
+        }
+        const auto factor = coarse.factor;
+        coarse.cellTypes.resize(Vec3<size_t>(coarse.resolution));
+        ParallelExec::run(0u, coarse.resolution.x, 0u, coarse.resolution.y, 0u, coarse.resolution.z,
+                          [&](UInt I, UInt J, UInt K) {
+                              bool bHasFluid = false;
+                              bool bHasAir   = false;
+                              for(UInt k = factor.z * K, kEnd = std::min(factor.z * (K + 1u), fine.resolution.z); k < kEnd; ++k) {
+                                  for(UInt j = factor.y * J, jEnd = std::min(factor.y * (J + 1u), fine.resolution.y); j < jEnd; ++j) {
+                                      for(UInt i = factor.x * I, iEnd = std::min(factor.x * (I + 1u), fine.resolution.x); i < iEnd; ++i) {
+                                          bHasFluid |= (fine.cellTypes(i, j, k) == Fluid);
+                                          bHasAir   |= (fine.cellTypes(i, j, k) == Air);
+                                      }
+                                  }
+                              }
+                              coarse.cellTypes(I, J, K) = bHasAir ? Air : (bHasFluid ? Fluid : Solid);
+                          });
+    }
+
+    for(auto& level : m_Levels) {
+        level.x.resize(Vec3<size_t>(level.resolution), Real_t(0));
+        level.b.resize(Vec3<size_t>(level.resolution), Real_t(0));
+        level.r.resize(Vec3<size_t>(level.resolution), Real_t(0));
+    }
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<class Real_t>
+void GeometricMGSolver<Real_t>::applyOperator(const Array3<Real_t>& x, Array3<Real_t>& result) const {
+    NT_REQUIRE(!m_Levels.empty() && x.dataSize() == m_Levels.front().cellTypes.dataSize());
+    result.resize(Vec3<size_t>(m_Levels.front().resolution));
+    applyOperator(m_Levels.front(), x, result);
+}
+
+template<class Real_t>
+void GeometricMGSolver<Real_t>::applyOperator(const Level& level, const Array3<Real_t>& x, Array3<Real_t>& result) const {
+    const auto types = level.cellTypes.flatData().data();
+    const auto xData = x.flatData().data();
+    runCells(level.resolution,
+             [&](UInt i, UInt j, UInt k, size_t idx) {
+                 if(types[idx] != Fluid) {
+                     result.flatData(idx) = 0;
+                     return;
+                 }
+                 Real_t diag, sum;
+                 stencil(level.resolution, level.weights, types, xData, i, j, k, idx, diag, sum);
+                 result.flatData(idx) = diag * xData[idx] - sum;
+             });
+}
+
+template<class Real_t>
+void GeometricMGSolver<Real_t>::computeResidual(Level& level) const {
+    const auto types = level.cellTypes.flatData().data();
+    const auto xData = level.x.flatData().data();
+    runCells(level.resolution,
+             [&](UInt i, UInt j, UInt k, size_t idx) {
+                 if(types[idx] != Fluid) {
+                     level.r.flatData(idx) = 0;
+                     return;
+                 }
+                 Real_t diag, sum;
+                 stencil(level.resolution, level.weights, types, xData, i, j, k, idx, diag, sum);
+                 level.r.flatData(idx) = level.b.flatData(idx) - (diag * xData[idx] - sum);
+             });
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// Red-black Gauss-Seidel, cells of the same color are independent thus updated in parallel
+template<class Real_t>
+void GeometricMGSolver<Real_t>::smoothRedBlack(Level& level, UInt nSteps, bool bReverseColors) const {
+    const auto& res   = level.resolution;
+    const auto  types = level.cellTypes.flatData().data();
+    const auto  bData = level.b.flatData().data();
+    auto        xData = level.x.flatData().data();
+    for(UInt step = 0; step < nSteps; ++step) {
+        for(UInt c = 0; c < 2u; ++c) {
+            const auto color = bReverseColors ? 1u - c : c;
+            ParallelExec::run(0u, res.z,
+                              [&](UInt k) {
+                                  for(UInt j = 0; j < res.y; ++j) {
+                                      const auto rowIdx = (static_cast<size_t>(k) * res.y + j) * res.x;
+                                      for(UInt i = (j + k + color) & 1u; i < res.x; i += 2u) {
+                                          const auto idx = rowIdx + i;
+                                          if(types[idx] != Fluid) {
+                                              continue;
+                                          }
+                                          Real_t diag, sum;
+                                          stencil(res, level.weights, types, xData, i, j, k, idx, diag, sum);
+                                          xData[idx] = (diag > Real_t(0)) ? (bData[idx] + sum) / diag : Real_t(0);
+                                      }
+                                  }
+                              });
+        }
+    }
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// coarse.b = R * fine.r, R = P^T / (number of fine cells per coarse cell): the average of the fine residual around the
+// coarse cell. The coarse operator is the 7-point stencil of the coarse grid spacing, with the weights of each level
+// relative to the finest grid spacing, thus the right hand side needs no further scaling
+template<class Real_t>
+void GeometricMGSolver<Real_t>::restrictResidual(const Level& fine, Level& coarse) const {
+    const auto fineRes   = Vec3i(fine.resolution);
+    const auto coarseRes = Vec3i(coarse.resolution);
+    const auto factor    = coarse.factor;
+    // fine cells around coarse cell C: [2C - 1, 2C + 2] if coarsened, C otherwise
+    const auto offsetBegin = [&](Int d) { return factor[d] == 2u ? -1 : 0; };
+    const auto offsetEnd   = [&](Int d) { return factor[d] == 2u ? 2 : 0; };
+    const auto scale       = Real_t(1) / static_cast<Real_t>(factor.x * factor.y * factor.z);
+    ParallelExec::run(0u, coarse.resolution.x, 0u, coarse.resolution.y, 0u, coarse.resolution.z,
+                      [&](UInt I, UInt J, UInt K) {
+                          if(coarse.cellTypes(I, J, K) != Fluid) {
+                              coarse.b(I, J, K) = 0;
+                              return;
+                          }
+                          Real_t sum = 0;
+                          for(Int dk = offsetBegin(2); dk <= offsetEnd(2); ++dk) {
+                              const Int k = static_cast<Int>(factor.z * K) + dk;
+                              if(k < 0 || k >= fineRes.z) {
+                                  continue;
+                              }
+                              for(Int dj = offsetBegin(1); dj <= offsetEnd(1); ++dj) {
+                                  const Int j = static_cast<Int>(factor.y * J) + dj;
+                                  if(j < 0 || j >= fineRes.y) {
+                                      continue;
+                                  }
+                                  const auto wjk = prolongationWeight<Real_t>(j, J, coarseRes.y, factor.y) *
+                                                   prolongationWeight<Real_t>(k, K, coarseRes.z, factor.z);
+                                  for(Int di = offsetBegin(0); di <= offsetEnd(0); ++di) {
+                                      const Int i = static_cast<Int>(factor.x * I) + di;
+                                      if(i < 0 || i >= fineRes.x) {
+                                          continue;
+                                      }
+                                      sum += wjk * prolongationWeight<Real_t>(i, I, coarseRes.x, factor.x) * fine.r(i, j, k);
+                                  }
+                              }
+                          }
+                          coarse.b(I, J, K) = scale * sum;
+                      });
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// fine.x += P * coarse.x, values of the non-fluid coarse cells are zero, values outside the grid are extrapolated
+template<class Real_t>
+void GeometricMGSolver<Real_t>::prolongateAndAdd(const Level& coarse, Level& fine) const {
+    const auto coarseRes = Vec3i(coarse.resolution);
+    const auto factor    = coarse.factor;
+    ParallelExec::run(0u, fine.resolution.x, 0u, fine.resolution.y, 0u, fine.resolution.z,
+                      [&](UInt i, UInt j, UInt k) {
+                          if(fine.cellTypes(i, j, k) != Fluid) {
+                              return;
+                          }
+                          // the two closest coarse cells in each coarsened dimension, the same cell otherwise
+                          const Vec3i cell(i, j, k);
+                          Vec3i       coarseIdx[2];
+                          Real_t      weight[2][3];
+                          for(Int d = 0; d < 3; ++d) {
+                              if(factor[d] == 1u) {
+                                  coarseIdx[0][d] = coarseIdx[1][d] = cell[d];
+                                  weight[0][d]    = Real_t(1);
+                                  weight[1][d]    = Real_t(0);
+                                  continue;
+                              }
+                              const Int parent = cell[d] / 2;
+                              coarseIdx[0][d] = parent;
+                              coarseIdx[1][d] = (cell[d] & 1) ? parent + 1 : parent - 1;
+                              weight[0][d]    = Real_t(0.75);
+                              weight[1][d]    = Real_t(0.25);
+                              if(coarseIdx[1][d] < 0 || coarseIdx[1][d] >= coarseRes[d]) {
+                                  coarseIdx[1][d] = parent;
+                              }
+                          }
+                          Real_t sum = 0;
+                          for(Int c = 0; c < 8; ++c) {
+                              const Int ci = c & 1, cj = (c >> 1) & 1, ck = c >> 2;
+                              sum += weight[ci][0] * weight[cj][1] * weight[ck][2] * coarse.x(coarseIdx[ci][0], coarseIdx[cj][1], coarseIdx[ck][2]);
+                          }
+                          fine.x(i, j, k) += sum;
+                      });
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// V-cycle for level.x with zero initial guess, the right hand side is level.b
+template<class Real_t>
+void GeometricMGSolver<Real_t>::vcycle(UInt levelIdx) {
+    auto& level = m_Levels[levelIdx];
+    level.x.assign(Real_t(0));
+    if(levelIdx + 1 == numLevels()) {
+        smoothRedBlack(level, m_nCoarsestSmoothSteps, false);
+        smoothRedBlack(level, m_nCoarsestSmoothSteps, true);
+        return;
+    }
+
+    auto& coarse = m_Levels[levelIdx + 1];
+    smoothRedBlack(level, m_nSmoothSteps, false);
+    computeResidual(level);
+    restrictResidual(level, coarse);
+    vcycle(levelIdx + 1);
+    prolongateAndAdd(coarse, level);
+    smoothRedBlack(level, m_nSmoothSteps, true);
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<class Real_t>
+void GeometricMGSolver<Real_t>::applyPreconditioner(const Array3<Real_t>& r, Array3<Real_t>& z) {
+    NT_REQUIRE(!m_Levels.empty() && r.dataSize() == m_Levels.front().cellTypes.dataSize());
+    auto& fine = m_Levels.front();
+    fine.b.flatData() = r.flatData();
+    vcycle(0);
+    z.resize(Vec3<size_t>(fine.resolution));
+    z.flatData() = fine.x.flatData();
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<class Real_t>
+bool GeometricMGSolver<Real_t>::solve(const Array3<Real_t>& rhs, Array3<Real_t>& result) {
+    NT_REQUIRE(!m_Levels.empty() && rhs.dataSize() == m_Levels.front().cellTypes.dataSize());
+    const auto& fine = m_Levels.front();
+    result.resize(Vec3<size_t>(fine.resolution));
+    if(m_bZeroInitial) {
+        result.assign(Real_t(0));
+    }
+
+    // r = rhs - A * result at fluid cells
+    m_r.resize(Vec3<size_t>(fine.resolution));
+    applyOperator(fine, result, m_r);
+    ParallelExec::run(rhs.dataSize(),
+                      [&](size_t idx) {
+                          m_r.flatData(idx) = (fine.cellTypes.flatData(idx) == Fluid) ? rhs.flatData(idx) - m_r.flatData(idx) : Real_t(0);
+                      });
+    auto& r = m_r.flatData();
+    m_OutResidual = ParallelSTL::maxAbs<Real_t>(r);
+    if(m_OutResidual < std::numeric_limits<Real_t>::min()) {
+        m_OutIterations = 0;
+        return true;
+    }
+
+    const auto tol = m_ToleranceFactor * m_OutResidual;
+    applyPreconditioner(m_r, m_z);
+    auto&  z   = m_z.flatData();
+    Real_t rho = ParallelBLAS::dotProduct<Real_t>(z, r);
+    if(rho < std::numeric_limits<Real_t>::min() || std::isnan(rho)) {
+        m_OutIterations = 0;
+        return false;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+    m_s = m_z;
+    m_As.resize(Vec3<size_t>(fine.resolution));
+    auto& s  = m_s.flatData();
+    auto& As = m_As.flatData();
+    auto& x  = result.flatData();
+    for(UInt iteration = 0; iteration < m_MaxIterations; ++iteration) {
+        applyOperator(fine, m_s, m_As);
+        Real_t tmp = ParallelBLAS::dotProduct<Real_t>(s, As);
+        if(tmp < std::numeric_limits<Real_t>::min()) {
+            m_OutIterations = iteration + 1;
+            return true;
+        }
+        Real_t alpha = rho / tmp;
+        ParallelBLAS::addScaled<Real_t>(alpha,  s,  x);
+        ParallelBLAS::addScaled<Real_t>(-alpha, As, r);
+
+        m_OutResidual = ParallelSTL::maxAbs<Real_t>(r);
+        if(m_OutResidual < tol) {
+            m_OutIterations = iteration + 1;
+            return true;
+        }
+
+        applyPreconditioner(m_r, m_z);
+        Real_t rho_new = ParallelBLAS::dotProduct<Real_t>(z, r);
+        Real_t beta    = rho_new / rho;
+        ParallelBLAS::scaledAdd<Real_t, Real_t>(beta, z, s);
+        rho = rho_new;
+    }
+
+    m_OutIterations = m_MaxIterations;
+    return false;
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<class Real_t>
+bool GeometricMGSolver<Real_t>::solveMG(const Array3<Real_t>& rhs, Array3<Real_t>& result) {
+    NT_REQUIRE(!m_Levels.empty() && rhs.dataSize() == m_Levels.front().cellTypes.dataSize());
+    auto& fine = m_Levels.front();
+    result.resize(Vec3<size_t>(fine.resolution));
+    if(m_bZeroInitial) {
+        result.assign(Real_t(0));
+    }
+
+    m_r.resize(Vec3<size_t>(fine.resolution));
+    auto computeResidual = [&]() {
+                               applyOperator(fine, result, m_r);
+                               ParallelExec::run(rhs.dataSize(),
+                                                 [&](size_t idx) {
+                                                     m_r.flatData(idx) = (fine.cellTypes.flatData(idx) == Fluid) ?
+                                                                         rhs.flatData(idx) - m_r.flatData(idx) : Real_t(0);
+                                                 });
+                               return ParallelSTL::maxAbs<Real_t>(m_r.flatData());
+                           };
+    m_OutResidual = computeResidual();
+    if(m_OutResidual < std::numeric_limits<Real_t>::min()) {
+        m_OutIterations = 0;
+        return true;
+    }
+
+    const auto tol = m_ToleranceFactor * m_OutResidual;
+    for(UInt iteration = 0; iteration < m_MaxIterations; ++iteration) {
+        applyPreconditioner(m_r, m_z);
+        ParallelBLAS::addScaled<Real_t>(Real_t(1), m_z.flatData(), result.flatData());
+        m_OutResidual = computeResidual();
+        if(m_OutResidual < tol) {
+            m_OutIterations = iteration + 1;
+            return true;
+        }
+    }
+
+    m_OutIterations = m_MaxIterations;
+    return false;
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+NT_INSTANTIATE_CLASS_COMMON_TYPES(GeometricMGSolver)
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+} // end namespace NTCodeBase
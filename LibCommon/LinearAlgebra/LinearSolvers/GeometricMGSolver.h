@@ -0,0 +1,105 @@
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//
+//    .--------------------------------------------------.
+//    |  This file is part of NTCodeBase                 |
+//    |  Created 2018 by NT (https://ttnghia.github.io)  |
+//    '--------------------------------------------------'
+//                            \o/
+//                             |
+//                            / |
+//
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+
+#pragma once
+
+#include <LibCommon/Array/Array.h>
+#include <LibCommon/ParallelHelpers/ParallelBLAS.h>
+#include <LibCommon/ParallelHelpers/ParallelSTL.h>
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+namespace NTCodeBase {
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// Matrix-free geometric multigrid for the 7-point Poisson equation on a cell centered grid (McAdams, Sifakis, Teran 2010)
+// The unknowns are the Fluid cells, Air cells are Dirichlet (zero) and Solid cells are Neumann boundaries,
+// cells outside the grid are treated as Solid. The operator uses unit grid spacing, for each fluid cell:
+//    (number of non-solid neighbors) * x_c - sum(x_n, fluid neighbors n) = b_c
+// Multigrid components:
+//    - semi-coarsening: each level halves the dimensions that are larger than the coarsest resolution, the others are
+//      kept, thus flat or elongated grids (e.g. 256 x 256 x 8) are coarsened until all dimensions reach the coarsest
+//      resolution. The coarse operators are the 7-point stencils of the (possibly anisotropic) coarse grid spacing
+//    - coarse cell types: Air if any child is Air, otherwise Fluid if any child is Fluid, otherwise Solid
+//    - smoother: red-black Gauss-Seidel, the post-smoothing sweeps run in reverse color order so that the V-cycle is symmetric
+//    - prolongation: trilinear interpolation of the coarse cells, restriction: the scaled transpose of prolongation
+// The V-cycle can be used standalone (solveMG) or as preconditioner for conjugate gradient (solve, MGPCG).
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<class Real_t>
+class GeometricMGSolver {
+public:
+    enum CellType : char {
+        Fluid = 0,
+        Air   = 1,
+        Solid = 2
+    };
+
+    GeometricMGSolver() = default;
+    Real_t residual() const noexcept { return m_OutResidual; }
+    UInt   iterations() const noexcept { return m_OutIterations; }
+    UInt   numLevels() const noexcept { return static_cast<UInt>(m_Levels.size()); }
+
+    ////////////////////////////////////////////////////////////////////////////////
+    void setSolverParameters(Real_t toleranceFactor, UInt maxIterations);
+    void setSmoothingSteps(UInt nSmoothSteps, UInt nCoarsestSmoothSteps = 50u);
+    void setCoarsestResolution(UInt coarsestResolution) { m_CoarsestResolution = coarsestResolution; }
+    void setZeroInitial(bool bZeroInitial) { m_bZeroInitial = bZeroInitial; }
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // build the multigrid hierarchy, must be called again when the cell types change
+    void setup(const Array3c& cellTypes);
+    // MGPCG
+    bool solve(const Array3<Real_t>& rhs, Array3<Real_t>& result);
+    // V-cycles only
+    bool solveMG(const Array3<Real_t>& rhs, Array3<Real_t>& result);
+
+    // result = A * x, zero at non-fluid cells
+    void applyOperator(const Array3<Real_t>& x, Array3<Real_t>& result) const;
+    // z = one V-cycle applied to r with zero initial guess
+    void applyPreconditioner(const Array3<Real_t>& r, Array3<Real_t>& z);
+
+private:
+    struct Level {
+        Vec3ui         resolution;
+        Vec3ui         factor;  // coarsening factor (1 or 2) of each dimension from the finer level
+        Vec3<Real_t>   weights; // stencil weights of each dimension, (h_finest / h_level)^2
+        Array3c        cellTypes;
+        Array3<Real_t> x, b, r;
+    };
+
+    void applyOperator(const Level& level, const Array3<Real_t>& x, Array3<Real_t>& result) const;
+    void computeResidual(Level& level) const;
+    void smoothRedBlack(Level& level, UInt nSteps, bool bReverseColors) const;
+    void restrictResidual(const Level& fine, Level& coarse) const;
+    void prolongateAndAdd(const Level& coarse, Level& fine) const;
+    void vcycle(UInt levelIdx);
+
+    ////////////////////////////////////////////////////////////////////////////////
+    StdVT<Level>   m_Levels;
+    Array3<Real_t> m_r, m_z, m_s, m_As; // PCG vectors
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // solver parameters
+    UInt   m_nSmoothSteps         = 2u;
+    UInt   m_nCoarsestSmoothSteps = 50u;
+    UInt   m_CoarsestResolution   = 8u;
+    Real_t m_ToleranceFactor      = Real_t(1e-20);
+    UInt   m_MaxIterations        = 1000u;
+    bool   m_bZeroInitial         = true;
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // output
+    Real_t m_OutResidual   = 0;
+    UInt   m_OutIterations = 0;
+};
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+} // end namespace NTCodeBase
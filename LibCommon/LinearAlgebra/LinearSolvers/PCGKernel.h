@@ -0,0 +1,77 @@
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//
+//    .--------------------------------------------------.
+//    |  This file is part of NTCodeBase                 |
+//    |  Created 2018 by NT (https://ttnghia.github.io)  |
+//    '--------------------------------------------------'
+//                            \o/
+//                             |
+//                            / |
+//
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+
+#pragma once
+
+#include <LibCommon/CommonSetup.h>
+#include <LibCommon/ParallelHelpers/ParallelBLAS.h>
+#include <LibCommon/ParallelHelpers/ParallelSTL.h>
+#include <cmath>
+#include <limits>
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+namespace NTCodeBase::PCGKernel {
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// Preconditioned conjugate gradient iterations, shared by the matrix-free solves of PCGSolver and BlockPCGSolver
+// Vector is StdVT<Real_t> or StdVT<VecX<N, Real_t>>, multiply(x, y) computes y = A * x and precondition(x, y) y = M^-1 * x
+// On entry, result holds the initial guess and r = rhs - A * result; tol is the absolute tolerance of max|r|,
+// z and s are work vectors of the size of r. A search direction with zero curvature ends the iterations successfully
+template<class Real_t, class Vector, class Multiply, class Precondition>
+bool iterate(Multiply&& multiply, Precondition&& precondition, Real_t tol, UInt maxIterations,
+             Vector& result, Vector& r, Vector& z, Vector& s, Real_t& outResidual, UInt& outIterations) {
+    outIterations = 0;
+    outResidual   = ParallelSTL::maxAbs(r);
+    if(outResidual < tol || outResidual < std::numeric_limits<Real_t>::min()) {
+        return true;
+    }
+
+    precondition(r, z);
+    Real_t rho = ParallelBLAS::dotProduct(z, r);
+    if(rho < std::numeric_limits<Real_t>::min() || std::isnan(rho)) {
+        return false;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+    s = z;
+    for(UInt iteration = 0; iteration < maxIterations; ++iteration) {
+        multiply(s, z);
+        Real_t tmp = ParallelBLAS::dotProduct(s, z);
+        if(tmp < std::numeric_limits<Real_t>::min()) {
+            outIterations = iteration + 1;
+            return true;
+        }
+        Real_t alpha = rho / tmp;
+        ParallelBLAS::addScaled(alpha,  s, result);
+        ParallelBLAS::addScaled(-alpha, z, r);
+
+        outResidual = ParallelSTL::maxAbs(r);
+        if(outResidual < tol) {
+            outIterations = iteration + 1;
+            return true;
+        }
+
+        precondition(r, z);
+        Real_t rho_new = ParallelBLAS::dotProduct(z, r);
+        Real_t beta    = rho_new / rho;
+        ParallelBLAS::addScaled(beta, s, z);
+        s.swap(z); // s=beta*s+z
+        rho = rho_new;
+    }
+
+    outIterations = maxIterations;
+    return false;
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+} // end namespace NTCodeBase::PCGKernel
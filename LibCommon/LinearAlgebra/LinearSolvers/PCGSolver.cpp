@@ -13,6 +13,8 @@
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 
 #include <LibCommon/LinearAlgebra/LinearSolvers/PCGSolver.h>
+#include <LibCommon/LinearAlgebra/LinearSolvers/PCGKernel.h>
+#include <LibCommon/Timer/Timer.h>
 
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 namespace NTCodeBase {
@@ -43,6 +45,115 @@ void SparseColumnLowerFactor<Real_t>::resize(UInt newSize) {
     colStart.resize(nRows + 1);
 }
 
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// Compare two CSR sparsity patterns: the column index arrays may have a stale padding element after the last row
+// (see FixedSparseMatrix::constructFromSparseMatrix), thus only the live entries [0, rowStart.back()) are compared.
+// storePattern keeps only the live entries
+static bool samePattern(const StdVT_UInt& rowStartA, const StdVT_UInt& colIndexA, const StdVT_UInt& rowStartB, const StdVT_UInt& colIndexB) {
+    if(rowStartA != rowStartB) {
+        return false;
+    }
+    const size_t nnz = rowStartA.empty() ? size_t(0) : static_cast<size_t>(rowStartA.back());
+    return colIndexA.size() >= nnz && colIndexB.size() >= nnz &&
+           std::equal(colIndexA.begin(), colIndexA.begin() + nnz, colIndexB.begin());
+}
+
+static void storePattern(const StdVT_UInt& rowStart, const StdVT_UInt& colIndex, StdVT_UInt& patternRowStart, StdVT_UInt& patternColIndex) {
+    patternRowStart = rowStart;
+    patternColIndex.assign(colIndex.begin(), colIndex.begin() + (rowStart.empty() ? size_t(0) : static_cast<size_t>(rowStart.back())));
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// Level schedule of lower factor
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<class Real_t>
+bool LowerFactorLevelSchedule<Real_t>::matchPattern(const SparseColumnLowerFactor<Real_t>& factor) const {
+    return samePattern(patternColStart, patternColIndex, factor.colStart, factor.colIndex);
+}
+
+template<class Real_t>
+void LowerFactorLevelSchedule<Real_t>::clear() {
+    rowStart.resize(0);
+    rowColIndex.resize(0);
+    rowValueIndex.resize(0);
+    rowValue.resize(0);
+    forwardLevelStart.resize(0);
+    forwardLevelRows.resize(0);
+    backwardLevelStart.resize(0);
+    backwardLevelRows.resize(0);
+    patternColStart.resize(0);
+    patternColIndex.resize(0);
+}
+
+template<class Real_t>
+void LowerFactorLevelSchedule<Real_t>::updateRowValues(const SparseColumnLowerFactor<Real_t>& factor) {
+    rowValue.resize(rowValueIndex.size());
+    ParallelExec::run(rowValueIndex.size(), [&](size_t q) { rowValue[q] = factor.colValue[rowValueIndex[q]]; });
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<class Real_t>
+void LowerFactorLevelSchedule<Real_t>::build(const SparseColumnLowerFactor<Real_t>& factor) {
+    const UInt nRows = factor.nRows;
+    storePattern(factor.colStart, factor.colIndex, patternColStart, patternColIndex);
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // transpose the pattern: rows of L, columns sorted since they are visited in increasing order
+    rowStart.assign(nRows + 1, 0u);
+    for(UInt p = 0, pEnd = factor.colStart[nRows]; p < pEnd; ++p) {
+        ++rowStart[factor.colIndex[p] + 1];
+    }
+    for(UInt i = 0; i < nRows; ++i) {
+        rowStart[i + 1] += rowStart[i];
+    }
+    rowColIndex.resize(rowStart[nRows]);
+    rowValueIndex.resize(rowStart[nRows]);
+    StdVT_UInt rowCursor(rowStart.begin(), rowStart.end() - 1);
+    for(UInt k = 0; k < nRows; ++k) {
+        for(UInt p = factor.colStart[k], pEnd = factor.colStart[k + 1]; p < pEnd; ++p) {
+            const auto pos = rowCursor[factor.colIndex[p]]++;
+            rowColIndex[pos]   = k;
+            rowValueIndex[pos] = p;
+        }
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // level of each row: one more than the largest level of the rows it depends on
+    auto groupByLevel = [nRows](const StdVT_UInt& level, StdVT_UInt& levelStart, StdVT_UInt& levelRows) {
+                            const UInt nLevels = nRows > 0 ? *std::max_element(level.begin(), level.end()) + 1u : 0u;
+                            levelStart.assign(nLevels + 1, 0u);
+                            for(UInt i = 0; i < nRows; ++i) {
+                                ++levelStart[level[i] + 1];
+                            }
+                            for(UInt l = 0; l < nLevels; ++l) {
+                                levelStart[l + 1] += levelStart[l];
+                            }
+                            levelRows.resize(nRows);
+                            StdVT_UInt levelCursor(levelStart.begin(), levelStart.end() - 1);
+                            for(UInt i = 0; i < nRows; ++i) {
+                                levelRows[levelCursor[level[i]]++] = i;
+                            }
+                        };
+
+    StdVT_UInt level(nRows, 0u);
+    for(UInt k = 0; k < nRows; ++k) {
+        for(UInt p = factor.colStart[k], pEnd = factor.colStart[k + 1]; p < pEnd; ++p) {
+            level[factor.colIndex[p]] = std::max(level[factor.colIndex[p]], level[k] + 1u);
+        }
+    }
+    groupByLevel(level, forwardLevelStart, forwardLevelRows);
+
+    for(UInt i = nRows; i > 0; --i) {
+        const UInt k = i - 1;
+        level[k] = 0;
+        for(UInt p = factor.colStart[k], pEnd = factor.colStart[k + 1]; p < pEnd; ++p) {
+            level[k] = std::max(level[k], level[factor.colIndex[p]] + 1u);
+        }
+    }
+    groupByLevel(level, backwardLevelStart, backwardLevelRows);
+}
+
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 // PCGSolver
@@ -50,12 +161,93 @@ void SparseColumnLowerFactor<Real_t>::resize(UInt newSize) {
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 template<class Real_t>
 void PCGSolver<Real_t>::setSolverParameters(Real_t tolerancem_ICCPrecond, int maxIterations, Real_t MICCL0Param /*= 0.97*/, Real_t minDiagonalRatio /*= 0.25*/) {
+    if(MICCL0Param != m_MICCL0Param || minDiagonalRatio != m_MinDiagonalRatio) {
+        m_bPreconditionerValid = false;
+    }
     m_ToleranceFactor  = fmax(tolerancem_ICCPrecond, Real_t(1e-30));
     m_MaxIterations    = maxIterations;
     m_MICCL0Param      = MICCL0Param;
     m_MinDiagonalRatio = minDiagonalRatio;
 }
 
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// Preconditioner reuse and solve statistics
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// Records the statistics when a solve function returns, whichever the return path
+template<class Real_t>
+struct PCGSolver<Real_t>::SolveStatsScope {
+    explicit SolveStatsScope(PCGSolver<Real_t>& solver, bool bPreconditioned = true) : m_Solver(solver), m_bPreconditioned(bPreconditioned) {
+        m_Solver.m_Stats.bRebuilt  = false;
+        m_Solver.m_Stats.setupTime = 0;
+        m_Timer.tick();
+    }
+
+    ~SolveStatsScope() { m_Solver.finishSolve(m_Timer.tock(), m_bPreconditioned); }
+
+private:
+    PCGSolver<Real_t>& m_Solver;
+    bool               m_bPreconditioned;
+    Timer              m_Timer;
+};
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<class Real_t>
+void PCGSolver<Real_t>::setMulticolorMICCL0Param(Real_t MICCL0Param) {
+    if(MICCL0Param != m_MulticolorMICCL0Param) {
+        m_bPreconditionerValid = false;
+    }
+    m_MulticolorMICCL0Param = MICCL0Param;
+}
+
+template<class Real_t>
+void PCGSolver<Real_t>::setPreconditionerReuse(UInt maxAge, Real_t maxIterationRatio /*= 1.5*/) {
+    m_MaxPreconditionerAge            = std::max(maxAge, 1u);
+    m_MaxPreconditionerIterationRatio = maxIterationRatio;
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// Call after m_FixedSparseMatrix is constructed. Returns true if the preconditioner was recomputed
+template<class Real_t>
+bool PCGSolver<Real_t>::updatePreconditioner(const SparseMatrix<Real_t>& matrix) {
+    const bool bRebuild = !m_bPreconditionerValid ||
+                          m_Stats.factorAge >= m_MaxPreconditionerAge ||
+                          m_FactorPreconditionerType != m_PreconditionerType ||
+                          !samePattern(m_PreconditionerRowStart, m_PreconditionerColIndex, m_FixedSparseMatrix.rowStart, m_FixedSparseMatrix.colIndex);
+    if(bRebuild) {
+        Timer timer;
+        timer.tick();
+        formPreconditioner(matrix);
+        m_Stats.setupTime = timer.tock();
+        m_Stats.factorAge = 0;
+        ++m_Stats.nFactorizations;
+
+        // the pattern is only needed to decide about reusing
+        if(m_MaxPreconditionerAge > 1u) {
+            storePattern(m_FixedSparseMatrix.rowStart, m_FixedSparseMatrix.colIndex, m_PreconditionerRowStart, m_PreconditionerColIndex);
+        }
+        m_FactorPreconditionerType  = m_PreconditionerType;
+        m_bPreconditionerValid      = true;
+        m_bFloatPreconditionerValid = false;
+    }
+    m_Stats.bRebuilt = bRebuild;
+    ++m_Stats.factorAge;
+    return bRebuild;
+}
+
+template<class Real_t>
+void PCGSolver<Real_t>::finishSolve(double totalTime, bool bPreconditioned) {
+    m_Stats.iterations = m_OutIterations;
+    m_Stats.solveTime  = totalTime - m_Stats.setupTime;
+    if(!bPreconditioned) {
+        return;
+    }
+    if(m_Stats.bRebuilt) {
+        m_Stats.factorIterations = m_OutIterations;
+    } else if(static_cast<Real_t>(m_OutIterations) > m_MaxPreconditionerIterationRatio * static_cast<Real_t>(std::max(m_Stats.factorIterations, 1u))) {
+        m_bPreconditionerValid = false; // degraded: recompute at the next solve
+    }
+}
+
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 template<class Real_t>
 void PCGSolver<Real_t>::reserve(UInt size) {
@@ -74,9 +266,25 @@ void PCGSolver<Real_t>::resize(UInt size) {
     r.resize(size);
 }
 
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// Warm start: r = rhs - A * result, with r = rhs on entry and the assembled matrix already constructed
+// return true if the initial guess already solves the system to the tolerance (zero iterations)
+template<class Real_t>
+bool PCGSolver<Real_t>::subtractInitialGuess(const StdVT<Real_t>& result, Real_t tol) {
+    FixedSparseMatrix<Real_t>::multiply(m_FixedSparseMatrix, result, s);
+    ParallelExec::run(m_FixedSparseMatrix.nRows, [&](UInt i) { r[i] -= s[i]; });
+    m_OutResidual = ParallelSTL::maxAbs<Real_t>(r);
+    if(m_OutResidual < tol) {
+        m_OutIterations = 0;
+        return true;
+    }
+    return false;
+}
+
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 template<class Real_t>
 bool PCGSolver<Real_t>::solve(const SparseMatrix<Real_t>& matrix, const StdVT<Real_t>& rhs, StdVT<Real_t>& result) {
+    SolveStatsScope statsScope(*this, false);
     resize(matrix.nRows);
 
     result.resize(matrix.nRows);
@@ -95,6 +303,9 @@ bool PCGSolver<Real_t>::solve(const SparseMatrix<Real_t>& matrix, const StdVT<Re
     }
 
     Real_t tol = m_ToleranceFactor * m_OutResidual;
+    if(!m_bZeroInitial && subtractInitialGuess(result, tol)) {
+        return true;
+    }
     Real_t rho = ParallelBLAS::dotProduct<Real_t>(r, r);
 
     if(rho < std::numeric_limits<Real_t>::min() || std::isnan(rho)) {
@@ -134,6 +345,7 @@ bool PCGSolver<Real_t>::solve(const SparseMatrix<Real_t>& matrix, const StdVT<Re
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 template<class Real_t>
 bool PCGSolver<Real_t>::solve_precond(const SparseMatrix<Real_t>& matrix, const StdVT<Real_t>& rhs, StdVT<Real_t>& result) {
+    SolveStatsScope statsScope(*this);
     resize(matrix.nRows);
 
     result.resize(matrix.nRows);
@@ -151,7 +363,10 @@ bool PCGSolver<Real_t>::solve_precond(const SparseMatrix<Real_t>& matrix, const
     }
 
     Real_t tol = m_ToleranceFactor * m_OutResidual;
-    formPreconditioner(matrix);
+    if(!m_bZeroInitial && subtractInitialGuess(result, tol)) {
+        return true;
+    }
+    updatePreconditioner(matrix);
     applyPreconditioner(r, z);
 
     Real_t rho = ParallelBLAS::dotProduct<Real_t>(z, r);
@@ -191,6 +406,174 @@ bool PCGSolver<Real_t>::solve_precond(const SparseMatrix<Real_t>& matrix, const
     return false;
 }
 
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<class Real_t>
+bool PCGSolver<Real_t>::solve(const LinearOperator<Real_t>& op, const StdVT<Real_t>& rhs, StdVT<Real_t>& result) {
+    return solveOperator(op, rhs, result, false);
+}
+
+template<class Real_t>
+bool PCGSolver<Real_t>::solve_precond(const LinearOperator<Real_t>& op, const StdVT<Real_t>& rhs, StdVT<Real_t>& result) {
+    return solveOperator(op, rhs, result, op.hasDiagonal());
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// Same iterations as solve_precond (see PCGKernel::iterate), the preconditioner of the assembled matrix (if any) is left untouched
+template<class Real_t>
+bool PCGSolver<Real_t>::solveOperator(const LinearOperator<Real_t>& op, const StdVT<Real_t>& rhs, StdVT<Real_t>& result, bool bJacobi) {
+    SolveStatsScope statsScope(*this, false);
+    const UInt n = op.size();
+    NT_REQUIRE(rhs.size() == n);
+    resize(n);
+
+    result.resize(n);
+    if(m_bZeroInitial) {
+        result.assign(result.size(), 0);
+        r = rhs;
+    } else {
+        op.multiply(result, s);
+        ParallelExec::run<UInt>(0, n, [&](UInt i) { r[i] = rhs[i] - s[i]; });
+    }
+
+    // relative to the right hand side, as for assembled matrices, whichever the initial guess
+    const Real_t tol = m_ToleranceFactor * ParallelSTL::maxAbs<Real_t>(rhs);
+    if(bJacobi) {
+        Timer timer;
+        timer.tick();
+        op.computeDiagonal(m_OperatorJacobiPrecond);
+        NT_REQUIRE(m_OperatorJacobiPrecond.size() == n);
+        ParallelExec::run<UInt>(0, n,
+                                [&](UInt i) {
+                                    auto& d = m_OperatorJacobiPrecond[i];
+                                    d = (d != Real_t(0)) ? Real_t(1.0) / d : Real_t(0);
+                                });
+        m_Stats.setupTime = timer.tock();
+    }
+    return PCGKernel::iterate(
+        [&](const StdVT<Real_t>& x, StdVT<Real_t>& y) { op.multiply(x, y); },
+        [&](const StdVT<Real_t>& x, StdVT<Real_t>& y) {
+            if(bJacobi) {
+                ParallelExec::run<UInt>(0, n, [&](UInt i) { y[i] = m_OperatorJacobiPrecond[i] * x[i]; });
+            } else {
+                y = x;
+            }
+        },
+        tol, m_MaxIterations, result, r, z, s, m_OutResidual, m_OutIterations);
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// Chronopoulos-Gear variant of PCG, with u = M^-1 r, w = A u and the recurrences s = A p:
+//   gamma = (r, u), delta = (w, u)
+//   beta  = gamma / gamma_old, alpha = gamma / (delta - beta * gamma / alpha_old)
+//   p = u + beta p, s = w + beta s, x += alpha p, r -= alpha s
+// The standard algorithm needs two dot products and a max norm per iteration, each of them a separate reduction
+// and a separate pass over memory. Here (r, u), (w, u) and max|r| are accumulated in the same sweep as w = A u,
+// and all vector updates are done in one sweep, thus there is one reduction and three passes per iteration
+// (update, preconditioner, matrix-vector product)
+template<class Real_t>
+bool PCGSolver<Real_t>::solve_precond_single_reduction(const SparseMatrix<Real_t>& matrix, const StdVT<Real_t>& rhs, StdVT<Real_t>& result) {
+    SolveStatsScope statsScope(*this);
+    resize(matrix.nRows);
+    w.resize(matrix.nRows);
+
+    result.resize(matrix.nRows);
+    if(m_bZeroInitial) {
+        result.assign(result.size(), 0);
+    }
+
+    m_FixedSparseMatrix.constructFromSparseMatrix(matrix);
+    r = rhs;
+
+    m_OutResidual = ParallelSTL::maxAbs<Real_t>(r);
+    if(m_OutResidual < std::numeric_limits<Real_t>::min()) {
+        m_OutIterations = 0;
+        return true;
+    }
+
+    Real_t tol = m_ToleranceFactor * m_OutResidual;
+    if(!m_bZeroInitial) {
+        FixedSparseMatrix<Real_t>::multiply(m_FixedSparseMatrix, result, s);
+        ParallelExec::run(matrix.nRows, [&](UInt i) { r[i] -= s[i]; });
+    }
+    updatePreconditioner(matrix);
+    applyPreconditioner(r, z);
+
+    Real_t gamma, delta;
+    multiplyAndReduce(z, w, gamma, delta, m_OutResidual);
+    if(gamma < std::numeric_limits<Real_t>::min() || std::isnan(gamma)) {
+        m_OutIterations = 0;
+        return m_OutResidual < tol;
+    }
+
+    // p and s are read (times beta = 0) in the first update, thus they must not hold values of a previous solve:
+    // 0 * inf or 0 * NaN would poison the new one
+    p.assign(matrix.nRows, 0);
+    s.assign(matrix.nRows, 0);
+
+    ////////////////////////////////////////////////////////////////////////////////
+    Real_t alpha = 0, beta = 0, gammaOld = 0;
+    for(UInt iteration = 0; iteration < m_MaxIterations; ++iteration) {
+        Real_t denominator = delta;
+        if(iteration > 0) {
+            beta         = gamma / gammaOld;
+            denominator -= beta * gamma / alpha;
+        }
+        if(denominator < std::numeric_limits<Real_t>::min()) {
+            m_OutIterations = iteration + 1;
+            return true;
+        }
+        alpha = gamma / denominator;
+
+        ParallelExec::run(matrix.nRows,
+                          [&, alpha, beta](UInt i) {
+                              const Real_t pi = z[i] + beta * p[i];
+                              const Real_t si = w[i] + beta * s[i];
+                              p[i]       = pi;
+                              s[i]       = si;
+                              result[i] += alpha * pi;
+                              r[i]      -= alpha * si;
+                          });
+
+        applyPreconditioner(r, z);
+        gammaOld = gamma;
+        multiplyAndReduce(z, w, gamma, delta, m_OutResidual);
+        if(m_OutResidual < tol) {
+            m_OutIterations = iteration + 1;
+            return true;
+        }
+    }
+
+    m_OutIterations = m_MaxIterations;
+    return false;
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// result = A * x, together with (r, x), (result, x) and max|r| in the same parallel reduction
+template<class Real_t>
+void PCGSolver<Real_t>::multiplyAndReduce(const StdVT<Real_t>& x, StdVT<Real_t>& result, Real_t& rDotX, Real_t& resultDotX, Real_t& rMaxAbs) const {
+    struct Reduction {
+        Real_t rDotX      = 0;
+        Real_t resultDotX = 0;
+        Real_t rMaxAbs    = 0;
+    };
+    const auto& A   = m_FixedSparseMatrix;
+    auto        red = ParallelExec::reduce(0u, A.nRows, Reduction(),
+                                           [&](UInt i) {
+                                               Real_t tmpResult = 0;
+                                               for(UInt j = A.rowStart[i], jEnd = A.rowStart[i + 1]; j < jEnd; ++j) {
+                                                   tmpResult += A.colValue[j] * x[A.colIndex[j]];
+                                               }
+                                               result[i] = tmpResult;
+                                               return Reduction { r[i] * x[i], tmpResult * x[i], std::abs(r[i]) };
+                                           },
+                                           [](const Reduction& a, const Reduction& b) {
+                                               return Reduction { a.rDotX + b.rDotX, a.resultDotX + b.resultDotX, std::max(a.rMaxAbs, b.rMaxAbs) };
+                                           });
+    rDotX      = red.rDotX;
+    resultDotX = red.resultDotX;
+    rMaxAbs    = red.rMaxAbs;
+}
+
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 template<class Real_t>
 void PCGSolver<Real_t>::formPreconditioner(const SparseMatrix<Real_t>& matrix) {
@@ -206,13 +589,32 @@ void PCGSolver<Real_t>::formPreconditioner(const SparseMatrix<Real_t>& matrix) {
         case Preconditioner::MICCL0_SYMMETRIC:
             formPreconditioner_Symmetric_MICC0L0(matrix);
             break;
+
+        case Preconditioner::MICCL0_LEVEL_SCHEDULED:
+            formPreconditioner_MICC0L0_LevelScheduled(matrix, m_MICCL0Param, m_MinDiagonalRatio);
+            break;
+
+        case Preconditioner::MICCL0_MULTICOLOR:
+            formPreconditioner_MICC0L0_Multicolor(matrix, m_MulticolorMICCL0Param, m_MinDiagonalRatio);
+            break;
+
+        case Preconditioner::AMG:
+            m_AMGPrecond.setup(m_FixedSparseMatrix);
+            break;
     }
 }
 
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 template<class Real_t>
 void PCGSolver<Real_t>::applyPreconditioner(const StdVT<Real_t>& x, StdVT<Real_t>& result) {
-    if(m_PreconditionerType != Preconditioner::JACOBI) {
+    if(m_PreconditionerType == Preconditioner::AMG) {
+        m_AMGPrecond.applyPreconditioner(x, result);
+    } else if(m_PreconditionerType == Preconditioner::MICCL0_MULTICOLOR) {
+        applyMulticolorPreconditioner(x, result);
+    } else if(m_PreconditionerType == Preconditioner::MICCL0_LEVEL_SCHEDULED) {
+        solveLower_LevelScheduled(x, result);
+        solveLower_TransposeInPlace_LevelScheduled(result);
+    } else if(m_PreconditionerType != Preconditioner::JACOBI) {
         solveLower(x, result);
         solveLower_TransposeInPlace(result);
     } else {
@@ -231,35 +633,51 @@ void PCGSolver<Real_t>::applyJacobiPreconditioner(const StdVT<Real_t>& x, StdVT<
 
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 // Solution routines with lower triangular matrix.
+// The sparsity pattern is taken from the factor, the values may be stored in a different precision
+// (see formPreconditioner_Float), and the vectors may hold several right hand sides (see solve_precond_multi)
+namespace {
 // solve L*result=rhs
-template<class Real_t>
-void PCGSolver<Real_t>::solveLower(const StdVT<Real_t>& rhs, StdVT<Real_t>& result) {
+template<class Real_t, class Value_t, class Vector_t>
+void forwardSubstitution(const SparseColumnLowerFactor<Real_t>& factor, const StdVT<Value_t>& invDiag, const StdVT<Value_t>& colValue,
+                         const StdVT<Vector_t>& rhs, StdVT<Vector_t>& result) {
     result = rhs;
 
-    for(UInt i = 0, iEnd = m_ICCPrecond.nRows; i < iEnd; ++i) {
-        result[i] *= m_ICCPrecond.invDiag[i];
+    for(UInt i = 0, iEnd = factor.nRows; i < iEnd; ++i) {
+        result[i] *= invDiag[i];
 
-        for(UInt j = m_ICCPrecond.colStart[i], jEnd = m_ICCPrecond.colStart[i + 1]; j < jEnd; ++j) {
-            result[m_ICCPrecond.colIndex[j]] -= m_ICCPrecond.colValue[j] * result[i];
+        for(UInt j = factor.colStart[i], jEnd = factor.colStart[i + 1]; j < jEnd; ++j) {
+            result[factor.colIndex[j]] -= colValue[j] * result[i];
         }
     }
 }
 
-//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 // solve L^T*result=rhs
-template<class Real_t>
-void PCGSolver<Real_t>::solveLower_TransposeInPlace(StdVT<Real_t>& x) {
-    UInt i = m_ICCPrecond.nRows;
+template<class Real_t, class Value_t, class Vector_t>
+void backwardSubstitutionInPlace(const SparseColumnLowerFactor<Real_t>& factor, const StdVT<Value_t>& invDiag, const StdVT<Value_t>& colValue,
+                                 StdVT<Vector_t>& x) {
+    UInt i = factor.nRows;
 
     do {
         --i;
-        for(UInt j = m_ICCPrecond.colStart[i], jEnd = m_ICCPrecond.colStart[i + 1]; j < jEnd; ++j) {
-            x[i] -= m_ICCPrecond.colValue[j] * x[m_ICCPrecond.colIndex[j]];
+        for(UInt j = factor.colStart[i], jEnd = factor.colStart[i + 1]; j < jEnd; ++j) {
+            x[i] -= colValue[j] * x[factor.colIndex[j]];
         }
 
-        x[i] *= m_ICCPrecond.invDiag[i];
+        x[i] *= invDiag[i];
     } while(i > 0);
 }
+} // end anonymous namespace
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<class Real_t>
+void PCGSolver<Real_t>::solveLower(const StdVT<Real_t>& rhs, StdVT<Real_t>& result) {
+    forwardSubstitution(m_ICCPrecond, m_ICCPrecond.invDiag, m_ICCPrecond.colValue, rhs, result);
+}
+
+template<class Real_t>
+void PCGSolver<Real_t>::solveLower_TransposeInPlace(StdVT<Real_t>& x) {
+    backwardSubstitutionInPlace(m_ICCPrecond, m_ICCPrecond.invDiag, m_ICCPrecond.colValue, x);
+}
 
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 template<class Real_t>
@@ -458,10 +876,640 @@ void PCGSolver<Real_t>::formPreconditioner_Symmetric_MICC0L0(const SparseMatrix<
     }
 }
 
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// Level scheduled MIC(0): rows of the same dependency level are processed in parallel, levels in order
+// Small levels are processed serially, as the parallel loop overhead would dominate
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+namespace {
+constexpr UInt MinParallelLevelSize = 256u;
+
+template<class Function>
+void runLevel(const StdVT_UInt& levelStart, const StdVT_UInt& levelRows, UInt level, Function&& function) {
+    const UInt begin = levelStart[level];
+    const UInt end   = levelStart[level + 1];
+    if(end - begin < MinParallelLevelSize) {
+        for(UInt idx = begin; idx < end; ++idx) {
+            function(levelRows[idx]);
+        }
+    } else {
+        ParallelExec::run(begin, end, [&](UInt idx) { function(levelRows[idx]); });
+    }
+}
+
+// solve L*result=rhs, row i gathers the already computed entries of its level predecessors
+template<class Real_t, class Value_t, class Vector_t>
+void forwardSubstitutionLevelScheduled(const LowerFactorLevelSchedule<Real_t>& levels, const StdVT<Value_t>& invDiag, const StdVT<Value_t>& rowValue,
+                                       const StdVT<Vector_t>& rhs, StdVT<Vector_t>& result) {
+    result.resize(rhs.size());
+    for(UInt level = 0, nLevels = levels.nForwardLevels(); level < nLevels; ++level) {
+        runLevel(levels.forwardLevelStart, levels.forwardLevelRows, level,
+                 [&](UInt i) {
+                     Vector_t tmp = rhs[i];
+                     for(UInt q = levels.rowStart[i], qEnd = levels.rowStart[i + 1]; q < qEnd; ++q) {
+                         tmp -= rowValue[q] * result[levels.rowColIndex[q]];
+                     }
+                     result[i] = tmp * invDiag[i];
+                 });
+    }
+}
+
+// solve L^T*result=rhs
+template<class Real_t, class Value_t, class Vector_t>
+void backwardSubstitutionInPlaceLevelScheduled(const SparseColumnLowerFactor<Real_t>& factor, const LowerFactorLevelSchedule<Real_t>& levels,
+                                               const StdVT<Value_t>& invDiag, const StdVT<Value_t>& colValue, StdVT<Vector_t>& x) {
+    for(UInt level = 0, nLevels = levels.nBackwardLevels(); level < nLevels; ++level) {
+        runLevel(levels.backwardLevelStart, levels.backwardLevelRows, level,
+                 [&](UInt i) {
+                     Vector_t tmp = x[i];
+                     for(UInt j = factor.colStart[i], jEnd = factor.colStart[i + 1]; j < jEnd; ++j) {
+                         tmp -= colValue[j] * x[factor.colIndex[j]];
+                     }
+                     x[i] = tmp * invDiag[i];
+                 });
+    }
+}
+} // end anonymous namespace
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<class Real_t>
+void PCGSolver<Real_t>::solveLower_LevelScheduled(const StdVT<Real_t>& rhs, StdVT<Real_t>& result) {
+    forwardSubstitutionLevelScheduled(m_ICCLevels, m_ICCPrecond.invDiag, m_ICCLevels.rowValue, rhs, result);
+}
+
+template<class Real_t>
+void PCGSolver<Real_t>::solveLower_TransposeInPlace_LevelScheduled(StdVT<Real_t>& x) {
+    backwardSubstitutionInPlaceLevelScheduled(m_ICCPrecond, m_ICCLevels, m_ICCPrecond.invDiag, m_ICCPrecond.colValue, x);
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// Left-looking version of formPreconditioner_MICC0L0, giving the same factor:
+// column j gathers the updates from all columns k < j with L(j,k) != 0 (in increasing k, as the right-looking
+// version applies them), then is finalized. Columns of the same level only write to themselves and read
+// finished columns, thus are processed in parallel.
+template<class Real_t>
+void PCGSolver<Real_t>::formPreconditioner_MICC0L0_LevelScheduled(const SparseMatrix<Real_t>& matrix, Real_t MICCL0Param /*= 0.97*/, Real_t minDiagonalRatio /*= 0.25*/) {
+    // copy lower triangle of matrix into m_ICCPrecond, in parallel
+    const UInt nRows = matrix.nRows;
+    m_ICCPrecond.resize(nRows);
+    ParallelExec::run(nRows,
+                      [&](UInt i) {
+                          UInt nLower = 0;
+                          m_ICCPrecond.invDiag[i] = 0;
+                          m_ICCPrecond.aDiag[i]   = 0;
+                          for(size_t j = 0, jEnd = matrix.colIndex[i].size(); j < jEnd; ++j) {
+                              if(matrix.colIndex[i][j] > i) {
+                                  ++nLower;
+                              } else if(matrix.colIndex[i][j] == i) {
+                                  m_ICCPrecond.invDiag[i] = m_ICCPrecond.aDiag[i] = matrix.colValue[i][j];
+                              }
+                          }
+                          m_ICCPrecond.colStart[i] = nLower;
+                      });
+    m_ICCPrecond.colStart[nRows] = 0;
+    const auto nnz = ParallelSTL::exclusive_scan(m_ICCPrecond.colStart);
+    m_ICCPrecond.colIndex.resize(nnz);
+    m_ICCPrecond.colValue.resize(nnz);
+    ParallelExec::run(nRows,
+                      [&](UInt i) {
+                          UInt p = m_ICCPrecond.colStart[i];
+                          for(size_t j = 0, jEnd = matrix.colIndex[i].size(); j < jEnd; ++j) {
+                              if(matrix.colIndex[i][j] > i) {
+                                  m_ICCPrecond.colIndex[p] = matrix.colIndex[i][j];
+                                  m_ICCPrecond.colValue[p] = matrix.colValue[i][j];
+                                  ++p;
+                              }
+                          }
+                      });
+
+    if(!m_ICCLevels.matchPattern(m_ICCPrecond)) {
+        m_ICCLevels.build(m_ICCPrecond);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+    auto& L = m_ICCPrecond;
+    for(UInt level = 0, nLevels = m_ICCLevels.nForwardLevels(); level < nLevels; ++level) {
+        runLevel(m_ICCLevels.forwardLevelStart, m_ICCLevels.forwardLevelRows, level,
+                 [&](UInt j) {
+                     // gather updates from finished columns k
+                     for(UInt q = m_ICCLevels.rowStart[j], qEnd = m_ICCLevels.rowStart[j + 1]; q < qEnd; ++q) {
+                         const UInt k = m_ICCLevels.rowColIndex[q];
+                         if(L.aDiag[k] < std::numeric_limits<Real_t>::min()) {
+                             continue; // null row/column
+                         }
+                         const UInt   p          = m_ICCLevels.rowValueIndex[q]; // position of L(j,k)
+                         const Real_t multiplier = L.colValue[p];
+                         Real_t       missing    = 0;
+
+                         // contributions to missing from dropped entries above the diagonal in column j
+                         UInt a = L.colStart[k];
+                         UInt b = 0;
+                         while(a < p) {
+                             while(b < matrix.colIndex[j].size()) {
+                                 if(matrix.colIndex[j][b] < L.colIndex[a]) {
+                                     ++b;
+                                 } else if(matrix.colIndex[j][b] == L.colIndex[a]) {
+                                     break;
+                                 } else {
+                                     missing += L.colValue[a];
+                                     break;
+                                 }
+                             }
+                             ++a;
+                         }
+
+                         // adjust the diagonal j,j entry
+                         L.invDiag[j] -= multiplier * L.colValue[p];
+
+                         // eliminate from the nonzero entries below the diagonal in column j (or add to missing if we can't)
+                         a = p + 1;
+                         b = L.colStart[j];
+                         while(a < L.colStart[k + 1] && b < L.colStart[j + 1]) {
+                             if(L.colIndex[b] < L.colIndex[a]) {
+                                 ++b;
+                             } else if(L.colIndex[b] == L.colIndex[a]) {
+                                 L.colValue[b] -= multiplier * L.colValue[a];
+                                 ++a;
+                                 ++b;
+                             } else {
+                                 missing += L.colValue[a];
+                                 ++a;
+                             }
+                         }
+                         while(a < L.colStart[k + 1]) {
+                             missing += L.colValue[a];
+                             ++a;
+                         }
+                         L.invDiag[j] -= MICCL0Param * multiplier * missing;
+                     }
+
+                     // finalize column j
+                     if(L.aDiag[j] < std::numeric_limits<Real_t>::min()) {
+                         return; // null row/column
+                     }
+                     if(L.invDiag[j] < minDiagonalRatio * L.aDiag[j]) {
+                         L.invDiag[j] = Real_t(1.0) / std::sqrt(L.aDiag[j]);
+                     } else {
+                         L.invDiag[j] = Real_t(1.0) / std::sqrt(L.invDiag[j]);
+                     }
+                     for(UInt p = L.colStart[j], pEnd = L.colStart[j + 1]; p < pEnd; ++p) {
+                         L.colValue[p] *= L.invDiag[j];
+                     }
+                 });
+    }
+    m_ICCLevels.updateRowValues(L);
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// Multicolor MIC(0): rows are reordered by color, so rows of the same color are not coupled and the factor
+// has no entry between them. Every color is then one dependency level of the level scheduled factorization and
+// triangular solves. The coloring is recomputed only when the sparsity pattern changes.
+// The reordering increases the number of PCG iterations compared to the natural ordering (about 3x for red-black
+// ordered 3D Poisson), and the modification hurts in this ordering, thus it has its own parameter
+// (setMulticolorMICCL0Param), 0 by default: plain IC(0).
+template<class Real_t>
+void PCGSolver<Real_t>::formPreconditioner_MICC0L0_Multicolor(const SparseMatrix<Real_t>& matrix, Real_t MICCL0Param /*= 0*/, Real_t minDiagonalRatio /*= 0.25*/) {
+    const UInt nRows = matrix.nRows;
+    if(!samePattern(m_ColorPatternRowStart, m_ColorPatternColIndex, m_FixedSparseMatrix.rowStart, m_FixedSparseMatrix.colIndex)) {
+        storePattern(m_FixedSparseMatrix.rowStart, m_FixedSparseMatrix.colIndex, m_ColorPatternRowStart, m_ColorPatternColIndex);
+
+        // sort rows by color, keeping the natural order within each color
+        StdVT_UInt rowColors;
+        m_nColors = matrix.computeRowColors(rowColors);
+        StdVT_UInt colorStart(m_nColors + 1, 0u);
+        for(UInt i = 0; i < nRows; ++i) {
+            ++colorStart[rowColors[i] + 1];
+        }
+        for(UInt c = 0; c < m_nColors; ++c) {
+            colorStart[c + 1] += colorStart[c];
+        }
+        m_ColorPermutation.resize(nRows);
+        m_ColorInvPermutation.resize(nRows);
+        for(UInt i = 0; i < nRows; ++i) {
+            const auto newIdx = colorStart[rowColors[i]]++;
+            m_ColorPermutation[newIdx] = i;
+            m_ColorInvPermutation[i]   = newIdx;
+        }
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // P * A * P^T
+    m_ColorPermutedMatrix.resize(nRows);
+    ParallelExec::run(nRows,
+                      [&](UInt newRow) {
+                          const UInt row     = m_ColorPermutation[newRow];
+                          auto&      indices = m_ColorPermutedMatrix.colIndex[newRow];
+                          auto&      values  = m_ColorPermutedMatrix.colValue[newRow];
+                          const auto size    = matrix.colIndex[row].size();
+                          StdVT<std::pair<UInt, Real_t>> entries(size);
+                          for(size_t k = 0; k < size; ++k) {
+                              entries[k] = std::make_pair(m_ColorInvPermutation[matrix.colIndex[row][k]], matrix.colValue[row][k]);
+                          }
+                          std::sort(entries.begin(), entries.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+                          indices.resize(size);
+                          values.resize(size);
+                          for(size_t k = 0; k < size; ++k) {
+                              indices[k] = entries[k].first;
+                              values[k]  = entries[k].second;
+                          }
+                      });
+    formPreconditioner_MICC0L0_LevelScheduled(m_ColorPermutedMatrix, MICCL0Param, minDiagonalRatio);
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<class Real_t>
+void PCGSolver<Real_t>::applyMulticolorPreconditioner(const StdVT<Real_t>& x, StdVT<Real_t>& result) {
+    m_ColorPermutedX.resize(x.size());
+    ParallelExec::run(x.size(), [&](size_t newIdx) { m_ColorPermutedX[newIdx] = x[m_ColorPermutation[newIdx]]; });
+    solveLower_LevelScheduled(m_ColorPermutedX, m_ColorPermutedResult);
+    solveLower_TransposeInPlace_LevelScheduled(m_ColorPermutedResult);
+    result.resize(x.size());
+    ParallelExec::run(x.size(), [&](size_t newIdx) { result[m_ColorPermutation[newIdx]] = m_ColorPermutedResult[newIdx]; });
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// Mixed precision PCG
+// The triangular solves and the SpMV are memory bound: storing the factor (and the matrix values) in float halves the
+// traffic of the values. The inner iterations can only reduce the residual to about float epsilon relative to their
+// right hand side, thus the solution is accumulated and the residual recomputed in Real_t (iterative refinement).
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+namespace {
+template<class Real_t, class Value_t, class Vector_t>
+void multiplyValues(const FixedSparseMatrix<Real_t>& pattern, const StdVT<Value_t>& values, const StdVT<Vector_t>& x, StdVT<Vector_t>& result) {
+    result.resize(pattern.nRows);
+    ParallelExec::run(pattern.nRows,
+                      [&](UInt i) {
+                          Vector_t tmpResult(0);
+                          for(UInt j = pattern.rowStart[i], jEnd = pattern.rowStart[i + 1]; j < jEnd; ++j) {
+                              tmpResult += values[j] * x[pattern.colIndex[j]];
+                          }
+                          result[i] = tmpResult;
+                      });
+}
+
+template<class DstType, class SrcType>
+void convertVector(const StdVT<SrcType>& src, StdVT<DstType>& dst) {
+    dst.resize(src.size());
+    ParallelExec::run(src.size(), [&](size_t i) { dst[i] = static_cast<DstType>(src[i]); });
+}
+} // end anonymous namespace
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<class Real_t>
+void PCGSolver<Real_t>::setMixedPrecisionParameters(bool bFloatMatrix, Real_t innerToleranceFactor /*= 1e-3*/, UInt maxStallIterations /*= 20*/) {
+    m_bFloatMatrix       = bFloatMatrix;
+    m_InnerTolerance     = innerToleranceFactor;
+    m_MaxStallIterations = std::max(maxStallIterations, 1u);
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// float copies of the factor computed by formPreconditioner
+// The multicolor and AMG preconditioners are not converted, they are applied in Real_t
+template<class Real_t>
+void PCGSolver<Real_t>::formPreconditioner_Float() {
+    switch(m_PreconditionerType) {
+        case Preconditioner::JACOBI:
+            convertVector(m_JacobiPrecond, m_FloatJacobi);
+            break;
+
+        case Preconditioner::MICCL0:
+        case Preconditioner::MICCL0_SYMMETRIC:
+            convertVector(m_ICCPrecond.invDiag,  m_FloatInvDiag);
+            convertVector(m_ICCPrecond.colValue, m_FloatColValue);
+            break;
+
+        case Preconditioner::MICCL0_LEVEL_SCHEDULED:
+            convertVector(m_ICCPrecond.invDiag,  m_FloatInvDiag);
+            convertVector(m_ICCPrecond.colValue, m_FloatColValue);
+            convertVector(m_ICCLevels.rowValue,  m_FloatRowValue);
+            break;
+
+        default:;
+    }
+}
+
+template<class Real_t>
+void PCGSolver<Real_t>::applyPreconditioner_Float(const StdVT<float>& x, StdVT<float>& result) {
+    switch(m_PreconditionerType) {
+        case Preconditioner::JACOBI:
+            result.resize(x.size());
+            ParallelExec::run(x.size(), [&](size_t i) { result[i] = m_FloatJacobi[i] * x[i]; });
+            break;
+
+        case Preconditioner::MICCL0:
+        case Preconditioner::MICCL0_SYMMETRIC:
+            forwardSubstitution(m_ICCPrecond, m_FloatInvDiag, m_FloatColValue, x, result);
+            backwardSubstitutionInPlace(m_ICCPrecond, m_FloatInvDiag, m_FloatColValue, result);
+            break;
+
+        case Preconditioner::MICCL0_LEVEL_SCHEDULED:
+            forwardSubstitutionLevelScheduled(m_ICCLevels, m_FloatInvDiag, m_FloatRowValue, x, result);
+            backwardSubstitutionInPlaceLevelScheduled(m_ICCPrecond, m_ICCLevels, m_FloatInvDiag, m_FloatColValue, result);
+            break;
+
+        default:
+            convertVector(x, m_MixedX);
+            applyPreconditioner(m_MixedX, m_MixedResult);
+            convertVector(m_MixedResult, result);
+    }
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// apply the float preconditioner to vectors of the inner iterations
+template<class Real_t>
+template<class Inner_t>
+void PCGSolver<Real_t>::applyMixedPreconditioner(const StdVT<Inner_t>& x, StdVT<Inner_t>& result) {
+    if constexpr(std::is_same_v<Inner_t, float>) {
+        applyPreconditioner_Float(x, result);
+    } else {
+        convertVector(x, m_FloatX);
+        applyPreconditioner_Float(m_FloatX, m_FloatResult);
+        convertVector(m_FloatResult, result);
+    }
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// PCG for A * v.d = v.r in Inner_t precision, starting from v.d = 0
+// Returns false if the iterations stalled or the iteration budget is exhausted
+template<class Real_t>
+template<class Inner_t>
+bool PCGSolver<Real_t>::solveInner(const StdVT<Inner_t>& matrixValues, MixedPrecisionVectors<Inner_t>& v, Real_t tol) {
+    v.d.assign(v.r.size(), Inner_t(0));
+    applyMixedPreconditioner(v.r, v.z);
+    Inner_t rho = ParallelBLAS::dotProduct<Inner_t>(v.z, v.r);
+    if(rho < std::numeric_limits<Inner_t>::min() || std::isnan(rho)) {
+        return false;
+    }
+
+    v.s = v.z;
+    Inner_t bestResidual = ParallelSTL::maxAbs<Inner_t>(v.r);
+    UInt    nStalls      = 0;
+    while(m_OutIterations < m_MaxIterations) {
+        ++m_OutIterations;
+        multiplyValues(m_FixedSparseMatrix, matrixValues, v.s, v.z);
+        Inner_t tmp = ParallelBLAS::dotProduct<Inner_t>(v.s, v.z);
+        if(tmp < std::numeric_limits<Inner_t>::min()) {
+            return true;
+        }
+        Inner_t alpha = rho / tmp;
+        ParallelBLAS::addScaled<Inner_t>(alpha,  v.s, v.d);
+        ParallelBLAS::addScaled<Inner_t>(-alpha, v.z, v.r);
+
+        Inner_t residual = ParallelSTL::maxAbs<Inner_t>(v.r);
+        if(residual < tol) {
+            return true;
+        }
+        if(residual < bestResidual) {
+            bestResidual = residual;
+            nStalls      = 0;
+        } else if(++nStalls >= m_MaxStallIterations) {
+            return false;
+        }
+
+        applyMixedPreconditioner(v.r, v.z);
+        Inner_t rho_new = ParallelBLAS::dotProduct<Inner_t>(v.z, v.r);
+        Inner_t beta    = rho_new / rho;
+        ParallelBLAS::addScaled<Inner_t, Inner_t>(beta, v.s, v.z);
+        v.s.swap(v.z); // s=beta*s+z
+        rho = rho_new;
+    }
+    return false;
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<class Real_t>
+bool PCGSolver<Real_t>::solve_precond_mixed(const SparseMatrix<Real_t>& matrix, const StdVT<Real_t>& rhs, StdVT<Real_t>& result) {
+    SolveStatsScope statsScope(*this);
+    resize(matrix.nRows);
+
+    result.resize(matrix.nRows);
+    if(m_bZeroInitial) {
+        result.assign(result.size(), 0);
+    }
+
+    m_FixedSparseMatrix.constructFromSparseMatrix(matrix);
+    r = rhs;
+
+    m_OutIterations      = 0;
+    m_OutRefinementSteps = 0;
+    m_OutResidual        = ParallelSTL::maxAbs<Real_t>(r);
+    if(m_OutResidual < std::numeric_limits<Real_t>::min()) {
+        return true;
+    }
+
+    Real_t tol = m_ToleranceFactor * m_OutResidual;
+    if(!m_bZeroInitial) {
+        FixedSparseMatrix<Real_t>::multiply(m_FixedSparseMatrix, result, s);
+        ParallelExec::run(matrix.nRows, [&](UInt i) { r[i] -= s[i]; });
+    }
+    updatePreconditioner(matrix);
+    if(!m_bFloatPreconditionerValid) {
+        formPreconditioner_Float();
+        m_bFloatPreconditionerValid = true;
+    }
+    if(m_bFloatMatrix) {
+        convertVector(m_FixedSparseMatrix.colValue, m_FloatMatrixValue);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+    m_OutResidual = ParallelSTL::maxAbs<Real_t>(r);
+    while(m_OutResidual >= tol && m_OutIterations < m_MaxIterations) {
+        if(m_bFloatMatrix) {
+            convertVector(r, m_FloatVectors.r);
+            solveInner(m_FloatMatrixValue, m_FloatVectors, std::max(m_InnerTolerance * m_OutResidual, tol));
+            ParallelExec::run(matrix.nRows, [&](UInt i) { result[i] += static_cast<Real_t>(m_FloatVectors.d[i]); });
+        } else {
+            m_MixedVectors.r = r;
+            solveInner(m_FixedSparseMatrix.colValue, m_MixedVectors, tol);
+            ParallelBLAS::addScaled<Real_t>(Real_t(1), m_MixedVectors.d, result);
+        }
+        ++m_OutRefinementSteps;
+
+        // true residual
+        FixedSparseMatrix<Real_t>::multiply(m_FixedSparseMatrix, result, s);
+        ParallelExec::run(matrix.nRows, [&](UInt i) { r[i] = rhs[i] - s[i]; });
+        Real_t residual = ParallelSTL::maxAbs<Real_t>(r);
+        if(residual >= m_OutResidual) { // refinement does not improve the solution anymore
+            m_OutResidual = residual;
+            break;
+        }
+        m_OutResidual = residual;
+    }
+    return m_OutResidual < tol;
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// Multiple right hand sides
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+namespace {
+// component-wise dot products and max norms of interleaved vectors
+template<Int K, class Real_t>
+VecX<K, Real_t> columnDotProducts(const StdVT<VecX<K, Real_t>>& x, const StdVT<VecX<K, Real_t>>& y) {
+    return ParallelExec::reduce(size_t(0), x.size(), VecX<K, Real_t>(0), [&](size_t i) { return x[i] * y[i]; });
+}
+
+template<Int K, class Real_t>
+VecX<K, Real_t> columnMaxAbs(const StdVT<VecX<K, Real_t>>& x) {
+    return ParallelExec::reduce(size_t(0), x.size(), VecX<K, Real_t>(0),
+                                [&](size_t i) { return glm::abs(x[i]); },
+                                [](const VecX<K, Real_t>& a, const VecX<K, Real_t>& b) { return glm::max(a, b); });
+}
+} // end anonymous namespace
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// The multicolor and AMG preconditioners are applied column by column
+template<class Real_t>
+template<Int K>
+void PCGSolver<Real_t>::applyPreconditioner_Multi(const StdVT<VecX<K, Real_t>>& x, StdVT<VecX<K, Real_t>>& result) {
+    result.resize(x.size());
+    switch(m_PreconditionerType) {
+        case Preconditioner::JACOBI:
+            ParallelExec::run(x.size(), [&](size_t i) { result[i] = m_JacobiPrecond[i] * x[i]; });
+            break;
+
+        case Preconditioner::MICCL0:
+        case Preconditioner::MICCL0_SYMMETRIC:
+            forwardSubstitution(m_ICCPrecond, m_ICCPrecond.invDiag, m_ICCPrecond.colValue, x, result);
+            backwardSubstitutionInPlace(m_ICCPrecond, m_ICCPrecond.invDiag, m_ICCPrecond.colValue, result);
+            break;
+
+        case Preconditioner::MICCL0_LEVEL_SCHEDULED:
+            forwardSubstitutionLevelScheduled(m_ICCLevels, m_ICCPrecond.invDiag, m_ICCLevels.rowValue, x, result);
+            backwardSubstitutionInPlaceLevelScheduled(m_ICCPrecond, m_ICCLevels, m_ICCPrecond.invDiag, m_ICCPrecond.colValue, result);
+            break;
+
+        default:
+            for(Int c = 0; c < K; ++c) {
+                m_MixedX.resize(x.size());
+                ParallelExec::run(x.size(), [&](size_t i) { m_MixedX[i] = x[i][c]; });
+                applyPreconditioner(m_MixedX, m_MixedResult);
+                ParallelExec::run(x.size(), [&](size_t i) { result[i][c] = m_MixedResult[i]; });
+            }
+    }
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// Same recurrences as solve_precond for each column, with component-wise alpha and beta
+// Converged columns get alpha = beta = 0, thus their solution and residual are no longer modified. Columns that break down
+// (zero curvature or rho) stop iterating as well, but only count as converged if their residual is below the tolerance
+template<class Real_t>
+template<Int K>
+bool PCGSolver<Real_t>::solve_precond_multi(const SparseMatrix<Real_t>& matrix, const StdVT<VecX<K, Real_t>>& rhs, StdVT<VecX<K, Real_t>>& result) {
+    SolveStatsScope statsScope(*this);
+    using VecK = VecX<K, Real_t>;
+    const UInt nRows = matrix.nRows;
+    result.resize(nRows);
+    if(m_bZeroInitial) {
+        result.assign(result.size(), VecK(0));
+    }
+
+    m_FixedSparseMatrix.constructFromSparseMatrix(matrix);
+    auto& vectors = std::get<MultiVectors<K>>(m_MultiVectors);
+    auto& mr      = vectors.r;
+    auto& mz      = vectors.z;
+    auto& ms      = vectors.s;
+    mr = rhs;
+    mz.resize(nRows);
+    ms.resize(nRows);
+    if(!m_bZeroInitial) {
+        multiplyValues(m_FixedSparseMatrix, m_FixedSparseMatrix.colValue, result, ms);
+        ParallelExec::run(nRows, [&](UInt i) { mr[i] -= ms[i]; });
+    }
+
+    const VecK tol = m_ToleranceFactor * columnMaxAbs(rhs);
+    VecK       residual = columnMaxAbs(mr);
+    m_OutIterations = 0;
+    m_OutResidual   = glm::compMax(residual);
+    if(m_OutResidual < std::numeric_limits<Real_t>::min()) {
+        return true;
+    }
+    // a zero right hand side has zero tolerance and is converged from the start
+    auto converged    = [&](Int c) { return residual[c] < tol[c] || residual[c] < std::numeric_limits<Real_t>::min(); };
+    auto allConverged = [&]() {
+                            for(Int c = 0; c < K; ++c) {
+                                if(!converged(c)) {
+                                    return false;
+                                }
+                            }
+                            return true;
+                        };
+
+    updatePreconditioner(matrix);
+    applyPreconditioner_Multi(mr, mz);
+    VecK rho = columnDotProducts(mz, mr);
+
+    // columns still iterating: 1, converged: 0
+    VecK active;
+    auto updateActive = [&]() {
+                            for(Int c = 0; c < K; ++c) {
+                                active[c] = (!converged(c) && rho[c] >= std::numeric_limits<Real_t>::min()) ? Real_t(1) : Real_t(0);
+                            }
+                            return glm::compMax(active) > Real_t(0);
+                        };
+    if(!updateActive()) {
+        return allConverged();
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+    ms = mz;
+    for(UInt iteration = 0; iteration < m_MaxIterations; ++iteration) {
+        multiplyValues(m_FixedSparseMatrix, m_FixedSparseMatrix.colValue, ms, mz);
+        VecK tmp   = columnDotProducts(ms, mz);
+        VecK alpha = VecK(0);
+        for(Int c = 0; c < K; ++c) {
+            if(active[c] > Real_t(0) && tmp[c] >= std::numeric_limits<Real_t>::min()) {
+                alpha[c] = rho[c] / tmp[c];
+            }
+        }
+        ParallelExec::run(nRows,
+                          [&, alpha](UInt i) {
+                              result[i] += alpha * ms[i];
+                              mr[i]     -= alpha * mz[i];
+                          });
+
+        residual        = columnMaxAbs(mr);
+        m_OutIterations = iteration + 1;
+        m_OutResidual   = glm::compMax(residual);
+        for(Int c = 0; c < K; ++c) {
+            if(tmp[c] < std::numeric_limits<Real_t>::min()) {
+                active[c] = Real_t(0);
+            }
+        }
+        if(!updateActive()) {
+            return allConverged();
+        }
+
+        applyPreconditioner_Multi(mr, mz);
+        VecK rho_new = columnDotProducts(mz, mr);
+        VecK beta    = VecK(0);
+        for(Int c = 0; c < K; ++c) {
+            if(active[c] > Real_t(0)) {
+                beta[c] = rho_new[c] / rho[c];
+            }
+        }
+        ParallelExec::run(nRows, [&, beta](UInt i) { ms[i] = mz[i] + beta * ms[i]; });
+        rho = rho_new;
+    }
+    return false;
+}
+
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 NT_INSTANTIATE_CLASS_COMMON_TYPES(PCGSolver)
 NT_INSTANTIATE_STRUCT_COMMON_TYPES(SparseColumnLowerFactor)
+NT_INSTANTIATE_STRUCT_COMMON_TYPES(LowerFactorLevelSchedule)
+
+#define NT_INSTANTIATE_PCG_MULTI(Real_t, K)                                                                                \
+    template bool PCGSolver<Real_t>::solve_precond_multi<K>(const SparseMatrix<Real_t>&, const StdVT<VecX<K, Real_t>>&, \
+                                                            StdVT<VecX<K, Real_t>>&);
+NT_INSTANTIATE_PCG_MULTI(float, 2)
+NT_INSTANTIATE_PCG_MULTI(float, 3)
+NT_INSTANTIATE_PCG_MULTI(float, 4)
+NT_INSTANTIATE_PCG_MULTI(double, 2)
+NT_INSTANTIATE_PCG_MULTI(double, 3)
+NT_INSTANTIATE_PCG_MULTI(double, 4)
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 } // end namespace NTCodeBase
@@ -15,8 +15,11 @@
 #pragma once
 
 #include <LibCommon/LinearAlgebra/SparseMatrix/SparseMatrix.h>
+#include <LibCommon/LinearAlgebra/LinearSolvers/AMGSolver.h>
+#include <LibCommon/LinearAlgebra/LinearSolvers/LinearOperator.h>
 #include <LibCommon/ParallelHelpers/ParallelBLAS.h>
 #include <LibCommon/ParallelHelpers/ParallelSTL.h>
+#include <tuple>
 
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 namespace NTCodeBase {
@@ -39,6 +42,52 @@ struct SparseColumnLowerFactor {
     void resize(UInt newSize);
 };
 
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// Dependency levels (wavefronts) of a SparseColumnLowerFactor
+// Rows in the same level of the forward (backward) substitution do not depend on each other, thus can be
+// processed in parallel. The analysis depends only on the sparsity pattern, and is rebuilt only when it changes.
+template<class Real_t>
+struct LowerFactorLevelSchedule {
+    // strictly lower part of the factor in row form: for each row i, the columns k < i with L(i, k) != 0 (sorted),
+    // and the position of L(i, k) in factor.colValue
+    StdVT_UInt rowStart;
+    StdVT_UInt rowColIndex;
+    StdVT_UInt rowValueIndex;
+
+    // copy of the factor values in row form, to avoid the indirection in the forward substitution
+    StdVT<Real_t> rowValue;
+
+    // rows grouped by level, for forward substitution (L * x = b) and backward substitution (L^T * x = b)
+    StdVT_UInt forwardLevelStart;
+    StdVT_UInt forwardLevelRows;
+    StdVT_UInt backwardLevelStart;
+    StdVT_UInt backwardLevelRows;
+
+    // sparsity pattern that the schedule was built for
+    StdVT_UInt patternColStart;
+    StdVT_UInt patternColIndex;
+
+    bool matchPattern(const SparseColumnLowerFactor<Real_t>& factor) const;
+    void build(const SparseColumnLowerFactor<Real_t>& factor);
+    void updateRowValues(const SparseColumnLowerFactor<Real_t>& factor);
+    void clear();
+
+    UInt nForwardLevels() const { return forwardLevelStart.size() > 0 ? static_cast<UInt>(forwardLevelStart.size() - 1) : 0u; }
+    UInt nBackwardLevels() const { return backwardLevelStart.size() > 0 ? static_cast<UInt>(backwardLevelStart.size() - 1) : 0u; }
+};
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// Statistics of the last solve, for tuning the preconditioner reuse policy
+struct PCGSolverStats {
+    UInt   iterations       = 0;
+    UInt   factorAge        = 0;     // number of solves done with the current preconditioner, including the last one
+    UInt   factorIterations = 0;     // iterations of the first solve with the current preconditioner
+    UInt   nFactorizations  = 0;     // number of times the preconditioner was computed, since construction
+    bool   bRebuilt         = false; // the preconditioner was computed in the last solve
+    double setupTime        = 0;     // ms, computing the preconditioner (0 if reused)
+    double solveTime        = 0;     // ms, everything else
+};
+
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 template<class Real_t>
 class PCGSolver {
@@ -46,14 +95,23 @@ public:
     enum Preconditioner {
         JACOBI,
         MICCL0,
-        MICCL0_SYMMETRIC
+        MICCL0_SYMMETRIC,
+        MICCL0_LEVEL_SCHEDULED, // same factor as MICCL0, factorization and triangular solves parallelized by dependency levels
+        MICCL0_MULTICOLOR,      // MICCL0 of the matrix reordered by row colors, factorization and triangular solves parallelized by colors
+        AMG                     // one V-cycle of smoothed aggregation algebraic multigrid, see AMGSolver
     };
 
     PCGSolver() = default;
     void reserve(UInt size);
     Real_t residual() const noexcept { return m_OutResidual; }
     UInt     iterations() const noexcept { return m_OutIterations; }
+    UInt     numColors() const noexcept { return m_nColors; }
+    UInt     refinementSteps() const noexcept { return m_OutRefinementSteps; }
     Real_t     tolerance() const noexcept { return m_ToleranceFactor; }
+    const AMGSolver<Real_t>& AMGPreconditioner() const noexcept { return m_AMGPrecond; }
+    // for setting AMG parameters: a reused AMG hierarchy would ignore them, thus the preconditioner is invalidated
+    AMGSolver<Real_t>& AMGPreconditioner() noexcept { invalidatePreconditioner(); return m_AMGPrecond; }
+    const PCGSolverStats& stats() const noexcept { return m_Stats; }
 
     ////////////////////////////////////////////////////////////////////////////////
     void setPreconditioners(Preconditioner precond) { m_PreconditionerType = precond; }
@@ -61,43 +119,144 @@ public:
     void enableZeroInitial() { m_bZeroInitial = true; }
     void disableZeroInitial() { m_bZeroInitial = false; }
     void setSolverParameters(Real_t toleranceFactor, int maxIterations, Real_t MICCL0Param = Real_t(0.97), Real_t minDiagonalRatio = Real_t(0.25));
+    // modification parameter of MICCL0_MULTICOLOR: the modification that helps in natural ordering increases the
+    // iterations in multicolor ordering (98 iterations at 0, 186 at 0.97 on 64^3 Poisson), thus the default is 0 (IC(0))
+    void setMulticolorMICCL0Param(Real_t MICCL0Param);
+
+    // Preconditioner reuse across solves (e.g. time steps with slowly changing matrix): the preconditioner is recomputed
+    // only when it was used for maxAge solves, when the last solve needed more than maxIterationRatio times the iterations
+    // of the first solve with it, or when the preconditioner type, its parameters or the sparsity pattern changed.
+    // maxAge = 1 (default): recompute for every solve
+    void setPreconditionerReuse(UInt maxAge, Real_t maxIterationRatio = Real_t(1.5));
+    void invalidatePreconditioner() { m_bPreconditionerValid = false; }
     bool solve(const SparseMatrix<Real_t>& matrix, const StdVT<Real_t>& rhs, StdVT<Real_t>& result);
     bool solve_precond(const SparseMatrix<Real_t>& matrix, const StdVT<Real_t>& rhs, StdVT<Real_t>& result);
 
+    // Matrix-free solves: solve() is unpreconditioned, solve_precond() uses Jacobi preconditioning if the operator
+    // provides its diagonal (the preconditioner type and reuse policy apply only to assembled matrices)
+    bool solve(const LinearOperator<Real_t>& op, const StdVT<Real_t>& rhs, StdVT<Real_t>& result);
+    bool solve_precond(const LinearOperator<Real_t>& op, const StdVT<Real_t>& rhs, StdVT<Real_t>& result);
+
+    // Chronopoulos-Gear PCG: mathematically equivalent to solve_precond, but all inner products of an iteration are
+    // computed in a single reduction, fused with the matrix-vector product, and the vector updates in a single sweep
+    bool solve_precond_single_reduction(const SparseMatrix<Real_t>& matrix, const StdVT<Real_t>& rhs, StdVT<Real_t>& result);
+
+    // Mixed precision PCG, for PCGSolver<double>: the preconditioner is factorized in Real_t but stored and applied in float.
+    // bFloatMatrix = false: the iterations run in Real_t, only the preconditioner is float
+    // bFloatMatrix = true:  the iterations run entirely in float on a float copy of the matrix values, until the residual
+    //                       drops by innerToleranceFactor; the solution and the true residual are then updated in Real_t
+    //                       (iterative refinement), and the inner iterations restarted
+    // In both cases, inner iterations that stall (no new minimum residual for maxStallIterations) are restarted from the
+    // true residual. The total number of inner iterations is bounded by maxIterations of setSolverParameters.
+    void setMixedPrecisionParameters(bool bFloatMatrix, Real_t innerToleranceFactor = Real_t(1e-3), UInt maxStallIterations = 20u);
+    bool solve_precond_mixed(const SparseMatrix<Real_t>& matrix, const StdVT<Real_t>& rhs, StdVT<Real_t>& result);
+
+    // Solve for K right hand sides at once, stored interleaved (rhs[i][c] is row i of the c-th right hand side).
+    // The K systems run independent PCG recurrences but share each matrix-vector product and preconditioner sweep,
+    // thus the matrix and the factor are streamed once per iteration for all of them.
+    // Iterations and residual are the maximum over the right hand sides. Returns true only if all of them converged,
+    // a column that breaks down above the tolerance makes the solve fail. Instantiated for K = 2, 3, 4
+    template<Int K>
+    bool solve_precond_multi(const SparseMatrix<Real_t>& matrix, const StdVT<VecX<K, Real_t>>& rhs, StdVT<VecX<K, Real_t>>& result);
+
 private:
     void resize(UInt size);
+    bool subtractInitialGuess(const StdVT<Real_t>& result, Real_t tol);
+    struct SolveStatsScope;
+    bool updatePreconditioner(const SparseMatrix<Real_t>& matrix);
+    void finishSolve(double totalTime, bool bPreconditioned);
     void formPreconditioner(const SparseMatrix<Real_t>& matrix);
     void applyPreconditioner(const StdVT<Real_t>& x, StdVT<Real_t>& result);
     void applyJacobiPreconditioner(const StdVT<Real_t>& x, StdVT<Real_t>& result);
 
     void solveLower(const StdVT<Real_t>& rhs, StdVT<Real_t>& result);
     void solveLower_TransposeInPlace(StdVT<Real_t>& x);
+    void solveLower_LevelScheduled(const StdVT<Real_t>& rhs, StdVT<Real_t>& result);
+    void solveLower_TransposeInPlace_LevelScheduled(StdVT<Real_t>& x);
 
     void formPreconditioner_Jacobi(const SparseMatrix<Real_t>& matrix);
     void formPreconditioner_MICC0L0(const SparseMatrix<Real_t>& matrix, Real_t MICCL0Param = Real_t(0.97), Real_t minDiagonalRatio = Real_t(0.25));
     void formPreconditioner_Symmetric_MICC0L0(const SparseMatrix<Real_t>& matrix, Real_t minDiagonalRatio = Real_t(0.25));
+    void formPreconditioner_MICC0L0_LevelScheduled(const SparseMatrix<Real_t>& matrix, Real_t MICCL0Param = Real_t(0.97), Real_t minDiagonalRatio = Real_t(0.25));
+    void formPreconditioner_MICC0L0_Multicolor(const SparseMatrix<Real_t>& matrix, Real_t MICCL0Param = Real_t(0), Real_t minDiagonalRatio = Real_t(0.25));
+    void applyMulticolorPreconditioner(const StdVT<Real_t>& x, StdVT<Real_t>& result);
+    template<class Inner_t>
+    struct MixedPrecisionVectors {
+        StdVT<Inner_t> r, z, s, d;
+    };
+    void formPreconditioner_Float();
+    void applyPreconditioner_Float(const StdVT<float>& x, StdVT<float>& result);
+    template<class Inner_t> void applyMixedPreconditioner(const StdVT<Inner_t>& x, StdVT<Inner_t>& result);
+    template<class Inner_t> bool solveInner(const StdVT<Inner_t>& matrixValues, MixedPrecisionVectors<Inner_t>& v, Real_t tol);
+    template<Int K> void applyPreconditioner_Multi(const StdVT<VecX<K, Real_t>>& x, StdVT<VecX<K, Real_t>>& result);
+    bool solveOperator(const LinearOperator<Real_t>& op, const StdVT<Real_t>& rhs, StdVT<Real_t>& result, bool bJacobi);
+    void multiplyAndReduce(const StdVT<Real_t>& x, StdVT<Real_t>& result, Real_t& rDotX, Real_t& resultDotX, Real_t& rMaxAbs) const;
 
     ////////////////////////////////////////////////////////////////////////////////
     // solver variables
     StdVT<Real_t>             z, s, r;
+    StdVT<Real_t>             p, w; // additional vectors of the single reduction variant
     FixedSparseMatrix<Real_t> m_FixedSparseMatrix;
 
-    SparseColumnLowerFactor<Real_t> m_ICCPrecond;
-    StdVT<Real_t>                   m_JacobiPrecond;
+    SparseColumnLowerFactor<Real_t>  m_ICCPrecond;
+    LowerFactorLevelSchedule<Real_t> m_ICCLevels;
+    StdVT<Real_t>                    m_JacobiPrecond;
+    StdVT<Real_t>                    m_OperatorJacobiPrecond; // from the diagonal of a LinearOperator
+
+    // multicolor ordering: rows sorted by color, the factor is computed for the reordered matrix
+    StdVT_UInt           m_ColorPermutation;     // new index -> original row
+    StdVT_UInt           m_ColorInvPermutation;  // original row -> new index
+    StdVT_UInt           m_ColorPatternRowStart; // sparsity pattern that the coloring was computed for
+    StdVT_UInt           m_ColorPatternColIndex;
+    SparseMatrix<Real_t> m_ColorPermutedMatrix;
+    StdVT<Real_t>        m_ColorPermutedX, m_ColorPermutedResult;
+    UInt                 m_nColors = 0;
+
+    AMGSolver<Real_t> m_AMGPrecond;
+
+    // preconditioner reuse
+    StdVT_UInt     m_PreconditionerRowStart; // sparsity pattern that the preconditioner was computed for
+    StdVT_UInt     m_PreconditionerColIndex;
+    Preconditioner m_FactorPreconditionerType        = Preconditioner::MICCL0;
+    bool           m_bPreconditionerValid            = false;
+    bool           m_bFloatPreconditionerValid       = false;
+    UInt           m_MaxPreconditionerAge            = 1u;
+    Real_t         m_MaxPreconditionerIterationRatio = Real_t(1.5);
+
+    // mixed precision: float copies of the preconditioner (sparsity pattern is shared with the Real_t version) and matrix values
+    StdVT<float>                  m_FloatInvDiag, m_FloatColValue, m_FloatRowValue, m_FloatJacobi, m_FloatMatrixValue;
+    StdVT<float>                  m_FloatX, m_FloatResult;
+    StdVT<Real_t>                 m_MixedX, m_MixedResult;
+    MixedPrecisionVectors<float>  m_FloatVectors;
+    MixedPrecisionVectors<Real_t> m_MixedVectors;
+
+    // multiple right hand sides: interleaved r, z, s for each instantiated K
+    template<Int K>
+    struct MultiVectors {
+        StdVT<VecX<K, Real_t>> r, z, s;
+    };
+    std::tuple<MultiVectors<2>, MultiVectors<3>, MultiVectors<4>> m_MultiVectors;
 
     ////////////////////////////////////////////////////////////////////////////////
     // solver parameters
-    Preconditioner m_PreconditionerType = Preconditioner::MICCL0;
-    Real_t         m_ToleranceFactor    = Real_t(1e-20);
-    UInt           m_MaxIterations      = 10000;
-    Real_t         m_MICCL0Param        = Real_t(0.97);
-    Real_t         m_MinDiagonalRatio   = Real_t(0.25);
-    bool           m_bZeroInitial       = true;
+    Preconditioner m_PreconditionerType    = Preconditioner::MICCL0;
+    Real_t         m_ToleranceFactor       = Real_t(1e-20);
+    UInt           m_MaxIterations         = 10000;
+    Real_t         m_MICCL0Param           = Real_t(0.97);
+    Real_t         m_MulticolorMICCL0Param = Real_t(0);
+    Real_t         m_MinDiagonalRatio      = Real_t(0.25);
+    bool           m_bZeroInitial          = true;
+    bool           m_bFloatMatrix          = false;
+    Real_t         m_InnerTolerance        = Real_t(1e-3);
+    UInt           m_MaxStallIterations    = 20u;
 
     ////////////////////////////////////////////////////////////////////////////////
     // output
-    Real_t m_OutResidual   = 0;
-    UInt   m_OutIterations = 0;
+    Real_t m_OutResidual        = 0;
+    UInt   m_OutIterations      = 0;
+    UInt   m_OutRefinementSteps = 0;
+
+    PCGSolverStats m_Stats;
 };
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 } // end namespace NTCodeBase
@@ -15,6 +15,8 @@
 #include <fstream>
 #include <LibCommon/Utils/Formatters.h>
 #include <LibCommon/LinearAlgebra/SparseMatrix/BlockSparseMatrix.h>
+#include <LibCommon/Math/SIMDPack.h>
+#include <LibCommon/ParallelHelpers/ParallelSTL.h>
 
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 namespace NTCodeBase {
@@ -321,10 +323,9 @@ bool BlockSparseMatrix<MatrixType>::loadFromBinaryFile(const char* fileName) {
 template<class MatrixType>
 void FixedBlockSparseMatrix<MatrixType>::constructFromSparseMatrix(const BlockSparseMatrix<MatrixType>& matrix) {
     resize(matrix.size());
-    m_RowStart[0] = 0;
-    for(UInt i = 0; i < m_Size; ++i) {
-        m_RowStart[i + 1] = m_RowStart[i] + static_cast<UInt>(matrix.getIndices(i).size());
-    }
+    ParallelExec::run(m_Size, [&](UInt i) { m_RowStart[i] = static_cast<UInt>(matrix.getIndices(i).size()); });
+    m_RowStart[m_Size] = 0;
+    ParallelSTL::exclusive_scan(m_RowStart);
 
     m_ColValue.resize(m_RowStart[m_Size]);
     m_ColIndex.resize(m_RowStart[m_Size]);
@@ -338,8 +339,71 @@ void FixedBlockSparseMatrix<MatrixType>::constructFromSparseMatrix(const BlockSp
 
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 // perform result=matrix*x
+// 3x3 blocks: result_i = sum_j column0_j * x_j[0] + column1_j * x_j[1] + column2_j * x_j[2]
+// The columns of a block are contiguous (9 values), each one is loaded into 4 lanes: the 4th lane reads the next
+// column (garbage that only pollutes the discarded 4th lane of the sum), the last column uses a masked load to not
+// read past the end of the values.
+// float: two consecutive blocks of a row in the two halves of 8-lane registers, summed at the end
 template<class MatrixType>
 void FixedBlockSparseMatrix<MatrixType>::multiply(const FixedBlockSparseMatrix<MatrixType>& matrix, const StdVT<VectorType>& x, StdVT<VectorType>& result) {
+#if defined(__AVX2__)
+    if constexpr(MatrixType::length() == 3) {
+        assert(matrix.size() == static_cast<UInt>(x.size()));
+        result.resize(matrix.size());
+        ParallelExec::run(matrix.size(),
+                          [&](UInt i) {
+                              const UInt    begin = matrix.m_RowStart[i];
+                              const UInt    end   = matrix.m_RowStart[i + 1];
+                              const UInt*   idx   = matrix.m_ColIndex.data();
+                              const Real_t* val   = reinterpret_cast<const Real_t*>(matrix.m_ColValue.data());
+                              alignas(32) Real_t sum[4];
+                              if constexpr(std::is_same_v<Real_t, float>) {
+                                  const __m128i mask = _mm_set_epi32(0, -1, -1, -1);
+                                  __m256        acc  = _mm256_setzero_ps();
+                                  UInt          j    = begin;
+                                  for(; j + 1 < end; j += 2) {
+                                      const float* xa = glm::value_ptr(x[idx[j]]);
+                                      const float* xb = glm::value_ptr(x[idx[j + 1]]);
+                                      const float* va = val + j * 9;
+                                      const __m256 c0 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(va)),     _mm_loadu_ps(va + 9),  1);
+                                      const __m256 c1 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(va + 3)), _mm_loadu_ps(va + 12), 1);
+                                      const __m256 c2 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(va + 6)), _mm_maskload_ps(va + 15, mask), 1);
+                                      acc = SIMD::fmadd(c0, _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_set1_ps(xa[0])), _mm_set1_ps(xb[0]), 1), acc);
+                                      acc = SIMD::fmadd(c1, _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_set1_ps(xa[1])), _mm_set1_ps(xb[1]), 1), acc);
+                                      acc = SIMD::fmadd(c2, _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_set1_ps(xa[2])), _mm_set1_ps(xb[2]), 1), acc);
+                                  }
+                                  __m128 acc4 = _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+                                  if(j < end) {
+                                      const float* xa = glm::value_ptr(x[idx[j]]);
+                                      const float* va = val + j * 9;
+                                      acc4 = SIMD::fmadd(_mm_loadu_ps(va),              _mm_set1_ps(xa[0]), acc4);
+                                      acc4 = SIMD::fmadd(_mm_loadu_ps(va + 3),          _mm_set1_ps(xa[1]), acc4);
+                                      acc4 = SIMD::fmadd(_mm_maskload_ps(va + 6, mask), _mm_set1_ps(xa[2]), acc4);
+                                  }
+                                  _mm_store_ps(sum, acc4);
+                              } else {
+                                  const __m256i mask = _mm256_set_epi64x(0, -1, -1, -1);
+                                  __m256d       acc  = _mm256_setzero_pd();
+                                  for(UInt j = begin; j < end; ++j) {
+                                      const double* xa = glm::value_ptr(x[idx[j]]);
+                                      const double* va = val + j * 9;
+                                      acc = SIMD::fmadd(_mm256_loadu_pd(va),              _mm256_broadcast_sd(xa),     acc);
+                                      acc = SIMD::fmadd(_mm256_loadu_pd(va + 3),          _mm256_broadcast_sd(xa + 1), acc);
+                                      acc = SIMD::fmadd(_mm256_maskload_pd(va + 6, mask), _mm256_broadcast_sd(xa + 2), acc);
+                                  }
+                                  _mm256_store_pd(sum, acc);
+                              }
+                              result[i] = VectorType(sum[0], sum[1], sum[2]);
+                          });
+        return;
+    }
+#endif
+    multiply_glm(matrix, x, result);
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<class MatrixType>
+void FixedBlockSparseMatrix<MatrixType>::multiply_glm(const FixedBlockSparseMatrix<MatrixType>& matrix, const StdVT<VectorType>& x, StdVT<VectorType>& result) {
     assert(matrix.size() == static_cast<UInt>(x.size()));
     result.resize(matrix.size());
     ParallelExec::run(matrix.size(),
@@ -371,6 +435,16 @@ __BNN_INSTANTIATE_BLOCK_SPARSE_MATRIX_FUNCS(Mat3x3f, UInt)
 __BNN_INSTANTIATE_BLOCK_SPARSE_MATRIX_FUNCS(Mat3x3f, Int64)
 __BNN_INSTANTIATE_BLOCK_SPARSE_MATRIX_FUNCS(Mat3x3f, UInt64)
 
+__BNN_INSTANTIATE_BLOCK_SPARSE_MATRIX_FUNCS(Mat2x2d, Int)
+__BNN_INSTANTIATE_BLOCK_SPARSE_MATRIX_FUNCS(Mat2x2d, UInt)
+__BNN_INSTANTIATE_BLOCK_SPARSE_MATRIX_FUNCS(Mat2x2d, Int64)
+__BNN_INSTANTIATE_BLOCK_SPARSE_MATRIX_FUNCS(Mat2x2d, UInt64)
+
+__BNN_INSTANTIATE_BLOCK_SPARSE_MATRIX_FUNCS(Mat3x3d, Int)
+__BNN_INSTANTIATE_BLOCK_SPARSE_MATRIX_FUNCS(Mat3x3d, UInt)
+__BNN_INSTANTIATE_BLOCK_SPARSE_MATRIX_FUNCS(Mat3x3d, Int64)
+__BNN_INSTANTIATE_BLOCK_SPARSE_MATRIX_FUNCS(Mat3x3d, UInt64)
+
 template class BlockSparseMatrix<Mat2x2f>;
 template class BlockSparseMatrix<Mat3x3f>;
 template class FixedBlockSparseMatrix<Mat2x2f>;
@@ -0,0 +1,153 @@
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//
+//    .--------------------------------------------------.
+//    |  This file is part of NTCodeBase                 |
+//    |  Created 2018 by NT (https://ttnghia.github.io)  |
+//    '--------------------------------------------------'
+//                            \o/
+//                             |
+//                            / |
+//
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+
+#include <LibCommon/LinearAlgebra/SparseMatrix/SlicedELLMatrix.h>
+#include <LibCommon/Math/SIMDPack.h>
+#include <LibCommon/ParallelHelpers/ParallelSTL.h>
+
+#include <numeric>
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+namespace NTCodeBase {
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<class Real_t>
+void SlicedELLMatrix<Real_t>::constructFromFixedSparseMatrix(const FixedSparseMatrix<Real_t>& matrix, UInt sigma /*= 1u*/) {
+    constexpr UInt C = SliceSize;
+    nRows   = matrix.nRows;
+    nSlices = (nRows + C - 1) / C;
+
+    auto rowLength = [&](UInt row) { return row < nRows ? matrix.rowStart[row + 1] - matrix.rowStart[row] : 0u; };
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // sort rows by decreasing length within each window of sigma rows
+    permutation.resize(nSlices * C);
+    std::iota(permutation.begin(), permutation.end(), 0u);
+    if(sigma > 1u) {
+        const UInt nWindows = (nRows + sigma - 1) / sigma;
+        ParallelExec::run(nWindows,
+                          [&](UInt window) {
+                              auto begin = permutation.begin() + window * sigma;
+                              auto end   = permutation.begin() + std::min((window + 1u) * sigma, nRows);
+                              std::stable_sort(begin, end, [&](UInt a, UInt b) { return rowLength(a) > rowLength(b); });
+                          });
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // slice widths and offsets
+    sliceStart.assign(nSlices + 1, 0u);
+    ParallelExec::run(nSlices,
+                      [&](UInt s) {
+                          UInt width = 0;
+                          for(UInt lane = 0; lane < C; ++lane) {
+                              width = std::max(width, rowLength(permutation[s * C + lane]));
+                          }
+                          sliceStart[s] = width * C;
+                      });
+    const auto storageSize = ParallelSTL::exclusive_scan(sliceStart);
+    colIndex.resize(storageSize);
+    colValue.resize(storageSize);
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // fill slices column-major, padding with zero values pointing to the last valid column of the row
+    ParallelExec::run(nSlices,
+                      [&](UInt s) {
+                          const UInt width = (sliceStart[s + 1] - sliceStart[s]) / C;
+                          for(UInt lane = 0; lane < C; ++lane) {
+                              const UInt row    = permutation[s * C + lane];
+                              const UInt length = rowLength(row);
+                              UInt       col    = 0;
+                              for(UInt k = 0; k < width; ++k) {
+                                  const UInt idx = sliceStart[s] + k * C + lane;
+                                  if(k < length) {
+                                      col           = matrix.colIndex[matrix.rowStart[row] + k];
+                                      colIndex[idx] = col;
+                                      colValue[idx] = matrix.colValue[matrix.rowStart[row] + k];
+                                  } else {
+                                      colIndex[idx] = col;
+                                      colValue[idx] = Real_t(0);
+                                  }
+                              }
+                          }
+                      });
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// perform result=matrix*x, one slice of SliceSize rows per SIMD iteration
+template<class Real_t>
+void SlicedELLMatrix<Real_t>::multiply(const SlicedELLMatrix<Real_t>& matrix, const StdVT<Real_t>& x, StdVT<Real_t>& result) {
+    constexpr UInt C = SliceSize;
+    assert(matrix.nRows == static_cast<UInt>(x.size()));
+    result.resize(matrix.nRows);
+    ParallelExec::run(matrix.nSlices,
+                      [&](UInt s) {
+                          const UInt    begin = matrix.sliceStart[s];
+                          const UInt    end   = matrix.sliceStart[s + 1];
+                          const UInt*   idx   = matrix.colIndex.data();
+                          const Real_t* val   = matrix.colValue.data();
+                          alignas(32) Real_t sum[C];
+#if defined(__AVX2__)
+                          if constexpr(std::is_same_v<Real_t, float>) {
+                              __m256 acc = _mm256_setzero_ps();
+                              for(UInt k = begin; k < end; k += C) {
+                                  const __m256i colIdx = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(idx + k));
+                                  const __m256  xv     = _mm256_i32gather_ps(x.data(), colIdx, 4);
+                                  acc = SIMD::fmadd(_mm256_loadu_ps(val + k), xv, acc);
+                              }
+                              _mm256_store_ps(sum, acc);
+                          } else {
+#  if defined(__AVX512F__)
+                              __m512d acc = _mm512_setzero_pd();
+                              for(UInt k = begin; k < end; k += C) {
+                                  const __m256i colIdx = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(idx + k));
+                                  const __m512d xv     = _mm512_i32gather_pd(colIdx, x.data(), 8);
+                                  acc = _mm512_fmadd_pd(_mm512_loadu_pd(val + k), xv, acc);
+                              }
+                              _mm256_store_pd(sum,     _mm512_castpd512_pd256(acc));
+                              _mm256_store_pd(sum + 4, _mm512_extractf64x4_pd(acc, 1));
+#  else
+                              __m256d accLo = _mm256_setzero_pd();
+                              __m256d accHi = _mm256_setzero_pd();
+                              for(UInt k = begin; k < end; k += C) {
+                                  const __m128i colIdxLo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(idx + k));
+                                  const __m128i colIdxHi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(idx + k + 4));
+                                  accLo = SIMD::fmadd(_mm256_loadu_pd(val + k),     _mm256_i32gather_pd(x.data(), colIdxLo, 8), accLo);
+                                  accHi = SIMD::fmadd(_mm256_loadu_pd(val + k + 4), _mm256_i32gather_pd(x.data(), colIdxHi, 8), accHi);
+                              }
+                              _mm256_store_pd(sum,     accLo);
+                              _mm256_store_pd(sum + 4, accHi);
+#  endif
+                          }
+#else
+                          for(UInt lane = 0; lane < C; ++lane) {
+                              sum[lane] = Real_t(0);
+                          }
+                          for(UInt k = begin; k < end; k += C) {
+                              for(UInt lane = 0; lane < C; ++lane) {
+                                  sum[lane] += val[k + lane] * x[idx[k + lane]];
+                              }
+                          }
+#endif
+                          for(UInt lane = 0; lane < C; ++lane) {
+                              const UInt p = s * C + lane;
+                              if(p < matrix.nRows) {
+                                  result[matrix.permutation[p]] = sum[lane];
+                              }
+                          }
+                      });
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+NT_INSTANTIATE_STRUCT_COMMON_TYPES(SlicedELLMatrix)
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+} // end namespace NTCodeBase
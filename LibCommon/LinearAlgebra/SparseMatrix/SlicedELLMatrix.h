@@ -0,0 +1,67 @@
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//
+//    .--------------------------------------------------.
+//    |  This file is part of NTCodeBase                 |
+//    |  Created 2018 by NT (https://ttnghia.github.io)  |
+//    '--------------------------------------------------'
+//                            \o/
+//                             |
+//                            / |
+//
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+
+#pragma once
+
+#include <LibCommon/CommonSetup.h>
+#include <LibCommon/LinearAlgebra/SparseMatrix/SparseMatrix.h>
+#include <LibCommon/Math/SIMDPack.h>
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+namespace NTCodeBase {
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// Sliced ELLPACK matrix (SELL-C-sigma, Kreutzer et al. 2014)
+// Rows are grouped into slices of C = SliceSize rows, each slice is stored column-major and padded to its
+// longest row, so the SpMV processes C rows at once with SIMD loads and gathers.
+// Before slicing, rows are sorted by decreasing length within windows of sigma rows to reduce padding
+// (sigma = 1: no sorting, plain sliced ELLPACK). The row permutation is applied inside multiply, thus
+// x and result are in the original row order.
+// Matrices in which all rows have similar lengths (7-27 nonzeros, as in Poisson or elasticity systems)
+// have almost no padding.
+template<class Real_t>
+struct SlicedELLMatrix {
+    static constexpr UInt SliceSize = 8u;
+    // multiply() uses AVX2 gathers when compiled with AVX2, otherwise a scalar loop over the lanes
+    static constexpr bool bVectorized = SIMD::bAVX2;
+
+    UInt nRows   = 0;
+    UInt nSlices = 0;
+
+    // original row index of each stored row, padded to nSlices * SliceSize
+    StdVT_UInt permutation;
+
+    // where each slice starts in colIndex/colValue (last entry is the total storage size)
+    StdVT_UInt sliceStart;
+
+    // column-major within each slice: element k of the lane-th row in slice s is at sliceStart[s] + k * SliceSize + lane
+    // padded elements have zero value and a valid column index
+    StdVT_UInt    colIndex;
+    StdVT<Real_t> colValue;
+
+    ////////////////////////////////////////////////////////////////////////////////
+    void constructFromFixedSparseMatrix(const FixedSparseMatrix<Real_t>& matrix, UInt sigma = 1u);
+    void clear() { nRows = 0; nSlices = 0; permutation.resize(0); sliceStart.resize(0); colIndex.resize(0); colValue.resize(0); }
+
+    // ratio of stored elements (including padding) over nonzeros
+    Real_t paddingRatio(const FixedSparseMatrix<Real_t>& matrix) const {
+        return static_cast<Real_t>(sliceStart.back()) / static_cast<Real_t>(std::max(1u, matrix.rowStart[matrix.nRows]));
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+    static void multiply(const SlicedELLMatrix<Real_t>& matrix, const StdVT<Real_t>& x, StdVT<Real_t>& result);
+};
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+} // end namespace NTCodeBase
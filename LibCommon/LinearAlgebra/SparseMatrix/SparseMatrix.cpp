@@ -14,6 +14,11 @@
 
 #include <LibCommon/LinearAlgebra/SparseMatrix/SparseMatrix.h>
 #include <LibCommon/Utils/Formatters.h>
+#include <LibCommon/ParallelHelpers/ParallelSTL.h>
+#include <LibCommon/ParallelHelpers/AtomicOperations.h>
+
+#include <array>
+#include <tuple>
 
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 namespace NTCodeBase {
@@ -109,6 +114,34 @@ bool SparseMatrix<Real_t>::hasElement(IndexType i, IndexType j, UInt& k) const {
     return STLHelpers::Sorted::contain(colIndex[i], static_cast<UInt>(j), k);
 }
 
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<class Real_t>
+UInt SparseMatrix<Real_t>::computeRowColors(StdVT_UInt& rowColors) const {
+    constexpr UInt NoColor = std::numeric_limits<UInt>::max();
+    rowColors.assign(nRows, NoColor);
+
+    // forbiddenStamp[c] == i means color c is used by a neighbor of row i
+    StdVT_UInt forbiddenStamp;
+    UInt       nColors = 0;
+    for(UInt i = 0; i < nRows; ++i) {
+        for(auto j : colIndex[i]) {
+            if(j != i && rowColors[j] != NoColor) {
+                forbiddenStamp[rowColors[j]] = i;
+            }
+        }
+        UInt color = 0;
+        while(color < nColors && forbiddenStamp[color] == i) {
+            ++color;
+        }
+        if(color == nColors) {
+            ++nColors;
+            forbiddenStamp.push_back(NoColor);
+        }
+        rowColors[i] = color;
+    }
+    return nColors;
+}
+
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 template<class Real_t>
 void SparseMatrix<Real_t>::printDebug(UInt maxRows /*= 0*/) const noexcept{
@@ -227,6 +260,315 @@ void FixedSparseMatrix<Real_t>::multiply(const FixedSparseMatrix<Real_t>& matrix
                       });
 }
 
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// Parallel triplet assembly
+//
+template<class Real_t>
+void SparseMatrixBuilder<Real_t>::clear() {
+    for(auto& triplets : m_Triplets) {
+        triplets.rows.resize(0);
+        triplets.cols.resize(0);
+        triplets.values.resize(0);
+    }
+}
+
+template<class Real_t>
+UInt64 SparseMatrixBuilder<Real_t>::nTriplets() const {
+    UInt64 count = 0;
+    for(const auto& triplets : m_Triplets) {
+        count += static_cast<UInt64>(triplets.rows.size());
+    }
+    return count;
+}
+
+template<class Real_t>
+StdVT<const typename SparseMatrixBuilder<Real_t>::Triplets*> SparseMatrixBuilder<Real_t>::getTripletBuffers() const {
+    StdVT<const Triplets*> buffers;
+    for(const auto& triplets : m_Triplets) {
+        if(triplets.rows.size() > 0) {
+            buffers.push_back(&triplets);
+        }
+    }
+    return buffers;
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<class Real_t>
+void SparseMatrixBuilder<Real_t>::sortTriplets(const StdVT<const Triplets*>& buffers,
+                                               StdVT_UInt& rowOffset, StdVT_UInt& rowSize, StdVT_UInt& cols, StdVT<Real_t>& values) const {
+    UInt nTotal = 0;
+    for(auto buffer : buffers) {
+        nTotal += static_cast<UInt>(buffer->rows.size());
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // counting sort by row: row sizes, prefix sum, then scatter into row buckets
+    // the index of each triplet is moved along, for the slot map
+    rowOffset.assign(m_nRows + 1, 0u);
+    for(auto buffer : buffers) {
+        ParallelExec::run(buffer->rows.size(),
+                          [&](size_t k) {
+                              AtomicOps::fetchAdd(rowOffset[buffer->rows[k]], 1u);
+                          });
+    }
+    ParallelSTL::exclusive_scan(rowOffset);
+
+    StdVT_UInt rowCursor(rowOffset.begin(), rowOffset.end() - 1);
+    UInt       offset = 0;
+    cols.resize(nTotal);
+    values.resize(nTotal);
+    m_SlotTriplets.resize(nTotal);
+    for(auto buffer : buffers) {
+        ParallelExec::run(buffer->rows.size(),
+                          [&](size_t k) {
+                              const auto pos = AtomicOps::fetchAdd(rowCursor[buffer->rows[k]], 1u);
+                              cols[pos]           = buffer->cols[k];
+                              values[pos]         = buffer->values[k];
+                              m_SlotTriplets[pos] = offset + static_cast<UInt>(k);
+                          });
+        offset += static_cast<UInt>(buffer->rows.size());
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // sort each row by column and sum duplicates in place
+    // the order of the triplets within a bucket depends on thread scheduling, so duplicates are also
+    // sorted by value: their sum is then computed in the same order in every run
+    // m_SlotTriplets keeps the sorted order of all triplets, m_TripletSlot gets the index of the entry of each triplet in its row
+    const auto less = [](UInt colA, Real_t valueA, UInt colB, Real_t valueB) {
+                          return colA < colB || (colA == colB && valueA < valueB);
+                      };
+    rowSize.assign(m_nRows + 1, 0u);
+    m_TripletSlot.resize(nTotal);
+    ParallelExec::run(m_nRows,
+                      [&](UInt i) {
+                          const UInt begin = rowOffset[i];
+                          const UInt end   = rowOffset[i + 1];
+                          if(end - begin > 64u) {
+                              StdVT<std::tuple<UInt, Real_t, UInt>> entries(end - begin);
+                              for(UInt k = begin; k < end; ++k) {
+                                  entries[k - begin] = std::make_tuple(cols[k], values[k], m_SlotTriplets[k]);
+                              }
+                              std::sort(entries.begin(), entries.end(),
+                                        [&](const auto& a, const auto& b) {
+                                            return less(std::get<0>(a), std::get<1>(a), std::get<0>(b), std::get<1>(b));
+                                        });
+                              for(UInt k = begin; k < end; ++k) {
+                                  std::tie(cols[k], values[k], m_SlotTriplets[k]) = entries[k - begin];
+                              }
+                          }
+                          // rows are usually short: insertion sort on the three arrays
+                          for(UInt k = begin + 1; k < end; ++k) {
+                              const auto col     = cols[k];
+                              const auto value   = values[k];
+                              const auto triplet = m_SlotTriplets[k];
+                              UInt       l       = k;
+                              for(; l > begin && less(col, value, cols[l - 1], values[l - 1]); --l) {
+                                  cols[l]           = cols[l - 1];
+                                  values[l]         = values[l - 1];
+                                  m_SlotTriplets[l] = m_SlotTriplets[l - 1];
+                              }
+                              cols[l]           = col;
+                              values[l]         = value;
+                              m_SlotTriplets[l] = triplet;
+                          }
+                          UInt nUnique = 0;
+                          for(UInt k = begin; k < end; ++k) {
+                              if(nUnique > 0 && cols[begin + nUnique - 1] == cols[k]) {
+                                  values[begin + nUnique - 1] += values[k];
+                              } else {
+                                  cols[begin + nUnique]   = cols[k];
+                                  values[begin + nUnique] = values[k];
+                                  ++nUnique;
+                              }
+                              m_TripletSlot[m_SlotTriplets[k]] = nUnique - 1;
+                          }
+                          rowSize[i] = nUnique;
+                      });
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<class Real_t>
+void SparseMatrixBuilder<Real_t>::construct(FixedSparseMatrix<Real_t>& matrix) const {
+    const auto    buffers = getTripletBuffers();
+    StdVT_UInt    rowOffset;
+    StdVT_UInt    rowSize;
+    StdVT_UInt    bucketCols;
+    StdVT<Real_t> bucketValues;
+    sortTriplets(buffers, rowOffset, rowSize, bucketCols, bucketValues);
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // emit CSR
+    matrix.nRows    = m_nRows;
+    matrix.rowStart = std::move(rowSize);
+    const auto nnz = ParallelSTL::exclusive_scan(matrix.rowStart);
+    // keep one extra element for padding, as in constructFromSparseMatrix
+    matrix.colIndex.resize(nnz + 1);
+    matrix.colValue.resize(nnz + 1);
+    ParallelExec::run(m_nRows,
+                      [&](UInt i) {
+                          const UInt n = matrix.rowStart[i + 1] - matrix.rowStart[i];
+                          memcpy(&matrix.colIndex[matrix.rowStart[i]], &bucketCols[rowOffset[i]], n * sizeof(UInt));
+                          memcpy(&matrix.colValue[matrix.rowStart[i]], &bucketValues[rowOffset[i]], n * sizeof(Real_t));
+                      });
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // slot map: the sorted triplets are grouped by slot, offset the entry indices of the triplets by the start of their rows
+    m_BufferSizes.resize(buffers.size());
+    for(size_t b = 0; b < buffers.size(); ++b) {
+        m_BufferSizes[b] = static_cast<UInt>(buffers[b]->rows.size());
+    }
+    m_SlotStart.resize(static_cast<size_t>(nnz) + 1u);
+    m_SlotStart[nnz] = rowOffset[m_nRows];
+    ParallelExec::run(m_nRows,
+                      [&](UInt i) {
+                          for(UInt k = rowOffset[i]; k < rowOffset[i + 1]; ++k) {
+                              const UInt slot = (m_TripletSlot[m_SlotTriplets[k]] += matrix.rowStart[i]);
+                              if(k == rowOffset[i] || slot != m_TripletSlot[m_SlotTriplets[k - 1]]) {
+                                  m_SlotStart[slot] = k;
+                              }
+                          }
+                      });
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<class Real_t>
+bool SparseMatrixBuilder<Real_t>::checkSlotMap(const StdVT<const Triplets*>& buffers, const FixedSparseMatrix<Real_t>& matrix) const {
+    if(m_BufferSizes.size() != buffers.size() || m_SlotStart.size() != static_cast<size_t>(matrix.rowStart[m_nRows]) + 1u) {
+        return false;
+    }
+    for(size_t b = 0; b < buffers.size(); ++b) {
+        if(m_BufferSizes[b] != static_cast<UInt>(buffers[b]->rows.size())) {
+            return false;
+        }
+    }
+    // each triplet must still be mapped to a slot of its row and column
+    std::atomic<bool> bValid { true };
+    UInt              offset = 0;
+    for(auto buffer : buffers) {
+        ParallelExec::run(buffer->rows.size(),
+                          [&](size_t k) {
+                              const UInt slot = m_TripletSlot[offset + k];
+                              const UInt row  = buffer->rows[k];
+                              if(slot < matrix.rowStart[row] || slot >= matrix.rowStart[row + 1] || matrix.colIndex[slot] != buffer->cols[k]) {
+                                  bValid = false;
+                              }
+                          });
+        offset += static_cast<UInt>(buffer->rows.size());
+    }
+    return bValid;
+}
+
+template<class Real_t>
+bool SparseMatrixBuilder<Real_t>::buildSlotMap(const StdVT<const Triplets*>& buffers, const FixedSparseMatrix<Real_t>& matrix) const {
+    UInt nTotal = 0;
+    m_BufferSizes.resize(buffers.size());
+    for(size_t b = 0; b < buffers.size(); ++b) {
+        m_BufferSizes[b] = static_cast<UInt>(buffers[b]->rows.size());
+        nTotal          += m_BufferSizes[b];
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // slot of each triplet by binary search in its row, counting the triplets per slot
+    std::atomic<bool> bFitPattern { true };
+    UInt              offset = 0;
+    m_TripletSlot.resize(nTotal);
+    m_SlotStart.assign(static_cast<size_t>(matrix.rowStart[m_nRows]) + 1u, 0u);
+    for(auto buffer : buffers) {
+        ParallelExec::run(buffer->rows.size(),
+                          [&](size_t k) {
+                              const auto begin = matrix.colIndex.begin() + matrix.rowStart[buffer->rows[k]];
+                              const auto end   = matrix.colIndex.begin() + matrix.rowStart[buffer->rows[k] + 1];
+                              const auto it    = std::lower_bound(begin, end, buffer->cols[k]);
+                              if(it == end || *it != buffer->cols[k]) {
+                                  bFitPattern = false;
+                                  return;
+                              }
+                              const auto slot = static_cast<UInt>(std::distance(matrix.colIndex.begin(), it));
+                              m_TripletSlot[offset + k] = slot;
+                              AtomicOps::fetchAdd(m_SlotStart[slot], 1u);
+                          });
+        offset += static_cast<UInt>(buffer->rows.size());
+    }
+    if(!bFitPattern) {
+        m_BufferSizes.resize(0);
+        m_SlotStart.resize(0);
+        return false;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // inverse map: counting sort of the triplets by slot
+    // the order of the triplets within a slot depends on thread scheduling, gatherValues() sorts them by value
+    ParallelSTL::exclusive_scan(m_SlotStart);
+    StdVT_UInt slotCursor(m_SlotStart.begin(), m_SlotStart.end() - 1);
+    m_SlotTriplets.resize(nTotal);
+    ParallelExec::run(nTotal, [&](UInt t) { m_SlotTriplets[AtomicOps::fetchAdd(slotCursor[m_TripletSlot[t]], 1u)] = t; });
+    return true;
+}
+
+template<class Real_t>
+void SparseMatrixBuilder<Real_t>::gatherValues(const StdVT<const Triplets*>& buffers, FixedSparseMatrix<Real_t>& matrix) const {
+    StdVT_UInt bufferOffset(buffers.size() + 1, 0u);
+    for(size_t b = 0; b < buffers.size(); ++b) {
+        bufferOffset[b + 1] = bufferOffset[b] + static_cast<UInt>(buffers[b]->values.size());
+    }
+    m_TripletValues.resize(bufferOffset.back());
+    ParallelExec::run(buffers.size(),
+                      [&](size_t b) {
+                          memcpy(&m_TripletValues[bufferOffset[b]], buffers[b]->values.data(), buffers[b]->values.size() * sizeof(Real_t));
+                      });
+
+    // the duplicates of a slot are summed in increasing order of values, as in sortTriplets: the result is the same as construct()
+    ParallelExec::run(m_nRows,
+                      [&](UInt i) {
+                          StdVT<Real_t> longSlot;
+                          for(UInt slot = matrix.rowStart[i], slotEnd = matrix.rowStart[i + 1]; slot < slotEnd; ++slot) {
+                              const UInt begin = m_SlotStart[slot];
+                              const UInt n     = m_SlotStart[slot + 1] - begin;
+                              if(n <= 1u) {
+                                  matrix.colValue[slot] = n == 1u ? m_TripletValues[m_SlotTriplets[begin]] : Real_t(0);
+                                  continue;
+                              }
+                              std::array<Real_t, 32> shortSlot;
+                              Real_t*                sorted = shortSlot.data();
+                              if(n > static_cast<UInt>(shortSlot.size())) {
+                                  longSlot.resize(n);
+                                  sorted = longSlot.data();
+                              }
+                              for(UInt k = 0; k < n; ++k) {
+                                  sorted[k] = m_TripletValues[m_SlotTriplets[begin + k]];
+                              }
+                              std::sort(sorted, sorted + n);
+                              Real_t sum = sorted[0];
+                              for(UInt k = 1; k < n; ++k) {
+                                  sum += sorted[k];
+                              }
+                              matrix.colValue[slot] = sum;
+                          }
+                      });
+}
+
+template<class Real_t>
+bool SparseMatrixBuilder<Real_t>::updateValues(FixedSparseMatrix<Real_t>& matrix) const {
+    if(matrix.nRows != m_nRows || matrix.rowStart.size() != static_cast<size_t>(m_nRows) + 1u) {
+        return false;
+    }
+    const auto buffers = getTripletBuffers();
+    if(!checkSlotMap(buffers, matrix) && !buildSlotMap(buffers, matrix)) {
+        return false;
+    }
+    gatherValues(buffers, matrix);
+    return true;
+}
+
+template<class Real_t>
+void SparseMatrixBuilder<Real_t>::assemble(FixedSparseMatrix<Real_t>& matrix, bool bReusePattern /*= true*/) const {
+    if(bReusePattern && updateValues(matrix)) {
+        return;
+    }
+    construct(matrix);
+}
+
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 #define __BNN_INSTANTIATE_SPARSE_MATRIX_FUNCS(IntType, Real_t)                                            \
@@ -248,6 +590,7 @@ __BNN_INSTANTIATE_SPARSE_MATRIX_FUNCS(UInt64, double)
 
 NT_INSTANTIATE_STRUCT_COMMON_TYPES(SparseMatrix)
 NT_INSTANTIATE_STRUCT_COMMON_TYPES(FixedSparseMatrix)
+NT_INSTANTIATE_CLASS_COMMON_TYPES(SparseMatrixBuilder)
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 } // end namespace NTCodeBase
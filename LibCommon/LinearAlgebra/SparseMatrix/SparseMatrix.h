@@ -52,6 +52,10 @@ public:
     template<class IndexType> bool hasElement(IndexType i, IndexType j) const;
     template<class IndexType> bool hasElement(IndexType i, IndexType j, UInt& k) const;
 
+    // greedy graph coloring of the rows (assuming symmetric sparsity pattern): rows of the same color are not coupled,
+    // return the number of colors (2 for 5/7-point stencils in natural ordering, red-black)
+    UInt computeRowColors(StdVT_UInt& rowColors) const;
+
     void printDebug(UInt maxRows        = 0) const noexcept;
     void checkSymmetry(Real_t threshold = Real_t(1e-8)) const noexcept;
     void printTextFile(const char* fileName);
@@ -89,5 +93,79 @@ struct FixedSparseMatrix {
     ////////////////////////////////////////////////////////////////////////////////
     static void multiply(const FixedSparseMatrix<Real_t>& matrix, const StdVT<Real_t>& x, StdVT<Real_t>& result);
 };
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// Parallel assembly of FixedSparseMatrix from (i, j, value) triplets
+// addElement() can be called concurrently without locking: each thread appends to its own triplet buffer.
+// Duplicated (i, j) entries are summed, in an order that does not depend on the thread scheduling.
+//
+// Usage:
+//    builder.clear();
+//    ParallelExec::run(nCells, [&](UInt cell) { ... builder.addElement(i, j, v); ... });
+//    builder.assemble(matrix); // reuses the sparsity pattern of matrix if all triplets fit in it
+//
+template<class Real_t>
+class SparseMatrixBuilder {
+public:
+    explicit SparseMatrixBuilder(UInt size = 0) : m_nRows(size) {}
+
+    auto nRows() const { return m_nRows; }
+    void resize(UInt newSize) { m_nRows = newSize; }
+    // remove all triplets, keeping the allocated memory of the thread buffers
+    void   clear();
+    UInt64 nTriplets() const;
+
+    template<class IndexType>
+    void addElement(IndexType i, IndexType j, Real_t value) {
+        assert(static_cast<UInt>(i) < m_nRows && static_cast<UInt>(j) < m_nRows);
+        auto& triplets = m_Triplets.local();
+        triplets.rows.push_back(static_cast<UInt>(i));
+        triplets.cols.push_back(static_cast<UInt>(j));
+        triplets.values.push_back(value);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // bucket triplets by row (counting sort), sort each row by column and sum duplicates,
+    // then write the CSR arrays of matrix directly, and cache the triplet -> CSR slot map for updateValues()
+    void construct(FixedSparseMatrix<Real_t>& matrix) const;
+
+    // same sparsity pattern fast path: only rewrite the values of matrix, by summing the triplets of each CSR slot
+    // The cached slot map is reused if every triplet is at the same position of the same thread buffer as in the last assembly
+    // (checked in one pass, e.g. serial assembly or repeated assembly by the same threads), otherwise it is rebuilt by a binary
+    // search of each triplet in its row. The sums are bitwise identical to construct().
+    // return false if some triplet is not in the pattern of matrix, in that case matrix is not modified
+    bool updateValues(FixedSparseMatrix<Real_t>& matrix) const;
+
+    // updateValues() if bReusePattern and the pattern fits, otherwise construct()
+    void assemble(FixedSparseMatrix<Real_t>& matrix, bool bReusePattern = true) const;
+
+private:
+    struct Triplets {
+        StdVT_UInt    rows;
+        StdVT_UInt    cols;
+        StdVT<Real_t> values;
+    };
+
+    StdVT<const Triplets*> getTripletBuffers() const;
+    // gather the triplets into row buckets [rowOffset[i], rowOffset[i] + rowSize[i]) of (cols, values),
+    // sorted by column with duplicates summed; also fills m_SlotTriplets and m_TripletSlot (relative to the row) for construct()
+    void sortTriplets(const StdVT<const Triplets*>& buffers,
+                      StdVT_UInt& rowOffset, StdVT_UInt& rowSize, StdVT_UInt& cols, StdVT<Real_t>& values) const;
+
+    // triplet -> CSR slot map, the triplets are numbered by concatenating the buffers of getTripletBuffers()
+    bool checkSlotMap(const StdVT<const Triplets*>& buffers, const FixedSparseMatrix<Real_t>& matrix) const;
+    bool buildSlotMap(const StdVT<const Triplets*>& buffers, const FixedSparseMatrix<Real_t>& matrix) const;
+    void gatherValues(const StdVT<const Triplets*>& buffers, FixedSparseMatrix<Real_t>& matrix) const;
+
+    UInt                                              m_nRows;
+    mutable tbb::enumerable_thread_specific<Triplets> m_Triplets;
+
+    mutable StdVT_UInt    m_BufferSizes;  // sizes of the non-empty buffers when the slot map was built
+    mutable StdVT_UInt    m_TripletSlot;  // CSR slot of each triplet
+    mutable StdVT_UInt    m_SlotStart;    // the triplets of slot s are m_SlotTriplets[m_SlotStart[s], m_SlotStart[s + 1])
+    mutable StdVT_UInt    m_SlotTriplets;
+    mutable StdVT<Real_t> m_TripletValues; // scratch: the values of all triplets, in the slot map numbering
+};
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 } // end namespace NTCodeBase
@@ -12,13 +12,24 @@
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 
-#include <LinearAlgebra/SparseMatrix/BlockSparseMatrix.h>
-#include <LinearAlgebra/SparseMatrix/SparseMatrix.h>
+#include <catch2/catch.hpp>
+#include <LibCommon/CommonSetup.h>
+#include <LibCommon/Timer/Timer.h>
+#include <LibCommon/Utils/Formatters.h>
+#include <LibCommon/Utils/NumberHelpers.h>
 
-#include <LinearAlgebra/LinearSolvers/BlockPCGSolver.h>
-#include <LinearAlgebra/LinearSolvers/PCGSolver.h>
+#include <LibCommon/LinearAlgebra/SparseMatrix/BlockSparseMatrix.h>
+#include <LibCommon/LinearAlgebra/SparseMatrix/SparseMatrix.h>
+#include <LibCommon/LinearAlgebra/SparseMatrix/SlicedELLMatrix.h>
 
-#include <CommonSetup.h>
+#include <LibCommon/LinearAlgebra/LinearSolvers/AMGSolver.h>
+#include <LibCommon/LinearAlgebra/LinearSolvers/BlockPCGSolver.h>
+#include <LibCommon/LinearAlgebra/LinearSolvers/GeometricMGSolver.h>
+#include <LibCommon/LinearAlgebra/LinearSolvers/PCGSolver.h>
+
+#include <LibCommon/LinearAlgebra/ImplicitQRSVD.h>
+
+using namespace NTCodeBase;
 
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 //namespace _LinearAlgebra_Test
@@ -29,3 +40,1163 @@
 //Banana::PCGSolver<float>    solver2;
 //Banana::SparseMatrix<float> mat2;
 //}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+#define TEST_GRID_RES 64
+#define SPMV_TEST_NUM 50
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// 3D matrix with 7-point stencil connectivity, nDofs unknowns per grid node fully coupled to the neighbor nodes
+// nDofs = 1: Poisson matrix (7 nonzeros per row), nDofs = 3: elasticity-like matrix (21 nonzeros per row)
+template<class Real_t>
+void generateStencilMatrix(FixedSparseMatrix<Real_t>& matrix, UInt res, UInt nDofs) {
+    const UInt                  nNodes = res * res * res;
+    SparseMatrixBuilder<Real_t> builder(nNodes * nDofs);
+    ParallelExec::run(nNodes,
+                      [&](UInt node) {
+                          const UInt i = node % res, j = (node / res) % res, k = node / (res * res);
+                          auto addNeighbor = [&](UInt neighbor, Real_t weight) {
+                                                 for(UInt d1 = 0; d1 < nDofs; ++d1) {
+                                                     for(UInt d2 = 0; d2 < nDofs; ++d2) {
+                                                         builder.addElement(node * nDofs + d1, neighbor * nDofs + d2,
+                                                                            d1 == d2 ? weight : weight * Real_t(0.1));
+                                                     }
+                                                 }
+                                             };
+                          addNeighbor(node, Real_t(6.5));
+                          if(i > 0) { addNeighbor(node - 1, Real_t(-1)); }
+                          if(i + 1 < res) { addNeighbor(node + 1, Real_t(-1)); }
+                          if(j > 0) { addNeighbor(node - res, Real_t(-1)); }
+                          if(j + 1 < res) { addNeighbor(node + res, Real_t(-1)); }
+                          if(k > 0) { addNeighbor(node - res * res, Real_t(-1)); }
+                          if(k + 1 < res) { addNeighbor(node + res * res, Real_t(-1)); }
+                      });
+    builder.construct(matrix);
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// random triplets with many duplicated (i, j) entries, the values are a pure function of the triplet index
+template<class Real_t>
+auto randomTriplet(UInt k, UInt n, Real_t scale) {
+    // the first rows get most of the triplets, to also exercise the long row path
+    const UInt i = k % 3 == 0 ? NumberHelpers::randhash(2 * k) % 4 : NumberHelpers::randhash(2 * k) % n;
+    const UInt j = NumberHelpers::randhash(2 * k + 1) % 16;
+    return std::make_tuple(i, j, scale * NumberHelpers::frandhash11<Real_t>(3 * k + 7));
+}
+
+template<class Real_t>
+void addRandomTriplets(SparseMatrixBuilder<Real_t>& builder, SparseMatrix<Real_t>* reference, UInt nTriplets, Real_t scale) {
+    auto triplet = [&](UInt k) { return randomTriplet(k, builder.nRows(), scale); };
+    ParallelExec::run(nTriplets,
+                      [&](UInt k) {
+                          const auto [i, j, value] = triplet(k);
+                          builder.addElement(i, j, value);
+                      });
+    if(reference != nullptr) {
+        for(UInt k = 0; k < nTriplets; ++k) {
+            const auto [i, j, value] = triplet(k);
+            reference->addElement(i, j, value);
+        }
+    }
+}
+
+template<class Real_t>
+void requireSameMatrix(const FixedSparseMatrix<Real_t>& matrix, const FixedSparseMatrix<Real_t>& reference, Real_t tolerance) {
+    REQUIRE(matrix.nRows == reference.nRows);
+    REQUIRE(matrix.rowStart == reference.rowStart);
+    for(UInt k = 0; k < reference.rowStart.back(); ++k) {
+        REQUIRE(matrix.colIndex[k] == reference.colIndex[k]);
+        REQUIRE(std::abs(matrix.colValue[k] - reference.colValue[k]) <= tolerance * (Real_t(1) + std::abs(reference.colValue[k])));
+    }
+}
+
+template<class Real_t>
+void testSparseMatrixBuilder() {
+    const UInt   nRows     = 1000;
+    const UInt   nTriplets = 200'000;
+    // the first rows sum about 1000 values per entry
+    const Real_t tolerance = NumberHelpers::isFloat<Real_t>() ? Real_t(1e-3) : Real_t(1e-10);
+
+    SparseMatrix<Real_t>        serial(nRows);
+    FixedSparseMatrix<Real_t>   reference;
+    SparseMatrixBuilder<Real_t> builder(nRows);
+    addRandomTriplets(builder, &serial, nTriplets, Real_t(1));
+    reference.constructFromSparseMatrix(serial);
+    REQUIRE(builder.nTriplets() == nTriplets);
+
+    // duplicates are summed, as the serial reference does
+    FixedSparseMatrix<Real_t> matrix;
+    builder.construct(matrix);
+    requireSameMatrix(matrix, reference, tolerance);
+
+    // the sum order does not depend on the thread scheduling: rebuilding gives bitwise identical values
+    for(Int test = 0; test < 5; ++test) {
+        SparseMatrixBuilder<Real_t> rebuilder(nRows);
+        addRandomTriplets<Real_t>(rebuilder, nullptr, nTriplets, Real_t(1));
+        FixedSparseMatrix<Real_t> rebuilt;
+        rebuilder.construct(rebuilt);
+        REQUIRE(rebuilt.colValue == matrix.colValue);
+
+        // updateValues gives the same values as construct
+        REQUIRE(rebuilder.updateValues(rebuilt));
+        REQUIRE(rebuilt.colValue == matrix.colValue);
+    }
+
+    // same pattern, new values: only the values are rewritten
+    builder.clear();
+    serial = SparseMatrix<Real_t>(nRows);
+    addRandomTriplets(builder, &serial, nTriplets, Real_t(2));
+    reference.constructFromSparseMatrix(serial);
+    auto colIndex = matrix.colIndex.data();
+    REQUIRE(builder.updateValues(matrix));
+    REQUIRE(matrix.colIndex.data() == colIndex);
+    requireSameMatrix(matrix, reference, tolerance);
+
+    // an entry out of the pattern: updateValues fails without modifying matrix, and assemble falls back to construct
+    builder.addElement(nRows - 1, nRows - 1, Real_t(1));
+    serial.addElement(nRows - 1, nRows - 1, Real_t(1));
+    const auto colValue = matrix.colValue;
+    REQUIRE_FALSE(builder.updateValues(matrix));
+    REQUIRE(matrix.colValue == colValue);
+    reference.constructFromSparseMatrix(serial);
+    builder.assemble(matrix);
+    requireSameMatrix(matrix, reference, tolerance);
+
+    // serial assembly in the same order reuses the slot map cached by construct, in the reversed order the map is rebuilt:
+    // both give the values of construct bitwise
+    SparseMatrixBuilder<Real_t> serialBuilder(nRows);
+    auto addSerial = [&](bool bReversed, Real_t scale) {
+                         serialBuilder.clear();
+                         for(UInt k = 0; k < nTriplets; ++k) {
+                             const auto [i, j, value] = randomTriplet(bReversed ? nTriplets - 1 - k : k, nRows, scale);
+                             serialBuilder.addElement(i, j, value);
+                         }
+                     };
+    FixedSparseMatrix<Real_t> serialMatrix, constructed;
+    addSerial(false, Real_t(1));
+    serialBuilder.construct(serialMatrix);
+    for(bool bReversed : { false, true, true, false }) {
+        addSerial(bReversed, Real_t(3));
+        REQUIRE(serialBuilder.updateValues(serialMatrix));
+        SparseMatrixBuilder<Real_t> constructBuilder(nRows);
+        addRandomTriplets<Real_t>(constructBuilder, nullptr, nTriplets, Real_t(3));
+        constructBuilder.construct(constructed);
+        REQUIRE(serialMatrix.rowStart == constructed.rowStart);
+        REQUIRE(serialMatrix.colIndex == constructed.colIndex);
+        REQUIRE(serialMatrix.colValue == constructed.colValue);
+    }
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+TEST_CASE("Test_SparseMatrixBuilder", "[Test_SparseMatrixBuilder]")
+{
+    testSparseMatrixBuilder<float>();
+    testSparseMatrixBuilder<double>();
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<class Real_t>
+void requireSameSpMV(const FixedSparseMatrix<Real_t>& csr, const SlicedELLMatrix<Real_t>& sell, const StdVT<Real_t>& x) {
+    StdVT<Real_t> resultCSR, resultSELL;
+    FixedSparseMatrix<Real_t>::multiply(csr, x, resultCSR);
+    SlicedELLMatrix<Real_t>::multiply(sell, x, resultSELL);
+    REQUIRE(resultSELL.size() == resultCSR.size());
+    UInt nErrors = 0;
+    for(UInt i = 0; i < csr.nRows; ++i) {
+        if(std::abs(resultCSR[i] - resultSELL[i]) > Real_t(1e-4) * (Real_t(1) + std::abs(resultCSR[i]))) {
+            ++nErrors;
+        }
+    }
+    REQUIRE(nErrors == 0);
+}
+
+// rows of very different lengths (including empty rows), and a row count that is not a multiple of the slice size
+template<class Real_t>
+void testSlicedELLIrregular() {
+    SparseMatrixBuilder<Real_t> builder(1003);
+    addRandomTriplets<Real_t>(builder, nullptr, 5000, Real_t(1));
+    FixedSparseMatrix<Real_t> csr;
+    builder.construct(csr);
+    StdVT<Real_t> x(csr.nRows);
+    for(UInt i = 0; i < csr.nRows; ++i) {
+        x[i] = NumberHelpers::frandhash11<Real_t>(i);
+    }
+    for(UInt sigma : { 1u, 8u, 64u, 2048u }) {
+        SlicedELLMatrix<Real_t> sell;
+        sell.constructFromFixedSparseMatrix(csr, sigma);
+        REQUIRE(sell.nSlices == (csr.nRows + SlicedELLMatrix<Real_t>::SliceSize - 1) / SlicedELLMatrix<Real_t>::SliceSize);
+        REQUIRE(sell.sliceStart.back() >= csr.rowStart.back());
+        requireSameSpMV(csr, sell, x);
+    }
+}
+
+template<class Real_t>
+void testSlicedELL(UInt nDofs, const char* matrixName) {
+    FixedSparseMatrix<Real_t> csr;
+    generateStencilMatrix(csr, TEST_GRID_RES, nDofs);
+    StdVT<Real_t> x(csr.nRows), resultCSR, resultSELL;
+    for(auto& v : x) {
+        v = NumberHelpers::fRand11<Real_t>::rnd();
+    }
+
+    for(UInt sigma : { 1u, 64u }) {
+        SlicedELLMatrix<Real_t> sell;
+        sell.constructFromFixedSparseMatrix(csr, sigma);
+        requireSameSpMV(csr, sell, x);
+
+        Timer timer;
+        timer.tick();
+        for(int test = 0; test < SPMV_TEST_NUM; ++test) {
+            FixedSparseMatrix<Real_t>::multiply(csr, x, resultCSR);
+        }
+        auto timeCSR = timer.tock() / SPMV_TEST_NUM;
+        timer.tick();
+        for(int test = 0; test < SPMV_TEST_NUM; ++test) {
+            SlicedELLMatrix<Real_t>::multiply(sell, x, resultSELL);
+        }
+        auto timeSELL = timer.tock() / SPMV_TEST_NUM;
+        printf("%s matrix (%s, %u rows, sigma = %u, padding ratio = %s): CSR SpMV = %sms, SELL-8 SpMV = %sms\n",
+               matrixName, NumberHelpers::nameRealT<Real_t>().c_str(), csr.nRows, sigma,
+               Formatters::toString(sell.paddingRatio(csr)).c_str(),
+               Formatters::toString(timeCSR).c_str(), Formatters::toString(timeSELL).c_str());
+    }
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+TEST_CASE("Test_SlicedELL_SpMV", "[Test_SlicedELL_SpMV]")
+{
+    // the timings below compare against the scalar fallback if the AVX2 kernel is not compiled
+    INFO("SlicedELLMatrix::multiply is not vectorized: build with -march=native (or -mavx2) or /arch:AVX2");
+    REQUIRE(SlicedELLMatrix<float>::bVectorized);
+    testSlicedELLIrregular<float>();
+    testSlicedELLIrregular<double>();
+    testSlicedELL<float>(1, "Poisson");
+    testSlicedELL<double>(1, "Poisson");
+    testSlicedELL<float>(3, "Elasticity");
+    testSlicedELL<double>(3, "Elasticity");
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// Block SpMV of the 3x3 elasticity-like matrix: glm block products vs SIMD block products
+template<class Real_t>
+void testBlockSpMV() {
+    using Mat = Mat3x3<Real_t>;
+    using Vec = Vec3<Real_t>;
+    const UInt           res = TEST_GRID_RES, nNodes = res * res * res;
+    BlockSparseMatrix<Mat> matrix(nNodes);
+    ParallelExec::run(nNodes,
+                      [&](UInt node) {
+                          const UInt i = node % res, j = (node / res) % res, k = node / (res * res);
+                          auto block = [&](UInt neighbor, Real_t weight) {
+                                           Mat B(weight * Real_t(0.1));
+                                           for(Int d = 0; d < 3; ++d) {
+                                               B[d][d] = weight;
+                                           }
+                                           B[0][1] += NumberHelpers::frandhash11<Real_t>(node * 7 + neighbor) * Real_t(0.01);
+                                           matrix.setElement(node, neighbor, B);
+                                       };
+                          if(k > 0) { block(node - res * res, Real_t(-1)); }
+                          if(j > 0) { block(node - res, Real_t(-1)); }
+                          if(i > 0) { block(node - 1, Real_t(-1)); }
+                          block(node, Real_t(6.5));
+                          if(i + 1 < res) { block(node + 1, Real_t(-1)); }
+                          if(j + 1 < res) { block(node + res, Real_t(-1)); }
+                          if(k + 1 < res) { block(node + res * res, Real_t(-1)); }
+                      });
+    StdVT<Vec> x(nNodes), resultGLM, resultSIMD;
+    for(auto& v : x) {
+        v = Vec(NumberHelpers::fRand11<Real_t>::rnd(), NumberHelpers::fRand11<Real_t>::rnd(), NumberHelpers::fRand11<Real_t>::rnd());
+    }
+
+    FixedBlockSparseMatrix<Mat> fixedMatrix;
+    Timer                       timer;
+    timer.tick();
+    fixedMatrix.constructFromSparseMatrix(matrix);
+    auto constructTime = timer.tock();
+
+    FixedBlockSparseMatrix<Mat>::multiply_glm(fixedMatrix, x, resultGLM);
+    FixedBlockSparseMatrix<Mat>::multiply(fixedMatrix, x, resultSIMD);
+    for(UInt i = 0; i < nNodes; ++i) {
+        REQUIRE(glm::length(resultGLM[i] - resultSIMD[i]) < Real_t(1e-4) * (Real_t(1) + glm::length(resultGLM[i])));
+    }
+
+    timer.tick();
+    for(int test = 0; test < SPMV_TEST_NUM; ++test) {
+        FixedBlockSparseMatrix<Mat>::multiply_glm(fixedMatrix, x, resultGLM);
+    }
+    auto timeGLM = timer.tock() / SPMV_TEST_NUM;
+    timer.tick();
+    for(int test = 0; test < SPMV_TEST_NUM; ++test) {
+        FixedBlockSparseMatrix<Mat>::multiply(fixedMatrix, x, resultSIMD);
+    }
+    auto timeSIMD = timer.tock() / SPMV_TEST_NUM;
+    printf("Block 3x3 matrix (%s, %u block rows): construction = %sms, glm SpMV = %sms, SIMD SpMV = %sms\n",
+           NumberHelpers::nameRealT<Real_t>().c_str(), nNodes, Formatters::toString(constructTime).c_str(),
+           Formatters::toString(timeGLM).c_str(), Formatters::toString(timeSIMD).c_str());
+}
+
+TEST_CASE("Test_BlockSpMV", "[Test_BlockSpMV]")
+{
+    // otherwise the test would only compare multiply_glm with itself
+    INFO("FixedBlockSparseMatrix::multiply is not vectorized: build with -march=native (or -mavx2) or /arch:AVX2");
+    REQUIRE(FixedBlockSparseMatrix<Mat3x3f>::bVectorized);
+    REQUIRE(FixedBlockSparseMatrix<Mat3x3d>::bVectorized);
+    testBlockSpMV<float>();
+    testBlockSpMV<double>();
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// 3D Poisson matrix on a res^3 grid, Dirichlet boundary
+template<class Real_t>
+void generatePoissonMatrix(SparseMatrix<Real_t>& matrix, UInt res) {
+    const UInt nNodes = res * res * res;
+    matrix.resize(nNodes);
+    matrix.clear();
+    ParallelExec::run(nNodes,
+                      [&](UInt node) {
+                          const UInt i = node % res, j = (node / res) % res, k = node / (res * res);
+                          matrix.addElement(node, node, Real_t(6));
+                          if(i > 0) { matrix.addElement(node, node - 1, Real_t(-1)); }
+                          if(i + 1 < res) { matrix.addElement(node, node + 1, Real_t(-1)); }
+                          if(j > 0) { matrix.addElement(node, node - res, Real_t(-1)); }
+                          if(j + 1 < res) { matrix.addElement(node, node + res, Real_t(-1)); }
+                          if(k > 0) { matrix.addElement(node, node - res * res, Real_t(-1)); }
+                          if(k + 1 < res) { matrix.addElement(node, node + res * res, Real_t(-1)); }
+                      });
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<class Real_t>
+void testPCGPreconditioners(const std::vector<std::pair<typename PCGSolver<Real_t>::Preconditioner, const char*>>& preconditioners) {
+    SparseMatrix<Real_t> matrix;
+    generatePoissonMatrix(matrix, TEST_GRID_RES);
+    StdVT<Real_t> rhs(matrix.nRows), reference;
+    for(auto& v : rhs) {
+        v = NumberHelpers::fRand11<Real_t>::rnd();
+    }
+
+    for(const auto& [precond, name] : preconditioners) {
+        PCGSolver<Real_t> solver;
+        StdVT<Real_t>     result;
+        solver.setSolverParameters(Real_t(1e-6), 1000);
+        solver.setPreconditioners(precond);
+        REQUIRE(solver.solve_precond(matrix, rhs, result)); // warm up, analysis of level schedule
+        Timer timer;
+        timer.tick();
+        REQUIRE(solver.solve_precond(matrix, rhs, result));
+        auto time = timer.tock();
+        printf("PCG (%s, %s, %u rows): %u iterations, residual = %s, time = %sms\n",
+               name, NumberHelpers::nameRealT<Real_t>().c_str(), matrix.nRows, solver.iterations(),
+               Formatters::toSciString(solver.residual()).c_str(), Formatters::toString(time).c_str());
+        REQUIRE(solver.residual() < Real_t(1e-6));
+
+        // check the solution against the first preconditioner
+        if(reference.empty()) {
+            reference = result;
+        } else {
+            REQUIRE(ParallelSTL::maxAbs(ParallelBLAS::minus(result, reference)) < Real_t(1e-3) * ParallelSTL::maxAbs(reference));
+        }
+    }
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+TEST_CASE("Test_PCG_LevelScheduled_MICCL0", "[Test_PCG_LevelScheduled_MICCL0]")
+{
+    testPCGPreconditioners<double>({ { PCGSolver<double>::MICCL0, "MICCL0" },
+                                     { PCGSolver<double>::MICCL0_LEVEL_SCHEDULED, "MICCL0 level scheduled" } });
+
+    // same factor up to rounding: same iteration count and residual at every iteration limit
+    SparseMatrix<double> matrix;
+    generatePoissonMatrix(matrix, TEST_GRID_RES);
+    StdVT<double> rhs(matrix.nRows);
+    for(UInt i = 0; i < matrix.nRows; ++i) {
+        rhs[i] = NumberHelpers::frandhash11<double>(i);
+    }
+    PCGSolver<double> solver, solverLevelScheduled;
+    solver.setPreconditioners(PCGSolver<double>::MICCL0);
+    solverLevelScheduled.setPreconditioners(PCGSolver<double>::MICCL0_LEVEL_SCHEDULED);
+    for(UInt maxIters : { 1u, 5u, 10u, 20u, 1000u }) {
+        StdVT<double> result, resultLevelScheduled;
+        solver.setSolverParameters(1e-6, maxIters);
+        solverLevelScheduled.setSolverParameters(1e-6, maxIters);
+        solver.solve_precond(matrix, rhs, result);
+        solverLevelScheduled.solve_precond(matrix, rhs, resultLevelScheduled);
+        REQUIRE(solverLevelScheduled.iterations() == solver.iterations());
+        REQUIRE(std::abs(solverLevelScheduled.residual() - solver.residual()) <= 1e-8 * solver.residual());
+        REQUIRE(ParallelSTL::maxAbs(ParallelBLAS::minus(resultLevelScheduled, result)) <= 1e-8 * ParallelSTL::maxAbs(result));
+    }
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+TEST_CASE("Test_PCG_Multicolor_MICCL0", "[Test_PCG_Multicolor_MICCL0]")
+{
+    SparseMatrix<double> matrix;
+    generatePoissonMatrix(matrix, 8);
+    StdVT_UInt rowColors;
+    REQUIRE(matrix.computeRowColors(rowColors) == 2u); // red-black
+    for(UInt i = 0; i < matrix.nRows; ++i) {
+        for(auto j : matrix.colIndex[i]) {
+            REQUIRE((j == i || rowColors[i] != rowColors[j]));
+        }
+    }
+    testPCGPreconditioners<double>({ { PCGSolver<double>::MICCL0, "MICCL0" },
+                                     { PCGSolver<double>::MICCL0_MULTICOLOR, "MICCL0 multicolor" } });
+
+    // the multicolor preconditioner must pay off against Jacobi, and its own default parameter (IC(0))
+    // must do better than the modification that suits the natural ordering
+    generatePoissonMatrix(matrix, TEST_GRID_RES);
+    StdVT<double> rhs(matrix.nRows), result;
+    for(UInt i = 0; i < matrix.nRows; ++i) {
+        rhs[i] = NumberHelpers::frandhash11<double>(i);
+    }
+    auto iterations = [&](PCGSolver<double>::Preconditioner precond, double multicolorMICCL0Param) {
+                          PCGSolver<double> solver;
+                          solver.setSolverParameters(1e-6, 1000);
+                          solver.setPreconditioners(precond);
+                          solver.setMulticolorMICCL0Param(multicolorMICCL0Param);
+                          REQUIRE(solver.solve_precond(matrix, rhs, result));
+                          return solver.iterations();
+                      };
+    const auto itJacobi             = iterations(PCGSolver<double>::JACOBI, 0.0);
+    const auto itMulticolor         = iterations(PCGSolver<double>::MICCL0_MULTICOLOR, 0.0);
+    const auto itMulticolorModified = iterations(PCGSolver<double>::MICCL0_MULTICOLOR, 0.97);
+    printf("PCG iterations (%u rows): Jacobi = %u, MICCL0 multicolor = %u (MICCL0Param 0), %u (MICCL0Param 0.97)\n",
+           matrix.nRows, itJacobi, itMulticolor, itMulticolorModified);
+    REQUIRE(itMulticolor < itJacobi);
+    REQUIRE(itMulticolor < itMulticolorModified);
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// The single reduction variant should reproduce the standard PCG up to rounding errors, with the same number of iterations
+TEST_CASE("Test_PCG_SingleReduction", "[Test_PCG_SingleReduction]")
+{
+    SparseMatrix<double> matrix;
+    generatePoissonMatrix(matrix, TEST_GRID_RES);
+    StdVT<double> rhs(matrix.nRows);
+    for(auto& v : rhs) {
+        v = NumberHelpers::fRand11<double>::rnd();
+    }
+
+    for(auto precond : { PCGSolver<double>::JACOBI, PCGSolver<double>::MICCL0, PCGSolver<double>::AMG }) {
+        PCGSolver<double> solver;
+        StdVT<double>     reference, result;
+        solver.setSolverParameters(1e-6, 1000);
+        solver.setPreconditioners(precond);
+
+        Timer timer;
+        timer.tick();
+        REQUIRE(solver.solve_precond(matrix, rhs, reference));
+        auto time       = timer.tock();
+        auto iterations = solver.iterations();
+        timer.tick();
+        REQUIRE(solver.solve_precond_single_reduction(matrix, rhs, result));
+        auto timeSingleReduction = timer.tock();
+        printf("PCG (precond %d, %u rows): standard = %u iterations, %sms, single reduction = %u iterations, %sms\n",
+               static_cast<int>(precond), matrix.nRows, iterations, Formatters::toString(time).c_str(),
+               solver.iterations(), Formatters::toString(timeSingleReduction).c_str());
+        REQUIRE(solver.iterations() == iterations);
+        REQUIRE(ParallelSTL::maxAbs(ParallelBLAS::minus(result, reference)) < 1e-3 * ParallelSTL::maxAbs(reference));
+
+        // the fused reduction follows the reduction policy: deterministic runs are bit-wise reproducible
+        ParallelExec::setDefaultReductionPolicy(ParallelExec::ReductionPolicy::Deterministic);
+        StdVT<double> result1, result2;
+        REQUIRE(solver.solve_precond_single_reduction(matrix, rhs, result1));
+        const auto residual1 = solver.residual();
+        REQUIRE(solver.solve_precond_single_reduction(matrix, rhs, result2));
+        ParallelExec::setDefaultReductionPolicy(ParallelExec::ReductionPolicy::Fast);
+        REQUIRE(solver.iterations() == iterations);
+        REQUIRE(solver.residual() == residual1);
+        REQUIRE(result1 == result2);
+    }
+}
+
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// Mixed precision PCG should reach a tolerance below float precision
+TEST_CASE("Test_PCG_MixedPrecision", "[Test_PCG_MixedPrecision]")
+{
+    SparseMatrix<double> matrix;
+    generatePoissonMatrix(matrix, TEST_GRID_RES);
+    StdVT<double> rhs(matrix.nRows);
+    for(auto& v : rhs) {
+        v = NumberHelpers::fRand11<double>::rnd();
+    }
+
+    for(auto precond : { PCGSolver<double>::MICCL0, PCGSolver<double>::MICCL0_LEVEL_SCHEDULED }) {
+        PCGSolver<double> solver;
+        StdVT<double>     reference, result;
+        solver.setSolverParameters(1e-10, 1000);
+        solver.setPreconditioners(precond);
+        REQUIRE(solver.solve_precond(matrix, rhs, reference)); // warm up, analysis of level schedule
+
+        Timer timer;
+        timer.tick();
+        REQUIRE(solver.solve_precond(matrix, rhs, reference));
+        auto time = timer.tock();
+        printf("PCG (precond %d, double, %u rows): %u iterations, residual = %s, time = %sms\n",
+               static_cast<int>(precond), matrix.nRows, solver.iterations(),
+               Formatters::toSciString(solver.residual()).c_str(), Formatters::toString(time).c_str());
+
+        for(bool bFloatMatrix : { false, true }) {
+            solver.setMixedPrecisionParameters(bFloatMatrix);
+            timer.tick();
+            REQUIRE(solver.solve_precond_mixed(matrix, rhs, result));
+            time = timer.tock();
+            printf("PCG (precond %d, %s, %u rows): %u iterations, %u refinement steps, residual = %s, time = %sms\n",
+                   static_cast<int>(precond), bFloatMatrix ? "float matrix + preconditioner" : "float preconditioner", matrix.nRows,
+                   solver.iterations(), solver.refinementSteps(),
+                   Formatters::toSciString(solver.residual()).c_str(), Formatters::toString(time).c_str());
+            REQUIRE(ParallelSTL::maxAbs(ParallelBLAS::minus(result, reference)) < 1e-8 * ParallelSTL::maxAbs(reference));
+        }
+    }
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// Solving 3 right hand sides at once should give the same results as 3 separate solves
+TEST_CASE("Test_PCG_MultiRHS", "[Test_PCG_MultiRHS]")
+{
+    SparseMatrix<double> matrix;
+    generatePoissonMatrix(matrix, TEST_GRID_RES);
+    StdVT<Vec3<double>> rhs(matrix.nRows), result;
+    for(auto& v : rhs) {
+        v = Vec3<double>(NumberHelpers::fRand11<double>::rnd(), NumberHelpers::fRand11<double>::rnd(), NumberHelpers::fRand11<double>::rnd());
+    }
+
+    for(auto precond : { PCGSolver<double>::JACOBI, PCGSolver<double>::MICCL0, PCGSolver<double>::AMG }) {
+        PCGSolver<double> solver;
+        solver.setSolverParameters(1e-6, 1000);
+        solver.setPreconditioners(precond);
+
+        StdVT<double>        columnRhs(matrix.nRows), columnResult;
+        StdVT<StdVT<double>> reference;
+        UInt                 maxIterations = 0;
+        Timer                timer;
+        timer.tick();
+        for(Int c = 0; c < 3; ++c) {
+            for(UInt i = 0; i < matrix.nRows; ++i) {
+                columnRhs[i] = rhs[i][c];
+            }
+            REQUIRE(solver.solve_precond(matrix, columnRhs, columnResult));
+            reference.push_back(columnResult);
+            maxIterations = std::max(maxIterations, solver.iterations());
+        }
+        auto timeSeparate = timer.tock();
+        timer.tick();
+        REQUIRE(solver.solve_precond_multi<3>(matrix, rhs, result));
+        auto timeMulti = timer.tock();
+        printf("PCG (precond %d, %u rows, 3 rhs): separate = %u iterations, %sms, multi = %u iterations, %sms\n",
+               static_cast<int>(precond), matrix.nRows, maxIterations, Formatters::toString(timeSeparate).c_str(),
+               solver.iterations(), Formatters::toString(timeMulti).c_str());
+        REQUIRE(solver.iterations() == maxIterations);
+        for(Int c = 0; c < 3; ++c) {
+            double maxDiff = 0;
+            for(UInt i = 0; i < matrix.nRows; ++i) {
+                maxDiff = std::max(maxDiff, std::abs(result[i][c] - reference[c][i]));
+            }
+            REQUIRE(maxDiff < 1e-8 * ParallelSTL::maxAbs(reference[c]));
+        }
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // indefinite diagonal matrix with Jacobi: rhs (1, 1) gives rho = (M^-1 r, r) = 0, the column breaks down without converging
+    SparseMatrix<double> indefinite(2);
+    indefinite.addElement(0, 0, 1.0);
+    indefinite.addElement(1, 1, -1.0);
+    PCGSolver<double> solver;
+    solver.setSolverParameters(1e-6, 100);
+    solver.setPreconditioners(PCGSolver<double>::JACOBI);
+    StdVT<Vec2<double>> rhs2 { Vec2<double>(1, 0), Vec2<double>(0, 0) }, result2;
+    REQUIRE(solver.solve_precond_multi<2>(indefinite, rhs2, result2));
+    REQUIRE(result2[0] == Vec2<double>(1, 0));
+    StdVT<Vec3<double>> rhs3 { Vec3<double>(1, 1, 0), Vec3<double>(0, 1, 0) };
+    REQUIRE_FALSE(solver.solve_precond_multi<3>(indefinite, rhs3, result));
+    REQUIRE(result[0][0] == 1.0);
+    REQUIRE(solver.residual() == 1.0);
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// max |rhs - matrix * x|, computed independently of the solvers
+template<class Real_t>
+Real_t trueResidual(const FixedSparseMatrix<Real_t>& matrix, const StdVT<Real_t>& rhs, const StdVT<Real_t>& x) {
+    StdVT<Real_t> Ax;
+    FixedSparseMatrix<Real_t>::multiply(matrix, x, Ax);
+    return ParallelSTL::maxAbs(ParallelBLAS::minus(rhs, Ax));
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// Time steps with a slowly changing matrix: the preconditioner is reused for up to 4 solves
+TEST_CASE("Test_PCG_PreconditionerReuse", "[Test_PCG_PreconditionerReuse]")
+{
+    SparseMatrix<double> matrix;
+    generatePoissonMatrix(matrix, TEST_GRID_RES);
+    StdVT<double> rhs(matrix.nRows), result;
+    for(auto& v : rhs) {
+        v = NumberHelpers::fRand11<double>::rnd();
+    }
+
+    PCGSolver<double> solver;
+    solver.setSolverParameters(1e-6, 1000);
+    solver.setPreconditioners(PCGSolver<double>::MICCL0);
+    solver.setPreconditionerReuse(4, 1.5);
+    for(UInt step = 0; step < 10; ++step) {
+        for(UInt i = 0; i < matrix.nRows; ++i) {
+            matrix.setElement(i, i, 6.0 + 0.01 * step);
+        }
+        REQUIRE(solver.solve_precond(matrix, rhs, result));
+        const auto& stats = solver.stats();
+        printf("Step %u: %u iterations, factor age = %u, rebuilt = %d, setup = %sms, solve = %sms\n",
+               step, stats.iterations, stats.factorAge, stats.bRebuilt ? 1 : 0,
+               Formatters::toString(stats.setupTime).c_str(), Formatters::toString(stats.solveTime).c_str());
+        REQUIRE(stats.factorAge == step % 4 + 1);
+        REQUIRE(stats.bRebuilt == (step % 4 == 0));
+        REQUIRE((stats.bRebuilt || stats.setupTime == 0));
+    }
+    REQUIRE(solver.stats().nFactorizations == 3u);
+
+    // a harder matrix with the factor of an easier one needs more iterations, then the factor is recomputed
+    auto setDiagonal = [&](double diagonal) {
+                           for(UInt i = 0; i < matrix.nRows; ++i) {
+                               matrix.setElement(i, i, diagonal);
+                           }
+                       };
+    solver.setPreconditionerReuse(100, 1.2);
+    solver.invalidatePreconditioner();
+    setDiagonal(8.0);
+    REQUIRE(solver.solve_precond(matrix, rhs, result));
+    const auto easyIterations = solver.stats().iterations;
+    setDiagonal(6.0);
+    REQUIRE(solver.solve_precond(matrix, rhs, result));
+    REQUIRE_FALSE(solver.stats().bRebuilt);
+    REQUIRE(solver.stats().iterations > UInt(1.2 * easyIterations));
+    REQUIRE(solver.solve_precond(matrix, rhs, result));
+    REQUIRE(solver.stats().bRebuilt);
+
+    // changing the sparsity pattern forces a new factorization
+    generatePoissonMatrix(matrix, TEST_GRID_RES / 2);
+    rhs.resize(matrix.nRows);
+    REQUIRE(solver.solve_precond(matrix, rhs, result));
+    REQUIRE(solver.stats().bRebuilt);
+    // changing the AMG parameters rebuilds the hierarchy
+    solver.setPreconditioners(PCGSolver<double>::AMG);
+    REQUIRE(solver.solve_precond(matrix, rhs, result));
+    REQUIRE(solver.solve_precond(matrix, rhs, result));
+    REQUIRE_FALSE(solver.stats().bRebuilt);
+    solver.AMGPreconditioner().setStrengthThreshold(0.1);
+    REQUIRE(solver.solve_precond(matrix, rhs, result));
+    REQUIRE(solver.stats().bRebuilt);
+
+    // warm start from the previous solution after a perturbation of the right hand side: the iterations start from
+    // rhs - A * x0, thus they converge to the solution of the new system in fewer iterations
+    generatePoissonMatrix(matrix, TEST_GRID_RES);
+    FixedSparseMatrix<double> fixedMatrix;
+    fixedMatrix.constructFromSparseMatrix(matrix);
+    rhs.resize(matrix.nRows);
+    for(bool bPrecond : { false, true }) {
+        PCGSolver<double> warmSolver;
+        warmSolver.setSolverParameters(1e-8, 1000);
+        warmSolver.setPreconditioners(PCGSolver<double>::MICCL0);
+        auto solve = [&](StdVT<double>& x) { return bPrecond ? warmSolver.solve_precond(matrix, rhs, x) : warmSolver.solve(matrix, rhs, x); };
+        for(auto& v : rhs) {
+            v = NumberHelpers::fRand11<double>::rnd();
+        }
+        StdVT<double> x;
+        REQUIRE(solve(x));
+        const auto coldIterations = warmSolver.iterations();
+
+        for(auto& v : rhs) {
+            v *= 1.0 + 1e-3 * NumberHelpers::fRand11<double>::rnd();
+        }
+        warmSolver.setZeroInitial(false);
+        REQUIRE(solve(x));
+        printf("PCG warm start (%s): %u iterations, %u from zero\n", bPrecond ? "MICCL0" : "no preconditioner", warmSolver.iterations(), coldIterations);
+        REQUIRE(trueResidual(fixedMatrix, rhs, x) < 2e-8 * ParallelSTL::maxAbs(rhs));
+        REQUIRE(warmSolver.iterations() < coldIterations);
+
+        // the initial guess is already the solution
+        REQUIRE(solve(x));
+        REQUIRE(warmSolver.iterations() == 0u);
+    }
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// AMG iteration counts should stay almost constant with the grid resolution, standalone AMG and PCG + AMG must reach
+// the requested residual and agree with the PCG + MICCL0 solution
+#define AMG_TEST_TOLERANCE 1e-6
+
+TEST_CASE("Test_AMG", "[Test_AMG]")
+{
+    UInt firstIterations = 0;
+    for(UInt res : { 16u, 32u, UInt(TEST_GRID_RES) }) {
+        SparseMatrix<double> matrix;
+        generatePoissonMatrix(matrix, res);
+        StdVT<double> rhs(matrix.nRows), result, reference;
+        for(auto& v : rhs) {
+            v = NumberHelpers::fRand11<double>::rnd();
+        }
+        const double tolerance = AMG_TEST_TOLERANCE * ParallelSTL::maxAbs(rhs);
+
+        FixedSparseMatrix<double> fixedMatrix;
+        fixedMatrix.constructFromSparseMatrix(matrix);
+        auto requireSolution = [&](const StdVT<double>& x) {
+                                   REQUIRE(trueResidual(fixedMatrix, rhs, x) < tolerance);
+                                   REQUIRE(ParallelSTL::maxAbs(ParallelBLAS::minus(x, reference)) < 1e-4 * ParallelSTL::maxAbs(reference));
+                               };
+
+        for(auto precond : { PCGSolver<double>::MICCL0, PCGSolver<double>::AMG }) {
+            PCGSolver<double> solver;
+            solver.setSolverParameters(AMG_TEST_TOLERANCE, 1000);
+            solver.setPreconditioners(precond);
+            Timer timer;
+            timer.tick();
+            REQUIRE(solver.solve_precond(matrix, rhs, result));
+            auto time = timer.tock();
+            printf("PCG (%s, %u rows): %u iterations, time = %sms\n", precond == PCGSolver<double>::AMG ? "AMG" : "MICCL0",
+                   matrix.nRows, solver.iterations(), Formatters::toString(time).c_str());
+            if(precond == PCGSolver<double>::MICCL0) {
+                REQUIRE(trueResidual(fixedMatrix, rhs, result) < tolerance);
+                reference = result;
+            } else {
+                requireSolution(result);
+                if(firstIterations == 0) {
+                    firstIterations = solver.iterations();
+                }
+                REQUIRE(solver.iterations() <= 2u * firstIterations);
+            }
+        }
+
+        for(auto smoother : { AMGSolver<double>::JACOBI, AMGSolver<double>::CHEBYSHEV }) {
+            AMGSolver<double> amg;
+            amg.setSmoother(smoother);
+            amg.setSolverParameters(AMG_TEST_TOLERANCE, 100);
+            Timer timer;
+            timer.tick();
+            amg.setup(fixedMatrix);
+            auto setupTime = timer.tock();
+            timer.tick();
+            REQUIRE(amg.solve(rhs, result));
+            auto solveTime = timer.tock();
+            printf("AMG (%s smoother, %u rows): %u levels, operator complexity = %s, %u V-cycles, setup = %sms, solve = %sms\n",
+                   smoother == AMGSolver<double>::JACOBI ? "Jacobi" : "Chebyshev", matrix.nRows, amg.numLevels(),
+                   Formatters::toString(amg.operatorComplexity()).c_str(), amg.iterations(),
+                   Formatters::toString(setupTime).c_str(), Formatters::toString(solveTime).c_str());
+            REQUIRE(amg.residual() < tolerance);
+            requireSolution(result);
+        }
+    }
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// 3D vector Poisson-like system with coupled components: 7-point stencil of 3x3 blocks, diagonal 6 * B, off-diagonal -B,
+// B = 0.9 * I + 0.1 * ones, plus a small mass term
+TEST_CASE("Test_BlockPCG", "[Test_BlockPCG]")
+{
+    Mat3x3<double> B(0.1);
+    for(Int d = 0; d < 3; ++d) {
+        B[d][d] = 1.0;
+    }
+    auto assemble = [&](UInt res, double scale, BlockSparseMatrix<Mat3x3<double>>& matrix, StdVT<Vec3<double>>& rhs) {
+                        const auto idx = [res](UInt i, UInt j, UInt k) { return (k * res + j) * res + i; };
+                        matrix.resize(res * res * res);
+                        rhs.resize(matrix.size());
+                        for(UInt k = 0; k < res; ++k) {
+                            for(UInt j = 0; j < res; ++j) {
+                                for(UInt i = 0; i < res; ++i) {
+                                    const auto row = idx(i, j, k);
+                                    matrix.setElement(row, row, scale * (B * 6.0 + Mat3x3<double>(1e-3)));
+                                    if(i > 0) { matrix.setElement(row, idx(i - 1, j, k), -scale * B); }
+                                    if(j > 0) { matrix.setElement(row, idx(i, j - 1, k), -scale * B); }
+                                    if(k > 0) { matrix.setElement(row, idx(i, j, k - 1), -scale * B); }
+                                    if(i + 1 < res) { matrix.setElement(row, idx(i + 1, j, k), -scale * B); }
+                                    if(j + 1 < res) { matrix.setElement(row, idx(i, j + 1, k), -scale * B); }
+                                    if(k + 1 < res) { matrix.setElement(row, idx(i, j, k + 1), -scale * B); }
+                                    for(Int d = 0; d < 3; ++d) {
+                                        rhs[row][d] = NumberHelpers::frandhash11<double>(row * 3u + d);
+                                    }
+                                }
+                            }
+                        }
+                    };
+    BlockSparseMatrix<Mat3x3<double>> matrix;
+    StdVT<Vec3<double>>               rhs;
+    assemble(32u, 1.0, matrix, rhs);
+
+    StdVT<Vec3<double>> jacobiResult;
+    UInt                jacobiIterations = 0;
+    for(auto precond : { BlockPCGSolver<3, double>::JACOBI, BlockPCGSolver<3, double>::BLOCK_ICC0, BlockPCGSolver<3, double>::AMG }) {
+        BlockPCGSolver<3, double> solver;
+        StdVT<Vec3<double>>       result(matrix.size());
+        solver.setSolverParameters(1e-8, 2000);
+        solver.setPreconditioners(precond);
+        Timer timer;
+        timer.tick();
+        REQUIRE(solver.solve_precond(matrix, rhs, result));
+        auto time = timer.tock();
+        printf("BlockPCG (%s, %u blocks): %u iterations, time = %sms\n",
+               precond == BlockPCGSolver<3, double>::JACOBI ? "Jacobi" : (precond == BlockPCGSolver<3, double>::AMG ? "AMG" : "Block IC(0)"),
+               matrix.size(), solver.iterations(), Formatters::toString(time).c_str());
+        if(precond == BlockPCGSolver<3, double>::JACOBI) {
+            jacobiIterations = solver.iterations();
+            jacobiResult     = result;
+        } else {
+            REQUIRE(solver.iterations() < jacobiIterations);
+            for(size_t i = 0; i < result.size(); ++i) {
+                REQUIRE(glm::length(result[i] - jacobiResult[i]) < 1e-5);
+            }
+        }
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // block IC(0) with cached pattern analysis: new values on the same pattern give bit-wise the same results as a new
+    // solver (with deterministic reductions), then a new pattern
+    ParallelExec::setDefaultReductionPolicy(ParallelExec::ReductionPolicy::Deterministic);
+    BlockPCGSolver<3, double> solver;
+    StdVT<Vec3<double>>       result(matrix.size());
+    solver.setSolverParameters(1e-8, 2000);
+    solver.setPreconditioners(BlockPCGSolver<3, double>::BLOCK_ICC0);
+    REQUIRE(solver.solve_precond(matrix, rhs, result));
+    const auto iterations = solver.iterations();
+    assemble(32u, 2.0, matrix, rhs);
+    REQUIRE(solver.solve_precond(matrix, rhs, result));
+    for(size_t i = 0; i < result.size(); ++i) {
+        REQUIRE(glm::length(2.0 * result[i] - jacobiResult[i]) < 1e-5);
+    }
+    {
+        BlockPCGSolver<3, double> freshSolver;
+        StdVT<Vec3<double>>       freshResult(matrix.size());
+        freshSolver.setSolverParameters(1e-8, 2000);
+        freshSolver.setPreconditioners(BlockPCGSolver<3, double>::BLOCK_ICC0);
+        REQUIRE(freshSolver.solve_precond(matrix, rhs, freshResult));
+        REQUIRE(solver.iterations() == freshSolver.iterations());
+        REQUIRE(result == freshResult);
+    }
+    ParallelExec::setDefaultReductionPolicy(ParallelExec::ReductionPolicy::Fast);
+    BlockSparseMatrix<Mat3x3<double>> smallMatrix;
+    assemble(16u, 1.0, smallMatrix, rhs);
+    result.resize(smallMatrix.size());
+    REQUIRE(solver.solve_precond(smallMatrix, rhs, result));
+    const auto smallIterations = solver.iterations();
+    REQUIRE(smallIterations < iterations);
+
+    // without pivot replacement (ratio 0) the factorization is plain block IC(0), the matrix is an M-matrix thus it converges
+    solver.setSolverParameters(1e-8, 2000, 0.0);
+    REQUIRE(solver.solve_precond(smallMatrix, rhs, result));
+    REQUIRE(solver.iterations() <= smallIterations + 2u);
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// Matrix-free versions of the systems above: the operators compute the stencil sums on the fly
+template<class Real_t>
+class PoissonOperator : public LinearOperator<Real_t> {
+public:
+    explicit PoissonOperator(UInt res) : m_Res(res) {}
+    UInt size() const override { return m_Res * m_Res * m_Res; }
+    bool hasDiagonal() const override { return true; }
+    void computeDiagonal(StdVT<Real_t>& diag) const override { diag.assign(size(), Real_t(6)); }
+    void multiply(const StdVT<Real_t>& x, StdVT<Real_t>& result) const override {
+        const UInt res = m_Res;
+        ParallelExec::run(size(),
+                          [&](UInt node) {
+                              const UInt i   = node % res, j = (node / res) % res, k = node / (res * res);
+                              Real_t     sum = Real_t(6) * x[node];
+                              if(i > 0) { sum -= x[node - 1]; }
+                              if(i + 1 < res) { sum -= x[node + 1]; }
+                              if(j > 0) { sum -= x[node - res]; }
+                              if(j + 1 < res) { sum -= x[node + res]; }
+                              if(k > 0) { sum -= x[node - res * res]; }
+                              if(k + 1 < res) { sum -= x[node + res * res]; }
+                              result[node] = sum;
+                          });
+    }
+
+private:
+    UInt m_Res;
+};
+
+class CoupledBlockOperator : public BlockLinearOperator<3, double> {
+public:
+    CoupledBlockOperator(UInt res, const Mat3x3<double>& B) : m_Res(res), m_B(B) {}
+    UInt size() const override { return m_Res * m_Res * m_Res; }
+    bool hasDiagonal() const override { return true; }
+    void computeDiagonal(StdVT<Mat3x3<double>>& diagBlocks) const override { diagBlocks.assign(size(), m_B * 6.0 + Mat3x3<double>(1e-3)); }
+    void multiply(const StdVT<Vec3<double>>& x, StdVT<Vec3<double>>& result) const override {
+        const UInt res = m_Res;
+        ParallelExec::run(size(),
+                          [&](UInt node) {
+                              const UInt   i   = node % res, j = (node / res) % res, k = node / (res * res);
+                              Vec3<double> sum = x[node] * 6.0;
+                              if(i > 0) { sum -= x[node - 1]; }
+                              if(i + 1 < res) { sum -= x[node + 1]; }
+                              if(j > 0) { sum -= x[node - res]; }
+                              if(j + 1 < res) { sum -= x[node + res]; }
+                              if(k > 0) { sum -= x[node - res * res]; }
+                              if(k + 1 < res) { sum -= x[node + res * res]; }
+                              result[node] = m_B * sum + Mat3x3<double>(1e-3) * x[node];
+                          });
+    }
+
+private:
+    UInt           m_Res;
+    Mat3x3<double> m_B;
+};
+
+TEST_CASE("Test_MatrixFree", "[Test_MatrixFree]")
+{
+    {
+        SparseMatrix<double> matrix;
+        generatePoissonMatrix(matrix, TEST_GRID_RES);
+        PoissonOperator<double> op(TEST_GRID_RES);
+        StdVT<double>           rhs(matrix.nRows), assembledResult, result;
+        for(auto& v : rhs) {
+            v = NumberHelpers::fRand11<double>::rnd();
+        }
+
+        PCGSolver<double> solver;
+        solver.setSolverParameters(1e-6, 1000);
+        solver.setPreconditioners(PCGSolver<double>::JACOBI);
+        Timer timer;
+        timer.tick();
+        REQUIRE(solver.solve_precond(matrix, rhs, assembledResult));
+        auto       assembledTime       = timer.tock();
+        const auto assembledIterations = solver.iterations();
+        timer.tick();
+        REQUIRE(solver.solve_precond(op, rhs, result));
+        auto time = timer.tock();
+        printf("PCG (Jacobi, %u rows): assembled %u iterations, %sms; matrix-free %u iterations, %sms\n", op.size(),
+               assembledIterations, Formatters::toString(assembledTime).c_str(), solver.iterations(), Formatters::toString(time).c_str());
+        REQUIRE(solver.iterations() == assembledIterations);
+        REQUIRE(ParallelSTL::maxAbs(ParallelBLAS::minus(result, assembledResult)) < 1e-8 * ParallelSTL::maxAbs(assembledResult));
+
+        REQUIRE(solver.solve(op, rhs, result));
+        REQUIRE(ParallelSTL::maxAbs(ParallelBLAS::minus(result, assembledResult)) < 1e-5 * ParallelSTL::maxAbs(assembledResult));
+
+        // with an initial guess, the tolerance is still relative to the right hand side: a converged guess needs no iteration,
+        // a partially converged one is solved to the same true residual
+        solver.disableZeroInitial();
+        REQUIRE(solver.solve_precond(op, rhs, result));
+        REQUIRE(solver.iterations() == 0u);
+        ParallelBLAS::scale(0.5, result);
+        REQUIRE(solver.solve_precond(op, rhs, result));
+        REQUIRE(solver.iterations() > 0u);
+        StdVT<double> Ax(op.size());
+        op.multiply(result, Ax);
+        REQUIRE(ParallelSTL::maxAbs(ParallelBLAS::minus(rhs, Ax)) < 1.01e-6 * ParallelSTL::maxAbs(rhs));
+    }
+
+    {
+        constexpr UInt res = 16u;
+        Mat3x3<double> B(0.1);
+        for(Int d = 0; d < 3; ++d) {
+            B[d][d] = 1.0;
+        }
+        CoupledBlockOperator              op(res, B);
+        BlockSparseMatrix<Mat3x3<double>> matrix(op.size());
+        StdVT<Vec3<double>>               rhs(op.size()), assembledResult(op.size()), result(op.size());
+        for(UInt node = 0; node < op.size(); ++node) {
+            const UInt i = node % res, j = (node / res) % res, k = node / (res * res);
+            matrix.setElement(node, node, B * 6.0 + Mat3x3<double>(1e-3));
+            if(i > 0) { matrix.setElement(node, node - 1, -B); }
+            if(i + 1 < res) { matrix.setElement(node, node + 1, -B); }
+            if(j > 0) { matrix.setElement(node, node - res, -B); }
+            if(j + 1 < res) { matrix.setElement(node, node + res, -B); }
+            if(k > 0) { matrix.setElement(node, node - res * res, -B); }
+            if(k + 1 < res) { matrix.setElement(node, node + res * res, -B); }
+            for(Int d = 0; d < 3; ++d) {
+                rhs[node][d] = NumberHelpers::fRand11<double>::rnd();
+            }
+        }
+
+        BlockPCGSolver<3, double> solver;
+        solver.setSolverParameters(1e-8, 2000);
+        REQUIRE(solver.solve_precond(matrix, rhs, assembledResult));
+        const auto assembledIterations = solver.iterations();
+        REQUIRE(solver.solve_precond(op, rhs, result));
+        printf("BlockPCG (Jacobi, %u blocks): assembled %u iterations, matrix-free %u iterations\n", op.size(), assembledIterations, solver.iterations());
+        REQUIRE(solver.iterations() == assembledIterations);
+        for(UInt i = 0; i < op.size(); ++i) {
+            REQUIRE(glm::length(result[i] - assembledResult[i]) < 1e-8);
+        }
+    }
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// Pressure Poisson equation on a res.x * res.y * res.z grid: air at the top, a solid sphere in the middle, solid walls
+// The matrix-free geometric multigrid solver is compared with PCG on the assembled matrix
+template<class Real_t>
+void testGeometricMG(const Vec3ui& res) {
+    using MGSolver = GeometricMGSolver<Real_t>;
+    Array3c        cellTypes { Vec3<size_t>(res) };
+    Array3<Real_t> rhs { Vec3<size_t>(res) }, result;
+    ParallelExec::run(0u, res.x, 0u, res.y, 0u, res.z,
+                      [&](UInt i, UInt j, UInt k) {
+                          const auto center = Vec3<Real_t>(res) * Real_t(0.5);
+                          const auto pos    = Vec3<Real_t>(i, j, k) + Vec3<Real_t>(0.5);
+                          if(j >= res.y * 3u / 4u) {
+                              cellTypes(i, j, k) = MGSolver::Air;
+                          } else if(glm::length(pos - center) < Real_t(glm::compMin(res)) * Real_t(0.2)) {
+                              cellTypes(i, j, k) = MGSolver::Solid;
+                          } else {
+                              cellTypes(i, j, k) = MGSolver::Fluid;
+                          }
+                          rhs(i, j, k) = NumberHelpers::frandhash11<Real_t>(rhs.getFlatIndex(i, j, k));
+                      });
+
+    MGSolver solver;
+    solver.setSolverParameters(std::is_same_v<Real_t, float> ? Real_t(1e-5) : Real_t(1e-6), 200); // solveMG checks the true residual
+    Timer timer;
+    timer.tick();
+    solver.setup(cellTypes);
+    auto setupTime = timer.tock();
+    timer.tick();
+    REQUIRE(solver.solve(rhs, result));
+    auto solveTime = timer.tock();
+    REQUIRE(solver.iterations() < 20u); // h-independent convergence, also on the semi-coarsened grids
+    printf("MGPCG (%s, %ux%ux%u): %u levels, %u iterations, residual = %s, setup = %sms, solve = %sms\n",
+           NumberHelpers::nameRealT<Real_t>().c_str(), res.x, res.y, res.z, solver.numLevels(), solver.iterations(),
+           Formatters::toSciString(solver.residual()).c_str(), Formatters::toString(setupTime).c_str(), Formatters::toString(solveTime).c_str());
+
+    Array3<Real_t> resultMG;
+    timer.tick();
+    REQUIRE(solver.solveMG(rhs, resultMG));
+    solveTime = timer.tock();
+    printf("MG    (%s, %ux%ux%u): %u V-cycles, solve = %sms\n", NumberHelpers::nameRealT<Real_t>().c_str(), res.x, res.y, res.z,
+           solver.iterations(),
+           Formatters::toString(solveTime).c_str());
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // assemble the same equation
+    if(glm::compMax(res) > TEST_GRID_RES) {
+        return;
+    }
+    StdVT_UInt fluidIdx(cellTypes.dataSize(), 0);
+    UInt       nFluid = 0;
+    for(size_t idx = 0; idx < cellTypes.dataSize(); ++idx) {
+        if(cellTypes.flatData(idx) == MGSolver::Fluid) {
+            fluidIdx[idx] = nFluid++;
+        }
+    }
+    SparseMatrix<Real_t> matrix(nFluid);
+    StdVT<Real_t>        assembledRhs(nFluid), assembledResult;
+    timer.tick();
+    ParallelExec::run(0u, res.x, 0u, res.y, 0u, res.z,
+                      [&](UInt i, UInt j, UInt k) {
+                          if(cellTypes(i, j, k) != MGSolver::Fluid) {
+                              return;
+                          }
+                          const auto row  = fluidIdx[cellTypes.getFlatIndex(i, j, k)];
+                          Real_t     diag = 0;
+                          auto       add  = [&](Int ii, Int jj, Int kk) {
+                                                if(ii < 0 || jj < 0 || kk < 0 || ii >= Int(res.x) || jj >= Int(res.y) || kk >= Int(res.z) ||
+                                                   cellTypes(ii, jj, kk) == MGSolver::Solid) {
+                                                    return;
+                                                }
+                                                diag += Real_t(1);
+                                                if(cellTypes(ii, jj, kk) == MGSolver::Fluid) {
+                                                    matrix.addElement(row, fluidIdx[cellTypes.getFlatIndex(ii, jj, kk)], Real_t(-1));
+                                                }
+                                            };
+                          add(Int(i) - 1, j, k); add(Int(i) + 1, j, k);
+                          add(i, Int(j) - 1, k); add(i, Int(j) + 1, k);
+                          add(i, j, Int(k) - 1); add(i, j, Int(k) + 1);
+                          matrix.addElement(row, row, diag);
+                          assembledRhs[row] = rhs(i, j, k);
+                      });
+    PCGSolver<Real_t> pcg;
+    pcg.setSolverParameters(Real_t(1e-6), 1000);
+    REQUIRE(pcg.solve_precond(matrix, assembledRhs, assembledResult));
+    auto pcgTime = timer.tock();
+    printf("PCG   (%s, %ux%ux%u, MICCL0): %u iterations, assembly + solve = %sms\n", NumberHelpers::nameRealT<Real_t>().c_str(),
+           res.x, res.y, res.z,
+           pcg.iterations(), Formatters::toString(pcgTime).c_str());
+
+    const auto maxVal = ParallelSTL::maxAbs(assembledResult);
+    for(size_t idx = 0; idx < cellTypes.dataSize(); ++idx) {
+        if(cellTypes.flatData(idx) == MGSolver::Fluid) {
+            REQUIRE(std::abs(result.flatData(idx) - assembledResult[fluidIdx[idx]]) < Real_t(1e-3) * maxVal);
+            REQUIRE(std::abs(resultMG.flatData(idx) - assembledResult[fluidIdx[idx]]) < Real_t(1e-3) * maxVal);
+        }
+    }
+}
+
+TEST_CASE("Test_GeometricMG", "[Test_GeometricMG]")
+{
+    for(UInt res : { 32u, UInt(TEST_GRID_RES), 2u * TEST_GRID_RES }) {
+        testGeometricMG<float>(Vec3ui(res));
+        testGeometricMG<double>(Vec3ui(res));
+    }
+    ////////////////////////////////////////////////////////////////////////////////
+    // flat and elongated grids are semi-coarsened down to the coarsest resolution
+    for(const auto& res : { Vec3ui(TEST_GRID_RES, TEST_GRID_RES, 8u), Vec3ui(TEST_GRID_RES, 16u, 16u), Vec3ui(16u, TEST_GRID_RES, 4u * TEST_GRID_RES) }) {
+        testGeometricMG<float>(res);
+        testGeometricMG<double>(res);
+    }
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// Batched SVD and polar decomposition against the single matrix versions, on random matrices (a count that is not a
+// multiple of the SIMD width) plus the zero and the all-ones (rank 1) matrices
+#define SVD_TEST_NUM 100'003
+
+template<class T>
+T maxAbsEntry(const Mat3x3<T>& M) {
+    return glm::compMax(glm::max(glm::max(glm::abs(M[0]), glm::abs(M[1])), glm::abs(M[2])));
+}
+
+template<class T>
+void testBatchedSVD(T tolerance) {
+    StdVT<Mat3x3<T>> tests(SVD_TEST_NUM);
+    for(auto& A : tests) {
+        for(Int c = 0; c < 3; ++c) {
+            for(Int r = 0; r < 3; ++r) {
+                A[c][r] = T(3) * NumberHelpers::fRand11<T>::rnd();
+            }
+        }
+    }
+    tests.push_back(Mat3x3<T>(0));
+    tests.push_back(Mat3x3<T>(1));
+
+    StdVT<Mat3x3<T>> UU, VV, RR, SS_Sym;
+    StdVT<Vec3<T>>   SS;
+    Timer            timer;
+    timer.tick();
+    QRSVD::svd(tests, UU, SS, VV);
+    auto batchedTime = timer.tock();
+    timer.tick();
+    QRSVD::polarDecomposition(tests, RR, SS_Sym);
+    auto polarTime = timer.tock();
+    timer.tick();
+    for(const auto& A : tests) {
+        volatile auto sigma0 = std::get<1>(QRSVD::svd(A))[0];
+        (void)sigma0;
+    }
+    auto scalarTime = timer.tock();
+    printf("SVD (%s, %zu matrices): batched = %sms, batched polar = %sms, single matrix (serial) = %sms\n",
+           NumberHelpers::nameRealT<T>().c_str(), tests.size(), Formatters::toString(batchedTime).c_str(),
+           Formatters::toString(polarTime).c_str(), Formatters::toString(scalarTime).c_str());
+
+    for(size_t i = 0; i < tests.size(); ++i) {
+        const auto [U, S, V] = QRSVD::svd(tests[i]);
+        const T scale        = std::max(std::abs(S[0]), T(1));
+        Mat3x3<T>  Sigma(0);
+        for(Int d = 0; d < 3; ++d) {
+            Sigma[d][d] = SS[i][d];
+        }
+        REQUIRE(glm::compMax(glm::abs(SS[i] - S)) < tolerance * scale);
+        REQUIRE(maxAbsEntry(Mat3x3<T>(UU[i] * Sigma * glm::transpose(VV[i]) - tests[i])) < tolerance * scale);
+        REQUIRE(maxAbsEntry(Mat3x3<T>(UU[i] * glm::transpose(UU[i]) - Mat3x3<T>(1))) < tolerance);
+        REQUIRE(maxAbsEntry(Mat3x3<T>(VV[i] * glm::transpose(VV[i]) - Mat3x3<T>(1))) < tolerance);
+        REQUIRE(std::abs(glm::determinant(UU[i]) - T(1)) < tolerance);
+        REQUIRE(std::abs(glm::determinant(VV[i]) - T(1)) < tolerance);
+        REQUIRE(maxAbsEntry(Mat3x3<T>(RR[i] * SS_Sym[i] - tests[i])) < tolerance * scale);
+        REQUIRE(maxAbsEntry(Mat3x3<T>(SS_Sym[i] - glm::transpose(SS_Sym[i]))) < tolerance * scale);
+    }
+}
+
+TEST_CASE("Test_BatchedSVD", "[Test_BatchedSVD]")
+{
+    // otherwise only the scalar fallback (the single matrix versions) would be tested
+    INFO("The batched SVD is not vectorized: build with -march=native (or -mavx2) or /arch:AVX2");
+    REQUIRE(QRSVD::bBatchedVectorized<float>);
+    REQUIRE(QRSVD::bBatchedVectorized<double>);
+    testBatchedSVD<float>(1e-4f);
+    testBatchedSVD<double>(1e-8);
+}
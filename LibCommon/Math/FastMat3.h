@@ -22,7 +22,10 @@ namespace NTCodeBase {
 template<class T>
 class FastMat3 {
 public:
-    inline FastMat3() { static_assert(sizeof(T) == sizeof(float) && alignof(FastMat3<T>) == 16, "Error: Size or alignment is not correct!"); }
+    inline FastMat3() {
+        static_assert(sizeof(T) == sizeof(float), "Error: FastMat3<double> needs AVX2 (-march=native or /arch:AVX2)!");
+        static_assert(alignof(FastMat3<T>) == 16, "Error: Size or alignment is not correct!");
+    }
     inline FastMat3(__m128 c0, __m128 c1, __m128 c2) : col{{ c0 }, { c1 }, { c2 }} {}
     inline FastMat3(T x) : col{FastVec3<T>(x, T(0), T(0)), FastVec3<T>(T(0), x, T(0)), FastVec3<T>(T(0), T(0), x)} {}
     inline FastMat3(const Mat3x3<T>& m) : col{{ m[0] }, { m[1] }, { m[2] }} {}
@@ -237,5 +240,173 @@ public:
     // member variable
     FastVec3<T> col[3];
 };
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// Double precision version, columns are FastVec3<double> (__m256d)
+// Compiled in all default builds, which enable AVX2 (see FastVec3<double>)
+#if defined(__AVX2__)
+template<>
+class FastMat3<double> {
+    using T = double;
+public:
+    inline FastMat3() { static_assert(alignof(FastMat3<T>) == 32, "Error: Size or alignment is not correct!"); }
+    inline FastMat3(__m256d c0, __m256d c1, __m256d c2) : col{{ c0 }, { c1 }, { c2 }} {}
+    inline FastMat3(T x) : col{FastVec3<T>(x, T(0), T(0)), FastVec3<T>(T(0), x, T(0)), FastVec3<T>(T(0), T(0), x)} {}
+    inline FastMat3(const Mat3x3<T>& m) : col{{ m[0] }, { m[1] }, { m[2] }} {}
+    inline FastMat3(const FastMat3<T>& other) : col{{ other.col[0] }, { other.col[1] }, { other.col[2] }} {}
+    inline FastMat3(const FastVec3<T>& c0, const FastVec3<T>& c1, const FastVec3<T>& c2) : col{{ c0 }, { c1 }, { c2 }} {}
+    ////////////////////////////////////////////////////////////////////////////////
+    inline FastMat3<T>& operator=(const FastMat3<T>& other) { col[0] = other.col[0]; col[1] = other.col[1]; col[2] = other.col[2]; return *this; }
+    inline FastMat3<T>& operator=(const Mat3x3<T>& other) { col[0] = other[0]; col[1] = other[1]; col[2] = other[2]; return *this; }
+    inline operator Mat3x3<T>() const { return Mat3x3<T>(col[0], col[1], col[2]); }
+    inline void copyToMat3x3r(Mat3x3<T>& m) const { m[0] = col[0].v3; m[1] = col[1].v3; m[2] = col[2].v3; }
+    ////////////////////////////////////////////////////////////////////////////////
+    /// Arithmetic operators with FastMat3
+    inline FastMat3<T> operator+(const FastMat3<T>& B) const {
+        return FastMat3<T>(_mm256_add_pd(col[0].mmvalue, B.col[0].mmvalue),
+                           _mm256_add_pd(col[1].mmvalue, B.col[1].mmvalue),
+                           _mm256_add_pd(col[2].mmvalue, B.col[2].mmvalue));
+    }
+
+    inline FastMat3<T> operator-(const FastMat3<T>& B) const {
+        return FastMat3<T>(_mm256_sub_pd(col[0].mmvalue, B.col[0].mmvalue),
+                           _mm256_sub_pd(col[1].mmvalue, B.col[1].mmvalue),
+                           _mm256_sub_pd(col[2].mmvalue, B.col[2].mmvalue));
+    }
+
+    inline FastVec3<T> operator*(const FastVec3<T>& v) const { return multiply(v.mmvalue); }
+    inline FastMat3<T> operator*(const FastMat3<T>& B) const {
+        return FastMat3<T>(multiply(B.col[0].mmvalue), multiply(B.col[1].mmvalue), multiply(B.col[2].mmvalue));
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+    inline FastMat3<T>& operator+=(const FastMat3<T>& B) {
+        col[0].mmvalue = _mm256_add_pd(col[0].mmvalue, B.col[0].mmvalue);
+        col[1].mmvalue = _mm256_add_pd(col[1].mmvalue, B.col[1].mmvalue);
+        col[2].mmvalue = _mm256_add_pd(col[2].mmvalue, B.col[2].mmvalue);
+        return *this;
+    }
+
+    inline FastMat3<T>& operator-=(const FastMat3<T>& B) {
+        col[0].mmvalue = _mm256_sub_pd(col[0].mmvalue, B.col[0].mmvalue);
+        col[1].mmvalue = _mm256_sub_pd(col[1].mmvalue, B.col[1].mmvalue);
+        col[2].mmvalue = _mm256_sub_pd(col[2].mmvalue, B.col[2].mmvalue);
+        return *this;
+    }
+
+    inline FastMat3<T>& operator*=(const FastMat3<T>& B) {
+        const __m256d col0m = multiply(B.col[0].mmvalue);
+        const __m256d col1m = multiply(B.col[1].mmvalue);
+        const __m256d col2m = multiply(B.col[2].mmvalue);
+        col[0].mmvalue = col0m;
+        col[1].mmvalue = col1m;
+        col[2].mmvalue = col2m;
+        return *this;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+    inline FastMat3<T> operator+(T a) const {
+        return FastMat3<T>(_mm256_add_pd(col[0].mmvalue, _mm256_set1_pd(a)),
+                           _mm256_add_pd(col[1].mmvalue, _mm256_set1_pd(a)),
+                           _mm256_add_pd(col[2].mmvalue, _mm256_set1_pd(a)));
+    }
+
+    inline FastMat3<T> operator-(T a) const {
+        return FastMat3<T>(_mm256_sub_pd(col[0].mmvalue, _mm256_set1_pd(a)),
+                           _mm256_sub_pd(col[1].mmvalue, _mm256_set1_pd(a)),
+                           _mm256_sub_pd(col[2].mmvalue, _mm256_set1_pd(a)));
+    }
+
+    inline FastMat3<T> operator*(T a) const {
+        return FastMat3<T>(_mm256_mul_pd(col[0].mmvalue, _mm256_set1_pd(a)),
+                           _mm256_mul_pd(col[1].mmvalue, _mm256_set1_pd(a)),
+                           _mm256_mul_pd(col[2].mmvalue, _mm256_set1_pd(a)));
+    }
+
+    inline FastMat3<T> operator/(T a) const {
+        assert(a != 0);
+        return FastMat3<T>(_mm256_div_pd(col[0].mmvalue, _mm256_set1_pd(a)),
+                           _mm256_div_pd(col[1].mmvalue, _mm256_set1_pd(a)),
+                           _mm256_div_pd(col[2].mmvalue, _mm256_set1_pd(a)));
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+    inline FastMat3<T>& operator+=(T a) {
+        col[0].mmvalue = _mm256_add_pd(col[0].mmvalue, _mm256_set1_pd(a));
+        col[1].mmvalue = _mm256_add_pd(col[1].mmvalue, _mm256_set1_pd(a));
+        col[2].mmvalue = _mm256_add_pd(col[2].mmvalue, _mm256_set1_pd(a));
+        return *this;
+    }
+
+    inline FastMat3<T>& operator-=(T a) {
+        col[0].mmvalue = _mm256_sub_pd(col[0].mmvalue, _mm256_set1_pd(a));
+        col[1].mmvalue = _mm256_sub_pd(col[1].mmvalue, _mm256_set1_pd(a));
+        col[2].mmvalue = _mm256_sub_pd(col[2].mmvalue, _mm256_set1_pd(a));
+        return *this;
+    }
+
+    inline FastMat3<T>& operator*=(T a) {
+        col[0].mmvalue = _mm256_mul_pd(col[0].mmvalue, _mm256_set1_pd(a));
+        col[1].mmvalue = _mm256_mul_pd(col[1].mmvalue, _mm256_set1_pd(a));
+        col[2].mmvalue = _mm256_mul_pd(col[2].mmvalue, _mm256_set1_pd(a));
+        return *this;
+    }
+
+    inline FastMat3<T>& operator/=(T a) {
+        assert(a != 0);
+        col[0].mmvalue = _mm256_div_pd(col[0].mmvalue, _mm256_set1_pd(a));
+        col[1].mmvalue = _mm256_div_pd(col[1].mmvalue, _mm256_set1_pd(a));
+        col[2].mmvalue = _mm256_div_pd(col[2].mmvalue, _mm256_set1_pd(a));
+        return *this;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // geometric functions
+    inline FastMat3<T> transposed() const {
+        const __m256d zero = _mm256_setzero_pd();
+        const __m256d t0   = _mm256_unpacklo_pd(col[0].mmvalue, col[1].mmvalue); // (c0.x, c1.x, c0.z, c1.z)
+        const __m256d t1   = _mm256_unpackhi_pd(col[0].mmvalue, col[1].mmvalue); // (c0.y, c1.y, c0.w, c1.w)
+        const __m256d t2   = _mm256_unpacklo_pd(col[2].mmvalue, zero);           // (c2.x, 0, c2.z, 0)
+        const __m256d t3   = _mm256_unpackhi_pd(col[2].mmvalue, zero);           // (c2.y, 0, c2.w, 0)
+        return FastMat3<T>(_mm256_permute2f128_pd(t0, t2, 0x20),
+                           _mm256_permute2f128_pd(t1, t3, 0x20),
+                           _mm256_permute2f128_pd(t0, t2, 0x31));
+    }
+
+    inline T norm2() const { return col[0].norm2() + col[1].norm2() + col[2].norm2(); }
+    inline T norm() const { return std::sqrt(norm2()); }
+    ////////////////////////////////////////////////////////////////////////////////
+    inline bool operator==(const FastMat3<T>& B) const { return col[0] == B.col[0] && col[1] == B.col[1] && col[2] == B.col[2]; }
+    inline bool operator!=(const FastMat3<T>& B) const { return !(*this == B); }
+    inline FastMat3<T> operator-() const { return FastMat3<T>(-col[0], -col[1], -col[2]); }
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // accessor
+    template<class IndexType> inline const FastVec3<T>& operator[](const IndexType i) const { assert(i < 4); return col[i]; }
+    template<class IndexType> inline FastVec3<T>& operator[](const IndexType i) { assert(i < 4); return col[i]; }
+    ////////////////////////////////////////////////////////////////////////////////
+    // member variable
+    FastVec3<T> col[3];
+private:
+    // M * v = col[0] * v.x + col[1] * v.y + col[2] * v.z
+    inline __m256d multiply(__m256d v) const {
+        const __m256d m0 = _mm256_mul_pd(col[0].mmvalue, _mm256_permute4x64_pd(v, _MM_SHUFFLE(0, 0, 0, 0)));
+        const __m256d m1 = _mm256_mul_pd(col[1].mmvalue, _mm256_permute4x64_pd(v, _MM_SHUFFLE(1, 1, 1, 1)));
+        const __m256d m2 = _mm256_mul_pd(col[2].mmvalue, _mm256_permute4x64_pd(v, _MM_SHUFFLE(2, 2, 2, 2)));
+        return _mm256_add_pd(_mm256_add_pd(m0, m1), m2);
+    }
+};
+#endif
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// One matrix times 4 vectors: the columns are broadcast to the 4 lanes, the vector components are splat within each lane
+#if defined(__AVX512F__)
+inline FastVec3x4 operator*(const FastMat3<float>& M, const FastVec3x4& v) {
+    const __m512 m0 = _mm512_mul_ps(_mm512_broadcast_f32x4(M.col[0].mmvalue), _mm512_permute_ps(v.mmvalue, _MM_SHUFFLE(0, 0, 0, 0)));
+    const __m512 m1 = _mm512_mul_ps(_mm512_broadcast_f32x4(M.col[1].mmvalue), _mm512_permute_ps(v.mmvalue, _MM_SHUFFLE(1, 1, 1, 1)));
+    const __m512 m2 = _mm512_mul_ps(_mm512_broadcast_f32x4(M.col[2].mmvalue), _mm512_permute_ps(v.mmvalue, _MM_SHUFFLE(2, 2, 2, 2)));
+    return _mm512_add_ps(_mm512_add_ps(m0, m1), m2);
+}
+#endif
+
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 } // end namespace NTCodeBase
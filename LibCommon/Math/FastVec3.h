@@ -16,6 +16,9 @@
 
 #include <cassert>
 #include <smmintrin.h>
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
 #include <LibCommon/MathTypes.h>
 #include <LibCommon/CommonMacros.h>
 
@@ -25,7 +28,10 @@ namespace NTCodeBase {
 template<class T>
 class NT_ALIGN16 FastVec3 {
 public:
-    inline FastVec3() { static_assert(sizeof(T) == sizeof(float) && alignof(FastVec3<T>) == 16, "Error: Size or alignment is not correct!"); }
+    inline FastVec3() {
+        static_assert(sizeof(T) == sizeof(float), "Error: FastVec3<double> needs AVX2 (-march=native or /arch:AVX2)!");
+        static_assert(alignof(FastVec3<T>) == 16, "Error: Size or alignment is not correct!");
+    }
     inline FastVec3(__m128 mval) : mmvalue(mval) {}
     inline FastVec3(T x) : mmvalue(_mm_set1_ps(x)) {}
     inline FastVec3(T x, T y, T z) : mmvalue(_mm_setr_ps(x, y, z, 1)) {}
@@ -109,13 +115,104 @@ private:
     inline static const __m128 s_SignMask = _mm_castsi128_ps(_mm_set1_epi32(0x80000000));
 };
 
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// Double precision version, 4 lanes of __m256d (requires AVX2 for the cross-lane permutations)
+// AVX2 is enabled in all default builds: -march=native in the Makefile and LibCommon.pri, /arch:AVX2 in LibCommon.pri (win32)
+// and EnableEnhancedInstructionSet = AdvancedVectorExtensions2 in all configurations of LibCommon.vcxproj.
+// Without AVX2, FastVec3<double> falls back to the generic template and fails to compile by its static_assert.
+#if defined(__AVX2__)
+template<>
+class NT_ALIGN32 FastVec3<double> {
+    using T = double;
+public:
+    inline FastVec3() { static_assert(alignof(FastVec3<T>) == 32, "Error: Size or alignment is not correct!"); }
+    inline FastVec3(__m256d mval) : mmvalue(mval) {}
+    inline FastVec3(T x) : mmvalue(_mm256_set1_pd(x)) {}
+    inline FastVec3(T x, T y, T z) : mmvalue(_mm256_setr_pd(x, y, z, 1)) {}
+    inline FastVec3(int x, int y, int z) : mmvalue(_mm256_cvtepi32_pd(_mm_setr_epi32(x, y, z, 1))) {}
+    inline FastVec3(unsigned int x, unsigned int y, unsigned int z) : mmvalue(_mm256_cvtepi32_pd(_mm_setr_epi32(x, y, z, 1))) { NT_DIE("Wrong"); }
+    inline FastVec3(const Vec2<T>& v) : mmvalue(_mm256_setr_pd(v.x, v.y, 0, 1)) {}
+    inline FastVec3(const Vec3<T>& v) : mmvalue(_mm256_setr_pd(v.x, v.y, v.z, 1)) {}
+    inline FastVec3(const Vec3i& vi) : mmvalue(_mm256_cvtepi32_pd(_mm_setr_epi32(vi.x, vi.y, vi.z, 1))) {}
+    inline FastVec3(const FastVec3<T>& other) : mmvalue(other.mmvalue) {}
+    ////////////////////////////////////////////////////////////////////////////////
+    inline FastVec3<T>& operator=(const FastVec3<T>& other) { mmvalue = other.mmvalue; return *this; }
+    inline FastVec3<T>& operator=(const Vec3<T>& v) { mmvalue = _mm256_setr_pd(v.x, v.y, v.z, 0); return *this; }
+    inline operator Vec3<T>() const { return v3; }
+    inline Vec3<T> toVec3r() const { return v3; }
+    inline Vec3i toVec3i() const {
+        NT_ALIGN16 int ival[4];
+        _mm_store_si128(reinterpret_cast<__m128i*>(ival), _mm256_cvttpd_epi32(mmvalue));
+        return Vec3i(ival[0], ival[1], ival[2]);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+    inline FastVec3<T> operator+(const FastVec3<T>& b) const { return _mm256_add_pd(mmvalue, b.mmvalue); }
+    inline FastVec3<T> operator-(const FastVec3<T>& b) const { return _mm256_sub_pd(mmvalue, b.mmvalue); }
+    inline FastVec3<T> operator*(const FastVec3<T>& b) const { return _mm256_mul_pd(mmvalue, b.mmvalue); }
+    inline FastVec3<T> operator/(const FastVec3<T>& b) const { return _mm256_div_pd(mmvalue, b.mmvalue); }
+
+    inline FastVec3<T>& operator+=(const FastVec3<T>& b) { mmvalue = _mm256_add_pd(mmvalue, b.mmvalue); return *this; }
+    inline FastVec3<T>& operator-=(const FastVec3<T>& b) { mmvalue = _mm256_sub_pd(mmvalue, b.mmvalue); return *this; }
+    inline FastVec3<T>& operator*=(const FastVec3<T>& b) { mmvalue = _mm256_mul_pd(mmvalue, b.mmvalue); return *this; }
+    inline FastVec3<T>& operator/=(const FastVec3<T>& b) { mmvalue = _mm256_div_pd(mmvalue, b.mmvalue); return *this; }
+
+    inline FastVec3<T> operator+(T a) const { return _mm256_add_pd(mmvalue, _mm256_set1_pd(a)); }
+    inline FastVec3<T> operator-(T a) const { return _mm256_sub_pd(mmvalue, _mm256_set1_pd(a)); }
+    inline FastVec3<T> operator*(T a) const { return _mm256_mul_pd(mmvalue, _mm256_set1_pd(a)); }
+    inline FastVec3<T> operator/(T a) const { assert(a != 0); return _mm256_div_pd(mmvalue, _mm256_set1_pd(a)); }
+
+    inline FastVec3<T>& operator+=(T a) { mmvalue = _mm256_add_pd(mmvalue, _mm256_set1_pd(a)); return *this; }
+    inline FastVec3<T>& operator-=(T a) { mmvalue = _mm256_sub_pd(mmvalue, _mm256_set1_pd(a)); return *this; }
+    inline FastVec3<T>& operator*=(T a) { mmvalue = _mm256_mul_pd(mmvalue, _mm256_set1_pd(a)); return *this; }
+    inline FastVec3<T>& operator/=(T a) { assert(a != 0); mmvalue = _mm256_div_pd(mmvalue, _mm256_set1_pd(a)); return *this; }
+    ////////////////////////////////////////////////////////////////////////////////
+    // geometric functions
+    inline FastVec3<T> cross(const FastVec3<T>& b) const {
+        return _mm256_sub_pd(
+            _mm256_mul_pd(_mm256_permute4x64_pd(mmvalue, _MM_SHUFFLE(3, 0, 2, 1)),
+                          _mm256_permute4x64_pd(b.mmvalue, _MM_SHUFFLE(3, 1, 0, 2))),
+            _mm256_mul_pd(_mm256_permute4x64_pd(mmvalue, _MM_SHUFFLE(3, 1, 0, 2)),
+                          _mm256_permute4x64_pd(b.mmvalue, _MM_SHUFFLE(3, 0, 2, 1)))
+            );
+    }
+
+    inline FastVec3<T> normalized() const { return _mm256_div_pd(mmvalue, _mm256_set1_pd(norm())); }
+    inline T dot(const FastVec3<T>& b) const {
+        // x * b.x + y * b.y + z * b.z: sum of the lower half (x, y) and the first lane of the upper half (z, w)
+        const __m256d prod = _mm256_mul_pd(mmvalue, b.mmvalue);
+        const __m128d xy   = _mm256_castpd256_pd128(prod);
+        const __m128d zw   = _mm256_extractf128_pd(prod, 1);
+        return _mm_cvtsd_f64(_mm_add_sd(_mm_add_sd(xy, _mm_unpackhi_pd(xy, xy)), zw));
+    }
+    inline T norm2() const { return dot(*this); }
+    inline T norm() const { return std::sqrt(norm2()); }
+    ////////////////////////////////////////////////////////////////////////////////
+    inline bool operator==(const FastVec3<T>& b) const { return (((_mm256_movemask_pd(_mm256_cmp_pd(mmvalue, b.mmvalue, _CMP_EQ_OQ))) & 0x7) == 0x7); }
+    inline bool operator!=(const FastVec3<T>& b) const { return !(*this == b); }
+    inline FastVec3<T> operator-() const { return _mm256_xor_pd(mmvalue, _mm256_set1_pd(-0.0)); }
+    ////////////////////////////////////////////////////////////////////////////////
+    // accessor
+    template<class IndexType> inline const T& operator[](const IndexType i) const { assert(i < 4); return val[i]; }
+    template<class IndexType> inline T& operator[](const IndexType i) { assert(i < 4); return val[i]; }
+    ////////////////////////////////////////////////////////////////////////////////
+    // member variable
+    union {
+        struct { Vec3<T> v3; T dummy; };
+        struct { T x, y, z, w; };
+        struct { T val[4]; };
+        __m256d mmvalue;
+    };
+};
+#endif
+
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 template<class T> inline FastVec3<T> operator+(T a, const FastVec3<T>& b) {
     return b + a;
 }
 
 template<class T> inline FastVec3<T> operator-(T a, const FastVec3<T>& b) {
-    return FastVec3(_mm_set1_ps(a)) - b;
+    return FastVec3<T>(a) - b;
 }
 
 template<class T> inline FastVec3<T> operator*(T a, const FastVec3<T>& b) {
@@ -123,8 +220,87 @@ template<class T> inline FastVec3<T> operator*(T a, const FastVec3<T>& b) {
 }
 
 template<class T> inline FastVec3<T> operator/(T a, const FastVec3<T>& b) {
-    return FastVec3(_mm_set1_ps(a)) / b;
+    return FastVec3<T>(a) / b;
 }
 
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// Packet of 4 single precision vectors in one AVX-512 register, each vector in one 128-bit lane laid out as FastVec3<float>
+// All operations are component-wise per vector, scalar results (dot, norm2) are broadcast to the 4 components of their vector
+#if defined(__AVX512F__)
+class NT_ALIGN64 FastVec3x4 {
+public:
+    inline FastVec3x4() {}
+    inline FastVec3x4(__m512 mval) : mmvalue(mval) {}
+    inline FastVec3x4(float x) : mmvalue(_mm512_set1_ps(x)) {}
+    inline FastVec3x4(const FastVec3<float>& v) : mmvalue(_mm512_broadcast_f32x4(v.mmvalue)) {}
+    inline FastVec3x4(const FastVec3<float>& v0, const FastVec3<float>& v1, const FastVec3<float>& v2, const FastVec3<float>& v3) :
+        mmvalue(_mm512_insertf32x4(_mm512_insertf32x4(_mm512_insertf32x4(_mm512_castps128_ps512(v0.mmvalue), v1.mmvalue, 1), v2.mmvalue, 2), v3.mmvalue, 3)) {}
+    inline FastVec3x4(const FastVec3x4& other) : mmvalue(other.mmvalue) {}
+    // a0 * v0, a1 * v1 etc.: one scalar per vector
+    static inline FastVec3x4 fromScalars(float a0, float a1, float a2, float a3) {
+        return _mm512_setr_ps(a0, a0, a0, a0, a1, a1, a1, a1, a2, a2, a2, a2, a3, a3, a3, a3);
+    }
+    ////////////////////////////////////////////////////////////////////////////////
+    inline FastVec3x4& operator=(const FastVec3x4& other) { mmvalue = other.mmvalue; return *this; }
+
+    ////////////////////////////////////////////////////////////////////////////////
+    inline FastVec3x4 operator+(const FastVec3x4& b) const { return _mm512_add_ps(mmvalue, b.mmvalue); }
+    inline FastVec3x4 operator-(const FastVec3x4& b) const { return _mm512_sub_ps(mmvalue, b.mmvalue); }
+    inline FastVec3x4 operator*(const FastVec3x4& b) const { return _mm512_mul_ps(mmvalue, b.mmvalue); }
+    inline FastVec3x4 operator/(const FastVec3x4& b) const { return _mm512_div_ps(mmvalue, b.mmvalue); }
+
+    inline FastVec3x4& operator+=(const FastVec3x4& b) { mmvalue = _mm512_add_ps(mmvalue, b.mmvalue); return *this; }
+    inline FastVec3x4& operator-=(const FastVec3x4& b) { mmvalue = _mm512_sub_ps(mmvalue, b.mmvalue); return *this; }
+    inline FastVec3x4& operator*=(const FastVec3x4& b) { mmvalue = _mm512_mul_ps(mmvalue, b.mmvalue); return *this; }
+    inline FastVec3x4& operator/=(const FastVec3x4& b) { mmvalue = _mm512_div_ps(mmvalue, b.mmvalue); return *this; }
+
+    inline FastVec3x4 operator+(float a) const { return _mm512_add_ps(mmvalue, _mm512_set1_ps(a)); }
+    inline FastVec3x4 operator-(float a) const { return _mm512_sub_ps(mmvalue, _mm512_set1_ps(a)); }
+    inline FastVec3x4 operator*(float a) const { return _mm512_mul_ps(mmvalue, _mm512_set1_ps(a)); }
+    inline FastVec3x4 operator/(float a) const { assert(a != 0); return _mm512_div_ps(mmvalue, _mm512_set1_ps(a)); }
+
+    inline FastVec3x4& operator+=(float a) { mmvalue = _mm512_add_ps(mmvalue, _mm512_set1_ps(a)); return *this; }
+    inline FastVec3x4& operator-=(float a) { mmvalue = _mm512_sub_ps(mmvalue, _mm512_set1_ps(a)); return *this; }
+    inline FastVec3x4& operator*=(float a) { mmvalue = _mm512_mul_ps(mmvalue, _mm512_set1_ps(a)); return *this; }
+    inline FastVec3x4& operator/=(float a) { assert(a != 0); mmvalue = _mm512_div_ps(mmvalue, _mm512_set1_ps(a)); return *this; }
+    ////////////////////////////////////////////////////////////////////////////////
+    // geometric functions, _mm512_permute_ps shuffles within each 128-bit lane like _mm_shuffle_ps
+    inline FastVec3x4 cross(const FastVec3x4& b) const {
+        return _mm512_sub_ps(
+            _mm512_mul_ps(_mm512_permute_ps(mmvalue, _MM_SHUFFLE(3, 0, 2, 1)),
+                          _mm512_permute_ps(b.mmvalue, _MM_SHUFFLE(3, 1, 0, 2))),
+            _mm512_mul_ps(_mm512_permute_ps(mmvalue, _MM_SHUFFLE(3, 1, 0, 2)),
+                          _mm512_permute_ps(b.mmvalue, _MM_SHUFFLE(3, 0, 2, 1)))
+            );
+    }
+
+    inline FastVec3x4 dot(const FastVec3x4& b) const {
+        const __m512 prod = _mm512_mul_ps(mmvalue, b.mmvalue);
+        const __m512 sum  = _mm512_add_ps(_mm512_add_ps(prod, _mm512_permute_ps(prod, _MM_SHUFFLE(0, 0, 0, 1))),
+                                          _mm512_permute_ps(prod, _MM_SHUFFLE(0, 0, 0, 2)));
+        return _mm512_permute_ps(sum, _MM_SHUFFLE(0, 0, 0, 0));
+    }
+    inline FastVec3x4 norm2() const { return dot(*this); }
+    inline FastVec3x4 norm() const { return _mm512_sqrt_ps(norm2().mmvalue); }
+    inline FastVec3x4 normalized() const { return _mm512_div_ps(mmvalue, _mm512_sqrt_ps(norm2().mmvalue)); }
+    ////////////////////////////////////////////////////////////////////////////////
+    inline bool operator==(const FastVec3x4& b) const { return (_mm512_cmp_ps_mask(mmvalue, b.mmvalue, _CMP_EQ_OQ) & 0x7777) == 0x7777; }
+    inline bool operator!=(const FastVec3x4& b) const { return !(*this == b); }
+    inline FastVec3x4 operator-() const { return _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(mmvalue), _mm512_set1_epi32(0x80000000))); }
+    ////////////////////////////////////////////////////////////////////////////////
+    // accessor, the i-th vector
+    template<class IndexType> inline FastVec3<float> operator[](const IndexType i) const { assert(i < 4); return _mm_load_ps(&val[4 * i]); }
+    template<class IndexType> inline void set(const IndexType i, const FastVec3<float>& v) { assert(i < 4); _mm_store_ps(&val[4 * i], v.mmvalue); }
+    ////////////////////////////////////////////////////////////////////////////////
+    // member variable
+    union {
+        float  val[16];
+        __m512 mmvalue;
+    };
+};
+
+inline FastVec3x4 operator*(float a, const FastVec3x4& b) { return b * a; }
+#endif
+
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 } // end namespace NTCodeBase
@@ -0,0 +1,173 @@
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//
+//    .--------------------------------------------------.
+//    |  This file is part of NTCodeBase                 |
+//    |  Created 2018 by NT (https://ttnghia.github.io)  |
+//    '--------------------------------------------------'
+//                            \o/
+//                             |
+//                            / |
+//
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+
+#include <LibCommon/Math/MathHelpers.h>
+#include <LibCommon/Math/SIMDPack.h>
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+namespace NTCodeBase::MathHelpers {
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+namespace {
+// The kernels are written once for SIMD packs and for the scalar remainder: both sides of each branch of the
+// scalar kernels are computed and the result is selected per lane. The divisions only occur in the branch
+// where the divisor is not smaller than 0.5, the divisor is clamped so that the discarded lanes stay finite.
+struct CubicBSpline {
+    template<class P, class T>
+    static void eval(P r2, P& value, P& gradFactor, const SPHKernelConstants<T>& c) {
+        const P    q     = sqrt(r2) * P::set1(c.invH);
+        const P    t     = max(P::set1(T(2)) - q, P::set1(T(0)));
+        const auto inner = q < P::set1(T(1));
+        value      = select(inner, q * q * (q * P::set1(T(0.5)) - P::set1(T(1))) + P::set1(T(2.0 / 3.0)), t * t * t * P::set1(T(1.0 / 6.0)));
+        gradFactor = select(inner, q * P::set1(T(1.5)) - P::set1(T(2)), -t * t / (P::set1(T(2)) * max(q, P::set1(T(1))))) * P::set1(c.invH2);
+    }
+};
+
+struct QuadBSpline {
+    template<class P, class T>
+    static void eval(P r2, P& value, P& gradFactor, const SPHKernelConstants<T>& c) {
+        const P    q     = sqrt(r2) * P::set1(c.invH);
+        const P    t     = max(P::set1(T(1.5)) - q, P::set1(T(0)));
+        const auto inner = q < P::set1(T(0.5));
+        value      = select(inner, P::set1(T(0.75)) - q * q, P::set1(T(0.5)) * t * t);
+        gradFactor = select(inner, P::set1(T(-2)), -t / max(q, P::set1(T(0.5)))) * P::set1(c.invH2);
+    }
+};
+
+struct Spiky {
+    template<class P, class T>
+    static void eval(P r2, P& value, P& gradFactor, const SPHKernelConstants<T>& c) {
+        const P t  = max(P::set1(T(1)) - r2 * P::set1(c.invH2), P::set1(T(0)));
+        const P t2 = t * t;
+        value      = P::set1(c.spikyCoeff) * t2 * t;
+        gradFactor = P::set1(T(-6) * c.spikyCoeff * c.invH2) * t2;
+    }
+};
+
+struct Smooth {
+    template<class P, class T>
+    static void eval(P r2, P& value, P& gradFactor, const SPHKernelConstants<T>& c) {
+        const P t  = max(P::set1(T(1)) - r2 * P::set1(c.invH2), P::set1(T(0)));
+        const P t2 = t * t;
+        value      = t2 * t;
+        gradFactor = P::set1(T(-6) * c.invH2) * t2;
+    }
+};
+
+template<class Kernel, class T>
+void evaluateBatch(const T* r2, T* values, T* gradFactors, size_t n, const SPHKernelConstants<T>& constants) {
+    using P       = SIMD::Pack<T>;
+    using Pscalar = SIMD::Pack<T, false>;
+    size_t i = 0;
+    if constexpr(P::Width > 1) {
+        for(; i + P::Width <= n; i += P::Width) {
+            P value, gradFactor;
+            Kernel::eval(P::loadu(r2 + i), value, gradFactor, constants);
+            value.storeu(values + i);
+            gradFactor.storeu(gradFactors + i);
+        }
+    }
+    for(; i < n; ++i) {
+        Pscalar value, gradFactor;
+        Kernel::eval(Pscalar::loadu(r2 + i), value, gradFactor, constants);
+        value.storeu(values + i);
+        gradFactor.storeu(gradFactors + i);
+    }
+}
+} // end anonymous namespace
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<class T>
+void cubic_bspline_kernel(const T* r2, T* values, T* gradFactors, size_t n, const SPHKernelConstants<T>& constants) {
+    evaluateBatch<CubicBSpline>(r2, values, gradFactors, n, constants);
+}
+
+template<class T>
+void quad_bspline_kernel(const T* r2, T* values, T* gradFactors, size_t n, const SPHKernelConstants<T>& constants) {
+    evaluateBatch<QuadBSpline>(r2, values, gradFactors, n, constants);
+}
+
+template<class T>
+void spiky_kernel(const T* r2, T* values, T* gradFactors, size_t n, const SPHKernelConstants<T>& constants) {
+    evaluateBatch<Spiky>(r2, values, gradFactors, n, constants);
+}
+
+template<class T>
+void smooth_kernel(const T* r2, T* values, T* gradFactors, size_t n, const SPHKernelConstants<T>& constants) {
+    evaluateBatch<Smooth>(r2, values, gradFactors, n, constants);
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<class T>
+TabulatedSPHKernel<T>::TabulatedSPHKernel(SPHKernelType type, double h, UInt nSamples) {
+    NT_REQUIRE(nSamples > 0);
+    double supportRadius = h;
+    switch(type) {
+        case SPHKernelType::CubicBSpline: supportRadius = 2.0 * h; break;
+        case SPHKernelType::QuadBSpline: supportRadius = 1.5 * h; break;
+        default:;
+    }
+    m_SupportRadius = T(supportRadius);
+    m_InvDr2        = T(double(nSamples) / (supportRadius * supportRadius));
+    m_MaxIdx        = T(nSamples);
+
+    // sample in double precision
+    const double               dr2 = supportRadius * supportRadius / double(nSamples);
+    StdVT<double>              r2(nSamples + 1);
+    StdVT<double>              values(nSamples + 1), gradFactors(nSamples + 1);
+    SPHKernelConstants<double> constants(h);
+    for(UInt i = 0; i <= nSamples; ++i) {
+        r2[i] = double(i) * dr2;
+    }
+    switch(type) {
+        case SPHKernelType::CubicBSpline: cubic_bspline_kernel(r2.data(), values.data(), gradFactors.data(), r2.size(), constants); break;
+        case SPHKernelType::QuadBSpline: quad_bspline_kernel(r2.data(), values.data(), gradFactors.data(), r2.size(), constants); break;
+        case SPHKernelType::Spiky: spiky_kernel(r2.data(), values.data(), gradFactors.data(), r2.size(), constants); break;
+        case SPHKernelType::Smooth: smooth_kernel(r2.data(), values.data(), gradFactors.data(), r2.size(), constants); break;
+    }
+    m_Values.assign(nSamples + 2, T(0));
+    m_GradFactors.assign(nSamples + 2, T(0));
+    for(UInt i = 0; i <= nSamples; ++i) {
+        m_Values[i]      = T(values[i]);
+        m_GradFactors[i] = T(gradFactors[i]);
+    }
+}
+
+template<class T>
+void TabulatedSPHKernel<T>::evaluate(const T* r2, T* values, T* gradFactors, size_t n) const {
+    const T* NT_RESTRICT tValues      = m_Values.data();
+    const T* NT_RESTRICT tGradFactors = m_GradFactors.data();
+    for(size_t i = 0; i < n; ++i) {
+        const T   x = std::min(r2[i] * m_InvDr2, m_MaxIdx);
+        const Int k = static_cast<Int>(x);
+        const T   f = x - T(k);
+        values[i]      = tValues[k] + f * (tValues[k + 1] - tValues[k]);
+        gradFactors[i] = tGradFactors[k] + f * (tGradFactors[k + 1] - tGradFactors[k]);
+    }
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template void cubic_bspline_kernel<float>(const float*, float*, float*, size_t, const SPHKernelConstants<float>&);
+template void cubic_bspline_kernel<double>(const double*, double*, double*, size_t, const SPHKernelConstants<double>&);
+template void quad_bspline_kernel<float>(const float*, float*, float*, size_t, const SPHKernelConstants<float>&);
+template void quad_bspline_kernel<double>(const double*, double*, double*, size_t, const SPHKernelConstants<double>&);
+template void spiky_kernel<float>(const float*, float*, float*, size_t, const SPHKernelConstants<float>&);
+template void spiky_kernel<double>(const double*, double*, double*, size_t, const SPHKernelConstants<double>&);
+template void smooth_kernel<float>(const float*, float*, float*, size_t, const SPHKernelConstants<float>&);
+template void smooth_kernel<double>(const double*, double*, double*, size_t, const SPHKernelConstants<double>&);
+
+template class TabulatedSPHKernel<float>;
+template class TabulatedSPHKernel<double>;
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+} // end namespace NTCodeBase::MathHelpers
@@ -757,6 +757,61 @@ inline constexpr T cubic_bspline_grad(T x) {
     return T(1.5) * x * abs_x - T(2.0) * x;
 }
 
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// Batched SPH kernels
+// Evaluate a kernel and its gradient for n squared distances at once (e.g. all neighbors of a particle),
+// branch-free and with SIMD when available (see SIMD::Pack):
+//     values[i]      = W(r), with r = sqrt(r2[i])
+//     gradFactors[i] = W'(r) / r, thus grad W(|x_ij|) = gradFactors[i] * x_ij
+// W are the scalar kernels above, scaled by the support parameter h:
+//     cubic_bspline: cubic_bspline_kernel(r / h), zero for r >= 2h
+//     quad_bspline:  quad_bspline_kernel(r / h), zero for r >= 1.5h
+//     spiky:         spiky_kernel(r, h), zero for r >= h
+//     smooth:        smooth_kernel(r2, h * h), zero for r >= h
+// spiky and smooth are polynomials of r2 and need no square root. The arrays do not need to be aligned.
+// The constants are computed once in double precision and rounded to T, thus the float kernels agree with
+// the double kernels up to the float precision.
+template<class T>
+struct SPHKernelConstants {
+    explicit SPHKernelConstants(double h_) :
+        h(T(h_)), invH(T(1.0 / h_)), invH2(T(1.0 / (h_ * h_))), spikyCoeff(T(315.0 / 64.0 / M_PI)) {}
+
+    T h, invH, invH2, spikyCoeff;
+};
+
+template<class T> void cubic_bspline_kernel(const T* r2, T* values, T* gradFactors, size_t n, const SPHKernelConstants<T>& constants);
+template<class T> void quad_bspline_kernel(const T* r2, T* values, T* gradFactors, size_t n, const SPHKernelConstants<T>& constants);
+template<class T> void spiky_kernel(const T* r2, T* values, T* gradFactors, size_t n, const SPHKernelConstants<T>& constants);
+template<class T> void smooth_kernel(const T* r2, T* values, T* gradFactors, size_t n, const SPHKernelConstants<T>& constants);
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// Tabulated version of the batched SPH kernels: value and gradient factor are sampled uniformly in r2
+// over the kernel support and linearly interpolated, no square root and no branch.
+// The interpolation error is largest for small r with the B-spline kernels, whose gradient factor is not
+// smooth in r2 at r = 0 (about 4e-3 relative error with the default 4096 samples). With SIMD, the batched
+// kernels are usually faster, the tables are meant for builds without SIMD or for more expensive kernels.
+enum class SPHKernelType {
+    CubicBSpline,
+    QuadBSpline,
+    Spiky,
+    Smooth
+};
+
+template<class T>
+class TabulatedSPHKernel {
+public:
+    TabulatedSPHKernel(SPHKernelType type, double h, UInt nSamples = 4096u);
+
+    T    supportRadius() const noexcept { return m_SupportRadius; }
+    void evaluate(const T* r2, T* values, T* gradFactors, size_t n) const;
+
+private:
+    StdVT<T> m_Values, m_GradFactors; // nSamples + 2 entries, the last two are zero (outside of the support)
+    T        m_SupportRadius;
+    T        m_InvDr2;
+    T        m_MaxIdx;
+};
+
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 // exponential smooth min (k = 32);
 template<class T>
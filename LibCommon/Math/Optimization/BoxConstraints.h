@@ -0,0 +1,99 @@
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//
+//    .--------------------------------------------------.
+//    |  This file is part of NTCodeBase                 |
+//    |  Created 2018 by NT (https://ttnghia.github.io)  |
+//    '--------------------------------------------------'
+//                            \o/
+//                             |
+//                            / |
+//
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+
+
+#pragma once
+
+#include <LibCommon/Math/Optimization/Problem.h>
+#include <LibCommon/ParallelHelpers/ParallelExec.h>
+
+#include <algorithm>
+#include <limits>
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+namespace NTCodeBase::Optimization {
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+/**
+ * @brief the box l <= x <= u of a problem (Problem::setBoxConstraint, or only one of the bounds), for projected solvers
+ * @details the bounds are not copied, the problem must not change them while it is minimized: the solvers call set() at the
+ * beginning of minimize and clear() on exit, thus the pointers to the bounds do not outlive the call.
+ * Reductions use ParallelExec::reduce with the default reduction policy (serial with NT_NO_PARALLEL/NT_DISABLE_PARALLEL),
+ * the min/max reductions do not depend on the policy, the dot product of projectDirection is reproducible with the Deterministic one.
+ */
+template<class Real_t>
+class BoxConstraints {
+public:
+    void set(const Problem<Real_t>& objFunc, size_t nVars) {
+        NT_REQUIRE(!objFunc.hasLowerBound() || objFunc.lowerBound().size() == nVars);
+        NT_REQUIRE(!objFunc.hasUpperBound() || objFunc.upperBound().size() == nVars);
+        m_Lower = objFunc.hasLowerBound() ? objFunc.lowerBound().data() : nullptr;
+        m_Upper = objFunc.hasUpperBound() ? objFunc.upperBound().data() : nullptr;
+    }
+
+    void clear() { m_Lower = nullptr; m_Upper = nullptr; }
+
+    bool bounded() const { return m_Lower != nullptr || m_Upper != nullptr; }
+    bool atLowerBound(size_t i, Real_t v, Real_t eps = Real_t(0)) const { return m_Lower != nullptr && v <= m_Lower[i] + eps; }
+    bool atUpperBound(size_t i, Real_t v, Real_t eps = Real_t(0)) const { return m_Upper != nullptr && v >= m_Upper[i] - eps; }
+
+    Real_t project(size_t i, Real_t v) const {
+        if(m_Lower != nullptr) { v = std::max(v, m_Lower[i]); }
+        if(m_Upper != nullptr) { v = std::min(v, m_Upper[i]); }
+        return v;
+    }
+
+    void project(StdVT<Real_t>& x) const {
+        if(bounded()) {
+            ParallelExec::run(x.size(), [&](size_t i) { x[i] = project(i, x[i]); });
+        }
+    }
+
+    // max norm of the projected gradient P(x - g) - x, which is the max norm of g if unbounded
+    Real_t projectedGradientNorm(const StdVT<Real_t>& x, const StdVT<Real_t>& g) const {
+        return ParallelExec::reduce(size_t(0), x.size(), Real_t(0),
+                                    [&](size_t i) { return std::abs(project(i, x[i] - g[i]) - x[i]); },
+                                    [](Real_t a, Real_t b) { return std::max(a, b); });
+    }
+
+    /**
+     * @brief search direction dir_i = P(target(i)) - x_i toward the projection of a target point, in one pass
+     * @details target(i) is called once per variable and may read dir[i] before it is overwritten
+     * @return dot(dir, g) and the largest step keeping x + stp * dir inside the box (infinity if unbounded)
+     */
+    template<class Function>
+    Vec2<Real_t> projectDirection(const StdVT<Real_t>& x, const StdVT<Real_t>& g, StdVT<Real_t>& dir, Function&& target) const {
+        const Real_t inf = std::numeric_limits<Real_t>::infinity();
+        return ParallelExec::reduce(size_t(0), x.size(), Vec2<Real_t>(0, inf),
+                                    [&](size_t i) {
+                                        dir[i] = project(i, target(i)) - x[i];
+                                        Real_t maxStep = inf;
+                                        if(dir[i] > 0 && m_Upper != nullptr) {
+                                            maxStep = (m_Upper[i] - x[i]) / dir[i];
+                                        } else if(dir[i] < 0 && m_Lower != nullptr) {
+                                            maxStep = (m_Lower[i] - x[i]) / dir[i];
+                                        }
+                                        return Vec2<Real_t>(dir[i] * g[i], maxStep);
+                                    },
+                                    [](const Vec2<Real_t>& a, const Vec2<Real_t>& b) { return Vec2<Real_t>(a[0] + b[0], std::min(a[1], b[1])); });
+    }
+
+    // step limit for MoreThuente from the largest feasible step of projectDirection, which is at least 1 up to round-off errors
+    static Real_t lineSearchMaxStep(Real_t maxFeasibleStep) { return std::min(std::max(maxFeasibleStep, Real_t(1.0)), Real_t(1e15)); }
+
+private:
+    const Real_t* m_Lower = nullptr; // nullptr if unbounded
+    const Real_t* m_Upper = nullptr;
+};
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+} // end namespace NTCodeBase::Optimization
@@ -0,0 +1,79 @@
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//
+//    .--------------------------------------------------.
+//    |  This file is part of NTCodeBase                 |
+//    |  Created 2018 by NT (https://ttnghia.github.io)  |
+//    '--------------------------------------------------'
+//                            \o/
+//                             |
+//                            / |
+//
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+
+
+#pragma once
+
+#include <LibCommon/Math/Optimization/Problem.h>
+#include <LibCommon/Math/Optimization/StoppingCriteria.h>
+#include <LibCommon/Timer/Timer.h>
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+namespace NTCodeBase::Optimization {
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<typename Real_t, Int Order>
+class ISolver {
+public:
+    ISolver() = default;
+    virtual ~ISolver() = default;
+
+    /**
+     * @brief minimize an objective function given a gradient
+     * @details this is just the abstract interface
+     *
+     * @param x0 starting point
+     * @param funObjective objective function
+     */
+    virtual void minimize(Problem<Real_t>& objFunc, StdVT<Real_t>& x0) = 0;
+    ////////////////////////////////////////////////////////////////////////////////
+    auto& stoppingCriteria() { return m_Criteria; }
+    auto& gradTolerance() { return m_Criteria.gradTol; }
+    auto& initHessian() { return m_InitHess; }
+    auto& maxIter() { return m_Criteria.maxIter; }
+    ////////////////////////////////////////////////////////////////////////////////
+    auto        nIters() const { return m_nIters; }
+    auto        status() const { return m_Status; }
+    const auto& iterationStats() const { return m_IterStats; }
+protected:
+    void startIterations() {
+        m_nIters = 0;
+        m_Status = SolverStatus::Running;
+        m_IterStats.resize(0);
+        m_Timer = Timer();
+        m_Timer.tick();
+    }
+
+    void recordIteration(Real_t f, Real_t gradNorm, Real_t stepLength, UInt nInnerIters = 0) {
+        m_IterStats.push_back(IterationStats<Real_t> { f, gradNorm, stepLength, nInnerIters, m_Timer.tock() });
+        m_Timer.tick();
+    }
+
+    void finishIterations(size_t nIters) {
+        m_nIters = nIters;
+        if(m_Status == SolverStatus::Running) {
+            m_Status = SolverStatus::IterationLimit;
+        }
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+    StoppingCriteria<Real_t>      m_Criteria;
+    size_t                        m_nIters   = 0;
+    SolverStatus                  m_Status   = SolverStatus::NotStarted;
+    StdVT<IterationStats<Real_t>> m_IterStats;
+    Timer                         m_Timer;
+
+    Real_t m_InitHess = Real_t(1.0); // only used by lbfgs
+};
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+} // end namespace NTCodeBase::Optimization
@@ -0,0 +1,161 @@
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//
+//    .--------------------------------------------------.
+//    |  This file is part of NTCodeBase                 |
+//    |  Created 2018 by NT (https://ttnghia.github.io)  |
+//    '--------------------------------------------------'
+//                            \o/
+//                             |
+//                            / |
+//
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+
+
+#pragma once
+
+#include <LibCommon/Math/Optimization/LBFGSSolver.h>
+#include <LibCommon/Math/Optimization/BoxConstraints.h>
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+namespace NTCodeBase::Optimization {
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+/**
+ * @brief  Projected L-BFGS for box constraints l <= x <= u, set by Problem::setBoxConstraint (or only one of the bounds)
+ * @details Each iteration:
+ *  1. The Cauchy point x_c = P(x - gamma * g) is the minimizer of the quadratic model with Hessian I / gamma in the box
+ *     (P is the projection onto the box). The variables clamped at x_c are fixed, the others are free.
+ *  2. The L-BFGS direction -H * g is computed from the gradient of the free variables, the fixed variables move to their Cauchy point.
+ *     The target point x + dir is projected onto the box, thus the search direction dir = P(x + dir) - x is a descent direction
+ *     (otherwise the history is dropped and the search direction is x_c - x).
+ *  3. The More-Thuente line search is limited to the largest step keeping x + stp * dir inside the box,
+ *     so the objective function is never evaluated outside of the box.
+ * Convergence is measured by the max norm of the projected gradient P(x - g) - x.
+ * All passes over the vectors are parallel, the memory is the same as LBFGSSolver: 2m + 4 vectors plus the line search workspace.
+ * The new point and its gradient are taken from the line search workspace, the objective is evaluated again only if the
+ * projection onto the box changes the point returned by the line search.
+ */
+template<class Real_t>
+class LBFGSBSolver : public ISolver<Real_t, 1> {
+    using LineSearch = MoreThuente<Real_t, Problem<Real_t>, 1>;
+public:
+    auto& historySize() { return m_HistorySize; }
+    auto  projectedGradientNorm() const { return m_ProjGradNorm; }
+
+    void minimize(Problem<Real_t>& objFunc, StdVT<Real_t>& x0) {
+        const auto&  criteria = this->m_Criteria;
+        const size_t m        = std::max(std::min(criteria.maxIter, m_HistorySize), size_t(1));
+        const size_t nVars    = x0.size();
+        m_Box.set(objFunc, nVars);
+        m_History.resize(nVars, m);
+        m_Grad.resize(nVars);
+        m_Dir.resize(nVars);
+        this->startIterations();
+
+        // start from a feasible point
+        m_Box.project(x0);
+
+        // the first direction is scaled to max norm m_InitHess (or less, for small gradients)
+        Real_t f        = objFunc.valueGradient(x0, m_Grad);
+        Real_t gamma_k  = this->m_InitHess / std::max(Real_t(1.0), ParallelSTL::maxAbs(m_Grad));
+        size_t globIter = 0;
+        m_ProjGradNorm = m_Box.projectedGradientNorm(x0, m_Grad);
+
+        for(size_t k = 0; k < criteria.maxIter; k++) {
+            if(criteria.gradientConverged(m_ProjGradNorm)) {
+                this->m_Status = SolverStatus::GradientNorm;
+                break;
+            }
+            globIter++;
+
+            Vec2<Real_t> dg_maxStep = computeDirection(x0, gamma_k);
+            if(dg_maxStep[0] >= 0 && m_History.size() > 0) {
+                m_History.clear();
+                gamma_k    = this->m_InitHess / std::max(Real_t(1.0), ParallelSTL::maxAbs(m_Grad));
+                dg_maxStep = computeDirection(x0, gamma_k);
+            }
+            if(dg_maxStep[0] >= 0) {
+                this->m_Status = SolverStatus::NoDescent;
+                break;
+            } // no descent along the Cauchy direction, x is stationary up to round-off errors
+
+            const Real_t stpmax = BoxConstraints<Real_t>::lineSearchMaxStep(dg_maxStep[1]);
+            const Real_t rate   = LineSearch::linesearch(x0, f, m_Grad, m_Dir, objFunc, Real_t(1.0), m_LineSearchWorkspace, stpmax);
+
+            // x_{k+1} = P(x_k + rate * dir) from the line search point (the projection only removes round-off errors), s = x_{k+1} - x_k,
+            // with dot(s, s) and the number of projected components, then x_{k+1} and its gradient are swapped in
+            auto&              s        = m_History.newS();
+            auto&              xNew     = m_LineSearchWorkspace.x;
+            const Vec2<Real_t> ss_nProj = ParallelExec::reduce(size_t(0), nVars, Vec2<Real_t>(0),
+                                                               [&](size_t i) {
+                                                                   const Real_t xi         = m_Box.project(i, xNew[i]);
+                                                                   const bool   bProjected = xi != xNew[i];
+                                                                   s[i]    = xi - x0[i];
+                                                                   xNew[i] = xi;
+                                                                   return Vec2<Real_t>(s[i] * s[i], bProjected ? Real_t(1) : Real_t(0));
+                                                               });
+            std::swap(x0, m_LineSearchWorkspace.x);
+            std::swap(m_Grad, m_LineSearchWorkspace.g);
+            if(criteria.stepConverged(ss_nProj[0])) {
+                this->m_Status = SolverStatus::StepSize;
+                break;
+            }
+
+            const Real_t fOld = f;
+            f              = ss_nProj[1] > 0 ? objFunc.valueGradient(x0, m_Grad) : m_LineSearchWorkspace.f;
+            m_ProjGradNorm = m_Box.projectedGradientNorm(x0, m_Grad);
+            this->recordIteration(f, m_ProjGradNorm, rate);
+            if(criteria.objectiveConverged(fOld, f)) {
+                this->m_Status = SolverStatus::ObjectiveDecrease;
+                break;
+            }
+
+            // y = g_{k+1} - g_k (g_k is now in the workspace), with dot(s, y) and dot(y, y)
+            // the pair is skipped if the curvature condition fails, which may happen when the step is limited by the bounds
+            auto&              y     = m_History.newY();
+            const auto&        gOld  = m_LineSearchWorkspace.g;
+            const Vec2<Real_t> sy_yy = ParallelExec::reduce(size_t(0), nVars, Vec2<Real_t>(0),
+                                                            [&](size_t i) {
+                                                                y[i] = m_Grad[i] - gOld[i];
+                                                                return Vec2<Real_t>(s[i] * y[i], y[i] * y[i]);
+                                                            });
+            if(sy_yy[0] > std::numeric_limits<Real_t>::epsilon() * sy_yy[1]) {
+                m_History.push(sy_yy[0]);
+                gamma_k = sy_yy[0] / sy_yy[1];
+            }
+        }
+        if(this->m_Status == SolverStatus::Running && criteria.gradientConverged(m_ProjGradNorm)) {
+            this->m_Status = SolverStatus::GradientNorm;
+        }
+        this->finishIterations(globIter);
+        m_Box.clear();
+    }
+
+private:
+    /**
+     * @brief search direction from the Cauchy point x_c = P(x - gamma * g) and the L-BFGS direction of the free variables
+     * @return dot(dir, g) and the largest step keeping x + stp * dir inside the box (infinity if unbounded)
+     */
+    Vec2<Real_t> computeDirection(const StdVT<Real_t>& x, Real_t gamma) {
+        // a variable is free if it is not clamped at the Cauchy point
+        auto isFree = [&](size_t i) { const Real_t xc = x[i] - gamma * m_Grad[i]; return m_Box.project(i, xc) == xc; };
+        ParallelExec::run(x.size(), [&](size_t i) { m_Dir[i] = isFree(i) ? m_Grad[i] : Real_t(0); });
+        m_History.computeDirection(m_Dir, gamma, m_Dir, m_Grad);
+        return m_Box.projectDirection(x, m_Grad, m_Dir, [&](size_t i) { return isFree(i) ? x[i] + m_Dir[i] : x[i] - gamma * m_Grad[i]; });
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+    size_t                         m_HistorySize = 10;
+    LBFGSHistory<Real_t>           m_History;
+    BoxConstraints<Real_t>         m_Box;
+    StdVT<Real_t>                  m_Grad, m_Dir;
+    typename LineSearch::Workspace m_LineSearchWorkspace;
+    Real_t                         m_ProjGradNorm = 0;
+};
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+} // end namespace NTCodeBase::Optimization
@@ -17,11 +17,12 @@
 #include <LibCommon/ParallelHelpers/ParallelBLAS.h>
 #include <LibCommon/ParallelHelpers/ParallelSTL.h>
 #include <LibCommon/Math/Optimization/MoreThuente.h>
-#include <LibCommon/Math/Optimization/Problem.h>
+#include <LibCommon/Math/Optimization/ISolver.h>
 
 #include <iostream>
 #include <algorithm>
 #include <cmath>
+#include <utility>
 
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 namespace NTCodeBase::Optimization {
@@ -37,6 +38,18 @@ public:
         }
     }
 
+    MatrixX() = default;
+
+    template<class IndexType>
+    void resize(IndexType nRows, IndexType nCols) {
+        m_nRows = static_cast<UInt>(nRows);
+        m_nCols = static_cast<UInt>(nCols);
+        m_Data.resize(nCols);
+        for(auto& col : m_Data) {
+            col.resize(m_nRows);
+        }
+    }
+
     auto nRows() const { return m_nRows; }
     auto nCols() const { return m_nCols; }
 
@@ -53,38 +66,90 @@ private:
 };
 
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
-template<typename Real_t, Int Order>
-class ISolver {
+/**
+ * @brief history of the last m updates s = x_{k+1} - x_k, y = g_{k+1} - g_k of L-BFGS type solvers
+ * @details the updates are stored in ring buffers, all vectors are allocated once (and kept between calls with the same problem size).
+ * A new entry is written into newS() and newY() then committed by push(), which drops the oldest entry if the history is full.
+ * The ring buffers have a spare (m + 1)-th column for the new entry, thus an entry that is not pushed (e.g. skipped by a curvature check)
+ * never overwrites a live one.
+ */
+template<class Real_t>
+class LBFGSHistory {
 public:
-    ISolver() = default;
+    void resize(size_t nVars, size_t m) {
+        if(m_S.nRows() != nVars || m_S.nCols() != m + 1) {
+            m_S.resize(nVars, m + 1);
+            m_Y.resize(nVars, m + 1);
+        }
+        m_Rho.resize(m + 1);
+        m_Alpha.resize(m + 1);
+        clear();
+    }
+
+    void clear() { m_Head = 0; m_nEntries = 0; }
+    size_t size() const { return m_nEntries; }
+    size_t capacity() const { return m_S.nCols() - 1; }
+
+    auto& newS() { return m_S.col(m_Head); }
+    auto& newY() { return m_Y.col(m_Head); }
+    void  push(Real_t sy) {
+        m_Rho[m_Head] = Real_t(1.0) / sy;
+        m_Head        = (m_Head + 1) % m_S.nCols();
+        m_nEntries    = std::min(m_nEntries + 1, capacity());
+    }
 
     /**
-     * @brief minimize an objective function given a gradient
-     * @details this is just the abstract interface
-     *
-     * @param x0 starting point
-     * @param funObjective objective function
+     * @brief two-loop recursion (Nocedal & Wright, Algorithm 7.4) applied to -v: dir = -H * v
+     * @details the initial Hessian gamma * I is applied in the first update of the second loop.
+     * Each pass is parallel and fuses the vector update with the dot product needed next, 2m + 1 passes in total.
+     * v may be the same vector as dir.
+     * @return dot(dir, w)
      */
-    virtual void minimize(Problem<Real_t>& objFunc, StdVT<Real_t>& x0) = 0;
-    ////////////////////////////////////////////////////////////////////////////////
-    auto& gradTolerance() { return m_GradTol; }
-    auto& initHessian() { return m_InitHess; }
-    auto& maxIter() { return m_MaxIter; }
+    Real_t computeDirection(const StdVT<Real_t>& v, Real_t gamma, StdVT<Real_t>& dir, const StdVT<Real_t>& w) {
+        const size_t nVars = v.size();
+        if(m_nEntries == 0) {
+            return ParallelExec::reduce(size_t(0), nVars, Real_t(0), [&](size_t i) { dir[i] = -gamma * v[i]; return dir[i] * w[i]; });
+        }
+
+        // first loop, from the newest to the oldest entry: alpha_i = rho_i * dot(s_i, q), q = q - alpha_i * y_i
+        const auto& sNewest = m_S.col(historyCol(0));
+        Real_t      dot     = ParallelExec::reduce(size_t(0), nVars, Real_t(0), [&](size_t i) { dir[i] = -v[i]; return sNewest[i] * dir[i]; });
+        for(size_t j = 0; j < m_nEntries; ++j) {
+            const size_t col   = historyCol(j);
+            const Real_t alpha = m_Rho[col] * dot;
+            const auto&  y     = m_Y.col(col);
+            const auto&  next  = j + 1 < m_nEntries ? m_S.col(historyCol(j + 1)) : y; // dot(y_oldest, q) starts the second loop
+            m_Alpha[col] = alpha;
+            dot          = ParallelExec::reduce(size_t(0), nVars, Real_t(0), [&](size_t i) { dir[i] -= alpha * y[i]; return next[i] * dir[i]; });
+        }
+
+        // second loop, from the oldest to the newest entry: beta = rho_i * dot(y_i, r), r = r + (alpha_i - beta) * s_i,
+        // starting with r = gamma * q
+        dot *= gamma;
+        for(size_t j = m_nEntries; j-- > 0;) {
+            const size_t col    = historyCol(j);
+            const Real_t coeff  = m_Alpha[col] - m_Rho[col] * dot;
+            const Real_t scale  = j + 1 == m_nEntries ? gamma : Real_t(1);
+            const auto&  s      = m_S.col(col);
+            const auto&  next   = j > 0 ? m_Y.col(historyCol(j - 1)) : w;
+            dot = ParallelExec::reduce(size_t(0), nVars, Real_t(0), [&](size_t i) { dir[i] = scale * dir[i] + coeff * s[i]; return next[i] * dir[i]; });
+        }
+        return dot;
+    }
+
+private:
+    // j-th newest history entry
+    size_t historyCol(size_t j) const { return (m_Head + m_S.nCols() - 1 - j) % m_S.nCols(); }
+
     ////////////////////////////////////////////////////////////////////////////////
-    auto        nIters() const { return m_nIters; }
-    const auto& objVals() const { return m_ObjVals; }
-    const auto& runtimes() const { return m_Runtimes; }
-protected:
-    size_t        m_nIters;
-    StdVT<Real_t> m_ObjVals;
-    StdVT<Real_t> m_Runtimes;
-
-    Real_t m_GradTol  = Real_t(1e-4);
-    Real_t m_InitHess = Real_t(1.0); // only used by lbfgs
-    size_t m_MaxIter  = 100000;
+    MatrixX<Real_t> m_S, m_Y; // m_Head is the next column to write, it never holds a live entry
+    StdVT<Real_t>   m_Rho, m_Alpha;
+    size_t          m_Head     = 0;
+    size_t          m_nEntries = 0;
 };
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 
+
 /**
  * @brief  LBFGS implementation based on Nocedal & Wright Numerical Optimization book (Section 7.2)
  * @tparam T scalar type
@@ -94,113 +159,96 @@ protected:
 
 template<class Real_t>
 class LBFGSSolver : public ISolver<Real_t, 1> {
+    using LineSearch = MoreThuente<Real_t, Problem<Real_t>, 1>;
 public:
-    void minimize(Problem<Real_t>& objFunc, StdVT<Real_t>& x0) {
-        size_t m     = std::min(this->m_MaxIter, size_t(10));
-        size_t nVars = static_cast<UInt>(x0.size());
-        Real_t eps_g = this->m_GradTol;
-        Real_t eps_x = Real_t(1e-8);
-
-        auto s = MatrixX<Real_t>(nVars, m);
-        auto y = MatrixX<Real_t>(nVars, m);
+    auto& historySize() { return m_HistorySize; }
 
-        StdVT<Real_t> alpha = StdVT<Real_t>(m, 0);
-        StdVT<Real_t> rho   = StdVT<Real_t>(m, 0);
-        StdVT<Real_t> grad(nVars), q(nVars), grad_old(nVars), x_old(nVars);
-
-        //	Real_t f = objFunc.value(x0);
-        Real_t f              = objFunc.valueGradient(x0, grad);
+    /**
+     * @details All vectors are allocated once (and kept between calls with the same problem size).
+     * Each pass over the vectors is parallel and fuses a vector update with the dot product needed next:
+     * the two-loop recursion takes 2m + 1 passes, the update of s and y takes 1 pass. The new point and its gradient
+     * are taken from the line search (swapped with its workspace), thus the objective is not evaluated again.
+     */
+    void minimize(Problem<Real_t>& objFunc, StdVT<Real_t>& x0) {
+        const auto&  criteria = this->m_Criteria;
+        const size_t m        = std::max(std::min(criteria.maxIter, m_HistorySize), size_t(1));
+        const size_t nVars    = x0.size();
+        m_History.resize(nVars, m);
+        m_Grad.resize(nVars);
+        m_Dir.resize(nVars);
+        this->startIterations();
+
+        Real_t f              = objFunc.valueGradient(x0, m_Grad);
         Real_t gamma_k        = this->m_InitHess;
         Real_t gradNorm       = 0;
-        Real_t alpha_init     = std::min(Real_t(1.0), Real_t(1.0) / ParallelSTL::maxAbs(grad));
+        Real_t alpha_init     = std::min(Real_t(1.0), Real_t(1.0) / ParallelSTL::maxAbs(m_Grad));
         size_t globIter       = 0;
-        size_t maxiter        = this->m_MaxIter;
+        size_t maxiter        = criteria.maxIter;
         Real_t new_hess_guess = 1.0; // only changed if we converged to a solution
 
         for(size_t k = 0; k < maxiter; k++) {
-            x_old    = x0;
-            grad_old = grad;
-            q        = grad;
             globIter++;
 
-            //L - BFGS first - loop recursion
-            size_t iter = std::min(m, k);
-            for(Int i = Int(iter) - 1; i >= 0; --i) {
-                rho[i]   = Real_t(1.0) / ParallelBLAS::dotProduct(s.col(i), y.col(i));
-                alpha[i] = rho[i] * ParallelBLAS::dotProduct(s.col(i), q);
-                ParallelBLAS::addScaled(-alpha[i], y.col(i), q);
-                //q = q - alpha[i] * y.col(i);
-            }
-
-            //L - BFGS second - loop recursion
-            //q = gamma_k * q;
-            ParallelBLAS::scale(gamma_k, q);
-            for(size_t i = 0; i < iter; ++i) {
-                Real_t beta = rho[i] * ParallelBLAS::dotProduct(q, y.col(i));
-                ParallelBLAS::addScaled((alpha[i] - beta), s.col(i), q);
-                //q = q + (alpha[i] - beta) * s.col(i);
-            }
-
             // is there a descent
-            Real_t dir = ParallelBLAS::dotProduct(q, grad);
-            if(dir < Real_t(1e-4)) {
-                q          = grad;
+            const Real_t dir = m_History.computeDirection(m_Grad, gamma_k, m_Dir, m_Grad);
+            if(dir > Real_t(-1e-4)) {
+                ParallelExec::run(nVars, [&](size_t i) { m_Dir[i] = -m_Grad[i]; });
                 maxiter   -= k;
                 k          = 0;
-                alpha_init = std::min(Real_t(1.0), Real_t(1.0) / ParallelSTL::maxAbs(grad));
+                alpha_init = std::min(Real_t(1.0), Real_t(1.0) / ParallelSTL::maxAbs(m_Grad));
+                m_History.clear();
             }
 
-            const Real_t rate = MoreThuente<Real_t, decltype(objFunc), 1>::linesearch(x0, ParallelBLAS::multiply(Real_t(-1.0), q), objFunc, alpha_init);
-            //		const Real_t rate = linesearch(objFunc, x0, -q, f, grad, 1.0);
-
-            ParallelBLAS::addScaled(-rate, q, x0);
-            //x0 = x0 - rate * q;
-
-            if(ParallelBLAS::norm2(ParallelBLAS::minus(x_old, x0)) < eps_x) {
-                //			std::cout << "x diff norm: " << (x_old - x0).squaredNorm() << std::endl;
+            const Real_t rate = LineSearch::linesearch(x0, f, m_Grad, m_Dir, objFunc, alpha_init, m_LineSearchWorkspace);
+
+            // the line search ends at x_{k+1} with its gradient in the workspace: s = x_{k+1} - x_k, y = g_{k+1} - g_k,
+            // with dot(s, s), dot(s, y) and dot(y, y), then x_{k+1} and g_{k+1} are swapped in
+            auto&              s        = m_History.newS();
+            auto&              y        = m_History.newY();
+            const auto&        xNew     = m_LineSearchWorkspace.x;
+            const auto&        gNew     = m_LineSearchWorkspace.g;
+            const Vec3<Real_t> ss_sy_yy = ParallelExec::reduce(size_t(0), nVars, Vec3<Real_t>(0),
+                                                               [&](size_t i) {
+                                                                   s[i] = xNew[i] - x0[i];
+                                                                   y[i] = gNew[i] - m_Grad[i];
+                                                                   return Vec3<Real_t>(s[i] * s[i], s[i] * y[i], y[i] * y[i]);
+                                                               });
+            std::swap(x0, m_LineSearchWorkspace.x);
+            std::swap(m_Grad, m_LineSearchWorkspace.g);
+            if(criteria.stepConverged(ss_sy_yy[0])) {
+                this->m_Status = SolverStatus::StepSize;
                 break;
             } // usually this is a problem so exit
 
-            //		f = objFunc.value(x0);
-            f = objFunc.valueGradient(x0, grad);
-
-            gradNorm = ParallelSTL::maxAbs(grad);
-            if(gradNorm < eps_g) {
+            const Real_t fOld = f;
+            f        = m_LineSearchWorkspace.f;
+            gradNorm = ParallelSTL::maxAbs(m_Grad);
+            this->recordIteration(f, gradNorm, rate);
+            if(criteria.gradientConverged(gradNorm)) {
                 // Only change hessian guess if we break out the loop via convergence.
-                //			std::cout << "grad norm: " << gradNorm << std::endl;
                 new_hess_guess = gamma_k;
+                this->m_Status = SolverStatus::GradientNorm;
                 break;
             }
-
-            StdVT<Real_t> s_temp = ParallelBLAS::minus(x0, x_old);
-            StdVT<Real_t> y_temp = ParallelBLAS::minus(grad, grad_old);
-            //StdVT<Real_t> s_temp = x0 - x_old;
-            //StdVT<Real_t> y_temp = grad - grad_old;
-
-            // update the history
-            if(k < m) {
-                s.col(k) = s_temp;
-                y.col(k) = y_temp;
-            } else {
-                std::rotate(s.data().begin(), s.data().begin() + 1, s.data().end());
-                s.col(s.nCols() - 1) = s_temp;
-
-                std::rotate(y.data().begin(), y.data().begin() + 1, y.data().end());
-                y.col(y.nCols() - 1) = y_temp;
-
-                /*s.leftCols(_m - 1) = s.rightCols(_m - 1).eval();
-                   s.rightCols(1)     = s_temp;
-                   y.leftCols(_m - 1) = y.rightCols(_m - 1).eval();
-                   y.rightCols(1)     = y_temp;*/
+            if(criteria.objectiveConverged(fOld, f)) {
+                this->m_Status = SolverStatus::ObjectiveDecrease;
+                break;
             }
 
-            gamma_k    = ParallelBLAS::dotProduct(s_temp, y_temp) / ParallelBLAS::dotProduct(y_temp, y_temp);
+            m_History.push(ss_sy_yy[1]);
+            gamma_k    = ss_sy_yy[1] / ss_sy_yy[2];
             alpha_init = 1.0;
         }
 
-        this->m_nIters   = globIter;
+        this->finishIterations(globIter);
         this->m_InitHess = new_hess_guess;
     }
+
+private:
+    size_t                         m_HistorySize = 10;
+    LBFGSHistory<Real_t>           m_History;
+    StdVT<Real_t>                  m_Grad, m_Dir;
+    typename LineSearch::Workspace m_LineSearchWorkspace;
 };
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 } // end namespace NTCodeBase::Optimization
@@ -46,19 +46,56 @@ public:
         return ak;
     }
 
+    // vectors of the trial points, kept by the caller between line searches to avoid allocations on large problems
+    // after a line search, x is the returned point x_0 + step * searchDir, g its gradient and f its objective value
+    struct Workspace {
+        StdVT<Real_t> x, g;
+        Real_t        f = 0;
+    };
+
+    /**
+     * @brief same as above, with the objective value fval and gradient grad at x already computed by the caller
+     * @details x, grad and searchDir are not copied, the trial points are stored in the workspace, which holds the
+     * returned point, its gradient and its objective value on exit: the caller can swap them in instead of evaluating them again.
+     * The step is at most stpmax, e.g. the largest step keeping x + stp * searchDir inside the feasible box.
+     * If searchDir is not a descent direction, the step is 0 and the workspace holds x, grad and fval.
+     */
+    static Real_t linesearch(const StdVT<Real_t>& x, Real_t fval, const StdVT<Real_t>& grad, const StdVT<Real_t>& searchDir, P& objFunc,
+                             Real_t alpha_init, Workspace& workspace, Real_t stpmax = Real_t(1e15)) {
+        Real_t       ak     = alpha_init;
+        const Real_t dginit = ParallelBLAS::dotProduct(grad, searchDir);
+        workspace.f = fval;
+        if(dginit >= 0) {
+            workspace.x = x;
+            workspace.g = grad;
+            return Real_t(0);
+        }
+        workspace.x.resize(x.size());
+        workspace.g.resize(x.size());
+        cvsrch(objFunc, x, workspace.x, workspace.f, dginit, workspace.g, ak, searchDir, stpmax);
+        return ak;
+    }
+
     static Int cvsrch(P& objFunc, StdVT<Real_t>& x, Real_t f, StdVT<Real_t>& g, Real_t& stp, StdVT<Real_t>& s) {
+        const StdVT<Real_t> wa = x;
+        return cvsrch(objFunc, wa, x, f, ParallelBLAS::dotProduct(g, s), g, stp, s);
+    }
+
+    // line search from wa along s, the trial points are written to x, their gradients to g and their objective values to f,
+    // dginit = dot(grad(wa), s), f = objective value at wa on entry
+    // unless s is not a descent direction, x, g and f are those of the returned step on exit (the last trial point)
+    static Int cvsrch(P& objFunc, const StdVT<Real_t>& wa, StdVT<Real_t>& x, Real_t& f, Real_t dginit, StdVT<Real_t>& g, Real_t& stp,
+                      const StdVT<Real_t>& s, const Real_t stpmax = Real_t(1e15)) {
         Int          info   = 0;
         Int          infoc  = 1;
         const Real_t xtol   = Real_t(1e-15);
         const Real_t ftol   = Real_t(1e-4);
         const Real_t gtol   = Real_t(1e-2);
         const Real_t stpmin = Real_t(1e-15);
-        const Real_t stpmax = Real_t(1e15);
         const Real_t xtrapf = Real_t(4);
         const Int    maxfev = 20;
         Int          nfev   = 0;
 
-        Real_t dginit = ParallelBLAS::dotProduct(g, s);
         if(dginit >= 0) {
             // no descent direction
             // TODO: handle this case
@@ -68,11 +105,10 @@ public:
         bool brackt = false;
         bool stage1 = true;
 
-        Real_t        finit  = f;
-        Real_t        dgtest = ftol * dginit;
-        Real_t        width  = stpmax - stpmin;
-        Real_t        width1 = 2 * width;
-        StdVT<Real_t> wa     = x;
+        Real_t finit  = f;
+        Real_t dgtest = ftol * dginit;
+        Real_t width  = stpmax - stpmin;
+        Real_t width1 = 2 * width;
 
         Real_t stx = Real_t(0.0);
         Real_t fx  = finit;
@@ -106,9 +142,7 @@ public:
             }
 
             // test new point
-            x = wa;
-            ParallelBLAS::addScaled(stp, s, x);
-            //x = wa + stp * s;
+            ParallelExec::run(x.size(), [&](size_t i) { x[i] = wa[i] + stp * s[i]; });
 
             //    f = objFunc.value(x);
             //    objFunc.gradient(x, g);
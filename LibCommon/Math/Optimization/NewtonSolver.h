@@ -0,0 +1,205 @@
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//
+//    .--------------------------------------------------.
+//    |  This file is part of NTCodeBase                 |
+//    |  Created 2018 by NT (https://ttnghia.github.io)  |
+//    '--------------------------------------------------'
+//                            \o/
+//                             |
+//                            / |
+//
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+
+
+#pragma once
+
+#include <LibCommon/Math/Optimization/ISolver.h>
+#include <LibCommon/Math/Optimization/BoxConstraints.h>
+#include <LibCommon/Math/Optimization/MoreThuente.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+namespace NTCodeBase::Optimization {
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+/**
+ * @brief  Projected Newton solver (Bertsekas 1982) with truncated CG inner solves (Nocedal & Wright, Algorithm 7.1)
+ * @details Each iteration:
+ *  1. The variables within eps of a bound with the gradient pointing outside of the box are fixed,
+ *     eps = min(activeSetTolerance, ||P(x - g) - x||). For unconstrained problems all variables are free.
+ *  2. The Newton system H_FF * d_F = -g_F of the free variables is solved by CG with Problem::hessianVectorProduct,
+ *     Jacobi preconditioned if the problem provides its Hessian diagonal, to the relative residual min(CGTolerance, sqrt(||g_F||)).
+ *     CG stops at the first direction of negative curvature, thus the Hessian does not need to be positive definite.
+ *  3. The fixed variables move toward P(x - g), the target point is projected onto the box and the More-Thuente line search,
+ *     starting with the Newton step 1, is limited to the largest feasible step as in LBFGSBSolver.
+ *     The new point and its gradient are taken from the line search workspace (evaluated again only if the projection changes the point).
+ * The number of CG iterations is reported as inner iterations in the iteration statistics.
+ */
+template<class Real_t>
+class ProjectedNewtonSolver : public ISolver<Real_t, 2> {
+    using LineSearch = MoreThuente<Real_t, Problem<Real_t>, 1>;
+public:
+    auto& maxCGIterations() { return m_MaxCGIters; }
+    auto& CGTolerance() { return m_CGTolerance; }
+    auto& activeSetTolerance() { return m_ActiveSetTol; }
+
+    void minimize(Problem<Real_t>& objFunc, StdVT<Real_t>& x0) {
+        const auto&  criteria = this->m_Criteria;
+        const size_t nVars    = x0.size();
+        m_Box.set(objFunc, nVars);
+        m_bPrecond = objFunc.hasHessianDiagonal();
+        m_Grad.resize(nVars);
+        m_Dir.resize(nVars);
+        m_R.resize(nVars);
+        m_P.resize(nVars);
+        m_HP.resize(nVars);
+        m_Free.resize(nVars);
+        m_InvDiag.resize(m_bPrecond ? nVars : 0);
+        this->startIterations();
+
+        // start from a feasible point
+        m_Box.project(x0);
+
+        Real_t f        = objFunc.valueGradient(x0, m_Grad);
+        Real_t gradNorm = m_Box.projectedGradientNorm(x0, m_Grad);
+        size_t globIter = 0;
+
+        for(size_t k = 0; k < criteria.maxIter; k++) {
+            if(criteria.gradientConverged(gradNorm)) {
+                this->m_Status = SolverStatus::GradientNorm;
+                break;
+            }
+            globIter++;
+
+            const Real_t eps = std::min(m_ActiveSetTol, gradNorm);
+            ParallelExec::run(nVars, [&](size_t i) {
+                                  m_Free[i] = !((m_Grad[i] > 0 && m_Box.atLowerBound(i, x0[i], eps)) ||
+                                                (m_Grad[i] < 0 && m_Box.atUpperBound(i, x0[i], eps)));
+                              });
+            const UInt nCGIters = solveNewtonSystem(objFunc, x0);
+
+            Vec2<Real_t> dg_maxStep = m_Box.projectDirection(x0, m_Grad, m_Dir, [&](size_t i) { return m_Free[i] ? x0[i] + m_Dir[i] : x0[i] - m_Grad[i]; });
+            if(dg_maxStep[0] >= 0) {
+                // projected steepest descent
+                dg_maxStep = m_Box.projectDirection(x0, m_Grad, m_Dir, [&](size_t i) { return x0[i] - m_Grad[i]; });
+            }
+            if(dg_maxStep[0] >= 0) {
+                this->m_Status = SolverStatus::NoDescent;
+                break;
+            }
+
+            const Real_t stpmax = BoxConstraints<Real_t>::lineSearchMaxStep(dg_maxStep[1]);
+            const Real_t rate   = LineSearch::linesearch(x0, f, m_Grad, m_Dir, objFunc, Real_t(1.0), m_LineSearchWorkspace, stpmax);
+
+            // x_{k+1} = P(x_k + rate * dir) from the line search point (the projection only removes round-off errors),
+            // with dot(s, s) and the number of projected components, then x_{k+1} and its gradient are swapped in
+            auto&              xNew     = m_LineSearchWorkspace.x;
+            const Vec2<Real_t> ss_nProj = ParallelExec::reduce(size_t(0), nVars, Vec2<Real_t>(0),
+                                                               [&](size_t i) {
+                                                                   const Real_t xi         = m_Box.project(i, xNew[i]);
+                                                                   const bool   bProjected = xi != xNew[i];
+                                                                   const Real_t si         = xi - x0[i];
+                                                                   xNew[i] = xi;
+                                                                   return Vec2<Real_t>(si * si, bProjected ? Real_t(1) : Real_t(0));
+                                                               });
+            std::swap(x0, m_LineSearchWorkspace.x);
+            std::swap(m_Grad, m_LineSearchWorkspace.g);
+            if(criteria.stepConverged(ss_nProj[0])) {
+                this->m_Status = SolverStatus::StepSize;
+                break;
+            }
+
+            const Real_t fOld = f;
+            f        = ss_nProj[1] > 0 ? objFunc.valueGradient(x0, m_Grad) : m_LineSearchWorkspace.f;
+            gradNorm = m_Box.projectedGradientNorm(x0, m_Grad);
+            this->recordIteration(f, gradNorm, rate, nCGIters);
+            if(criteria.objectiveConverged(fOld, f)) {
+                this->m_Status = SolverStatus::ObjectiveDecrease;
+                break;
+            }
+        }
+        if(this->m_Status == SolverStatus::Running && criteria.gradientConverged(gradNorm)) {
+            this->m_Status = SolverStatus::GradientNorm;
+        }
+        this->finishIterations(globIter);
+        m_Box.clear();
+    }
+
+private:
+    /**
+     * @brief truncated (preconditioned) CG for H_FF * dir_F = -g_F, the entries of the fixed variables in dir are zero
+     * @details the Hessian-vector product is taken with p, which is zero at the fixed variables, and its fixed entries are discarded
+     * @return number of CG iterations
+     */
+    UInt solveNewtonSystem(Problem<Real_t>& objFunc, const StdVT<Real_t>& x) {
+        const size_t nVars = x.size();
+        if(m_bPrecond) {
+            objFunc.hessianDiagonal(x, m_InvDiag);
+            ParallelExec::run(nVars, [&](size_t i) { m_InvDiag[i] = m_InvDiag[i] > Real_t(0) ? Real_t(1.0) / m_InvDiag[i] : Real_t(1.0); });
+        }
+        auto precond = [&](size_t i) { return m_bPrecond ? m_InvDiag[i] * m_R[i] : m_R[i]; };
+
+        // dir = 0, r = -g_F, p = z = M^-1 * r, with dot(r, z) and dot(r, r)
+        const Vec2<Real_t> rz_rr = ParallelExec::reduce(size_t(0), nVars, Vec2<Real_t>(0),
+                                                        [&](size_t i) {
+                                                            m_Dir[i] = Real_t(0);
+                                                            m_R[i]   = m_Free[i] ? -m_Grad[i] : Real_t(0);
+                                                            m_P[i]   = precond(i);
+                                                            return Vec2<Real_t>(m_R[i] * m_P[i], m_R[i] * m_R[i]);
+                                                        });
+        const Real_t gNorm = std::sqrt(rz_rr[1]);
+        const Real_t tol   = std::min(m_CGTolerance, std::sqrt(gNorm)) * gNorm;
+        Real_t       rz    = rz_rr[0];
+        UInt         iter  = 0;
+        while(iter < m_MaxCGIters && gNorm > Real_t(0)) {
+            ++iter;
+            objFunc.hessianVectorProduct(x, m_P, m_HP);
+            const Vec2<Real_t> pHp_pp = ParallelExec::reduce(size_t(0), nVars, Vec2<Real_t>(0),
+                                                             [&](size_t i) {
+                                                                 if(!m_Free[i]) { m_HP[i] = Real_t(0); }
+                                                                 return Vec2<Real_t>(m_P[i] * m_HP[i], m_P[i] * m_P[i]);
+                                                             });
+            if(pHp_pp[0] <= std::numeric_limits<Real_t>::epsilon() * pHp_pp[1]) {
+                // negative curvature: keep the current iterate, or take the (preconditioned) steepest descent direction
+                if(iter == 1) {
+                    ParallelExec::run(nVars, [&](size_t i) { m_Dir[i] = m_P[i]; });
+                }
+                break;
+            }
+
+            // dir = dir + alpha * p, r = r - alpha * Hp, with dot(r, M^-1 * r) and dot(r, r)
+            const Real_t       alpha    = rz / pHp_pp[0];
+            const Vec2<Real_t> rzNew_rr = ParallelExec::reduce(size_t(0), nVars, Vec2<Real_t>(0),
+                                                               [&](size_t i) {
+                                                                   m_Dir[i] += alpha * m_P[i];
+                                                                   m_R[i]   -= alpha * m_HP[i];
+                                                                   return Vec2<Real_t>(m_R[i] * precond(i), m_R[i] * m_R[i]);
+                                                               });
+            if(std::sqrt(rzNew_rr[1]) < tol) {
+                break;
+            }
+            const Real_t beta = rzNew_rr[0] / rz;
+            rz = rzNew_rr[0];
+            ParallelExec::run(nVars, [&](size_t i) { m_P[i] = precond(i) + beta * m_P[i]; });
+        }
+        return iter;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+    UInt                           m_MaxCGIters   = 100u;
+    Real_t                         m_CGTolerance  = Real_t(1e-2);
+    Real_t                         m_ActiveSetTol = Real_t(1e-3);
+    BoxConstraints<Real_t>         m_Box;
+    StdVT<Real_t>                  m_Grad, m_Dir;
+    StdVT<Real_t>                  m_R, m_P, m_HP, m_InvDiag; // CG vectors
+    StdVT<char>                    m_Free;                    // free variables of the current iteration
+    bool                           m_bPrecond = false;
+    typename LineSearch::Workspace m_LineSearchWorkspace;
+};
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+} // end namespace NTCodeBase::Optimization
@@ -0,0 +1,154 @@
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//
+//    .--------------------------------------------------.
+//    |  This file is part of NTCodeBase                 |
+//    |  Created 2018 by NT (https://ttnghia.github.io)  |
+//    '--------------------------------------------------'
+//                            \o/
+//                             |
+//                            / |
+//
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+
+
+#pragma once
+
+#include <LibCommon/Math/Optimization/ISolver.h>
+#include <LibCommon/Math/Optimization/MoreThuente.h>
+#include <LibCommon/ParallelHelpers/ParallelSTL.h>
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+namespace NTCodeBase::Optimization {
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+/**
+ * @brief  Nonlinear conjugate gradient (Nocedal & Wright, Section 5.2) with the More-Thuente line search
+ * @details The direction is d = -z + beta * d with z = M^-1 * g, M is the Hessian diagonal if the problem provides it
+ * (Jacobi preconditioning, updated every iteration), otherwise the identity.
+ * beta is max(0, dot(z_{k+1}, g_{k+1} - g_k) / dot(z_k, g_k)) (Polak-Ribiere+, default) or dot(z_{k+1}, g_{k+1}) / dot(z_k, g_k)
+ * (Fletcher-Reeves). The direction is reset to -z every restartInterval iterations (0: never) and if it is not a descent direction.
+ * The initial step of the line search is alpha_{k-1} * dot(g_{k-1}, d_{k-1}) / dot(g_k, d_k) (Nocedal & Wright, (3.60)).
+ * Only unconstrained problems are supported, use LBFGSBSolver or ProjectedNewtonSolver for box constraints.
+ * The new point and its gradient are taken from the line search workspace, which keeps the previous gradient until the next line search.
+ * Memory: 2 vectors plus the line search workspace (3 with preconditioning), 3 parallel passes per iteration besides the line search.
+ */
+template<class Real_t>
+class NonlinearCGSolver : public ISolver<Real_t, 1> {
+    using LineSearch = MoreThuente<Real_t, Problem<Real_t>, 1>;
+public:
+    enum class BetaFormula {
+        FletcherReeves,
+        PolakRibierePlus
+    };
+
+    auto& betaFormula() { return m_BetaFormula; }
+    auto& restartInterval() { return m_RestartInterval; }
+
+    void minimize(Problem<Real_t>& objFunc, StdVT<Real_t>& x0) {
+        NT_REQUIRE(!objFunc.hasLowerBound() && !objFunc.hasUpperBound());
+        const auto&  criteria = this->m_Criteria;
+        const size_t nVars    = x0.size();
+        m_bPrecond = objFunc.hasHessianDiagonal();
+        m_Grad.resize(nVars);
+        m_Dir.resize(nVars);
+        m_InvDiag.resize(m_bPrecond ? nVars : 0);
+        this->startIterations();
+
+        Real_t f        = objFunc.valueGradient(x0, m_Grad);
+        Real_t gradNorm = ParallelSTL::maxAbs(m_Grad);
+        size_t globIter = 0;
+        updatePreconditioner(objFunc, x0);
+
+        // d = -z, with dot(z, g)
+        Real_t zg = ParallelExec::reduce(size_t(0), nVars, Real_t(0),
+                                         [&](size_t i) {
+                                             const Real_t zi = precond(i);
+                                             m_Dir[i] = -zi;
+                                             return zi * m_Grad[i];
+                                         });
+        Real_t dg         = -zg;
+        Real_t alpha_init = std::min(Real_t(1.0), Real_t(1.0) / std::max(ParallelSTL::maxAbs(m_Dir), std::numeric_limits<Real_t>::min()));
+
+        for(size_t k = 0; k < criteria.maxIter; k++) {
+            if(criteria.gradientConverged(gradNorm)) {
+                this->m_Status = SolverStatus::GradientNorm;
+                break;
+            }
+            globIter++;
+
+            // the line search ends at x_{k+1} with its gradient in the workspace: dot(s, s) with s = x_{k+1} - x_k,
+            // then x_{k+1} and g_{k+1} are swapped in, g_k stays in the workspace
+            const Real_t rate  = LineSearch::linesearch(x0, f, m_Grad, m_Dir, objFunc, alpha_init, m_LineSearchWorkspace);
+            const auto&  xNew  = m_LineSearchWorkspace.x;
+            const Real_t sNorm = ParallelExec::reduce(size_t(0), nVars, Real_t(0), [&](size_t i) { const Real_t si = xNew[i] - x0[i]; return si * si; });
+            std::swap(x0, m_LineSearchWorkspace.x);
+            std::swap(m_Grad, m_LineSearchWorkspace.g);
+            if(criteria.stepConverged(sNorm)) {
+                this->m_Status = SolverStatus::StepSize;
+                break;
+            }
+
+            const Real_t fOld = f;
+            f        = m_LineSearchWorkspace.f;
+            gradNorm = ParallelSTL::maxAbs(m_Grad);
+            this->recordIteration(f, gradNorm, rate);
+            if(criteria.objectiveConverged(fOld, f)) {
+                this->m_Status = SolverStatus::ObjectiveDecrease;
+                break;
+            }
+            updatePreconditioner(objFunc, x0);
+
+            // dot(z_{k+1}, g_{k+1}) and dot(z_{k+1}, g_k)
+            const auto&        gOld     = m_LineSearchWorkspace.g;
+            const Vec2<Real_t> zg_zgOld = ParallelExec::reduce(size_t(0), nVars, Vec2<Real_t>(0),
+                                                               [&](size_t i) {
+                                                                   const Real_t zi = precond(i);
+                                                                   return Vec2<Real_t>(zi * m_Grad[i], zi * gOld[i]);
+                                                               });
+            Real_t beta = m_BetaFormula == BetaFormula::FletcherReeves ?
+                          zg_zgOld[0] / zg :
+                          std::max(Real_t(0), (zg_zgOld[0] - zg_zgOld[1]) / zg);
+            if(m_RestartInterval > 0 && globIter % m_RestartInterval == 0) {
+                beta = Real_t(0);
+            }
+            zg = zg_zgOld[0];
+
+            // d = -z + beta * d, with dot(d, g)
+            Real_t dgNew = ParallelExec::reduce(size_t(0), nVars, Real_t(0), [&](size_t i) { m_Dir[i] = beta * m_Dir[i] - precond(i); return m_Dir[i] * m_Grad[i]; });
+            if(dgNew >= 0) {
+                dgNew = ParallelExec::reduce(size_t(0), nVars, Real_t(0), [&](size_t i) { m_Dir[i] = -precond(i); return m_Dir[i] * m_Grad[i]; });
+            }
+            alpha_init = rate * dg / dgNew;
+            dg         = dgNew;
+        }
+        if(this->m_Status == SolverStatus::Running && criteria.gradientConverged(gradNorm)) {
+            this->m_Status = SolverStatus::GradientNorm;
+        }
+        this->finishIterations(globIter);
+    }
+
+private:
+    void updatePreconditioner(Problem<Real_t>& objFunc, const StdVT<Real_t>& x) {
+        if(m_bPrecond) {
+            objFunc.hessianDiagonal(x, m_InvDiag);
+            ParallelExec::run(x.size(), [&](size_t i) { m_InvDiag[i] = m_InvDiag[i] > Real_t(0) ? Real_t(1.0) / m_InvDiag[i] : Real_t(1.0); });
+        }
+    }
+
+    // z_i = (M^-1 * g)_i
+    Real_t precond(size_t i) const { return m_bPrecond ? m_InvDiag[i] * m_Grad[i] : m_Grad[i]; }
+
+    ////////////////////////////////////////////////////////////////////////////////
+    BetaFormula                    m_BetaFormula     = BetaFormula::PolakRibierePlus;
+    size_t                         m_RestartInterval = 0;
+    StdVT<Real_t>                  m_Grad, m_Dir, m_InvDiag;
+    bool                           m_bPrecond = false;
+    typename LineSearch::Workspace m_LineSearchWorkspace;
+};
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+} // end namespace NTCodeBase::Optimization
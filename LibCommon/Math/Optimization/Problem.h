@@ -15,6 +15,10 @@
 #pragma once
 
 #include <LibCommon/CommonSetup.h>
+#include <LibCommon/ParallelHelpers/ParallelSTL.h>
+
+#include <cmath>
+#include <limits>
 
 #define EXPECT_NEAR(x, y, z)
 
@@ -31,6 +35,10 @@ protected:
     StdVT<Real_t> lowerBound_;
     StdVT<Real_t> upperBound_;
 
+    // scratch vectors of finiteHessianVectorProduct
+    StdVT<Real_t> fdX_;
+    StdVT<Real_t> fdGrad_;
+
 public:
 
     Problem() {}
@@ -50,19 +58,19 @@ public:
         hasUpperBound_ = true;
     }
 
-    bool hasLowerBound() {
+    bool hasLowerBound() const {
         return hasLowerBound_;
     }
 
-    bool hasUpperBound() {
+    bool hasUpperBound() const {
         return hasUpperBound_;
     }
 
-    StdVT<Real_t> lowerBound() {
+    const StdVT<Real_t>& lowerBound() const {
         return lowerBound_;
     }
 
-    StdVT<Real_t> upperBound() {
+    const StdVT<Real_t>& upperBound() const {
         return upperBound_;
     }
 
@@ -111,6 +119,20 @@ public:
     //    finiteHessian(x, hessian);
     //}
 
+    /**
+     * @brief Hessian-vector product Hv = H(x) * v, for Newton type solvers
+     * @details should be overwritten by the symbolic product (e.g. summed element by element, with the element Hessians
+     * projected to positive semi-definite), the default uses central differences of the gradient at x +/- h * v
+     * (2 evaluations of valueGradient), with the two points kept inside the box constraint
+     */
+    virtual void hessianVectorProduct(const StdVT<Real_t>& x, const StdVT<Real_t>& v, StdVT<Real_t>& Hv) {
+        finiteHessianVectorProduct(x, v, Hv);
+    }
+
+    // Diagonal of the Hessian, used for Jacobi preconditioning by the Newton and nonlinear CG solvers if provided
+    virtual bool hasHessianDiagonal() const { return false; }
+    virtual void hessianDiagonal(const StdVT<Real_t>& /*x*/, StdVT<Real_t>& /*diag*/) {}
+
     virtual bool checkGradient(const StdVT<Real_t>& x, int accuracy = 3) {
         // TODO: check if derived class exists:
         // int(typeid(&Rosenbrock<float>::gradient) == typeid(&Problem<float>::gradient)) == 1 --> overwritten
@@ -178,6 +200,51 @@ public:
         grad = finiteDiff;
     }
 
+    virtual void finiteHessianVectorProduct(const StdVT<Real_t>& x, const StdVT<Real_t>& v, StdVT<Real_t>& Hv) final {
+        const size_t D    = x.size();
+        const Real_t vMax = ParallelSTL::maxAbs(v);
+        Hv.resize(D);
+        if(vMax == Real_t(0)) {
+            ParallelExec::run(D, [&](size_t i) { Hv[i] = Real_t(0); });
+            return;
+        }
+        // step minimizing truncation + round-off error of central differences, relative to the magnitude of x
+        const Real_t h = std::cbrt(std::numeric_limits<Real_t>::epsilon()) * (Real_t(1) + ParallelSTL::maxAbs(x)) / vMax;
+        // with bounds, the steps along +/- v are shortened to stay inside the box, which makes the difference one-sided
+        // (first order) close to the bounds; if v leaves the box in both directions the points are not projected
+        Real_t hPlus = h, hMinus = h;
+        if(hasLowerBound_ || hasUpperBound_) {
+            hPlus  = feasibleStep(x, v, Real_t(1), h);
+            hMinus = feasibleStep(x, v, Real_t(-1), h);
+            if(hPlus + hMinus == Real_t(0)) {
+                hPlus = hMinus = h;
+            }
+        }
+        fdX_.resize(D);
+        fdGrad_.resize(D);
+        ParallelExec::run(D, [&](size_t i) { fdX_[i] = x[i] + hPlus * v[i]; });
+        valueGradient(fdX_, Hv);
+        ParallelExec::run(D, [&](size_t i) { fdX_[i] = x[i] - hMinus * v[i]; });
+        valueGradient(fdX_, fdGrad_);
+        ParallelExec::run(D, [&](size_t i) { Hv[i] = (Hv[i] - fdGrad_[i]) / (hPlus + hMinus); });
+    }
+
+    // largest step t <= maxStep such that x + t * sign * v is inside the box
+    Real_t feasibleStep(const StdVT<Real_t>& x, const StdVT<Real_t>& v, Real_t sign, Real_t maxStep) const {
+        return ParallelExec::reduce(size_t(0), x.size(), maxStep,
+                                    [&](size_t i) {
+                                        const Real_t d = sign * v[i];
+                                        Real_t t = maxStep;
+                                        if(d > 0 && hasUpperBound_) {
+                                            t = (upperBound_[i] - x[i]) / d;
+                                        } else if(d < 0 && hasLowerBound_) {
+                                            t = (lowerBound_[i] - x[i]) / d;
+                                        }
+                                        return std::max(t, Real_t(0));
+                                    },
+                                    [](Real_t a, Real_t b) { return std::min(a, b); });
+    }
+
     /*
             virtual void finiteHessian(const StdVT<Real_t>& x, MatrixX<Real_t>& hessian, int accuracy = 0) final
             {
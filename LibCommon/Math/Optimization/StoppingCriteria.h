@@ -0,0 +1,64 @@
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//
+//    .--------------------------------------------------.
+//    |  This file is part of NTCodeBase                 |
+//    |  Created 2018 by NT (https://ttnghia.github.io)  |
+//    '--------------------------------------------------'
+//                            \o/
+//                             |
+//                            / |
+//
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+
+
+#pragma once
+
+#include <LibCommon/CommonSetup.h>
+
+#include <algorithm>
+#include <cmath>
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+namespace NTCodeBase::Optimization {
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+enum class SolverStatus {
+    NotStarted,
+    Running,
+    IterationLimit,    // maxIter iterations done
+    GradientNorm,      // converged: the max norm of the (projected) gradient is below gradTol
+    StepSize,          // the last step is shorter than stepTol
+    ObjectiveDecrease, // the relative decrease of the objective is below fDeltaTol
+    NoDescent          // no descent direction could be found
+};
+
+/**
+ * @brief stopping criteria shared by all solvers
+ * @details gradTol is the usual convergence test, stepTol and fDeltaTol stop stagnating iterations
+ */
+template<class Real_t>
+struct StoppingCriteria {
+    size_t maxIter   = 100000;
+    Real_t gradTol   = Real_t(1e-4); // max norm of the gradient, or of the projected gradient P(x - g) - x for box constrained problems
+    Real_t stepTol   = Real_t(1e-4); // L2 norm of the step x_{k+1} - x_k
+    Real_t fDeltaTol = Real_t(0);    // relative decrease (f_k - f_{k+1}) / max(|f_k|, 1), 0 disables the test
+
+    bool gradientConverged(Real_t gradNorm) const { return gradNorm < gradTol; }
+    bool stepConverged(Real_t stepNorm2) const { return stepNorm2 < stepTol * stepTol; } // squared step norm, as returned by the fused passes
+    bool objectiveConverged(Real_t fOld, Real_t fNew) const {
+        return fDeltaTol > 0 && fOld - fNew < fDeltaTol * std::max(std::abs(fOld), Real_t(1));
+    }
+};
+
+// Statistics of one iteration, see ISolver::iterationStats
+template<class Real_t>
+struct IterationStats {
+    Real_t f           = 0; // objective value after the iteration
+    Real_t gradNorm    = 0; // max norm of the (projected) gradient after the iteration
+    Real_t stepLength  = 0; // step of the line search along the search direction
+    UInt   nInnerIters = 0; // inner (e.g. CG) iterations for computing the search direction
+    double time        = 0; // wall time of the iteration, in ms
+};
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+} // end namespace NTCodeBase::Optimization
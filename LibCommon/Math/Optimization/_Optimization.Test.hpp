@@ -0,0 +1,510 @@
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//
+//    .--------------------------------------------------.
+//    |  This file is part of NTCodeBase                 |
+//    |  Created 2018 by NT (https://ttnghia.github.io)  |
+//    '--------------------------------------------------'
+//                            \o/
+//                             |
+//                            / |
+//
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+
+
+#pragma once
+
+#include <catch2/catch.hpp>
+#include <LibCommon/CommonSetup.h>
+#include <LibCommon/Math/Optimization/LBFGSSolver.h>
+#include <LibCommon/Math/Optimization/LBFGSBSolver.h>
+#include <LibCommon/Math/Optimization/NewtonSolver.h>
+#include <LibCommon/Math/Optimization/NonlinearCGSolver.h>
+
+#include <random>
+
+using namespace NTCodeBase;
+using namespace NTCodeBase::Optimization;
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// largest distance of x to the box of the problem, 0 if x is feasible
+double boundViolation(const Problem<double>& problem, const StdVT<double>& x) {
+    double violation = 0;
+    for(size_t i = 0; i < x.size(); ++i) {
+        if(problem.hasLowerBound()) {
+            violation = std::max(violation, problem.lowerBound()[i] - x[i]);
+        }
+        if(problem.hasUpperBound()) {
+            violation = std::max(violation, x[i] - problem.upperBound()[i]);
+        }
+    }
+    return violation;
+}
+
+// max norm of the projected gradient P(x - g) - x
+double projectedGradientNorm(const Problem<double>& problem, const StdVT<double>& x, const StdVT<double>& grad) {
+    double result = 0;
+    for(size_t i = 0; i < x.size(); ++i) {
+        double xi = x[i] - grad[i];
+        if(problem.hasLowerBound()) {
+            xi = std::max(xi, problem.lowerBound()[i]);
+        }
+        if(problem.hasUpperBound()) {
+            xi = std::min(xi, problem.upperBound()[i]);
+        }
+        result = std::max(result, std::abs(xi - x[i]));
+    }
+    return result;
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// sum_k 100 * (x_{2k+1} - x_{2k}^2)^2 + (1 - x_{2k})^2, minimum 0 at x = 1, counting the evaluations
+class Rosenbrock : public Problem<double> {
+public:
+    double value(const StdVT<double>& x) override { StdVT<double> grad(x.size()); return valueGradient(x, grad); }
+    double valueGradient(const StdVT<double>& x, StdVT<double>& grad) override {
+        ++nEvaluations;
+        maxBoundViolation = std::max(maxBoundViolation, boundViolation(*this, x));
+        grad.resize(x.size());
+        return ParallelExec::reduce(size_t(0), x.size() / 2, 0.0,
+                                    [&](size_t k) {
+                                        const size_t i = 2 * k;
+                                        const double a = x[i + 1] - x[i] * x[i];
+                                        const double b = 1.0 - x[i];
+                                        grad[i]     = -400.0 * a * x[i] - 2.0 * b;
+                                        grad[i + 1] = 200.0 * a;
+                                        return 100.0 * a * a + b * b;
+                                    });
+    }
+
+    // the usual starting point (-1.2, 1) for each pair
+    static StdVT<double> startingPoint(size_t nVars) {
+        StdVT<double> x(nVars);
+        for(size_t i = 0; i < nVars; ++i) {
+            x[i] = (i % 2) ? 1.0 : -1.2;
+        }
+        return x;
+    }
+
+    size_t nEvaluations      = 0;
+    double maxBoundViolation = 0; // over all evaluated points, the iterates included
+};
+
+// Rosenbrock with the analytic Hessian-vector product and Hessian diagonal
+class RosenbrockHessian : public Rosenbrock {
+public:
+    void hessianVectorProduct(const StdVT<double>& x, const StdVT<double>& v, StdVT<double>& Hv) override {
+        Hv.resize(x.size());
+        for(size_t i = 0; i < x.size(); i += 2) {
+            const double h00 = 1200.0 * x[i] * x[i] - 400.0 * x[i + 1] + 2.0;
+            const double h01 = -400.0 * x[i];
+            Hv[i]     = h00 * v[i] + h01 * v[i + 1];
+            Hv[i + 1] = h01 * v[i] + 200.0 * v[i + 1];
+        }
+    }
+
+    bool hasHessianDiagonal() const override { return true; }
+    void hessianDiagonal(const StdVT<double>& x, StdVT<double>& diag) override {
+        diag.resize(x.size());
+        for(size_t i = 0; i < x.size(); i += 2) {
+            diag[i]     = 1200.0 * x[i] * x[i] - 400.0 * x[i + 1] + 2.0;
+            diag[i + 1] = 200.0;
+        }
+    }
+};
+
+// 0.5 * x^T A x - b^T x with the SPD tridiagonal A = tridiag(-1, 4, -1), minimum at A^-1 b
+class TridiagonalQuadratic : public Problem<double> {
+public:
+    double value(const StdVT<double>& x) override { StdVT<double> grad(x.size()); return valueGradient(x, grad); }
+    double valueGradient(const StdVT<double>& x, StdVT<double>& grad) override {
+        multiply(x, grad);
+        double f = 0;
+        for(size_t i = 0; i < x.size(); ++i) {
+            f       += 0.5 * x[i] * grad[i] - b[i] * x[i];
+            grad[i] -= b[i];
+        }
+        return f;
+    }
+
+    void hessianVectorProduct(const StdVT<double>& /*x*/, const StdVT<double>& v, StdVT<double>& Hv) override { multiply(v, Hv); }
+
+    void multiply(const StdVT<double>& v, StdVT<double>& Av) const {
+        Av.resize(v.size());
+        for(size_t i = 0; i < v.size(); ++i) {
+            Av[i] = 4.0 * v[i] - (i > 0 ? v[i - 1] : 0.0) - (i + 1 < v.size() ? v[i + 1] : 0.0);
+        }
+    }
+
+    StdVT<double> b;
+};
+
+// sum_i c_i * (x_i - t_i)^2
+class SeparableQuadratic : public Problem<double> {
+public:
+    double value(const StdVT<double>& x) override { StdVT<double> grad(x.size()); return valueGradient(x, grad); }
+    double valueGradient(const StdVT<double>& x, StdVT<double>& grad) override {
+        maxBoundViolation = std::max(maxBoundViolation, boundViolation(*this, x));
+        grad.resize(x.size());
+        double f = 0;
+        for(size_t i = 0; i < x.size(); ++i) {
+            f       += c[i] * (x[i] - t[i]) * (x[i] - t[i]);
+            grad[i]  = 2.0 * c[i] * (x[i] - t[i]);
+        }
+        return f;
+    }
+
+    StdVT<double> c, t;
+    double        maxBoundViolation = 0;
+};
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// regression test: iterations and evaluations are pinned (deterministic reductions), the new point and its gradient are
+// taken from the line search, thus each iteration costs the line search evaluations only
+TEST_CASE("Test_LBFGS", "[Test_LBFGS]")
+{
+    ParallelExec::setDefaultReductionPolicy(ParallelExec::ReductionPolicy::Deterministic);
+    for(size_t nVars : { size_t(2), size_t(1000) }) {
+        Rosenbrock          problem;
+        LBFGSSolver<double> solver;
+        StdVT<double>       x = Rosenbrock::startingPoint(nVars);
+        solver.gradTolerance()            = 1e-8;
+        solver.stoppingCriteria().stepTol = 1e-12;
+        solver.minimize(problem, x);
+        printf("L-BFGS, Rosenbrock (%zu variables): %zu iterations, %zu evaluations, f = %g\n",
+               nVars, solver.nIters(), problem.nEvaluations, solver.iterationStats().back().f);
+
+        REQUIRE(solver.status() == SolverStatus::GradientNorm);
+        REQUIRE(solver.nIters() == (nVars == 2 ? 70u : 28u));
+        REQUIRE(problem.nEvaluations == (nVars == 2 ? 170u : 86u));
+        REQUIRE(solver.iterationStats().size() == solver.nIters());
+        REQUIRE(solver.iterationStats().back().gradNorm < 1e-8);
+        REQUIRE(solver.iterationStats().back().f < 1e-15);
+        for(auto xi : x) {
+            REQUIRE(std::abs(xi - 1.0) < 1e-7);
+        }
+
+        // the objective value and gradient at the returned point are the ones of the last iteration
+        StdVT<double> grad;
+        REQUIRE(problem.valueGradient(x, grad) == solver.iterationStats().back().f);
+        REQUIRE(ParallelSTL::maxAbs(grad) == solver.iterationStats().back().gradNorm);
+    }
+    ParallelExec::setDefaultReductionPolicy(ParallelExec::ReductionPolicy::Fast);
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// a pair written into a full history but not pushed (skipped by the curvature check of L-BFGS-B, e.g. after a step limited
+// by the bounds) leaves the history unchanged, and the next pushed pair drops the oldest entry
+TEST_CASE("Test_LBFGSHistory", "[Test_LBFGSHistory]")
+{
+    ParallelExec::setDefaultReductionPolicy(ParallelExec::ReductionPolicy::Deterministic);
+    const size_t                           nVars = 1000, m = 5;
+    std::mt19937                           generator(0);
+    std::uniform_real_distribution<double> distribution(-1.0, 1.0);
+    StdVT<double>                          diag(nVars), v(nVars);
+    StdVT<StdVT<double>>                   pairs(m + 1, StdVT<double>(nVars));
+    for(size_t i = 0; i < nVars; ++i) {
+        diag[i] = 2.0 + distribution(generator);
+        v[i]    = distribution(generator);
+        for(auto& s : pairs) {
+            s[i] = distribution(generator);
+        }
+    }
+
+    // s and y = diag(A) * s, thus dot(s, y) > 0
+    auto pushPair = [&](LBFGSHistory<double>& history, const StdVT<double>& s) {
+                        auto&  newS = history.newS();
+                        auto&  newY = history.newY();
+                        double sy   = 0;
+                        for(size_t i = 0; i < nVars; ++i) {
+                            newS[i] = s[i];
+                            newY[i] = diag[i] * s[i];
+                            sy     += newS[i] * newY[i];
+                        }
+                        history.push(sy);
+                    };
+
+    LBFGSHistory<double> history;
+    StdVT<double>        dir(nVars), dirSkipped(nVars);
+    history.resize(nVars, m);
+    for(size_t j = 0; j < m; ++j) {
+        pushPair(history, pairs[j]);
+    }
+    REQUIRE(history.size() == m);
+    const double dot = history.computeDirection(v, 0.5, dir, v);
+
+    // a pair with negative curvature, which is not pushed
+    auto& skippedS = history.newS();
+    auto& skippedY = history.newY();
+    for(size_t i = 0; i < nVars; ++i) {
+        skippedS[i] = 1e3 * distribution(generator);
+        skippedY[i] = -skippedS[i];
+    }
+    REQUIRE(history.size() == m);
+    REQUIRE(history.computeDirection(v, 0.5, dirSkipped, v) == dot);
+    REQUIRE(dirSkipped == dir);
+
+    // same as a history of the last m pairs
+    LBFGSHistory<double> historyLastPairs;
+    StdVT<double>        dirLastPairs(nVars);
+    pushPair(history, pairs[m]);
+    historyLastPairs.resize(nVars, m);
+    for(size_t j = 1; j <= m; ++j) {
+        pushPair(historyLastPairs, pairs[j]);
+    }
+    REQUIRE(history.size() == m);
+    REQUIRE(history.computeDirection(v, 0.5, dir, v) == historyLastPairs.computeDirection(v, 0.5, dirLastPairs, v));
+    REQUIRE(dir == dirLastPairs);
+    ParallelExec::setDefaultReductionPolicy(ParallelExec::ReductionPolicy::Fast);
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+TEST_CASE("Test_LBFGSB", "[Test_LBFGSB]")
+{
+    ////////////////////////////////////////////////////////////////////////////////
+    // separable quadratic in [-1, 1]^n: the minimizer is clamp(t, -1, 1), the active set is |t_i| > 1
+    {
+        const size_t                           nVars = 1000;
+        std::mt19937                           generator(0);
+        std::uniform_real_distribution<double> target(-2.0, 2.0), curvature(1.0, 100.0);
+        SeparableQuadratic                     problem;
+        problem.c.resize(nVars);
+        problem.t.resize(nVars);
+        for(size_t i = 0; i < nVars; ++i) {
+            problem.c[i] = curvature(generator);
+            problem.t[i] = target(generator);
+        }
+        problem.setBoxConstraint(StdVT<double>(nVars, -1.0), StdVT<double>(nVars, 1.0));
+
+        LBFGSBSolver<double> solver;
+        StdVT<double>        x(nVars, 0.3);
+        solver.gradTolerance()            = 1e-8;
+        solver.stoppingCriteria().stepTol = 1e-12;
+        solver.minimize(problem, x);
+        REQUIRE(solver.status() == SolverStatus::GradientNorm);
+        REQUIRE(problem.maxBoundViolation == 0.0);
+        size_t nActive = 0;
+        for(size_t i = 0; i < nVars; ++i) {
+            if(std::abs(problem.t[i]) > 1.0) {
+                REQUIRE(x[i] == (problem.t[i] > 0 ? 1.0 : -1.0));
+                ++nActive;
+            } else {
+                // the gradient of a free variable is 2 c_i (x_i - t_i)
+                REQUIRE(std::abs(x[i] - problem.t[i]) < 1e-8 / (2.0 * problem.c[i]));
+            }
+        }
+        REQUIRE(nActive > nVars / 3);
+        StdVT<double> grad;
+        problem.valueGradient(x, grad);
+        REQUIRE(projectedGradientNorm(problem, x, grad) == solver.projectedGradientNorm());
+        REQUIRE(solver.projectedGradientNorm() < 1e-8);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // Rosenbrock with x_{2k} <= 0.5, cutting through the unconstrained minimum x = 1: the minimizer is (0.5, 0.25) for each pair,
+    // the feasibility of the iterates is checked at every evaluation
+    // iterations and evaluations are pinned (deterministic reductions), the new point and its gradient are taken from the line search
+    ParallelExec::setDefaultReductionPolicy(ParallelExec::ReductionPolicy::Deterministic);
+    for(size_t nVars : { size_t(2), size_t(1000) }) {
+        Rosenbrock    problem;
+        StdVT<double> lower(nVars, -10.0), upper(nVars, 10.0);
+        for(size_t i = 0; i < nVars; i += 2) {
+            upper[i] = 0.5;
+        }
+        problem.setBoxConstraint(lower, upper);
+
+        LBFGSBSolver<double> solver;
+        StdVT<double>        x = Rosenbrock::startingPoint(nVars);
+        solver.gradTolerance()            = 1e-8;
+        solver.stoppingCriteria().stepTol = 1e-12;
+        solver.minimize(problem, x);
+        printf("L-BFGS-B, bounded Rosenbrock (%zu variables): %zu iterations, %zu evaluations\n", nVars, solver.nIters(), problem.nEvaluations);
+        REQUIRE(solver.status() == SolverStatus::GradientNorm);
+        REQUIRE(solver.nIters() == 12u);
+        REQUIRE(problem.nEvaluations == 44u);
+        REQUIRE(problem.maxBoundViolation == 0.0);
+        for(size_t i = 0; i < nVars; i += 2) {
+            REQUIRE(x[i] == 0.5);
+            REQUIRE(std::abs(x[i + 1] - 0.25) < 1e-8);
+        }
+        StdVT<double> grad;
+        REQUIRE(problem.valueGradient(x, grad) == solver.iterationStats().back().f);
+        REQUIRE(projectedGradientNorm(problem, x, grad) == solver.projectedGradientNorm());
+        REQUIRE(solver.projectedGradientNorm() < 1e-8);
+        REQUIRE(solver.iterationStats().back().gradNorm == solver.projectedGradientNorm());
+    }
+    ParallelExec::setDefaultReductionPolicy(ParallelExec::ReductionPolicy::Fast);
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // without bounds, the same minimizer as L-BFGS
+    {
+        const size_t         nVars = 1000;
+        Rosenbrock           problem, problemLBFGS;
+        LBFGSBSolver<double> solver;
+        LBFGSSolver<double>  solverLBFGS;
+        StdVT<double>        x = Rosenbrock::startingPoint(nVars), xLBFGS = x;
+        solver.gradTolerance()                 = 1e-8;
+        solver.stoppingCriteria().stepTol      = 1e-12;
+        solverLBFGS.gradTolerance()            = 1e-8;
+        solverLBFGS.stoppingCriteria().stepTol = 1e-12;
+        solver.minimize(problem, x);
+        solverLBFGS.minimize(problemLBFGS, xLBFGS);
+        REQUIRE(solver.status() == SolverStatus::GradientNorm);
+        REQUIRE(solverLBFGS.status() == SolverStatus::GradientNorm);
+        for(size_t i = 0; i < nVars; ++i) {
+            REQUIRE(std::abs(x[i] - xLBFGS[i]) < 1e-7);
+        }
+        REQUIRE(std::abs(solver.iterationStats().back().f - solverLBFGS.iterationStats().back().f) < 1e-12);
+    }
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+TEST_CASE("Test_HessianVectorProduct", "[Test_HessianVectorProduct]")
+{
+    const size_t                           nVars = 1000;
+    std::mt19937                           generator(0);
+    std::uniform_real_distribution<double> distribution(-1.0, 1.0);
+    RosenbrockHessian                      problem;
+    StdVT<double>                          x(nVars), v(nVars), Hv, fdHv;
+    for(size_t i = 0; i < nVars; ++i) {
+        x[i] = distribution(generator);
+        v[i] = distribution(generator);
+    }
+    auto maxRelativeError = [&] {
+                                double error = 0, scale = 0;
+                                for(size_t i = 0; i < nVars; ++i) {
+                                    error = std::max(error, std::abs(Hv[i] - fdHv[i]));
+                                    scale = std::max(scale, std::abs(Hv[i]));
+                                }
+                                return error / scale;
+                            };
+
+    // central differences
+    problem.hessianVectorProduct(x, v, Hv);
+    problem.finiteHessianVectorProduct(x, v, fdHv);
+    REQUIRE(maxRelativeError() < 1e-8);
+
+    // x on the bounds of the box [-1, 1]^n with v pointing out of the box: the finite difference points are projected,
+    // which makes the differences one-sided
+    StdVT<double> lower(nVars, -1.0), upper(nVars, 1.0);
+    x[0] = 1.0;
+    v[0] = std::abs(v[0]);
+    x[1] = -1.0;
+    v[1] = -std::abs(v[1]);
+    problem.setBoxConstraint(lower, upper);
+    problem.hessianVectorProduct(x, v, Hv);
+    problem.finiteHessianVectorProduct(x, v, fdHv);
+    REQUIRE(problem.maxBoundViolation == 0.0);
+    REQUIRE(maxRelativeError() < 1e-4);
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+TEST_CASE("Test_ProjectedNewton", "[Test_ProjectedNewton]")
+{
+    ////////////////////////////////////////////////////////////////////////////////
+    // SPD quadratic: with an exact CG solve, the Newton step 1 is the minimizer
+    {
+        const size_t                  nVars = 100;
+        TridiagonalQuadratic          problem;
+        ProjectedNewtonSolver<double> solver;
+        StdVT<double>                 x(nVars, 0.0), Ax;
+        problem.b.resize(nVars);
+        for(size_t i = 0; i < nVars; ++i) {
+            problem.b[i] = std::sin(double(i));
+        }
+        REQUIRE(solver.status() == SolverStatus::NotStarted);
+        solver.gradTolerance() = 1e-8;
+        solver.CGTolerance()   = 1e-14;
+        solver.minimize(problem, x);
+        REQUIRE(solver.status() == SolverStatus::GradientNorm);
+        REQUIRE(solver.nIters() == 1u);
+        REQUIRE(solver.iterationStats().size() == 1u);
+        REQUIRE(solver.iterationStats()[0].stepLength == 1.0);
+        REQUIRE(solver.iterationStats()[0].nInnerIters > 0u);
+        REQUIRE(solver.iterationStats()[0].gradNorm < 1e-8);
+        problem.multiply(x, Ax);
+        for(size_t i = 0; i < nVars; ++i) {
+            REQUIRE(std::abs(Ax[i] - problem.b[i]) < 1e-8);
+        }
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // Rosenbrock with the analytic and the finite difference Hessian-vector products, unbounded and with x_{2k} <= 0.5
+    // iterations and evaluations are pinned (deterministic reductions), the new point and its gradient are taken from the line search
+    ParallelExec::setDefaultReductionPolicy(ParallelExec::ReductionPolicy::Deterministic);
+    for(bool bBounded : { false, true }) {
+        const size_t      nVars = 1000;
+        RosenbrockHessian analytic;
+        Rosenbrock        finite;
+        if(bBounded) {
+            StdVT<double> lower(nVars, -10.0), upper(nVars, 10.0);
+            for(size_t i = 0; i < nVars; i += 2) {
+                upper[i] = 0.5;
+            }
+            analytic.setBoxConstraint(lower, upper);
+            finite.setBoxConstraint(lower, upper);
+        }
+        for(Rosenbrock* problem : { static_cast<Rosenbrock*>(&analytic), &finite }) {
+            ProjectedNewtonSolver<double> solver;
+            StdVT<double>                 x = Rosenbrock::startingPoint(nVars);
+            solver.gradTolerance()            = 1e-8;
+            solver.stoppingCriteria().stepTol = 1e-12;
+            solver.minimize(*problem, x);
+            printf("Projected Newton, %s Rosenbrock (%s Hessian): %zu iterations, %zu evaluations\n", bBounded ? "bounded" : "unbounded",
+                   problem == &analytic ? "analytic" : "finite difference", solver.nIters(), problem->nEvaluations);
+            REQUIRE(solver.status() == SolverStatus::GradientNorm);
+            REQUIRE(solver.nIters() == (bBounded ? 9u : 14u));
+            REQUIRE(problem->nEvaluations == (problem == &analytic ? (bBounded ? 35u : 54u) : (bBounded ? 71u : 106u)));
+            REQUIRE(problem->maxBoundViolation == 0.0);
+            REQUIRE(solver.iterationStats().size() == solver.nIters());
+            for(const auto& stats : solver.iterationStats()) {
+                REQUIRE(stats.nInnerIters > 0u);
+            }
+            REQUIRE(solver.iterationStats().back().gradNorm < 1e-8);
+            for(size_t i = 0; i < nVars; i += 2) {
+                REQUIRE(std::abs(x[i] - (bBounded ? 0.5 : 1.0)) < 1e-7);
+                REQUIRE(std::abs(x[i + 1] - (bBounded ? 0.25 : 1.0)) < 1e-7);
+            }
+            StdVT<double> grad;
+            REQUIRE(problem->valueGradient(x, grad) == solver.iterationStats().back().f);
+            REQUIRE(projectedGradientNorm(*problem, x, grad) == solver.iterationStats().back().gradNorm);
+        }
+    }
+    ParallelExec::setDefaultReductionPolicy(ParallelExec::ReductionPolicy::Fast);
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+TEST_CASE("Test_NonlinearCG", "[Test_NonlinearCG]")
+{
+    // iterations and evaluations are pinned (deterministic reductions), the new point and its gradient are taken from the line search
+    using BetaFormula = NonlinearCGSolver<double>::BetaFormula;
+    ParallelExec::setDefaultReductionPolicy(ParallelExec::ReductionPolicy::Deterministic);
+    for(BetaFormula beta : { BetaFormula::PolakRibierePlus, BetaFormula::FletcherReeves }) {
+        for(size_t nVars : { size_t(2), size_t(1000) }) {
+            Rosenbrock                problem;
+            NonlinearCGSolver<double> solver;
+            StdVT<double>             x = Rosenbrock::startingPoint(nVars);
+            REQUIRE(solver.status() == SolverStatus::NotStarted);
+            solver.betaFormula()              = beta;
+            solver.gradTolerance()            = 1e-8;
+            solver.stoppingCriteria().stepTol = 1e-12;
+            solver.minimize(problem, x);
+            printf("Nonlinear CG (%s), Rosenbrock (%zu variables): %zu iterations, %zu evaluations\n",
+                   beta == BetaFormula::FletcherReeves ? "Fletcher-Reeves" : "Polak-Ribiere+", nVars, solver.nIters(), problem.nEvaluations);
+            REQUIRE(solver.status() == SolverStatus::GradientNorm);
+            REQUIRE(solver.nIters() == (beta == BetaFormula::FletcherReeves ? 115u : 22u));
+            REQUIRE(problem.nEvaluations == (beta == BetaFormula::FletcherReeves ? 278u : 74u));
+            REQUIRE(solver.iterationStats().size() == solver.nIters());
+            REQUIRE(solver.iterationStats().back().gradNorm < 1e-8);
+            REQUIRE(solver.iterationStats().back().f < 1e-12);
+            for(size_t i = 0; i < nVars; ++i) {
+                REQUIRE(std::abs(x[i] - 1.0) < 1e-6);
+            }
+            StdVT<double> grad;
+            REQUIRE(problem.valueGradient(x, grad) == solver.iterationStats().back().f);
+            REQUIRE(ParallelSTL::maxAbs(grad) == solver.iterationStats().back().gradNorm);
+        }
+    }
+    ParallelExec::setDefaultReductionPolicy(ParallelExec::ReductionPolicy::Fast);
+}
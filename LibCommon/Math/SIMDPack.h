@@ -0,0 +1,202 @@
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//
+//    .--------------------------------------------------.
+//    |  This file is part of NTCodeBase                 |
+//    |  Created 2018 by NT (https://ttnghia.github.io)  |
+//    '--------------------------------------------------'
+//                            \o/
+//                             |
+//                            / |
+//
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+
+#include <LibCommon/CommonSetup.h>
+
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+namespace NTCodeBase::SIMD {
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// SIMD packs of Width lanes, for writing branch-free batched kernels once for all instruction sets
+// Pack<T> uses the widest registers available (AVX-512 or AVX2), Pack<T, false> is always the scalar version
+// (one lane), for the remainders of batches and for builds without SIMD.
+// Masks are the result of comparisons and are only used by select(mask, a, b) = mask ? a : b
+// load/store require Width * sizeof(T) aligned pointers, loadu/storeu do not
+// rsqrt uses the hardware approximation refined by Newton iterations when available (about 14 or 12 bits,
+// each iteration doubles the number of correct bits), which is much cheaper than a square root and a division
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<class P, class T>
+P newtonRsqrt(P a, P y) {
+    return y * (P::set1(T(1.5)) - P::set1(T(0.5)) * a * y * y);
+}
+
+template<class T, bool bSIMD = true>
+struct Pack {
+    static constexpr Int Width = 1;
+    using Mask                 = bool;
+    T v;
+
+    static Pack set1(T x) { return { x }; }
+    static Pack load(const T* p) { return { *p }; }
+    static Pack loadu(const T* p) { return { *p }; }
+    void        store(T* p) const { *p = v; }
+    void        storeu(T* p) const { *p = v; }
+
+    friend Pack operator+(Pack a, Pack b) { return { a.v + b.v }; }
+    friend Pack operator-(Pack a, Pack b) { return { a.v - b.v }; }
+    friend Pack operator*(Pack a, Pack b) { return { a.v * b.v }; }
+    friend Pack operator/(Pack a, Pack b) { return { a.v / b.v }; }
+    friend Pack operator-(Pack a) { return { -a.v }; }
+    friend Mask operator<(Pack a, Pack b) { return a.v < b.v; }
+    friend Pack select(Mask m, Pack a, Pack b) { return { m ? a.v : b.v }; }
+    friend Pack abs(Pack a) { return { std::abs(a.v) }; }
+    friend Pack min(Pack a, Pack b) { return { std::min(a.v, b.v) }; }
+    friend Pack max(Pack a, Pack b) { return { std::max(a.v, b.v) }; }
+    friend Pack sqrt(Pack a) { return { std::sqrt(a.v) }; }
+    friend Pack rsqrt(Pack a) { return { T(1) / std::sqrt(a.v) }; }
+};
+
+#if defined(__AVX512F__)
+// GCC's _mm512_min/max/sqrt wrappers pass _mm512_undefined_*() as the merge source, which trips
+// -Wmaybe-uninitialized once inlined into the kernels; the unmasked result never reads it
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+template<>
+struct Pack<float, true> {
+    static constexpr Int Width = 16;
+    using Mask                 = __mmask16;
+    __m512 v;
+
+    static Pack set1(float x) { return { _mm512_set1_ps(x) }; }
+    static Pack load(const float* p) { return { _mm512_load_ps(p) }; }
+    static Pack loadu(const float* p) { return { _mm512_loadu_ps(p) }; }
+    void        store(float* p) const { _mm512_store_ps(p, v); }
+    void        storeu(float* p) const { _mm512_storeu_ps(p, v); }
+
+    friend Pack operator+(Pack a, Pack b) { return { _mm512_add_ps(a.v, b.v) }; }
+    friend Pack operator-(Pack a, Pack b) { return { _mm512_sub_ps(a.v, b.v) }; }
+    friend Pack operator*(Pack a, Pack b) { return { _mm512_mul_ps(a.v, b.v) }; }
+    friend Pack operator/(Pack a, Pack b) { return { _mm512_div_ps(a.v, b.v) }; }
+    friend Pack operator-(Pack a) { return { _mm512_sub_ps(_mm512_setzero_ps(), a.v) }; }
+    friend Mask operator<(Pack a, Pack b) { return _mm512_cmp_ps_mask(a.v, b.v, _CMP_LT_OQ); }
+    friend Pack select(Mask m, Pack a, Pack b) { return { _mm512_mask_blend_ps(m, b.v, a.v) }; }
+    friend Pack abs(Pack a) { return { _mm512_abs_ps(a.v) }; }
+    friend Pack min(Pack a, Pack b) { return { _mm512_min_ps(a.v, b.v) }; }
+    friend Pack max(Pack a, Pack b) { return { _mm512_max_ps(a.v, b.v) }; }
+    friend Pack sqrt(Pack a) { return { _mm512_sqrt_ps(a.v) }; }
+    friend Pack rsqrt(Pack a) { return newtonRsqrt<Pack, float>(a, Pack { _mm512_rsqrt14_ps(a.v) }); }
+};
+
+template<>
+struct Pack<double, true> {
+    static constexpr Int Width = 8;
+    using Mask                 = __mmask8;
+    __m512d v;
+
+    static Pack set1(double x) { return { _mm512_set1_pd(x) }; }
+    static Pack load(const double* p) { return { _mm512_load_pd(p) }; }
+    static Pack loadu(const double* p) { return { _mm512_loadu_pd(p) }; }
+    void        store(double* p) const { _mm512_store_pd(p, v); }
+    void        storeu(double* p) const { _mm512_storeu_pd(p, v); }
+
+    friend Pack operator+(Pack a, Pack b) { return { _mm512_add_pd(a.v, b.v) }; }
+    friend Pack operator-(Pack a, Pack b) { return { _mm512_sub_pd(a.v, b.v) }; }
+    friend Pack operator*(Pack a, Pack b) { return { _mm512_mul_pd(a.v, b.v) }; }
+    friend Pack operator/(Pack a, Pack b) { return { _mm512_div_pd(a.v, b.v) }; }
+    friend Pack operator-(Pack a) { return { _mm512_sub_pd(_mm512_setzero_pd(), a.v) }; }
+    friend Mask operator<(Pack a, Pack b) { return _mm512_cmp_pd_mask(a.v, b.v, _CMP_LT_OQ); }
+    friend Pack select(Mask m, Pack a, Pack b) { return { _mm512_mask_blend_pd(m, b.v, a.v) }; }
+    friend Pack abs(Pack a) { return { _mm512_abs_pd(a.v) }; }
+    friend Pack min(Pack a, Pack b) { return { _mm512_min_pd(a.v, b.v) }; }
+    friend Pack max(Pack a, Pack b) { return { _mm512_max_pd(a.v, b.v) }; }
+    friend Pack sqrt(Pack a) { return { _mm512_sqrt_pd(a.v) }; }
+    friend Pack rsqrt(Pack a) { return newtonRsqrt<Pack, double>(a, newtonRsqrt<Pack, double>(a, Pack { _mm512_rsqrt14_pd(a.v) })); }
+};
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+#elif defined(__AVX2__)
+template<>
+struct Pack<float, true> {
+    static constexpr Int Width = 8;
+    using Mask                 = __m256;
+    __m256 v;
+
+    static Pack set1(float x) { return { _mm256_set1_ps(x) }; }
+    static Pack load(const float* p) { return { _mm256_load_ps(p) }; }
+    static Pack loadu(const float* p) { return { _mm256_loadu_ps(p) }; }
+    void        store(float* p) const { _mm256_store_ps(p, v); }
+    void        storeu(float* p) const { _mm256_storeu_ps(p, v); }
+
+    friend Pack operator+(Pack a, Pack b) { return { _mm256_add_ps(a.v, b.v) }; }
+    friend Pack operator-(Pack a, Pack b) { return { _mm256_sub_ps(a.v, b.v) }; }
+    friend Pack operator*(Pack a, Pack b) { return { _mm256_mul_ps(a.v, b.v) }; }
+    friend Pack operator/(Pack a, Pack b) { return { _mm256_div_ps(a.v, b.v) }; }
+    friend Pack operator-(Pack a) { return { _mm256_xor_ps(a.v, _mm256_set1_ps(-0.0f)) }; }
+    friend Mask operator<(Pack a, Pack b) { return _mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ); }
+    friend Pack select(Mask m, Pack a, Pack b) { return { _mm256_blendv_ps(b.v, a.v, m) }; }
+    friend Pack abs(Pack a) { return { _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a.v) }; }
+    friend Pack min(Pack a, Pack b) { return { _mm256_min_ps(a.v, b.v) }; }
+    friend Pack max(Pack a, Pack b) { return { _mm256_max_ps(a.v, b.v) }; }
+    friend Pack sqrt(Pack a) { return { _mm256_sqrt_ps(a.v) }; }
+    friend Pack rsqrt(Pack a) { return newtonRsqrt<Pack, float>(a, Pack { _mm256_rsqrt_ps(a.v) }); }
+};
+
+template<>
+struct Pack<double, true> {
+    static constexpr Int Width = 4;
+    using Mask                 = __m256d;
+    __m256d v;
+
+    static Pack set1(double x) { return { _mm256_set1_pd(x) }; }
+    static Pack load(const double* p) { return { _mm256_load_pd(p) }; }
+    static Pack loadu(const double* p) { return { _mm256_loadu_pd(p) }; }
+    void        store(double* p) const { _mm256_store_pd(p, v); }
+    void        storeu(double* p) const { _mm256_storeu_pd(p, v); }
+
+    friend Pack operator+(Pack a, Pack b) { return { _mm256_add_pd(a.v, b.v) }; }
+    friend Pack operator-(Pack a, Pack b) { return { _mm256_sub_pd(a.v, b.v) }; }
+    friend Pack operator*(Pack a, Pack b) { return { _mm256_mul_pd(a.v, b.v) }; }
+    friend Pack operator/(Pack a, Pack b) { return { _mm256_div_pd(a.v, b.v) }; }
+    friend Pack operator-(Pack a) { return { _mm256_xor_pd(a.v, _mm256_set1_pd(-0.0)) }; }
+    friend Mask operator<(Pack a, Pack b) { return _mm256_cmp_pd(a.v, b.v, _CMP_LT_OQ); }
+    friend Pack select(Mask m, Pack a, Pack b) { return { _mm256_blendv_pd(b.v, a.v, m) }; }
+    friend Pack abs(Pack a) { return { _mm256_andnot_pd(_mm256_set1_pd(-0.0), a.v) }; }
+    friend Pack min(Pack a, Pack b) { return { _mm256_min_pd(a.v, b.v) }; }
+    friend Pack max(Pack a, Pack b) { return { _mm256_max_pd(a.v, b.v) }; }
+    friend Pack sqrt(Pack a) { return { _mm256_sqrt_pd(a.v) }; }
+    friend Pack rsqrt(Pack a) { return { _mm256_div_pd(_mm256_set1_pd(1.0), _mm256_sqrt_pd(a.v)) }; }
+};
+#endif
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// bAVX2: whether the hand-written AVX2 kernels of the library are compiled (-mavx2/-march=native, /arch:AVX2)
+// fmadd(a, b, c) = a * b + c on raw registers for these kernels, fused when FMA is enabled
+// (MSVC does not define __FMA__, but /arch:AVX2 implies it), otherwise a multiply and an add
+#if defined(__AVX2__)
+constexpr bool bAVX2 = true;
+#  if defined(__FMA__) || defined(_MSC_VER)
+inline __m128  fmadd(__m128 a, __m128 b, __m128 c) { return _mm_fmadd_ps(a, b, c); }
+inline __m256  fmadd(__m256 a, __m256 b, __m256 c) { return _mm256_fmadd_ps(a, b, c); }
+inline __m256d fmadd(__m256d a, __m256d b, __m256d c) { return _mm256_fmadd_pd(a, b, c); }
+#  else
+inline __m128  fmadd(__m128 a, __m128 b, __m128 c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+inline __m256  fmadd(__m256 a, __m256 b, __m256 c) { return _mm256_add_ps(_mm256_mul_ps(a, b), c); }
+inline __m256d fmadd(__m256d a, __m256d b, __m256d c) { return _mm256_add_pd(_mm256_mul_pd(a, b), c); }
+#  endif
+#else
+constexpr bool bAVX2 = false;
+#endif
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+} // end namespace NTCodeBase::SIMD
@@ -0,0 +1,135 @@
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//
+//    .--------------------------------------------------.
+//    |  This file is part of NTCodeBase                 |
+//    |  Created 2018 by NT (https://ttnghia.github.io)  |
+//    '--------------------------------------------------'
+//                            \o/
+//                             |
+//                            / |
+//
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+
+
+#pragma once
+
+#include <catch2/catch.hpp>
+#include <LibCommon/CommonSetup.h>
+#include <LibCommon/Utils/NumberHelpers.h>
+#include <LibCommon/Timer/ScopeTimer.h>
+#include <LibCommon/ParallelHelpers/ParallelExec.h>
+#include <LibCommon/Math/FastVec3.h>
+#include <LibCommon/Math/FastMat3.h>
+
+using namespace NTCodeBase;
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+#define FAST_TYPES_DATA_SIZE         100'000
+#define FAST_TYPES_BENCHMARK_REPEATS 100
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// GLM against FastVec3 + FastMat3 in both precisions, run with "[!benchmark]"
+template<class RealType>
+void compareFastTypesPerformance(const char* precision, RealType tolerance) {
+    StdVT<Vec3<RealType>>     u(FAST_TYPES_DATA_SIZE), v(FAST_TYPES_DATA_SIZE), result(FAST_TYPES_DATA_SIZE);
+    StdVT<Mat3x3<RealType>>   M(FAST_TYPES_DATA_SIZE);
+    StdVT<FastVec3<RealType>> fu(FAST_TYPES_DATA_SIZE), fv(FAST_TYPES_DATA_SIZE), fresult(FAST_TYPES_DATA_SIZE);
+    StdVT<FastMat3<RealType>> fM(FAST_TYPES_DATA_SIZE);
+    ParallelExec::run(FAST_TYPES_DATA_SIZE,
+                      [&](int i) {
+                          u[i]  = NumberHelpers::fRand01<RealType>::template vrnd<Vec3<RealType>>() + Vec3<RealType>(2);
+                          v[i]  = NumberHelpers::fRand01<RealType>::template vrnd<Vec3<RealType>>();
+                          M[i]  = NumberHelpers::fRand01<RealType>::template mrnd<Mat3x3<RealType>>();
+                          fu[i] = FastVec3<RealType>(u[i]);
+                          fv[i] = FastVec3<RealType>(v[i]);
+                          fM[i] = FastMat3<RealType>(M[i]);
+                      });
+
+    {
+        ScopeTimer timer(std::string("Test vector operations using GLM, ") + precision);
+        for(int test = 0; test < FAST_TYPES_BENCHMARK_REPEATS; ++test) {
+            ParallelExec::run(FAST_TYPES_DATA_SIZE,
+                              [&](int i) {
+                                  result[i] = M[i] * glm::cross(u[i], v[i]) + glm::normalize(u[i]) * glm::dot(u[i], v[i]);
+                                  result[i] = glm::transpose(M[i]) * (M[i] * result[i]) - RealType(0.5) * result[i];
+                              });
+        }
+    }
+
+    {
+        ScopeTimer timer(std::string("Test vector operations using FastVec3 + FastMat3, ") + precision);
+        for(int test = 0; test < FAST_TYPES_BENCHMARK_REPEATS; ++test) {
+            ParallelExec::run(FAST_TYPES_DATA_SIZE,
+                              [&](int i) {
+                                  fresult[i] = fM[i] * fu[i].cross(fv[i]) + fu[i].normalized() * fu[i].dot(fv[i]);
+                                  fresult[i] = fM[i].transposed() * (fM[i] * fresult[i]) - RealType(0.5) * fresult[i];
+                              });
+        }
+    }
+
+    for(int i = 0; i < FAST_TYPES_DATA_SIZE; ++i) {
+        for(int j = 0; j < 3; ++j) {
+            REQUIRE(std::abs(result[i][j] - fresult[i][j]) < tolerance * (RealType(1) + std::abs(result[i][j])));
+        }
+    }
+}
+
+TEST_CASE("Benchmark_FastTypes_Precisions", "[Benchmark_FastTypes_Precisions][!benchmark]")
+{
+    // the double version is the AVX2 specialization, AVX2 is enabled in all default builds
+    compareFastTypesPerformance<float>("float", 1e-4f);
+    compareFastTypesPerformance<double>("double", 1e-12);
+}
+
+#if defined(__AVX512F__)
+TEST_CASE("Benchmark_FastVec3x4", "[Benchmark_FastVec3x4][!benchmark]")
+{
+    // one matrix applied to 4 vectors, e.g. the affine velocity of a particle at 4 grid nodes
+    StdVT<FastMat3<float>> fM(FAST_TYPES_DATA_SIZE);
+    StdVT<FastVec3<float>> fx(FAST_TYPES_DATA_SIZE * 4), fresult(FAST_TYPES_DATA_SIZE * 4);
+    StdVT<FastVec3x4>      fx4(FAST_TYPES_DATA_SIZE), fresult4(FAST_TYPES_DATA_SIZE);
+    ParallelExec::run(FAST_TYPES_DATA_SIZE,
+                      [&](int i) {
+                          fM[i] = FastMat3<float>(NumberHelpers::fRand01<float>::template mrnd<Mat3x3<float>>());
+                          for(int j = 0; j < 4; ++j) {
+                              fx[i * 4 + j] = FastVec3<float>(NumberHelpers::fRand01<float>::template vrnd<Vec3<float>>());
+                          }
+                          fx4[i] = FastVec3x4(fx[i * 4], fx[i * 4 + 1], fx[i * 4 + 2], fx[i * 4 + 3]);
+                      });
+
+    {
+        ScopeTimer timer("Test transforming 4 vectors using FastVec3");
+        for(int test = 0; test < FAST_TYPES_BENCHMARK_REPEATS; ++test) {
+            ParallelExec::run(FAST_TYPES_DATA_SIZE,
+                              [&](int i) {
+                                  for(int j = 0; j < 4; ++j) {
+                                      const auto& x = fx[i * 4 + j];
+                                      fresult[i * 4 + j] = fM[i] * x + x.cross(fM[i] * x) * 0.5f;
+                                  }
+                              });
+        }
+    }
+
+    {
+        ScopeTimer timer("Test transforming 4 vectors using FastVec3x4");
+        for(int test = 0; test < FAST_TYPES_BENCHMARK_REPEATS; ++test) {
+            ParallelExec::run(FAST_TYPES_DATA_SIZE,
+                              [&](int i) {
+                                  const auto& x = fx4[i];
+                                  fresult4[i] = fM[i] * x + x.cross(fM[i] * x) * 0.5f;
+                              });
+        }
+    }
+
+    for(int i = 0; i < FAST_TYPES_DATA_SIZE; ++i) {
+        for(int j = 0; j < 4; ++j) {
+            const auto fv = fresult4[i][j];
+            for(int k = 0; k < 3; ++k) {
+                REQUIRE(std::abs(fresult[i * 4 + j][k] - fv[k]) < 1e-5f * (1.0f + std::abs(fv[k])));
+            }
+        }
+    }
+}
+#endif
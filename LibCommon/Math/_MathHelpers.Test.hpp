@@ -0,0 +1,189 @@
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//
+//    .--------------------------------------------------.
+//    |  This file is part of NTCodeBase                 |
+//    |  Created 2018 by NT (https://ttnghia.github.io)  |
+//    '--------------------------------------------------'
+//                            \o/
+//                             |
+//                            / |
+//
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+
+
+#pragma once
+
+#include <random>
+#include <catch2/catch.hpp>
+#include <LibCommon/CommonSetup.h>
+#include <LibCommon/Math/MathHelpers.h>
+#include <LibCommon/Math/SIMDPack.h>
+#include <LibCommon/ParallelHelpers/ParallelExec.h>
+#include <LibCommon/Timer/ScopeTimer.h>
+
+using namespace NTCodeBase;
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+#define SPH_KERNEL_DATA_SIZE 100'003
+#define SPH_KERNEL_NEIGHBORS 61
+
+#define SPH_KERNEL_BENCHMARK_PARTICLES 100'000
+#define SPH_KERNEL_BENCHMARK_NEIGHBORS 64
+#define SPH_KERNEL_BENCHMARK_REPEATS   100
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// batched and tabulated kernels against the scalar kernels, for squared distances in [0, (1.1 * support)^2]
+// the batches have SPH_KERNEL_NEIGHBORS elements, thus most of them start at unaligned addresses and end with
+// a scalar remainder
+template<class T, class ScalarKernel, class BatchedKernel>
+void testSPHKernel(MathHelpers::SPHKernelType type, T h, T support, T tolerance, ScalarKernel&& scalarKernel, BatchedKernel&& batchedKernel) {
+    StdVT<T> r2(SPH_KERNEL_DATA_SIZE);
+    StdVT<T> values(r2.size()), gradFactors(r2.size());
+    StdVT<T> bValues(r2.size()), bGradFactors(r2.size());
+    StdVT<T> tValues(r2.size()), tGradFactors(r2.size());
+    std::mt19937                      generator(0);
+    std::uniform_real_distribution<T> distribution(T(0), support * T(1.1));
+    for(auto& x : r2) {
+        x = MathHelpers::sqr(distribution(generator));
+    }
+    r2[0] = T(0);
+    r2[1] = support * support;
+
+    const MathHelpers::SPHKernelConstants<T> constants(h);
+    const MathHelpers::TabulatedSPHKernel<T> tabulatedKernel(type, h);
+    for(size_t i = 0; i < r2.size(); ++i) {
+        scalarKernel(r2[i], values[i], gradFactors[i]);
+    }
+    for(size_t begin = 0; begin < r2.size(); begin += SPH_KERNEL_NEIGHBORS) {
+        const size_t n = std::min(r2.size() - begin, size_t(SPH_KERNEL_NEIGHBORS));
+        batchedKernel(&r2[begin], &bValues[begin], &bGradFactors[begin], n, constants);
+        tabulatedKernel.evaluate(&r2[begin], &tValues[begin], &tGradFactors[begin], n);
+    }
+
+    T maxValueError = 0, maxGradError = 0, maxTabulatedValueError = 0, maxTabulatedGradError = 0;
+    // the scalar gradient factors divide by r, skip r = 0
+    for(size_t i = 1; i < r2.size(); ++i) {
+        // gradient factors are of order 1 / h^2
+        const T gradScale = std::abs(gradFactors[i]) + T(1) / (h * h);
+        maxValueError          = std::max(maxValueError, std::abs(values[i] - bValues[i]));
+        maxGradError           = std::max(maxGradError, std::abs(gradFactors[i] - bGradFactors[i]) / gradScale);
+        maxTabulatedValueError = std::max(maxTabulatedValueError, std::abs(values[i] - tValues[i]));
+        maxTabulatedGradError  = std::max(maxTabulatedGradError, std::abs(gradFactors[i] - tGradFactors[i]) / gradScale);
+    }
+    REQUIRE(std::abs(values[0] - bValues[0]) < tolerance);
+    REQUIRE(maxValueError < tolerance);
+    REQUIRE(maxGradError < tolerance);
+    REQUIRE(maxTabulatedValueError < T(1e-3));
+    REQUIRE(maxTabulatedGradError < T(1e-2));
+}
+
+// calls func(name, type, support, scalarKernel, batchedKernel) for each SPH kernel with support radius h
+template<class T, class Function>
+void forEachSPHKernel(T h, Function&& func) {
+    func("cubic B-spline", MathHelpers::SPHKernelType::CubicBSpline, T(2) * h,
+         [h](T r2, T& value, T& gradFactor) {
+             const T r = std::sqrt(r2);
+             value      = MathHelpers::cubic_bspline_kernel(r / h);
+             gradFactor = MathHelpers::cubic_bspline_grad(r / h) / (h * r);
+         },
+         [](auto&&... args) { MathHelpers::cubic_bspline_kernel(args...); });
+    func("quadratic B-spline", MathHelpers::SPHKernelType::QuadBSpline, T(1.5) * h,
+         [h](T r2, T& value, T& gradFactor) {
+             const T r = std::sqrt(r2);
+             value      = MathHelpers::quad_bspline_kernel(r / h);
+             gradFactor = MathHelpers::quad_bspline_grad(r / h) / (h * r);
+         },
+         [](auto&&... args) { MathHelpers::quad_bspline_kernel(args...); });
+    func("spiky", MathHelpers::SPHKernelType::Spiky, h,
+         [h](T r2, T& value, T& gradFactor) {
+             const T r = std::sqrt(r2);
+             value      = MathHelpers::spiky_kernel(r, h);
+             gradFactor = r < h ? T(-6.0 * 315.0 / 64.0 / M_PI) * MathHelpers::sqr(T(1) - r2 / (h * h)) / (h * h) : T(0);
+         },
+         [](auto&&... args) { MathHelpers::spiky_kernel(args...); });
+    func("smooth", MathHelpers::SPHKernelType::Smooth, h,
+         [h](T r2, T& value, T& gradFactor) {
+             value      = MathHelpers::smooth_kernel(r2, h * h);
+             gradFactor = r2 < h * h ? T(-6) * MathHelpers::sqr(T(1) - r2 / (h * h)) / (h * h) : T(0);
+         },
+         [](auto&&... args) { MathHelpers::smooth_kernel(args...); });
+}
+
+template<class T>
+void testSPHKernels(T tolerance) {
+    const T h = T(0.25);
+    forEachSPHKernel(h, [&](const char*, MathHelpers::SPHKernelType type, T support, auto&& scalarKernel, auto&& batchedKernel) {
+                         testSPHKernel(type, h, support, tolerance, scalarKernel, batchedKernel);
+                     });
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+TEST_CASE("Test_SPH_Kernels", "[Test_SPH_Kernels]")
+{
+    // otherwise only the scalar remainder loop of the batched kernels would be tested
+    INFO("The batched SPH kernels are not vectorized: build with -march=native (or -mavx2) or /arch:AVX2");
+    REQUIRE(SIMD::Pack<float>::Width > 1);
+    REQUIRE(SIMD::Pack<double>::Width > 1);
+    testSPHKernels<float>(1e-5f);
+    testSPHKernels<double>(1e-12);
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// scalar, batched and tabulated evaluation of batches of SPH_KERNEL_BENCHMARK_NEIGHBORS squared distances
+// (the neighbors of one particle), run with "[!benchmark]"
+template<class T>
+void benchmarkSPHKernels(const char* precision) {
+    const T h = T(0.25);
+    forEachSPHKernel(h, [&](const char* kernelName, MathHelpers::SPHKernelType type, T support, auto&& scalarKernel, auto&& batchedKernel) {
+                         StdVT<T> r2(SPH_KERNEL_BENCHMARK_PARTICLES * SPH_KERNEL_BENCHMARK_NEIGHBORS);
+                         StdVT<T> values(r2.size()), gradFactors(r2.size());
+                         std::mt19937                      generator(0);
+                         std::uniform_real_distribution<T> distribution(T(0), support * T(1.1));
+                         for(auto& x : r2) {
+                             x = MathHelpers::sqr(distribution(generator));
+                         }
+
+                         const MathHelpers::SPHKernelConstants<T> constants(h);
+                         const MathHelpers::TabulatedSPHKernel<T> tabulatedKernel(type, h);
+                         const auto                               caption = std::string(kernelName) + " kernel, " + precision;
+                         {
+                             ScopeTimer timer(caption + ", scalar");
+                             for(int test = 0; test < SPH_KERNEL_BENCHMARK_REPEATS; ++test) {
+                                 ParallelExec::run(SPH_KERNEL_BENCHMARK_PARTICLES,
+                                                   [&](int p) {
+                                                       for(int i = p * SPH_KERNEL_BENCHMARK_NEIGHBORS; i < (p + 1) * SPH_KERNEL_BENCHMARK_NEIGHBORS; ++i) {
+                                                           scalarKernel(r2[i], values[i], gradFactors[i]);
+                                                       }
+                                                   });
+                             }
+                         }
+                         {
+                             ScopeTimer timer(caption + ", batched");
+                             for(int test = 0; test < SPH_KERNEL_BENCHMARK_REPEATS; ++test) {
+                                 ParallelExec::run(SPH_KERNEL_BENCHMARK_PARTICLES,
+                                                   [&](int p) {
+                                                       const auto begin = p * SPH_KERNEL_BENCHMARK_NEIGHBORS;
+                                                       batchedKernel(&r2[begin], &values[begin], &gradFactors[begin], SPH_KERNEL_BENCHMARK_NEIGHBORS, constants);
+                                                   });
+                             }
+                         }
+                         {
+                             ScopeTimer timer(caption + ", tabulated");
+                             for(int test = 0; test < SPH_KERNEL_BENCHMARK_REPEATS; ++test) {
+                                 ParallelExec::run(SPH_KERNEL_BENCHMARK_PARTICLES,
+                                                   [&](int p) {
+                                                       const auto begin = p * SPH_KERNEL_BENCHMARK_NEIGHBORS;
+                                                       tabulatedKernel.evaluate(&r2[begin], &values[begin], &gradFactors[begin], SPH_KERNEL_BENCHMARK_NEIGHBORS);
+                                                   });
+                             }
+                         }
+                     });
+}
+
+TEST_CASE("Benchmark_SPH_Kernels", "[Benchmark_SPH_Kernels][!benchmark]")
+{
+    benchmarkSPHKernels<float>("float");
+    benchmarkSPHKernels<double>("double");
+}
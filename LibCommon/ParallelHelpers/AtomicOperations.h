@@ -15,6 +15,7 @@
 #pragma once
 
 #include <atomic>
+#include <type_traits>
 #include <LibCommon/CommonSetup.h>
 
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
@@ -31,42 +32,68 @@ inline void atomicOp(T& target, T operand, Function&& f) {
     } while(!tgt.compare_exchange_weak(cur_val, new_val));
 }
 
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// Atomic add, using std::atomic_ref::fetch_add when available (C++20, native float atomics on
+// hardware supporting it), otherwise a relaxed CAS loop that reloads the current value on failure
+template<class T>
+inline void atomicAdd(T& target, T operand) {
+#if defined(__cpp_lib_atomic_ref)
+    std::atomic_ref<T>(target).fetch_add(operand, std::memory_order_relaxed);
+#else
+    std::atomic<T>& tgt = *((std::atomic<T>*) & target);
+
+    T cur_val = tgt.load(std::memory_order_relaxed);
+    while(!tgt.compare_exchange_weak(cur_val, cur_val + operand, std::memory_order_relaxed)) {}
+#endif
+}
+
+// Atomic add returning the previous value, for integer counters and cursors
+template<class T>
+inline T fetchAdd(T& target, T operand) {
+    static_assert(std::is_integral_v<T>, "fetchAdd requires integer type");
+#if defined(__cpp_lib_atomic_ref)
+    return std::atomic_ref<T>(target).fetch_add(operand, std::memory_order_relaxed);
+#else
+    return ((std::atomic<T>*) & target)->fetch_add(operand, std::memory_order_relaxed);
+#endif
+}
+
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 template<class T>
 inline void add(T& target, T operand) {
-    atomicOp(target, operand, [](T a, T b) { return a + b; });
+    atomicAdd(target, operand);
 }
 
 template<class T>
 inline void add(Vec2<T>& target, const Vec2<T>& operand) {
-    atomicOp(target[0], operand[0], [](T a, T b) { return a + b; });
-    atomicOp(target[1], operand[1], [](T a, T b) { return a + b; });
+    atomicAdd(target[0], operand[0]);
+    atomicAdd(target[1], operand[1]);
 }
 
 template<class T>
 inline void add(Vec3<T>& target, const Vec3<T>& operand) {
-    atomicOp(target[0], operand[0], [](T a, T b) { return a + b; });
-    atomicOp(target[1], operand[1], [](T a, T b) { return a + b; });
-    atomicOp(target[2], operand[2], [](T a, T b) { return a + b; });
+    atomicAdd(target[0], operand[0]);
+    atomicAdd(target[1], operand[1]);
+    atomicAdd(target[2], operand[2]);
 }
 
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 template<class T>
 inline void subtract(T& target, T operand) {
-    atomicOp(target, operand, [](T a, T b) { return a - b; });
+    atomicAdd(target, -operand);
 }
 
 template<class T>
 inline void subtract(Vec2<T>& target, const Vec2<T>& operand) {
-    atomicOp(target[0], operand[0], [](T a, T b) { return a - b; });
-    atomicOp(target[1], operand[1], [](T a, T b) { return a - b; });
+    atomicAdd(target[0], -operand[0]);
+    atomicAdd(target[1], -operand[1]);
 }
 
 template<class T>
 inline void subtract(Vec3<T>& target, const Vec3<T>& operand) {
-    atomicOp(target[0], operand[0], [](T a, T b) { return a - b; });
-    atomicOp(target[1], operand[1], [](T a, T b) { return a - b; });
-    atomicOp(target[2], operand[2], [](T a, T b) { return a - b; });
+    atomicAdd(target[0], -operand[0]);
+    atomicAdd(target[1], -operand[1]);
+    atomicAdd(target[2], -operand[2]);
 }
 
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
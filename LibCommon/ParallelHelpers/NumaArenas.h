@@ -0,0 +1,305 @@
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//
+//    .--------------------------------------------------.
+//    |  This file is part of NTCodeBase                 |
+//    |  Created 2018 by NT (https://ttnghia.github.io)  |
+//    '--------------------------------------------------'
+//                            \o/
+//                             |
+//                            / |
+//
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+
+#pragma once
+
+#include <LibCommon/CommonSetup.h>
+#include <LibCommon/ParallelHelpers/ParallelExec.h>
+
+#include <memory>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#if defined(NT_IN_LINUX_OS)
+#include <pthread.h>
+#include <sched.h>
+#elif defined(NT_IN_WINDOWS_OS)
+#include <windows.h>
+#endif
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+namespace NTCodeBase::ParallelExec {
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// CPU topology
+// TBB 2019 does not expose the machine topology, thus on Linux the NUMA nodes are read from sysfs,
+// on other systems all hardware threads are reported as a single node
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+struct NumaNode {
+    UInt       nodeID = 0;
+    StdVT_UInt cpuIDs;
+};
+
+// parse cpu list such as "0-7,16-23"
+inline StdVT_UInt parseCPUList(const String& cpuList) {
+    StdVT_UInt        cpuIDs;
+    std::stringstream ss(cpuList);
+    String            token;
+    while(std::getline(ss, token, ',')) {
+        if(token.empty() || token == "\n") {
+            continue;
+        }
+        auto dash = token.find('-');
+        if(dash == String::npos) {
+            cpuIDs.push_back(static_cast<UInt>(std::stoul(token)));
+        } else {
+            auto first = static_cast<UInt>(std::stoul(token.substr(0, dash)));
+            auto last  = static_cast<UInt>(std::stoul(token.substr(dash + 1)));
+            for(UInt cpu = first; cpu <= last; ++cpu) {
+                cpuIDs.push_back(cpu);
+            }
+        }
+    }
+    return cpuIDs;
+}
+
+inline StdVT<NumaNode> getNumaNodes() {
+    StdVT<NumaNode> nodes;
+#if defined(NT_IN_LINUX_OS)
+    for(UInt nodeID = 0; ; ++nodeID) {
+        std::ifstream file("/sys/devices/system/node/node" + std::to_string(nodeID) + "/cpulist");
+        if(!file.is_open()) {
+            break;
+        }
+        String cpuList;
+        std::getline(file, cpuList);
+        auto cpuIDs = parseCPUList(cpuList);
+        if(!cpuIDs.empty()) { // memory-only nodes have no cpu
+            nodes.push_back(NumaNode { nodeID, std::move(cpuIDs) });
+        }
+    }
+#endif
+    if(nodes.empty()) {
+        NumaNode node;
+        for(UInt cpu = 0, nCPUs = std::max(1u, std::thread::hardware_concurrency()); cpu < nCPUs; ++cpu) {
+            node.cpuIDs.push_back(cpu);
+        }
+        nodes.push_back(std::move(node));
+    }
+    return nodes;
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// Affinity of a thread, saved by pinCurrentThread to be restored by restoreCurrentThread
+struct ThreadAffinity {
+#if defined(NT_IN_LINUX_OS)
+    cpu_set_t cpuSet;
+#elif defined(NT_IN_WINDOWS_OS)
+    DWORD_PTR mask = 0;
+#endif
+    bool valid = false;
+};
+
+// Affinity of the calling thread, invalid if not supported
+inline ThreadAffinity getCurrentThreadAffinity() {
+    ThreadAffinity affinity;
+#if defined(NT_IN_LINUX_OS)
+    CPU_ZERO(&affinity.cpuSet);
+    affinity.valid = pthread_getaffinity_np(pthread_self(), sizeof(cpu_set_t), &affinity.cpuSet) == 0;
+#endif
+    // Windows has no getter, the previous mask is only returned by SetThreadAffinityMask
+    return affinity;
+}
+
+// Restrict the calling thread to the given cpus, return false if not supported or failed
+// If previous != nullptr, the affinity before the call is saved there
+inline bool pinCurrentThread(const StdVT_UInt& cpuIDs, ThreadAffinity* previous = nullptr) {
+    if(cpuIDs.empty()) {
+        return false;
+    }
+#if defined(NT_IN_LINUX_OS)
+    if(previous != nullptr) {
+        *previous = getCurrentThreadAffinity();
+    }
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    for(auto cpu : cpuIDs) {
+        if(cpu < CPU_SETSIZE) {
+            CPU_SET(cpu, &cpuSet);
+        }
+    }
+    return pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuSet) == 0;
+#elif defined(NT_IN_WINDOWS_OS)
+    DWORD_PTR mask = 0;
+    for(auto cpu : cpuIDs) {
+        if(cpu < sizeof(DWORD_PTR) * 8) { // only the first processor group is supported
+            mask |= (DWORD_PTR(1) << cpu);
+        }
+    }
+    if(mask == 0) {
+        return false;
+    }
+    const DWORD_PTR previousMask = SetThreadAffinityMask(GetCurrentThread(), mask);
+    if(previous != nullptr) {
+        previous->mask  = previousMask;
+        previous->valid = previousMask != 0;
+    }
+    return previousMask != 0;
+#else
+    (void)previous;
+    return false; // Mac OS has no thread affinity API
+#endif
+}
+
+// Restore an affinity saved by pinCurrentThread, return false if it is invalid or failed
+inline bool restoreCurrentThread(const ThreadAffinity& affinity) {
+    if(!affinity.valid) {
+        return false;
+    }
+#if defined(NT_IN_LINUX_OS)
+    return pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &affinity.cpuSet) == 0;
+#elif defined(NT_IN_WINDOWS_OS)
+    return SetThreadAffinityMask(GetCurrentThread(), affinity.mask) != 0;
+#else
+    return false;
+#endif
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// Pin every thread entering an arena (or the implicit global arena if constructed without arena)
+// If bPinToSingleCPU == true, each thread is pinned to one cpu selected by its slot index in the arena,
+// otherwise it may float over all the given cpus
+// The affinity of a thread is restored when it leaves, thus external threads joining the arena (e.g. the main thread calling
+// NumaArenas::run or execute) are only pinned while they work in the arena. The saved affinities are kept per thread as a stack,
+// since a thread may enter the arena again from a task of the arena
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+class ThreadPinningObserver : public tbb::task_scheduler_observer {
+public:
+    ThreadPinningObserver(const StdVT_UInt& cpuIDs, bool bPinToSingleCPU = false) :
+        tbb::task_scheduler_observer(), m_CPUIDs(cpuIDs), m_bPinToSingleCPU(bPinToSingleCPU) { observe(true); }
+    ThreadPinningObserver(tbb::task_arena& arena, const StdVT_UInt& cpuIDs, bool bPinToSingleCPU = false) :
+        tbb::task_scheduler_observer(arena), m_CPUIDs(cpuIDs), m_bPinToSingleCPU(bPinToSingleCPU) { observe(true); }
+    ~ThreadPinningObserver() { observe(false); }
+
+    virtual void on_scheduler_entry(bool) override {
+        ThreadAffinity previous;
+        if(m_bPinToSingleCPU) {
+            auto slot = static_cast<UInt>(std::max(0, tbb::this_task_arena::current_thread_index()));
+            pinCurrentThread(StdVT_UInt { m_CPUIDs[slot % static_cast<UInt>(m_CPUIDs.size())] }, &previous);
+        } else {
+            pinCurrentThread(m_CPUIDs, &previous);
+        }
+        m_SavedAffinities.local().push_back(previous);
+    }
+
+    virtual void on_scheduler_exit(bool) override {
+        // empty if the observer was enabled while the thread was already in the arena
+        auto& saved = m_SavedAffinities.local();
+        if(!saved.empty()) {
+            restoreCurrentThread(saved.back());
+            saved.pop_back();
+        }
+    }
+
+private:
+    StdVT_UInt                                              m_CPUIDs;
+    bool                                                    m_bPinToSingleCPU;
+    tbb::enumerable_thread_specific<StdVT<ThreadAffinity>> m_SavedAffinities;
+};
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// One task arena per NUMA node, with threads pinned to the cpus of that node
+// A range is split into contiguous chunks, one per node (proportional to the number of cpus of the node),
+// and each chunk is processed by the threads of its node using a static partitioner,
+// thus data initialized by first_touch() is later processed by the same node
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+class NumaArenas {
+public:
+    explicit NumaArenas(bool bPinThreads = true, bool bPinToSingleCPU = false) : m_Nodes(getNumaNodes()) {
+        for(const auto& node : m_Nodes) {
+            m_Arenas.emplace_back(std::make_unique<tbb::task_arena>(static_cast<int>(node.cpuIDs.size())));
+            if(bPinThreads) {
+                m_Observers.emplace_back(std::make_unique<ThreadPinningObserver>(*m_Arenas.back(), node.cpuIDs, bPinToSingleCPU));
+            }
+            m_nCPUs += static_cast<UInt>(node.cpuIDs.size());
+        }
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+    auto        numNodes() const { return static_cast<UInt>(m_Nodes.size()); }
+    auto        numCPUs() const { return m_nCPUs; }
+    const auto& node(UInt nodeIdx) const { NT_REQUIRE(nodeIdx < numNodes()); return m_Nodes[nodeIdx]; }
+    auto&       arena(UInt nodeIdx) { NT_REQUIRE(nodeIdx < numNodes()); return *m_Arenas[nodeIdx]; }
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // Run function inside the arena of the given node, blocking
+    template<class Function>
+    void execute(UInt nodeIdx, Function&& function) { arena(nodeIdx).execute(std::forward<Function>(function)); }
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // Chunk of the range [beginIdx, endIdx) assigned to the given node
+    template<class IndexType>
+    std::pair<IndexType, IndexType> nodeRange(UInt nodeIdx, IndexType beginIdx, IndexType endIdx) const {
+        UInt cpuBegin = 0;
+        for(UInt i = 0; i < nodeIdx; ++i) {
+            cpuBegin += static_cast<UInt>(m_Nodes[i].cpuIDs.size());
+        }
+        UInt cpuEnd = cpuBegin + static_cast<UInt>(m_Nodes[nodeIdx].cpuIDs.size());
+        auto size   = static_cast<UInt64>(endIdx - beginIdx);
+        return { static_cast<IndexType>(beginIdx + static_cast<IndexType>(size * cpuBegin / m_nCPUs)),
+                 static_cast<IndexType>(beginIdx + static_cast<IndexType>(size * cpuEnd / m_nCPUs)) };
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // Run function over [beginIdx, endIdx), all nodes concurrently
+    template<class IndexType, class Function>
+    void run(IndexType beginIdx, IndexType endIdx, Function&& function) {
+        if(endIdx <= beginIdx) {
+            return;
+        }
+#if defined(NT_NO_PARALLEL) || defined(NT_DISABLE_PARALLEL)
+        for(IndexType i = beginIdx; i < endIdx; ++i) {
+            function(i);
+        }
+#else
+        if(numNodes() == 1) {
+            execute(0, [&] { ParallelExec::run_static(beginIdx, endIdx, function); });
+            return;
+        }
+        auto taskGroups = std::make_unique<tbb::task_group[]>(numNodes());
+        for(UInt nodeIdx = 0; nodeIdx < numNodes(); ++nodeIdx) {
+            auto [nodeBegin, nodeEnd] = nodeRange(nodeIdx, beginIdx, endIdx);
+            arena(nodeIdx).execute([&, nodeIdx, nodeBegin = nodeBegin, nodeEnd = nodeEnd] {
+                                       taskGroups[nodeIdx].run([&, nodeBegin, nodeEnd] {
+                                                                   ParallelExec::run_static(nodeBegin, nodeEnd, function);
+                                                               });
+                                   });
+        }
+        for(UInt nodeIdx = 0; nodeIdx < numNodes(); ++nodeIdx) {
+            arena(nodeIdx).execute([&, nodeIdx] { taskGroups[nodeIdx].wait(); });
+        }
+#endif
+    }
+
+    template<class IndexType, class Function>
+    void run(IndexType endIdx, Function&& function) { run(IndexType(0), endIdx, std::forward<Function>(function)); }
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // NUMA-aware first touch: pages of each node chunk are allocated on the memory of that node,
+    // see ParallelExec::first_touch (requires FirstTouchVector)
+    template<class T, class Allocator>
+    void first_touch(std::vector<T, Allocator>& data, size_t size, const T& value = T(0)) {
+        ParallelExec::first_touch(data, size, value, [this](size_t n, auto&& func) { run(size_t(0), n, func); });
+    }
+
+private:
+    StdVT<NumaNode>                               m_Nodes;
+    StdVT<std::unique_ptr<tbb::task_arena>>       m_Arenas;
+    StdVT<std::unique_ptr<ThreadPinningObserver>> m_Observers;
+    UInt                                          m_nCPUs = 0;
+};
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+} // namespace NTCodeBase::ParallelExec
@@ -28,10 +28,16 @@
 namespace NTCodeBase::ParallelBLAS {
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 // dot products
+// policy = Deterministic gives bit-wise reproducible results regardless of the number of threads,
+// see ParallelExec::ReductionPolicy
 //
 template<class Real_t>
-inline Real_t dotProduct(const StdVT<Real_t>& x, const StdVT<Real_t>& y) {
+inline Real_t dotProduct(const StdVT<Real_t>& x, const StdVT<Real_t>& y,
+                         ParallelExec::ReductionPolicy policy = ParallelExec::getDefaultReductionPolicy()) {
     NT_REQUIRE(x.size() == y.size());
+    if(policy == ParallelExec::ReductionPolicy::Deterministic) {
+        return ParallelExec::reduce_deterministic(size_t(0), x.size(), Real_t(0), [&](size_t i) { return x[i] * y[i]; });
+    }
     ParallelObjects::DotProduct<1, Real_t> pObj(x, y);
     tbb::parallel_reduce(tbb::blocked_range<size_t>(0, x.size()), pObj);
 
@@ -39,8 +45,12 @@ inline Real_t dotProduct(const StdVT<Real_t>& x, const StdVT<Real_t>& y) {
 }
 
 template<Int N, class Real_t>
-inline Real_t dotProduct(const StdVT<VecX<N, Real_t>>& x, const StdVT<VecX<N, Real_t>>& y) {
+inline Real_t dotProduct(const StdVT<VecX<N, Real_t>>& x, const StdVT<VecX<N, Real_t>>& y,
+                         ParallelExec::ReductionPolicy policy = ParallelExec::getDefaultReductionPolicy()) {
     NT_REQUIRE(x.size() == y.size());
+    if(policy == ParallelExec::ReductionPolicy::Deterministic) {
+        return ParallelExec::reduce_deterministic(size_t(0), x.size(), Real_t(0), [&](size_t i) { return glm::dot(x[i], y[i]); });
+    }
     ParallelObjects::DotProduct<N, Real_t> pObj(x, y);
     tbb::parallel_reduce(tbb::blocked_range<size_t>(0, x.size()), pObj);
 
@@ -49,7 +59,10 @@ inline Real_t dotProduct(const StdVT<VecX<N, Real_t>>& x, const StdVT<VecX<N, Re
 
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 template<class Real_t>
-inline Real_t norm2(const StdVT<Real_t>& x) {
+inline Real_t norm2(const StdVT<Real_t>& x, ParallelExec::ReductionPolicy policy = ParallelExec::getDefaultReductionPolicy()) {
+    if(policy == ParallelExec::ReductionPolicy::Deterministic) {
+        return ParallelExec::reduce_deterministic(size_t(0), x.size(), Real_t(0), [&](size_t i) { return x[i] * x[i]; });
+    }
     ParallelObjects::VectorSumSqr<1, Real_t> pObj(x);
     tbb::parallel_reduce(tbb::blocked_range<size_t>(0, x.size()), pObj);
 
@@ -57,7 +70,10 @@ inline Real_t norm2(const StdVT<Real_t>& x) {
 }
 
 template<Int N, class Real_t>
-inline Real_t norm2(const StdVT<VecX<N, Real_t>>& x) {
+inline Real_t norm2(const StdVT<VecX<N, Real_t>>& x, ParallelExec::ReductionPolicy policy = ParallelExec::getDefaultReductionPolicy()) {
+    if(policy == ParallelExec::ReductionPolicy::Deterministic) {
+        return ParallelExec::reduce_deterministic(size_t(0), x.size(), Real_t(0), [&](size_t i) { return glm::length2(x[i]); });
+    }
     ParallelObjects::VectorSumSqr<N, Real_t> pObj(x);
     tbb::parallel_reduce(tbb::blocked_range<size_t>(0, x.size()), pObj);
 
@@ -15,9 +15,11 @@
 #pragma once
 
 #include <LibCommon/CommonSetup.h>
+#include <LibCommon/Utils/STLHelpers.h>
 #include <utility>
 #include <algorithm>
 #include <functional>
+#include <type_traits>
 
 #if !defined(Q_MOC_RUN)
 #include <tbb/tbb.h>
@@ -60,6 +62,224 @@ void run(IndexType endIdx, Function&& function) {
     ParallelExec::run(IndexType(0), endIdx, std::forward<Function>(function));
 }
 
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// parallel for with explicit partitioner
+// tbb::static_partitioner:   the range is split evenly and deterministically over the threads, so the
+//                            same thread processes the same sub-range in every call (given the same
+//                            range and number of threads), which keeps first-touched pages local
+// tbb::affinity_partitioner: must be kept alive between calls (e.g. as a member of the simulation
+//                            object), replays the previous mapping of sub-ranges to threads
+template<class IndexType, class Function, class Partitioner>
+void run(IndexType beginIdx, IndexType endIdx, Function&& function, Partitioner&& partitioner) {
+#if defined(NT_NO_PARALLEL) || defined(NT_DISABLE_PARALLEL)
+    NT_UNUSED(partitioner);
+    for(IndexType i = beginIdx; i < endIdx; ++i) {
+        function(i);
+    }
+#else
+    tbb::parallel_for(tbb::blocked_range<IndexType>(beginIdx, endIdx),
+                      [&](const tbb::blocked_range<IndexType>& r) {
+                          for(IndexType i = r.begin(), iEnd = r.end(); i < iEnd; ++i) {
+                              function(i);
+                          }
+                      },
+                      partitioner);
+#endif
+}
+
+template<class IndexType, class Function>
+void run_static(IndexType beginIdx, IndexType endIdx, Function&& function) {
+    ParallelExec::run(beginIdx, endIdx, std::forward<Function>(function), tbb::static_partitioner());
+}
+
+template<class IndexType, class Function>
+void run_static(IndexType endIdx, Function&& function) {
+    ParallelExec::run(IndexType(0), endIdx, std::forward<Function>(function), tbb::static_partitioner());
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// NUMA first-touch initialization
+// Pages of a fresh allocation are placed on the NUMA node of the thread writing them first. The old storage is
+// released and every element is written by a static partitioner, which puts each page on the node of the thread
+// that will process it in ParallelExec::run_static loops.
+// The allocator must not write the elements in resize(): use FirstTouchVector (STLHelpers::DefaultInitAllocator).
+// With std::allocator (StdVT) the result is correct, but the pages are placed by the serial value-initialization.
+template<class T>
+using FirstTouchVector = std::vector<T, STLHelpers::DefaultInitAllocator<T>>;
+
+// runner(size, func) calls func(i) for all i in [0, size), e.g. NumaArenas::run
+template<class T, class Allocator, class Runner>
+void first_touch(std::vector<T, Allocator>& data, size_t size, const T& value, Runner&& runner) {
+    static_assert(std::is_trivially_copyable_v<T>, "First touch initialization requires trivially copyable type");
+    std::vector<T, Allocator>().swap(data);
+    data.resize(size);
+    runner(size, [&](size_t i) { data[i] = value; });
+}
+
+template<class T, class Allocator>
+void first_touch(std::vector<T, Allocator>& data, size_t size, const T& value = T(0)) {
+    first_touch(data, size, value, [](size_t n, auto&& func) { ParallelExec::run_static(size_t(0), n, func); });
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// reduction policy
+// Fast:          tbb::parallel_reduce with dynamic partitioning, the summation order (and thus
+//                the result, bit-wise) may change between runs and with the number of threads
+// Deterministic: the range is cut into fixed-size blocks, each block is summed with Kahan
+//                compensation and the partial sums are combined pairwise in a fixed order,
+//                so the result only depends on the input data
+enum class ReductionPolicy {
+    Fast,
+    Deterministic
+};
+
+inline ReductionPolicy& defaultReductionPolicy() {
+    static ReductionPolicy policy = ReductionPolicy::Fast;
+    return policy;
+}
+
+inline void setDefaultReductionPolicy(ReductionPolicy policy) { defaultReductionPolicy() = policy; }
+inline ReductionPolicy getDefaultReductionPolicy() { return defaultReductionPolicy(); }
+
+constexpr size_t DeterministicReductionBlockSize = 4096;
+
+template<class ResultType, class IndexType, class Function>
+ResultType reduce_deterministic(IndexType beginIdx, IndexType endIdx, const ResultType& zero, Function&& function) {
+    if(endIdx <= beginIdx) {
+        return zero;
+    }
+    const size_t n       = static_cast<size_t>(endIdx - beginIdx);
+    const size_t nBlocks = (n + DeterministicReductionBlockSize - 1) / DeterministicReductionBlockSize;
+
+    StdVT<ResultType> partialSums(nBlocks, zero);
+    auto              sumBlock = [&](size_t block) {
+                                     const IndexType blockBegin = beginIdx + static_cast<IndexType>(block * DeterministicReductionBlockSize);
+                                     const IndexType blockEnd   = beginIdx + static_cast<IndexType>(std::min(n, (block + 1) * DeterministicReductionBlockSize));
+                                     ResultType      sum        = zero;
+                                     ResultType      c          = zero;
+                                     for(IndexType i = blockBegin; i < blockEnd; ++i) {
+                                         const ResultType y = function(i) - c;
+                                         const ResultType t = sum + y;
+                                         c   = (t - sum) - y;
+                                         sum = t;
+                                     }
+                                     partialSums[block] = sum;
+                                 };
+#if defined(NT_NO_PARALLEL) || defined(NT_DISABLE_PARALLEL)
+    for(size_t block = 0; block < nBlocks; ++block) {
+        sumBlock(block);
+    }
+#else
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, nBlocks),
+                      [&](const tbb::blocked_range<size_t>& r) {
+                          for(size_t block = r.begin(), blockEnd = r.end(); block < blockEnd; ++block) {
+                              sumBlock(block);
+                          }
+                      },
+                      tbb::static_partitioner());
+#endif
+
+    // pairwise combination, the tree shape only depends on the number of blocks
+    for(size_t stride = 1; stride < nBlocks; stride *= 2) {
+        for(size_t block = 0; block + stride < nBlocks; block += 2 * stride) {
+            partialSums[block] += partialSums[block + stride];
+        }
+    }
+    return partialSums[0];
+}
+
+// sum of function(i) over [beginIdx, endIdx) with the given reduction policy
+// function(i) is called exactly once for each index, thus it can also write to vectors: this fuses a vector
+// update and a dot product into a single pass over the data, e.g. [&](size_t i) { r[i] -= alpha * q[i]; return r[i] * r[i]; }
+template<class ResultType, class IndexType, class Function>
+ResultType reduce(IndexType beginIdx, IndexType endIdx, const ResultType& zero, Function&& function,
+                  ReductionPolicy policy = getDefaultReductionPolicy()) {
+    if(policy == ReductionPolicy::Deterministic) {
+        return reduce_deterministic(beginIdx, endIdx, zero, std::forward<Function>(function));
+    }
+#if defined(NT_NO_PARALLEL) || defined(NT_DISABLE_PARALLEL)
+    ResultType sum = zero;
+    for(IndexType i = beginIdx; i < endIdx; ++i) {
+        sum += function(i);
+    }
+    return sum;
+#else
+    if(endIdx <= beginIdx) {
+        return zero;
+    }
+    return tbb::parallel_reduce(tbb::blocked_range<IndexType>(beginIdx, endIdx), zero,
+                                [&](const tbb::blocked_range<IndexType>& r, ResultType sum) {
+                                    for(IndexType i = r.begin(), iEnd = r.end(); i < iEnd; ++i) {
+                                        sum += function(i);
+                                    }
+                                    return sum;
+                                },
+                                [](const ResultType& x, const ResultType& y) { return x + y; });
+#endif
+}
+
+// reduction of function(i) over [beginIdx, endIdx) with an associative combine(a, b), e.g. min/max or a struct of several sums
+// The Deterministic policy combines the values of each fixed-size block in index order and the block results pairwise
+// in a fixed order (without Kahan compensation, as combine is not necessarily a sum), thus the result only depends on the input data
+template<class ResultType, class IndexType, class Function, class Combine,
+         class = std::enable_if_t<!std::is_same_v<std::decay_t<Combine>, ReductionPolicy>>>
+ResultType reduce(IndexType beginIdx, IndexType endIdx, const ResultType& zero, Function&& function, Combine&& combine,
+                  ReductionPolicy policy = getDefaultReductionPolicy()) {
+    if(endIdx <= beginIdx) {
+        return zero;
+    }
+    if(policy == ReductionPolicy::Deterministic) {
+        const size_t n       = static_cast<size_t>(endIdx - beginIdx);
+        const size_t nBlocks = (n + DeterministicReductionBlockSize - 1) / DeterministicReductionBlockSize;
+
+        StdVT<ResultType> partials(nBlocks, zero);
+        auto              combineBlock = [&](size_t block) {
+                                             const IndexType blockBegin = beginIdx + static_cast<IndexType>(block * DeterministicReductionBlockSize);
+                                             const IndexType blockEnd   = beginIdx + static_cast<IndexType>(std::min(n, (block + 1) * DeterministicReductionBlockSize));
+                                             ResultType      partial    = zero;
+                                             for(IndexType i = blockBegin; i < blockEnd; ++i) {
+                                                 partial = combine(partial, function(i));
+                                             }
+                                             partials[block] = partial;
+                                         };
+#if defined(NT_NO_PARALLEL) || defined(NT_DISABLE_PARALLEL)
+        for(size_t block = 0; block < nBlocks; ++block) {
+            combineBlock(block);
+        }
+#else
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, nBlocks),
+                          [&](const tbb::blocked_range<size_t>& r) {
+                              for(size_t block = r.begin(), blockEnd = r.end(); block < blockEnd; ++block) {
+                                  combineBlock(block);
+                              }
+                          },
+                          tbb::static_partitioner());
+#endif
+        for(size_t stride = 1; stride < nBlocks; stride *= 2) {
+            for(size_t block = 0; block + stride < nBlocks; block += 2 * stride) {
+                partials[block] = combine(partials[block], partials[block + stride]);
+            }
+        }
+        return partials[0];
+    }
+#if defined(NT_NO_PARALLEL) || defined(NT_DISABLE_PARALLEL)
+    ResultType result = zero;
+    for(IndexType i = beginIdx; i < endIdx; ++i) {
+        result = combine(result, function(i));
+    }
+    return result;
+#else
+    return tbb::parallel_reduce(tbb::blocked_range<IndexType>(beginIdx, endIdx), zero,
+                                [&](const tbb::blocked_range<IndexType>& r, ResultType partial) {
+                                    for(IndexType i = r.begin(), iEnd = r.end(); i < iEnd; ++i) {
+                                        partial = combine(partial, function(i));
+                                    }
+                                    return partial;
+                                },
+                                [&](const ResultType& x, const ResultType& y) { return combine(x, y); });
+#endif
+}
+
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 // parallel for 2D
 template<class IndexType, class Function>
@@ -74,6 +294,19 @@ void run_row_major(IndexType beginIdxX, IndexType endIdxX,
                       });
 }
 
+template<class IndexType, class Function, class Partitioner>
+void run_row_major(IndexType beginIdxX, IndexType endIdxX,
+                   IndexType beginIdxY, IndexType endIdxY,
+                   Function&& function, Partitioner&& partitioner) {
+    ParallelExec::run(beginIdxX, endIdxX,
+                      [&](IndexType i) {
+                          for(IndexType j = beginIdxY; j < endIdxY; ++j) {
+                              function(i, j);
+                          }
+                      },
+                      std::forward<Partitioner>(partitioner));
+}
+
 template<class IndexType, class Function>
 void run(IndexType beginIdxX, IndexType endIdxX,
          IndexType beginIdxY, IndexType endIdxY,
@@ -86,6 +319,19 @@ void run(IndexType beginIdxX, IndexType endIdxX,
                       });
 }
 
+template<class IndexType, class Function, class Partitioner>
+void run(IndexType beginIdxX, IndexType endIdxX,
+         IndexType beginIdxY, IndexType endIdxY,
+         Function&& function, Partitioner&& partitioner) {
+    ParallelExec::run(beginIdxY, endIdxY,
+                      [&](IndexType j) {
+                          for(IndexType i = beginIdxX; i < endIdxX; ++i) {
+                              function(i, j);
+                          }
+                      },
+                      std::forward<Partitioner>(partitioner));
+}
+
 template<class IndexType, class Function>
 void run_row_major(const Vec2<IndexType>& endIdx, Function&& function) {
     ParallelExec::run_row_major(IndexType(0), endIdx[0], IndexType(0), endIdx[1], std::forward<Function>(function));
@@ -113,6 +359,22 @@ void run_row_major(IndexType beginIdxX, IndexType endIdxX,
                       });
 }
 
+template<class IndexType, class Function, class Partitioner>
+void run_row_major(IndexType beginIdxX, IndexType endIdxX,
+                   IndexType beginIdxY, IndexType endIdxY,
+                   IndexType beginIdxZ, IndexType endIdxZ,
+                   Function&& function, Partitioner&& partitioner) {
+    ParallelExec::run(beginIdxX, endIdxX,
+                      [&](IndexType i) {
+                          for(IndexType j = beginIdxY; j < endIdxY; ++j) {
+                              for(IndexType k = beginIdxZ; k < endIdxZ; ++k) {
+                                  function(i, j, k);
+                              }
+                          }
+                      },
+                      std::forward<Partitioner>(partitioner));
+}
+
 template<class IndexType, class Function>
 void run(IndexType beginIdxX, IndexType endIdxX,
          IndexType beginIdxY, IndexType endIdxY,
@@ -128,6 +390,22 @@ void run(IndexType beginIdxX, IndexType endIdxX,
                       });
 }
 
+template<class IndexType, class Function, class Partitioner>
+void run(IndexType beginIdxX, IndexType endIdxX,
+         IndexType beginIdxY, IndexType endIdxY,
+         IndexType beginIdxZ, IndexType endIdxZ,
+         Function&& function, Partitioner&& partitioner) {
+    ParallelExec::run(beginIdxZ, endIdxZ,
+                      [&](IndexType k) {
+                          for(IndexType j = beginIdxY; j < endIdxY; ++j) {
+                              for(IndexType i = beginIdxX; i < endIdxX; ++i) {
+                                  function(i, j, k);
+                              }
+                          }
+                      },
+                      std::forward<Partitioner>(partitioner));
+}
+
 template<class IndexType, class Function>
 void run_row_major(const Vec3<IndexType>& endIdx, Function&& function) {
     ParallelExec::run_row_major(IndexType(0), endIdx[0], IndexType(0), endIdx[1], IndexType(0), endIdx[2], std::forward<Function>(function));
@@ -23,6 +23,7 @@
 #endif
 
 #include <LibCommon/ParallelHelpers/ParallelObjects.h>
+#include <LibCommon/ParallelHelpers/ParallelExec.h>
 
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 namespace NTCodeBase::ParallelSTL {
@@ -119,36 +120,48 @@ inline void min_max_norm2(const StdVT<VecX<N, T>>& x, T& minVal, T& maxVal) {
 
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 template<class T>
-inline T sum(const StdVT<T>& x) {
+inline T sum(const StdVT<T>& x, ParallelExec::ReductionPolicy policy = ParallelExec::getDefaultReductionPolicy()) {
+    if(policy == ParallelExec::ReductionPolicy::Deterministic) {
+        return ParallelExec::reduce_deterministic(size_t(0), x.size(), T(0), [&](size_t i) { return x[i]; });
+    }
     ParallelObjects::VectorSum<1, T> pObj(x);
     tbb::parallel_reduce(tbb::blocked_range<size_t>(0, x.size()), pObj);
     return pObj.getResult();
 }
 
 template<Int N, class T>
-inline VecX<N, T> sum(const StdVT<VecX<N, T>>& x) {
+inline VecX<N, T> sum(const StdVT<VecX<N, T>>& x, ParallelExec::ReductionPolicy policy = ParallelExec::getDefaultReductionPolicy()) {
+    if(policy == ParallelExec::ReductionPolicy::Deterministic) {
+        return ParallelExec::reduce_deterministic(size_t(0), x.size(), VecX<N, T>(0), [&](size_t i) { return x[i]; });
+    }
     ParallelObjects::VectorSum<N, T> pObj(x);
     tbb::parallel_reduce(tbb::blocked_range<size_t>(0, x.size()), pObj);
     return pObj.getResult();
 }
 
 template<class T>
-inline T sum_sqr(const StdVT<T>& x) {
+inline T sum_sqr(const StdVT<T>& x, ParallelExec::ReductionPolicy policy = ParallelExec::getDefaultReductionPolicy()) {
+    if(policy == ParallelExec::ReductionPolicy::Deterministic) {
+        return ParallelExec::reduce_deterministic(size_t(0), x.size(), T(0), [&](size_t i) { return x[i] * x[i]; });
+    }
     ParallelObjects::VectorSumSqr<1, T> pObj(x);
     tbb::parallel_reduce(tbb::blocked_range<size_t>(0, x.size()), pObj);
     return pObj.getResult();
 }
 
 template<Int N, class T>
-inline T sum_sqr(const StdVT<VecX<N, T>>& x) {
+inline T sum_sqr(const StdVT<VecX<N, T>>& x, ParallelExec::ReductionPolicy policy = ParallelExec::getDefaultReductionPolicy()) {
+    if(policy == ParallelExec::ReductionPolicy::Deterministic) {
+        return ParallelExec::reduce_deterministic(size_t(0), x.size(), T(0), [&](size_t i) { return glm::length2(x[i]); });
+    }
     ParallelObjects::VectorSumSqr<N, T> pObj(x);
     tbb::parallel_reduce(tbb::blocked_range<size_t>(0, x.size()), pObj);
     return pObj.getResult();
 }
 
 template<class T>
-inline T average(const StdVT<T>& x) {
-    return ParallelSTL::sum<T>(x) / static_cast<T>(x.size());
+inline T average(const StdVT<T>& x, ParallelExec::ReductionPolicy policy = ParallelExec::getDefaultReductionPolicy()) {
+    return ParallelSTL::sum<T>(x, policy) / static_cast<T>(x.size());
 }
 
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
@@ -163,5 +176,24 @@ inline void sort_dsd(StdVT<T>& v) {
     tbb::parallel_sort(std::begin(v), std::end(v), std::greater<T> ());
 }
 
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// prefix sum
+// in-place exclusive scan: v[i] = v[0] + ... + v[i-1], returns the sum of all elements
+template<class T>
+inline T exclusive_scan(StdVT<T>& v) {
+    return tbb::parallel_scan(tbb::blocked_range<size_t>(0, v.size()), T(0),
+                              [&](const tbb::blocked_range<size_t>& r, T runningSum, bool bFinalScan) {
+                                  for(size_t i = r.begin(), iEnd = r.end(); i < iEnd; ++i) {
+                                      const T x = v[i];
+                                      if(bFinalScan) {
+                                          v[i] = runningSum;
+                                      }
+                                      runningSum += x;
+                                  }
+                                  return runningSum;
+                              },
+                              std::plus<T>());
+}
+
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 } // end namespace NTCodeBase::ParallelSTL
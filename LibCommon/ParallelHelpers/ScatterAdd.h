@@ -0,0 +1,145 @@
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//
+//    .--------------------------------------------------.
+//    |  This file is part of NTCodeBase                 |
+//    |  Created 2018 by NT (https://ttnghia.github.io)  |
+//    '--------------------------------------------------'
+//                            \o/
+//                             |
+//                            / |
+//
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+
+#pragma once
+
+#include <LibCommon/CommonSetup.h>
+#include <LibCommon/ParallelHelpers/AtomicOperations.h>
+#include <LibCommon/ParallelHelpers/ParallelExec.h>
+
+#if !defined(Q_MOC_RUN)
+#include <tbb/tbb.h>
+#endif
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// Scatter-add (particle-to-grid splatting) into a flat array
+// The user function is called as func(itemIdx, splat) for each item, and calls splat(targetIdx, value)
+// for each contribution of that item, for example:
+//
+//    ScatterAdd::run(ScatterAdd::Policy::Atomic, gridData, particles.size(),
+//                    [&](size_t p, auto&& splat) {
+//                        for(...) { splat(grid.getLinearizedIndex(i, j, k), weight * mass[p]); }
+//                    });
+//
+// Policies:
+//    Atomic:         every contribution is an atomic add into the target array
+//    PrivateBuffers: each thread splats into its own zero-initialized copy of the target array,
+//                    the copies are then summed into the target by a parallel reduction (memory cost
+//                    is one array per thread, no contention at all)
+//
+// run_colored is a separate function for grid targets: items are bucketed into blocks of cells, blocks are
+// processed in 2^N colors such that two blocks of the same color never write to the same target entry, so
+// plain (non-atomic) adds are used. The block size must be at least the width of the splat stencil
+// (e.g. 2 cells for linear kernel, 3 cells for quadratic B-spline kernel)
+namespace NTCodeBase::ScatterAdd {
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+enum class Policy {
+    Atomic,
+    PrivateBuffers
+};
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<class T, class IndexType, class Function>
+void run(Policy policy, StdVT<T>& target, IndexType nItems, Function&& func) {
+    if(policy == Policy::Atomic) {
+        ParallelExec::run(nItems,
+                          [&](IndexType item) {
+                              func(item, [&](size_t idx, const T& value) { AtomicOps::add(target[idx], value); });
+                          });
+        return;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+    tbb::enumerable_thread_specific<StdVT<T>> buffers([&] { return StdVT<T>(target.size(), T(0)); });
+    ParallelExec::run(nItems,
+                      [&](IndexType item) {
+                          auto& buffer = buffers.local();
+                          func(item, [&](size_t idx, const T& value) { buffer[idx] += value; });
+                      });
+
+    StdVT<StdVT<T>*> localBuffers;
+    for(auto& buffer : buffers) {
+        localBuffers.push_back(&buffer);
+    }
+    ParallelExec::run(target.size(),
+                      [&](size_t idx) {
+                          for(auto buffer : localBuffers) {
+                              target[idx] += (*buffer)[idx];
+                          }
+                      });
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// Colour-partitioned conflict-free scatter
+// nBlocks:  number of blocks in each dimension
+// blockIdx: blockIdx(item) returns the (N-dimensional) index of the block containing the item
+template<Int N, class T, class IndexType, class BlockFunction, class Function>
+void run_colored(StdVT<T>& target, IndexType nItems, const VecX<N, UInt>& nBlocks, BlockFunction&& blockIdx, Function&& func) {
+    // bucket the items by block
+    const size_t totalBlocks = static_cast<size_t>(glm::compMul(VecX<N, size_t>(nBlocks)));
+    StdVT_UInt   itemBlock(nItems);
+    ParallelExec::run(nItems,
+                      [&](IndexType item) {
+                          const auto bIdx   = blockIdx(item);
+                          UInt       linear = 0;
+                          for(Int d = N - 1; d >= 0; --d) {
+                              linear = linear * nBlocks[d] + static_cast<UInt>(bIdx[d]);
+                          }
+                          itemBlock[item] = linear;
+                      });
+
+    StdVT_UInt blockStart(totalBlocks + 1, 0u);
+    for(IndexType item = 0; item < nItems; ++item) {
+        ++blockStart[itemBlock[item] + 1];
+    }
+    for(size_t b = 0; b < totalBlocks; ++b) {
+        blockStart[b + 1] += blockStart[b];
+    }
+    StdVT<IndexType> sortedItems(nItems);
+    {
+        StdVT_UInt fillPos(blockStart.begin(), blockStart.end() - 1);
+        for(IndexType item = 0; item < nItems; ++item) {
+            sortedItems[fillPos[itemBlock[item]]++] = item;
+        }
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // blocks having the same parity in every dimension are at least one block apart
+    StdVT_StdVec<UInt> colorBlocks(1 << N);
+    for(size_t b = 0; b < totalBlocks; ++b) {
+        if(blockStart[b] == blockStart[b + 1]) {
+            continue;
+        }
+        UInt color = 0;
+        UInt tmp   = static_cast<UInt>(b);
+        for(Int d = 0; d < N; ++d) {
+            color |= ((tmp % nBlocks[d]) & 1u) << d;
+            tmp   /= nBlocks[d];
+        }
+        colorBlocks[color].push_back(static_cast<UInt>(b));
+    }
+
+    for(const auto& blocks : colorBlocks) {
+        ParallelExec::run(blocks.size(),
+                          [&](size_t i) {
+                              const UInt b = blocks[i];
+                              for(UInt k = blockStart[b], kEnd = blockStart[b + 1]; k < kEnd; ++k) {
+                                  func(sortedItems[k], [&](size_t idx, const T& value) { target[idx] += value; });
+                              }
+                          });
+    }
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+} // end namespace NTCodeBase::ScatterAdd
@@ -0,0 +1,198 @@
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//
+//    .--------------------------------------------------.
+//    |  This file is part of NTCodeBase                 |
+//    |  Created 2018 by NT (https://ttnghia.github.io)  |
+//    '--------------------------------------------------'
+//                            \o/
+//                             |
+//                            / |
+//
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+
+#pragma once
+
+#include <LibCommon/CommonSetup.h>
+#include <LibCommon/Timer/Timer.h>
+#include <LibCommon/Utils/Formatters.h>
+
+#include <functional>
+#include <memory>
+#include <sstream>
+#include <unordered_map>
+
+#if !defined(Q_MOC_RUN)
+#include <tbb/tbb.h>
+#include <tbb/flow_graph.h>
+#endif
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+namespace NTCodeBase::ParallelExec {
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// Dependency graph of simulation stages
+// Each stage declares the resources (named data, such as "positions", "density") it reads and writes.
+// Ordering follows the order of addStage() calls, restricted to conflicting stages:
+//   a stage reading a resource runs after the last stage writing it,
+//   a stage writing a resource runs after the last stage writing it and all stages reading it since then.
+// Stages without conflicts run concurrently, each of them may use ParallelExec::run internally.
+//
+// Example:
+//    TaskGraph graph;
+//    graph.addStage("DensityA",  { "positionsA" },            { "densityA" }, [&] { computeDensity(setA); });
+//    graph.addStage("SampleSDF", { "positionsB", "boundary" }, { "sdfB" },     [&] { sampleSDF(setB); });
+//    graph.addStage("Pressure",  { "densityA", "sdfB" },      { "pressure" }, [&] { computePressure(); });
+//    graph.run(); // DensityA and SampleSDF run concurrently, then Pressure
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+class TaskGraph {
+public:
+    using StageFunc = std::function<void()>;
+
+    TaskGraph() = default;
+    TaskGraph(const TaskGraph&) = delete;
+    TaskGraph& operator=(const TaskGraph&) = delete;
+
+    ////////////////////////////////////////////////////////////////////////////////
+    UInt addStage(const String& name, const StdVT_String& reads, const StdVT_String& writes, const StageFunc& func) {
+        NT_REQUIRE(func != nullptr);
+        m_Stages.push_back(Stage { name, reads, writes, func, {}, 0 });
+        m_bGraphChanged = true;
+        return static_cast<UInt>(m_Stages.size() - 1);
+    }
+
+    void clear() {
+        m_Stages.clear();
+        m_Nodes.clear();
+        m_Graph.reset();
+        m_bGraphChanged = true;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // Execute all stages once and wait for them to finish, the graph is built on first run and
+    // reused until stages are added or removed
+    void run() {
+        if(m_Stages.empty()) {
+            return;
+        }
+        if(m_bGraphChanged) {
+            buildGraph();
+        }
+#if defined(NT_NO_PARALLEL) || defined(NT_DISABLE_PARALLEL)
+        for(UInt i = 0; i < numStages(); ++i) { // addStage() order is a valid topological order
+            executeStage(i);
+        }
+#else
+        for(UInt i = 0; i < numStages(); ++i) {
+            if(m_Stages[i].dependencies.empty()) {
+                m_Nodes[i]->try_put(tbb::flow::continue_msg());
+            }
+        }
+        m_Graph->wait_for_all();
+#endif
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+    UInt        numStages() const { return static_cast<UInt>(m_Stages.size()); }
+    const auto& stageName(UInt stageIdx) const { NT_REQUIRE(stageIdx < numStages()); return m_Stages[stageIdx].name; }
+    // stages that must finish before the given stage starts
+    const auto& dependencies(UInt stageIdx) { NT_REQUIRE(stageIdx < numStages()); if(m_bGraphChanged) { buildGraph(); } return m_Stages[stageIdx].dependencies; }
+    // run time (ms) of the given stage in the last run
+    auto stageTime(UInt stageIdx) const { NT_REQUIRE(stageIdx < numStages()); return m_Stages[stageIdx].time; }
+
+    String getTimings(const String& caption = String("Task graph timing")) const {
+        std::stringstream ss;
+        ss << caption << ":\n";
+        for(const auto& stage : m_Stages) {
+            ss << "    " << stage.name << ": " << Formatters::toString(stage.time) << "ms\n";
+        }
+        return ss.str();
+    }
+
+private:
+    struct Stage {
+        String       name;
+        StdVT_String reads;
+        StdVT_String writes;
+        StageFunc    func;
+        StdVT_UInt   dependencies;
+        double       time;
+    };
+
+    void executeStage(UInt stageIdx) {
+        Timer timer;
+        timer.tick();
+        m_Stages[stageIdx].func();
+        m_Stages[stageIdx].time = timer.tock();
+    }
+
+    void buildGraph() {
+        struct ResourceState {
+            Int        lastWriter = -1;
+            StdVT_UInt readersSinceWrite;
+        };
+        std::unordered_map<String, ResourceState> resources;
+        auto addDependency = [](StdVT_UInt& deps, UInt stageIdx) {
+                                 if(std::find(deps.begin(), deps.end(), stageIdx) == deps.end()) {
+                                     deps.push_back(stageIdx);
+                                 }
+                             };
+        for(UInt i = 0; i < numStages(); ++i) {
+            auto& stage = m_Stages[i];
+            stage.dependencies.clear();
+            for(const auto& res : stage.reads) {
+                auto& state = resources[res];
+                if(state.lastWriter >= 0 && static_cast<UInt>(state.lastWriter) != i) {
+                    addDependency(stage.dependencies, static_cast<UInt>(state.lastWriter));
+                }
+            }
+            for(const auto& res : stage.writes) {
+                auto& state = resources[res];
+                if(state.lastWriter >= 0 && static_cast<UInt>(state.lastWriter) != i) {
+                    addDependency(stage.dependencies, static_cast<UInt>(state.lastWriter));
+                }
+                for(auto reader : state.readersSinceWrite) {
+                    if(reader != i) {
+                        addDependency(stage.dependencies, reader);
+                    }
+                }
+            }
+            // update resource states after collecting dependencies, so a stage reading and writing
+            // the same resource does not depend on itself
+            for(const auto& res : stage.reads) {
+                resources[res].readersSinceWrite.push_back(i);
+            }
+            for(const auto& res : stage.writes) {
+                auto& state = resources[res];
+                state.lastWriter = static_cast<Int>(i);
+                state.readersSinceWrite.clear();
+            }
+            std::sort(stage.dependencies.begin(), stage.dependencies.end());
+        }
+
+#if !defined(NT_NO_PARALLEL) && !defined(NT_DISABLE_PARALLEL)
+        m_Nodes.clear();
+        m_Graph = std::make_unique<tbb::flow::graph>();
+        for(UInt i = 0; i < numStages(); ++i) {
+            // the number of predecessors is counted by make_edge
+            m_Nodes.emplace_back(std::make_unique<tbb::flow::continue_node<tbb::flow::continue_msg>>(
+                                     *m_Graph, [this, i](const tbb::flow::continue_msg&) { executeStage(i); }));
+        }
+        for(UInt i = 0; i < numStages(); ++i) {
+            for(auto dep : m_Stages[i].dependencies) {
+                tbb::flow::make_edge(*m_Nodes[dep], *m_Nodes[i]);
+            }
+        }
+#endif
+        m_bGraphChanged = false;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+    StdVT<Stage>                                                              m_Stages;
+    std::unique_ptr<tbb::flow::graph>                                         m_Graph;
+    StdVT<std::unique_ptr<tbb::flow::continue_node<tbb::flow::continue_msg>>> m_Nodes; // destroyed before m_Graph
+    bool                                                                      m_bGraphChanged = true;
+};
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+} // namespace NTCodeBase::ParallelExec
@@ -13,3 +13,244 @@
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 
 #pragma once
+
+#include <catch2/catch.hpp>
+#include <LibCommon/CommonSetup.h>
+#include <LibCommon/Utils/NumberHelpers.h>
+#include <LibCommon/Utils/Formatters.h>
+#include <LibCommon/Timer/Timer.h>
+
+#include <LibCommon/ParallelHelpers/ParallelExec.h>
+#include <LibCommon/ParallelHelpers/NumaArenas.h>
+#include <LibCommon/ParallelHelpers/ParallelSTL.h>
+#include <LibCommon/ParallelHelpers/ParallelBLAS.h>
+#include <LibCommon/ParallelHelpers/ScatterAdd.h>
+#include <LibCommon/ParallelHelpers/TaskGraph.h>
+
+using namespace NTCodeBase;
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+#define REDUCTION_DATA_SIZE 10'000'000
+#define REDUCTION_TEST_NUM  20
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+TEST_CASE("Test_Deterministic_Reduction", "[Test_Deterministic_Reduction]")
+{
+    StdVT<double> x(REDUCTION_DATA_SIZE);
+    StdVT<double> y(REDUCTION_DATA_SIZE);
+    for(size_t i = 0; i < x.size(); ++i) {
+        x[i] = NumberHelpers::fRand11<double>::rnd();
+        y[i] = NumberHelpers::fRand11<double>::rnd();
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // results must be bit-wise identical for any number of threads
+    const double refSum = ParallelSTL::sum(x, ParallelExec::ReductionPolicy::Deterministic);
+    const double refDot = ParallelBLAS::dotProduct(x, y, ParallelExec::ReductionPolicy::Deterministic);
+    for(int nThreads : { 1, 2, 3, 4, 8, tbb::task_scheduler_init::default_num_threads() }) {
+        tbb::task_arena arena(nThreads);
+        arena.execute([&] {
+                          for(int test = 0; test < 4; ++test) {
+                              REQUIRE(ParallelSTL::sum(x, ParallelExec::ReductionPolicy::Deterministic) == refSum);
+                              REQUIRE(ParallelBLAS::dotProduct(x, y, ParallelExec::ReductionPolicy::Deterministic) == refDot);
+                          }
+                      });
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // reduction with a combine functor: max and a pair of sums in one pass
+    using MaxSum = std::pair<double, double>;
+    auto maxSum  = [&](size_t i) { return MaxSum(std::abs(x[i]), x[i]); };
+    auto combine = [](const MaxSum& a, const MaxSum& b) { return MaxSum(std::max(a.first, b.first), a.second + b.second); };
+    const auto refMaxSum = ParallelExec::reduce(size_t(0), x.size(), MaxSum(0, 0), maxSum, combine, ParallelExec::ReductionPolicy::Deterministic);
+    REQUIRE(refMaxSum.first == ParallelSTL::maxAbs(x));
+    REQUIRE(std::abs(refMaxSum.second - refSum) < 1e-8 * ParallelSTL::maxAbs(x) * std::sqrt(double(x.size())));
+    for(int nThreads : { 1, 2, 3, 4, 8, tbb::task_scheduler_init::default_num_threads() }) {
+        tbb::task_arena arena(nThreads);
+        arena.execute([&] {
+                          REQUIRE(ParallelExec::reduce(size_t(0), x.size(), MaxSum(0, 0), maxSum, combine,
+                                                       ParallelExec::ReductionPolicy::Deterministic) == refMaxSum);
+                          const auto fast = ParallelExec::reduce(size_t(0), x.size(), MaxSum(0, 0), maxSum, combine, ParallelExec::ReductionPolicy::Fast);
+                          REQUIRE(fast.first == refMaxSum.first);
+                          REQUIRE(std::abs(fast.second - refMaxSum.second) < 1e-8 * ParallelSTL::maxAbs(x) * std::sqrt(double(x.size())));
+                      });
+    }
+    REQUIRE(ParallelExec::reduce(size_t(0), size_t(0), MaxSum(-1, -1), maxSum, combine) == MaxSum(-1, -1));
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // overhead of the deterministic path
+    Timer  timer;
+    double fastTime = 0, deterministicTime = 0;
+    double fastDot  = 0, deterministicDot = 0;
+    for(int test = 0; test < REDUCTION_TEST_NUM; ++test) {
+        timer.tick();
+        fastDot   = ParallelBLAS::dotProduct(x, y, ParallelExec::ReductionPolicy::Fast);
+        fastTime += timer.tock();
+
+        timer.tick();
+        deterministicDot   = ParallelBLAS::dotProduct(x, y, ParallelExec::ReductionPolicy::Deterministic);
+        deterministicTime += timer.tock();
+    }
+    printf("dotProduct, %d elements: fast = %s (%.16e), deterministic = %s (%.16e), overhead = %.2f%%\n", REDUCTION_DATA_SIZE,
+           Formatters::toSciString(fastTime / REDUCTION_TEST_NUM).c_str(), fastDot,
+           Formatters::toSciString(deterministicTime / REDUCTION_TEST_NUM).c_str(), deterministicDot,
+           (deterministicTime / fastTime - 1.0) * 100.0);
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+#define SPLAT_GRID_RES       128
+#define SPLAT_NUM_PARTICLES  4'000'000
+#define SPLAT_BLOCK_SIZE     4
+#define SPLAT_TEST_NUM       5
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+TEST_CASE("Test_ScatterAdd", "[Test_ScatterAdd]")
+{
+    // dense particle-to-grid splatting with trilinear weights, positions in grid units
+    const UInt    nNodes = SPLAT_GRID_RES + 1;
+    StdVT_Vec3f   positions(SPLAT_NUM_PARTICLES);
+    StdVT<float>  masses(SPLAT_NUM_PARTICLES);
+    for(size_t p = 0; p < positions.size(); ++p) {
+        positions[p] = NumberHelpers::fRand01<float>::vrnd<Vec3f>() * float(SPLAT_GRID_RES - 1e-3);
+        masses[p]    = NumberHelpers::fRand01<float>::rnd();
+    }
+
+    auto splatParticle = [&](size_t p, auto&& splat) {
+                             const auto& ppos = positions[p];
+                             const Vec3ui cell(static_cast<UInt>(ppos[0]), static_cast<UInt>(ppos[1]), static_cast<UInt>(ppos[2]));
+                             const Vec3f  w1 = ppos - Vec3f(cell);
+                             const Vec3f  w0 = Vec3f(1) - w1;
+                             for(UInt k = 0; k < 2; ++k) {
+                                 for(UInt j = 0; j < 2; ++j) {
+                                     for(UInt i = 0; i < 2; ++i) {
+                                         const float w = (i ? w1[0] : w0[0]) * (j ? w1[1] : w0[1]) * (k ? w1[2] : w0[2]);
+                                         splat(((cell[2] + k) * nNodes + cell[1] + j) * nNodes + cell[0] + i, w * masses[p]);
+                                     }
+                                 }
+                             }
+                         };
+
+    StdVT<double> reference(nNodes * nNodes * nNodes, 0.0);
+    for(size_t p = 0; p < positions.size(); ++p) {
+        splatParticle(p, [&](size_t idx, float value) { reference[idx] += value; });
+    }
+
+    auto check = [&](const StdVT<float>& grid) {
+                     double maxErr = 0;
+                     for(size_t idx = 0; idx < grid.size(); ++idx) {
+                         maxErr = std::max(maxErr, std::abs(grid[idx] - reference[idx]) / std::max(1.0, reference[idx]));
+                     }
+                     REQUIRE(maxErr < 1e-4);
+                 };
+
+    ////////////////////////////////////////////////////////////////////////////////
+    StdVT<float> grid(reference.size());
+    Timer        timer;
+    double       atomicTime = 0, privateBufferTime = 0, coloredTime = 0;
+    for(int test = 0; test < SPLAT_TEST_NUM; ++test) {
+        grid.assign(grid.size(), 0.0f);
+        timer.tick();
+        ScatterAdd::run(ScatterAdd::Policy::Atomic, grid, positions.size(), splatParticle);
+        atomicTime += timer.tock();
+        check(grid);
+
+        grid.assign(grid.size(), 0.0f);
+        timer.tick();
+        ScatterAdd::run(ScatterAdd::Policy::PrivateBuffers, grid, positions.size(), splatParticle);
+        privateBufferTime += timer.tock();
+        check(grid);
+
+        grid.assign(grid.size(), 0.0f);
+        timer.tick();
+        ScatterAdd::run_colored(grid, positions.size(), Vec3ui(SPLAT_GRID_RES / SPLAT_BLOCK_SIZE),
+                                [&](size_t p) { return Vec3ui(positions[p] / float(SPLAT_BLOCK_SIZE)); },
+                                splatParticle);
+        coloredTime += timer.tock();
+        check(grid);
+    }
+    printf("Splatting %d particles to %d^3 grid: atomic = %sms, private buffers = %sms, colored = %sms\n", SPLAT_NUM_PARTICLES, SPLAT_GRID_RES,
+           Formatters::toString(atomicTime / SPLAT_TEST_NUM).c_str(),
+           Formatters::toString(privateBufferTime / SPLAT_TEST_NUM).c_str(),
+           Formatters::toString(coloredTime / SPLAT_TEST_NUM).c_str());
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+#define TASK_GRAPH_DATA_SIZE 1'000'000
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+TEST_CASE("Test_TaskGraph", "[Test_TaskGraph]")
+{
+    StdVT<double> a(TASK_GRAPH_DATA_SIZE), b(TASK_GRAPH_DATA_SIZE), c(TASK_GRAPH_DATA_SIZE);
+    double        sum = 0;
+
+    ParallelExec::TaskGraph graph;
+    graph.addStage("InitA", {}, { "a" }, [&] { ParallelExec::run(a.size(), [&](size_t i) { a[i] = double(i); }); });
+    graph.addStage("InitB", {}, { "b" }, [&] { ParallelExec::run(b.size(), [&](size_t i) { b[i] = 2.0; }); });
+    graph.addStage("Mult", { "a", "b" }, { "c" }, [&] { ParallelExec::run(c.size(), [&](size_t i) { c[i] = a[i] * b[i]; }); });
+    graph.addStage("ScaleA", { "a" }, { "a" }, [&] { ParallelExec::run(a.size(), [&](size_t i) { a[i] *= 0.5; }); });
+    graph.addStage("Sum", { "c" }, {}, [&] { sum = ParallelSTL::sum(c); });
+
+    REQUIRE(graph.dependencies(0).empty());
+    REQUIRE(graph.dependencies(1).empty());
+    REQUIRE(graph.dependencies(2) == StdVT_UInt({ 0, 1 }));
+    REQUIRE(graph.dependencies(3) == StdVT_UInt({ 0, 2 })); // write-after-read on "a"
+    REQUIRE(graph.dependencies(4) == StdVT_UInt({ 2 }));
+
+    for(int run = 0; run < 3; ++run) {
+        graph.run();
+        REQUIRE(sum == Approx(double(TASK_GRAPH_DATA_SIZE) * double(TASK_GRAPH_DATA_SIZE - 1)));
+        REQUIRE(a[10] == Approx(5.0));
+    }
+    printf("%s", graph.getTimings().c_str());
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+TEST_CASE("Test_NumaArenas", "[Test_NumaArenas]")
+{
+    REQUIRE(ParallelExec::parseCPUList("0-3,8,10-11\n") == StdVT_UInt({ 0, 1, 2, 3, 8, 10, 11 }));
+    REQUIRE(ParallelExec::parseCPUList("5") == StdVT_UInt({ 5 }));
+    REQUIRE(ParallelExec::parseCPUList("").empty());
+
+    ParallelExec::NumaArenas arenas(false);
+    REQUIRE(arenas.numNodes() > 0);
+    REQUIRE(arenas.numCPUs() > 0);
+
+    // the node chunks cover the range contiguously
+    for(size_t size : { size_t(0), size_t(1), size_t(7), size_t(1'000'003) }) {
+        size_t nextBegin = 10;
+        for(UInt node = 0; node < arenas.numNodes(); ++node) {
+            auto [nodeBegin, nodeEnd] = arenas.nodeRange(node, size_t(10), size_t(10) + size);
+            REQUIRE(nodeBegin == nextBegin);
+            REQUIRE(nodeEnd >= nodeBegin);
+            nextBegin = nodeEnd;
+        }
+        REQUIRE(nextBegin == size_t(10) + size);
+    }
+
+    ParallelExec::FirstTouchVector<double> data(5, 1.0);
+    ParallelExec::first_touch(data, TASK_GRAPH_DATA_SIZE, 3.0);
+    REQUIRE(data.size() == size_t(TASK_GRAPH_DATA_SIZE));
+    REQUIRE(std::all_of(data.begin(), data.end(), [](double x) { return x == 3.0; }));
+
+    StdVT<float> stdData;
+    arenas.first_touch(stdData, TASK_GRAPH_DATA_SIZE + 1, 2.0f);
+    REQUIRE(stdData.size() == size_t(TASK_GRAPH_DATA_SIZE + 1));
+    REQUIRE(std::all_of(stdData.begin(), stdData.end(), [](float x) { return x == 2.0f; }));
+
+#if defined(NT_IN_LINUX_OS)
+    // the main thread is pinned while it works in a node arena, and its affinity is restored when it leaves
+    {
+        const auto               before = ParallelExec::getCurrentThreadAffinity();
+        ParallelExec::NumaArenas pinnedArenas(true, true);
+        ParallelExec::ThreadAffinity inside;
+        pinnedArenas.execute(0, [&] { inside = ParallelExec::getCurrentThreadAffinity(); });
+        pinnedArenas.first_touch(stdData, TASK_GRAPH_DATA_SIZE, 3.0f);
+        const auto after = ParallelExec::getCurrentThreadAffinity();
+        REQUIRE(before.valid);
+        REQUIRE(inside.valid);
+        REQUIRE(after.valid);
+        REQUIRE(CPU_COUNT(&inside.cpuSet) == 1);
+        REQUIRE(CPU_EQUAL(&before.cpuSet, &after.cpuSet));
+    }
+#endif
+}
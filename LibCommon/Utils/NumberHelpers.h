@@ -20,6 +20,7 @@
 #include <iomanip>
 #include <locale>
 #include <random>
+#include <array>
 
 #include <LibCommon/CommonSetup.h>
 #include <LibCommon/ParallelHelpers/ParallelExec.h>
@@ -334,6 +335,245 @@ inline T frandhash11(unsigned int seed) {
     return frandhash(T(-1.0), T(1.0), seed);
 }
 
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// Counter-based random number generator Philox4x32-10
+// (Salmon et al., "Parallel random numbers: as easy as 1, 2, 3", SC 2011)
+// The output is a pure function of (counter, key): there is no state to share or lock, and the value
+// for a given (seed, particle id, step) does not depend on which thread computes it or in which order
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+class Philox4x32 {
+public:
+    static constexpr Int nRounds = 10;
+
+    // generate 4 random words from a counter and a key
+    static std::array<UInt, 4> generate(std::array<UInt, 4> ctr, std::array<UInt, 2> key) {
+        for(Int r = 0; r < nRounds; ++r) {
+            if(r > 0) {
+                key[0] += W0;
+                key[1] += W1;
+            }
+            round(ctr[0], ctr[1], ctr[2], ctr[3], key[0], key[1]);
+        }
+        return ctr;
+    }
+
+    // generate K counters at once, counters are stored as structure of arrays (ctr[word][lane]) so the
+    // loops over lanes are vectorized by the compiler
+    template<Int K>
+    static void generate(UInt (&ctr)[4][K], std::array<UInt, 2> key) {
+        for(Int r = 0; r < nRounds; ++r) {
+            if(r > 0) {
+                key[0] += W0;
+                key[1] += W1;
+            }
+            for(Int j = 0; j < K; ++j) {
+                round(ctr[0][j], ctr[1][j], ctr[2][j], ctr[3][j], key[0], key[1]);
+            }
+        }
+    }
+
+private:
+    static constexpr UInt M0 = 0xD2511F53u;
+    static constexpr UInt M1 = 0xCD9E8D57u;
+    static constexpr UInt W0 = 0x9E3779B9u;
+    static constexpr UInt W1 = 0xBB67AE85u;
+
+    static void round(UInt& c0, UInt& c1, UInt& c2, UInt& c3, UInt k0, UInt k1) {
+        const auto p0 = static_cast<UInt64>(M0) * static_cast<UInt64>(c0);
+        const auto p1 = static_cast<UInt64>(M1) * static_cast<UInt64>(c2);
+        const auto x1 = static_cast<UInt>(p1);
+        const auto x3 = static_cast<UInt>(p0);
+        c0 = static_cast<UInt>(p1 >> 32) ^ c1 ^ k0;
+        c2 = static_cast<UInt>(p0 >> 32) ^ c3 ^ k1;
+        c1 = x1;
+        c3 = x3;
+    }
+};
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// Deterministic random values indexed by (id, step), built on Philox4x32
+// Counter = (id low bits, id high bits, step, block), each block gives 4 words: one float or half a double each.
+// Uniform values are in the open interval (0, 1), so they can be passed to log() directly.
+// The batch generators write values for ids [idOffset, idOffset + size) and give exactly the same results
+// as the per-id functions, independent of the number of threads
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<class Real_t>
+class CounterRandom {
+    static constexpr Int WordsPerValue = isFloat<Real_t>() ? 1 : 2;
+    static constexpr Int BatchLanes    = 8;
+public:
+    explicit CounterRandom(UInt64 seed = 0) { setSeed(seed); }
+    void setSeed(UInt64 seed) { m_Key = { static_cast<UInt>(seed), static_cast<UInt>(seed >> 32) }; }
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // N uniform random values in (0, 1)
+    template<Int N>
+    VecX<N, Real_t> uniform01(UInt64 id, UInt step) const {
+        Real_t values[N];
+        generateValues<N>(id, step, values);
+        VecX<N, Real_t> result;
+        for(Int d = 0; d < N; ++d) {
+            result[d] = values[d];
+        }
+        return result;
+    }
+
+    Real_t uniform01(UInt64 id, UInt step) const { return uniform01<1>(id, step)[0]; }
+
+    template<Int N>
+    VecX<N, Real_t> uniform(UInt64 id, UInt step, Real_t a, Real_t b) const { return uniform01<N>(id, step) * (b - a) + VecX<N, Real_t>(a); }
+
+    template<Int N>
+    VecX<N, Real_t> uniform11(UInt64 id, UInt step) const { return uniform<N>(id, step, Real_t(-1), Real_t(1)); }
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // N standard normal random values (Box-Muller)
+    template<Int N>
+    VecX<N, Real_t> normal(UInt64 id, UInt step) const {
+        Real_t values[N + (N & 1)];
+        generateValues<N + (N & 1)>(id, step, values);
+        return boxMuller<N>(values);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // random point on the unit circle (N = 2) or unit sphere (N = 3)
+    template<Int N>
+    VecX<N, Real_t> onSphere(UInt64 id, UInt step) const {
+        static_assert(N == 2 || N == 3, "Only 2D and 3D are supported");
+        Real_t values[N - 1];
+        generateValues<N - 1>(id, step, values);
+        return sphereFromUniform<N>(values);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // batch generation, value i uses id = idOffset + i
+    template<Int N>
+    void generateUniform(StdVT_VecX<N, Real_t>& output, UInt step, Real_t a = Real_t(0), Real_t b = Real_t(1), UInt64 idOffset = 0) const {
+        generateBatch<N>(output.size(), step, idOffset,
+                         [&](size_t i, const Real_t* values) {
+                             for(Int d = 0; d < N; ++d) {
+                                 output[i][d] = values[d] * (b - a) + a;
+                             }
+                         });
+    }
+
+    // add uniform random values in [a, b] to the existing entries, without a temporary array
+    template<Int N>
+    void addUniform(StdVT_VecX<N, Real_t>& output, UInt step, Real_t a, Real_t b, UInt64 idOffset = 0) const {
+        generateBatch<N>(output.size(), step, idOffset,
+                         [&](size_t i, const Real_t* values) {
+                             for(Int d = 0; d < N; ++d) {
+                                 output[i][d] += values[d] * (b - a) + a;
+                             }
+                         });
+    }
+
+    template<Int N>
+    void generateNormal(StdVT_VecX<N, Real_t>& output, UInt step, Real_t mean = Real_t(0), Real_t stdDev = Real_t(1), UInt64 idOffset = 0) const {
+        generateBatch<N + (N & 1)>(output.size(), step, idOffset,
+                                   [&](size_t i, const Real_t* values) {
+                                       output[i] = boxMuller<N>(values) * stdDev + VecX<N, Real_t>(mean);
+                                   });
+    }
+
+    template<Int N>
+    void generateOnSphere(StdVT_VecX<N, Real_t>& output, UInt step, Real_t radius = Real_t(1), UInt64 idOffset = 0) const {
+        generateBatch<N - 1>(output.size(), step, idOffset,
+                             [&](size_t i, const Real_t* values) {
+                                 output[i] = sphereFromUniform<N>(values) * radius;
+                             });
+    }
+
+private:
+    static Real_t toReal(const UInt* words) {
+        if constexpr(isFloat<Real_t>()) {
+            // 23 bits: (k + 0.5) * 2^-23 is exact in float, the largest value is 1 - 2^-24 < 1
+            return (static_cast<float>(words[0] >> 9) + 0.5f) * (1.0f / 8388608.0f);
+        } else {
+            // 52 bits: (k + 0.5) * 2^-52 is exact in double, the largest value is 1 - 2^-53 < 1
+            const auto bits = (static_cast<UInt64>(words[0]) << 20) | static_cast<UInt64>(words[1] >> 12);
+            return (static_cast<double>(bits) + 0.5) * (1.0 / 4503599627370496.0);
+        }
+    }
+
+    static constexpr Int numBlocks(Int nValues) { return (nValues * WordsPerValue + 3) / 4; }
+
+    template<Int NValues>
+    void generateValues(UInt64 id, UInt step, Real_t* values) const {
+        UInt words[numBlocks(NValues) * 4];
+        for(Int block = 0; block < numBlocks(NValues); ++block) {
+            auto r = Philox4x32::generate({ static_cast<UInt>(id), static_cast<UInt>(id >> 32), step, static_cast<UInt>(block) }, m_Key);
+            std::copy(r.begin(), r.end(), &words[block * 4]);
+        }
+        for(Int v = 0; v < NValues; ++v) {
+            values[v] = toReal(&words[v * WordsPerValue]);
+        }
+    }
+
+    template<Int NValues, class Function>
+    void generateBatch(size_t size, UInt step, UInt64 idOffset, Function&& function) const {
+        const size_t nLaneBlocks = (size + BatchLanes - 1) / BatchLanes;
+        ParallelExec::run(nLaneBlocks,
+                          [&](size_t laneBlock) {
+                              const size_t begin = laneBlock * BatchLanes;
+                              const size_t end   = std::min(begin + BatchLanes, size);
+                              UInt         words[BatchLanes][numBlocks(NValues) * 4];
+                              for(Int block = 0; block < numBlocks(NValues); ++block) {
+                                  UInt ctr[4][BatchLanes];
+                                  for(Int j = 0; j < BatchLanes; ++j) {
+                                      const UInt64 id = idOffset + static_cast<UInt64>(begin + j);
+                                      ctr[0][j] = static_cast<UInt>(id);
+                                      ctr[1][j] = static_cast<UInt>(id >> 32);
+                                      ctr[2][j] = step;
+                                      ctr[3][j] = static_cast<UInt>(block);
+                                  }
+                                  Philox4x32::generate<BatchLanes>(ctr, m_Key);
+                                  for(Int j = 0; j < BatchLanes; ++j) {
+                                      for(Int w = 0; w < 4; ++w) {
+                                          words[j][block * 4 + w] = ctr[w][j];
+                                      }
+                                  }
+                              }
+                              for(size_t i = begin; i < end; ++i) {
+                                  Real_t values[NValues];
+                                  for(Int v = 0; v < NValues; ++v) {
+                                      values[v] = toReal(&words[i - begin][v * WordsPerValue]);
+                                  }
+                                  function(i, values);
+                              }
+                          });
+    }
+
+    template<Int N>
+    static VecX<N, Real_t> boxMuller(const Real_t* values) {
+        VecX<N, Real_t> result;
+        for(Int d = 0; d < N; d += 2) {
+            const auto r     = std::sqrt(Real_t(-2) * std::log(values[d]));
+            const auto theta = Real_t(2.0 * M_PI) * values[d + 1];
+            result[d] = r * std::cos(theta);
+            if(d + 1 < N) {
+                result[d + 1] = r * std::sin(theta);
+            }
+        }
+        return result;
+    }
+
+    template<Int N>
+    static VecX<N, Real_t> sphereFromUniform(const Real_t* values) {
+        const auto phi = Real_t(2.0 * M_PI) * values[0];
+        if constexpr(N == 2) {
+            return VecX<N, Real_t>(std::cos(phi), std::sin(phi));
+        } else {
+            const auto z = Real_t(2) * values[1] - Real_t(1);
+            const auto r = std::sqrt(std::max(Real_t(0), Real_t(1) - z * z));
+            return VecX<N, Real_t>(r * std::cos(phi), r * std::sin(phi), z);
+        }
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+    std::array<UInt, 2> m_Key;
+};
+
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 class FastRand {
 public:
@@ -369,6 +609,12 @@ void jitter(VecX<N, RealType1>& ppos, RealType2 maxJitter) {
     }
 }
 
+// deterministic parallel jittering: the offset of particle i depends only on (seed, i, step)
+template<Int N, class Real_t>
+void jitter(StdVT_VecX<N, Real_t>& positions, Real_t maxJitter, const CounterRandom<Real_t>& rng, UInt step) {
+    rng.template addUniform<N>(positions, step, -maxJitter, maxJitter);
+}
+
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 template<Int N, class Real_t>
 void translate(StdVT_VecX<N, Real_t>& points, const VecX<N, Real_t>& translation) {
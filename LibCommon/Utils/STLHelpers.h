@@ -17,6 +17,10 @@
 #include <vector>
 #include <map>
 #include <algorithm>
+#include <new>
+#include <memory>
+#include <type_traits>
+#include <utility>
 #include <LibCommon/CommonSetup.h>
 
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
@@ -54,6 +58,38 @@ struct VecHash {
     }
 };
 
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// Allocator returning memory aligned to Alignment bytes (default: cache line / AVX-512 register),
+// for vectors processed with aligned SIMD loads, e.g. std::vector<float, STLHelpers::AlignedAllocator<float>>
+template<class T, size_t Alignment = 64>
+struct AlignedAllocator {
+    static_assert(Alignment >= alignof(T), "Alignment must not be smaller than the alignment of T");
+    using value_type = T;
+    template<class U> struct rebind { using other = AlignedAllocator<U, Alignment>; };
+
+    AlignedAllocator() noexcept = default;
+    template<class U> AlignedAllocator(const AlignedAllocator<U, Alignment>&) noexcept {}
+
+    T*   allocate(size_t n) { return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(Alignment))); }
+    void deallocate(T* p, size_t) noexcept { ::operator delete(p, std::align_val_t(Alignment)); }
+
+    template<class U> bool operator==(const AlignedAllocator<U, Alignment>&) const noexcept { return true; }
+    template<class U> bool operator!=(const AlignedAllocator<U, Alignment>&) const noexcept { return false; }
+};
+
+// Allocator which default-initializes instead of value-initializing: resize(n) does not write the new elements of
+// trivial types, thus they can be initialized later in parallel (see ParallelExec::first_touch)
+template<class T>
+struct DefaultInitAllocator : std::allocator<T> {
+    template<class U> struct rebind { using other = DefaultInitAllocator<U>; };
+
+    DefaultInitAllocator() noexcept = default;
+    template<class U> DefaultInitAllocator(const DefaultInitAllocator<U>&) noexcept {}
+
+    template<class U> void construct(U* p) noexcept(std::is_nothrow_default_constructible_v<U>) { ::new(static_cast<void*>(p)) U; }
+    template<class U, class... Args> void construct(U* p, Args&&... args) { ::new(static_cast<void*>(p)) U(std::forward<Args>(args)...); }
+};
+
 //-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 template<class T>
 T maxAbs(const StdVT<T>& vec) {
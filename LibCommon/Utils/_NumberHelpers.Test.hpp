@@ -0,0 +1,93 @@
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//
+//    .--------------------------------------------------.
+//    |  This file is part of NTCodeBase                 |
+//    |  Created 2018 by NT (https://ttnghia.github.io)  |
+//    '--------------------------------------------------'
+//                            \o/
+//                             |
+//                            / |
+//
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+
+
+#pragma once
+
+#include <catch2/catch.hpp>
+#include <LibCommon/CommonSetup.h>
+#include <LibCommon/Utils/NumberHelpers.h>
+
+using namespace NTCodeBase;
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+#define COUNTER_RANDOM_DATA_SIZE 100'003
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// known answer tests of philox4x32 with 10 rounds, from the Random123 distribution (kat_vectors)
+TEST_CASE("Test_Philox_KAT", "[Test_Philox_KAT]")
+{
+    using Words = std::array<UInt, 4>;
+    REQUIRE(NumberHelpers::Philox4x32::generate({ 0u, 0u, 0u, 0u }, { 0u, 0u }) ==
+            Words({ 0x6627e8d5u, 0xe169c58du, 0xbc57ac4cu, 0x9b00dbd8u }));
+    REQUIRE(NumberHelpers::Philox4x32::generate({ 0xffffffffu, 0xffffffffu, 0xffffffffu, 0xffffffffu }, { 0xffffffffu, 0xffffffffu }) ==
+            Words({ 0x408f276du, 0x41c83b0eu, 0xa20bc7c6u, 0x6d5451fdu }));
+    REQUIRE(NumberHelpers::Philox4x32::generate({ 0x243f6a88u, 0x85a308d3u, 0x13198a2eu, 0x03707344u }, { 0xa4093822u, 0x299f31d0u }) ==
+            Words({ 0xd16cfe09u, 0x94fdccebu, 0x5001e420u, 0x24126ea1u }));
+
+    // the lane-parallel generator must give the same words
+    UInt ctr[4][3] = {
+        { 0u, 0xffffffffu, 0x243f6a88u },
+        { 0u, 0xffffffffu, 0x85a308d3u },
+        { 0u, 0xffffffffu, 0x13198a2eu },
+        { 0u, 0xffffffffu, 0x03707344u },
+    };
+    NumberHelpers::Philox4x32::generate<3>(ctr, { 0u, 0u });
+    for(Int w = 0; w < 4; ++w) {
+        REQUIRE(ctr[w][0] == NumberHelpers::Philox4x32::generate({ 0u, 0u, 0u, 0u }, { 0u, 0u })[w]);
+    }
+}
+
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+template<class Real_t>
+void testCounterRandom() {
+    NumberHelpers::CounterRandom<Real_t> rng(0x1234'5678'9abcULL);
+    const UInt                           step     = 7;
+    const UInt64                         idOffset = 0xffff'fff0ULL; // crosses the 32 bit boundary of the id
+
+    StdVT_Vec3<Real_t> uniformBatch(COUNTER_RANDOM_DATA_SIZE);
+    StdVT_Vec3<Real_t> normalBatch(COUNTER_RANDOM_DATA_SIZE);
+    StdVT_Vec3<Real_t> sphereBatch(COUNTER_RANDOM_DATA_SIZE);
+    rng.template generateUniform<3>(uniformBatch, step, Real_t(0), Real_t(1), idOffset);
+    rng.template generateNormal<3>(normalBatch, step, Real_t(0), Real_t(1), idOffset);
+    rng.template generateOnSphere<3>(sphereBatch, step, Real_t(1), idOffset);
+
+    StdVT_Vec3<Real_t> jittered(COUNTER_RANDOM_DATA_SIZE, Vec3<Real_t>(Real_t(1)));
+    NumberHelpers::jitter(jittered, Real_t(0.5), rng, step);
+
+    for(size_t i = 0; i < COUNTER_RANDOM_DATA_SIZE; ++i) {
+        const auto u = rng.template uniform01<3>(idOffset + i, step);
+        REQUIRE(uniformBatch[i] == u);
+        REQUIRE(normalBatch[i] == rng.template normal<3>(idOffset + i, step));
+        REQUIRE(sphereBatch[i] == rng.template onSphere<3>(idOffset + i, step));
+        for(Int d = 0; d < 3; ++d) {
+            REQUIRE(u[d] > Real_t(0));
+            REQUIRE(u[d] < Real_t(1));
+        }
+    }
+    const auto offsets = [&] {
+                             StdVT_Vec3<Real_t> result(COUNTER_RANDOM_DATA_SIZE);
+                             rng.template generateUniform<3>(result, step, Real_t(-0.5), Real_t(0.5));
+                             return result;
+                         } ();
+    for(size_t i = 0; i < COUNTER_RANDOM_DATA_SIZE; ++i) {
+        REQUIRE(jittered[i] == Vec3<Real_t>(Real_t(1)) + offsets[i]);
+    }
+}
+
+TEST_CASE("Test_CounterRandom", "[Test_CounterRandom]")
+{
+    testCounterRandom<float>();
+    testCounterRandom<double>();
+}